@@ -10,14 +10,22 @@
 
 # pragma once
 # include <memory>
+# include <cstring>
 # include "Fwd.hpp"
 # include "IReader.hpp"
+# include "Array.hpp"
+# include "ByteArray.hpp"
+# include "Compression.hpp"
 
 namespace s3d
 {
 	/// <summary>
 	/// アーカイブの読み込み
 	/// </summary>
+	/// <remarks>
+	/// 圧縮されたエントリは、最初にデータを読み込んだときに展開します。
+	/// 開いただけでは展開しないので、size() などは展開せずに返します。
+	/// </remarks>
 	class ArchivedFileReader : public IReader
 	{
 	private:
@@ -30,6 +38,47 @@ namespace s3d
 
 		int64 m_pos = 0;
 
+		// 圧縮されたデータのサイズ。圧縮されていない場合は 0
+		int64 m_compressedSize = 0;
+
+		mutable std::shared_ptr<const ByteArray> m_decompressed;
+
+		const ByteArray& decompressed() const
+		{
+			if (!m_decompressed)
+			{
+				Array<uint8> compressed(static_cast<size_t>(m_compressedSize));
+
+				const int64 readSize = m_reader->read(compressed.data(), m_offset, m_compressedSize);
+
+				m_decompressed = std::make_shared<const ByteArray>(
+					readSize == m_compressedSize ? Compression::Decompress(compressed.data(), compressed.size()) : ByteArray());
+			}
+
+			return *m_decompressed;
+		}
+
+		int64 readDecompressed(void* buffer, int64 pos, int64 size) const
+		{
+			const ByteArray& data = decompressed();
+
+			const int64 available = (data.size() < m_size) ? data.size() : m_size;
+
+			if (pos < 0 || pos >= available || size <= 0)
+			{
+				return 0;
+			}
+
+			if (size > available - pos)
+			{
+				size = available - pos;
+			}
+
+			std::memcpy(buffer, data.data() + pos, static_cast<size_t>(size));
+
+			return size;
+		}
+
 	public:
 
 		/// <summary>
@@ -53,6 +102,29 @@ namespace s3d
 			}
 		}
 
+		/// <summary>
+		/// 圧縮されたエントリを読み込みます。
+		/// </summary>
+		/// <param name="reader">
+		/// アーカイブの IReader
+		/// </param>
+		/// <param name="offset">
+		/// 圧縮されたデータの位置（バイト）
+		/// </param>
+		/// <param name="compressedSize">
+		/// 圧縮されたデータのサイズ（バイト）
+		/// </param>
+		/// <param name="size">
+		/// 展開後のサイズ（バイト）
+		/// </param>
+		ArchivedFileReader(std::shared_ptr<IReader> reader, int64 offset, int64 compressedSize, int64 size)
+			: ArchivedFileReader(reader, offset, compressedSize)
+		{
+			m_compressedSize = m_size;
+
+			m_size = m_compressedSize ? size : 0;
+		}
+
 		bool isOpened() const override
 		{
 			if (!m_reader)
@@ -126,6 +198,15 @@ namespace s3d
 				return 0;
 			}
 
+			if (m_compressedSize)
+			{
+				const int64 readSize = readDecompressed(buffer, m_pos, size);
+
+				m_pos += readSize;
+
+				return readSize;
+			}
+
 			if (m_pos + size > m_size)
 			{
 				size = m_size - m_pos;
@@ -147,17 +228,22 @@ namespace s3d
 				return 0;
 			}
 
+			if (m_compressedSize)
+			{
+				return readDecompressed(buffer, pos, size);
+			}
+
 			if (pos < 0)
 			{
 				return 0;
 			}
 
-			if (m_pos + pos > m_size)
+			if (pos > m_size)
 			{
 				return 0;
 			}
 
-			if (m_pos + pos + size > m_size)
+			if (size > m_size - pos)
 			{
 				size = m_size - pos;
 			}
@@ -172,6 +258,11 @@ namespace s3d
 				return false;
 			}
 
+			if (m_compressedSize)
+			{
+				return true;
+			}
+
 			return m_reader->supportsLookahead();
 		}
 
@@ -182,6 +273,11 @@ namespace s3d
 				return 0;
 			}
 
+			if (m_compressedSize)
+			{
+				return readDecompressed(buffer, m_pos, size);
+			}
+
 			if (m_pos + size > m_size)
 			{
 				size = m_size - m_pos;
@@ -197,17 +293,22 @@ namespace s3d
 				return 0;
 			}
 
+			if (m_compressedSize)
+			{
+				return readDecompressed(buffer, pos, size);
+			}
+
 			if (pos < 0)
 			{
 				return 0;
 			}
 
-			if (m_pos + pos > m_size)
+			if (pos > m_size)
 			{
 				return 0;
 			}
 
-			if (m_pos + pos + size > m_size)
+			if (size > m_size - pos)
 			{
 				size = m_size - pos;
 			}
@@ -0,0 +1,130 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <vector>
+# include <iterator>
+# include <stdexcept>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "PropertyMacro.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// 連続した要素への読み取り専用の参照
+	/// </summary>
+	/// <remarks>
+	/// 要素を所有しないので、参照先のメモリが解放された後は使えません。
+	/// </remarks>
+	template <class Type>
+	class ArrayView
+	{
+	private:
+
+		const Type* m_data = nullptr;
+
+		size_t m_size = 0;
+
+	public:
+
+		using value_type				= Type;
+		using size_type					= size_t;
+		using const_pointer				= const Type*;
+		using const_reference			= const Type&;
+		using const_iterator			= const Type*;
+		using const_reverse_iterator	= std::reverse_iterator<const_iterator>;
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		constexpr ArrayView() = default;
+
+		/// <summary>
+		/// 連続した要素への参照を作成します。
+		/// </summary>
+		/// <param name="data">
+		/// 先頭の要素へのポインタ
+		/// </param>
+		/// <param name="size">
+		/// 要素数
+		/// </param>
+		constexpr ArrayView(const Type* data, size_t size) noexcept
+			: m_data(data)
+			, m_size(size) {}
+
+		/// <summary>
+		/// 配列の要素への参照を作成します。
+		/// </summary>
+		/// <param name="array">
+		/// 配列
+		/// </param>
+		template <class Allocator>
+		ArrayView(const std::vector<Type, Allocator>& array) noexcept
+			: m_data(array.data())
+			, m_size(array.size()) {}
+
+		const_pointer data() const noexcept { return m_data; }
+
+		size_type size() const noexcept { return m_size; }
+
+		const_iterator begin() const noexcept { return m_data; }
+
+		const_iterator end() const noexcept { return m_data + m_size; }
+
+		const_iterator cbegin() const noexcept { return m_data; }
+
+		const_iterator cend() const noexcept { return m_data + m_size; }
+
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+		const_reference operator [](size_t index) const { return m_data[index]; }
+
+		const_reference at(size_t index) const
+		{
+			if (index >= m_size)
+			{
+				throw std::out_of_range("ArrayView::at() index out of range");
+			}
+
+			return m_data[index];
+		}
+
+		const_reference front() const { return m_data[0]; }
+
+		const_reference back() const { return m_data[m_size - 1]; }
+
+		/// <summary>
+		/// 要素が空であるかを示します。
+		/// </summary>
+		Property_Get(bool, isEmpty) const noexcept { return m_size == 0; }
+
+		/// <summary>
+		/// 要素が空でないかを返します。
+		/// </summary>
+		/// <returns>
+		/// 要素が空でない場合 true, それ以外の場合は false
+		/// </returns>
+		explicit operator bool() const noexcept { return m_size != 0; }
+
+		/// <summary>
+		/// 要素をコピーした配列を返します。
+		/// </summary>
+		/// <returns>
+		/// 配列
+		/// </returns>
+		Array<Type> asArray() const
+		{
+			return Array<Type>(begin(), end());
+		}
+	};
+}
@@ -0,0 +1,378 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cstring>
+# include <utility>
+# include <algorithm>
+# include <type_traits>
+# include "Fwd.hpp"
+# include "IReader.hpp"
+# include "Array.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// 読み込みバッファ付きの IReader
+	/// </summary>
+	/// <remarks>
+	/// Reader からバッファの大きさずつまとめて読み込み、小さな読み込みをバッファから返します。
+	/// 小さな値を何度も読み込む場合に、Reader の仮想関数呼び出しやシステムコールの回数を減らします。
+	/// バッファより大きな読み込みは、バッファを経由せずに直接 Reader から読み込みます。
+	/// </remarks>
+	template <class Reader>
+	class BufferedReader final : public IReader
+	{
+	private:
+
+		static_assert(std::is_base_of<IReader, Reader>::value, "BufferedReader: Reader must be derived from IReader");
+
+		Reader m_reader;
+
+		Array<uint8> m_buffer = Array<uint8>(DefaultBufferSize);
+
+		// m_buffer[0] に対応する Reader 上の位置
+		int64 m_bufferPos = 0;
+
+		// バッファ内の現在の読み込み位置
+		size_t m_current = 0;
+
+		// バッファ内の有効なデータのサイズ
+		size_t m_available = 0;
+
+		void resetBuffer()
+		{
+			m_bufferPos = m_reader.getPos();
+
+			m_current = m_available = 0;
+		}
+
+		int64 readSlow(void* buffer, int64 size)
+		{
+			uint8* dst = static_cast<uint8*>(buffer);
+
+			const size_t buffered = m_available - m_current;
+
+			std::memcpy(dst, m_buffer.data() + m_current, buffered);
+
+			m_current = m_available;
+
+			dst += buffered;
+
+			size -= buffered;
+
+			// Reader の位置はつねにバッファの末尾にある
+			if (static_cast<uint64>(size) >= m_buffer.size())
+			{
+				const int64 readSize = m_reader.read(dst, size);
+
+				resetBuffer();
+
+				return buffered + readSize;
+			}
+
+			m_bufferPos += m_available;
+
+			m_current = 0;
+
+			m_available = static_cast<size_t>(m_reader.read(m_buffer.data(), m_buffer.size()));
+
+			const size_t count = std::min(static_cast<size_t>(size), m_available);
+
+			std::memcpy(dst, m_buffer.data(), count);
+
+			m_current = count;
+
+			return buffered + count;
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトのバッファの大きさ（バイト）
+		/// </summary>
+		static constexpr size_t DefaultBufferSize = 64 * 1024;
+
+		/// <summary>
+		/// バッファの大きさの最小値（バイト）
+		/// </summary>
+		static constexpr size_t MinBufferSize = 16;
+
+		/// <summary>
+		/// Reader を作成します。
+		/// </summary>
+		/// <param name="args">
+		/// Reader のコンストラクタ引数
+		/// </param>
+		template <class ...Args, class = std::enable_if_t<std::is_constructible<Reader, Args&&...>::value>>
+		explicit BufferedReader(Args&&... args)
+			: m_reader(std::forward<Args>(args)...)
+		{
+			resetBuffer();
+		}
+
+		BufferedReader(const BufferedReader&) = delete;
+
+		BufferedReader& operator =(const BufferedReader&) = delete;
+
+		BufferedReader(BufferedReader&& other)
+			: m_reader(std::move(other.m_reader))
+			, m_buffer(std::move(other.m_buffer))
+			, m_bufferPos(other.m_bufferPos)
+			, m_current(std::exchange(other.m_current, 0))
+			, m_available(std::exchange(other.m_available, 0)) {}
+
+		/// <summary>
+		/// バッファの大きさを変更します。
+		/// </summary>
+		/// <param name="size">
+		/// バッファの大きさ（バイト）
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void setBufferSize(size_t size)
+		{
+			const int64 pos = getPos();
+
+			m_buffer.resize(size < MinBufferSize ? MinBufferSize : size);
+
+			m_buffer.shrink_to_fit();
+
+			m_reader.setPos(pos);
+
+			resetBuffer();
+		}
+
+		/// <summary>
+		/// 読み込み位置をバッファの位置に合わせてから、Reader を返します。
+		/// </summary>
+		/// <returns>
+		/// Reader
+		/// </returns>
+		Reader& getReader()
+		{
+			if (m_current != m_available)
+			{
+				m_reader.setPos(getPos());
+			}
+
+			resetBuffer();
+
+			return m_reader;
+		}
+
+		bool isOpened() const override
+		{
+			return m_reader.isOpened();
+		}
+
+		explicit operator bool() const { return isOpened(); }
+
+		int64 size() const override
+		{
+			return m_reader.size();
+		}
+
+		/// <summary>
+		/// 現在の読み込み位置を返します。
+		/// </summary>
+		/// <returns>
+		/// 現在の読み込み位置（バイト）
+		/// </returns>
+		int64 getPos() const override
+		{
+			return m_bufferPos + static_cast<int64>(m_current);
+		}
+
+		/// <summary>
+		/// 読み込み位置を変更します。
+		/// </summary>
+		/// <remarks>
+		/// 新しい位置がバッファの範囲内にある場合は、Reader から読み直しません。
+		/// </remarks>
+		/// <param name="pos">
+		/// 新しい読み込み位置（バイト）
+		/// </param>
+		/// <returns>
+		/// 読み込み位置の変更に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool setPos(int64 pos) override
+		{
+			if (m_bufferPos <= pos && pos <= m_bufferPos + static_cast<int64>(m_available))
+			{
+				m_current = static_cast<size_t>(pos - m_bufferPos);
+
+				return true;
+			}
+
+			if (!m_reader.setPos(pos))
+			{
+				return false;
+			}
+
+			resetBuffer();
+
+			return true;
+		}
+
+		/// <summary>
+		/// 読み込み位置を移動します。
+		/// </summary>
+		/// <param name="offset">
+		/// 移動するサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 新しい読み込み位置
+		/// </returns>
+		int64 skip(int64 offset) override
+		{
+			setPos(getPos() + offset);
+
+			return getPos();
+		}
+
+		using IReader::read;
+
+		/// <summary>
+		/// データを読み込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 読み込み先
+		/// </param>
+		/// <param name="size">
+		/// 読み込むサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 実際に読み込んだサイズ（バイト）
+		/// </returns>
+		int64 read(_Out_writes_bytes_all_(size) void* buffer, int64 size) override
+		{
+			if (static_cast<uint64>(size) <= m_available - m_current)
+			{
+				std::memcpy(buffer, m_buffer.data() + m_current, static_cast<size_t>(size));
+
+				m_current += static_cast<size_t>(size);
+
+				return size;
+			}
+
+			return readSlow(buffer, size);
+		}
+
+		/// <summary>
+		/// 読み込み位置を変更してから、データを読み込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 読み込み先
+		/// </param>
+		/// <param name="pos">
+		/// 先頭から数えた読み込み開始位置（バイト）
+		/// </param>
+		/// <param name="size">
+		/// 読み込むサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 実際に読み込んだサイズ（バイト）
+		/// </returns>
+		int64 read(_Out_writes_bytes_all_(size) void* buffer, int64 pos, int64 size) override
+		{
+			if (!setPos(pos))
+			{
+				return 0;
+			}
+
+			return read(buffer, size);
+		}
+
+		/// <summary>
+		/// データを読み込みます。
+		/// </summary>
+		/// <param name="to">
+		/// 読み込み先
+		/// </param>
+		/// <returns>
+		/// 読み込みに成功したら true, それ以外の場合は false
+		/// </returns>
+		template <class Type>
+		_Check_return_ bool read(Type& to)
+		{
+			static_assert(std::is_trivially_copyable<Type>::value, "Type must be trivially copyable");
+
+			if (sizeof(Type) <= m_available - m_current)
+			{
+				std::memcpy(std::addressof(to), m_buffer.data() + m_current, sizeof(Type));
+
+				m_current += sizeof(Type);
+
+				return true;
+			}
+
+			return readSlow(std::addressof(to), sizeof(Type)) == sizeof(Type);
+		}
+
+		using IReader::lookahead;
+
+		/// <summary>
+		/// 読み込み位置を変更しないデータ読み込みをサポートしているかを返します。
+		/// </summary>
+		/// <returns>
+		/// Reader がサポートしている場合 true, それ以外の場合は false
+		/// </returns>
+		bool supportsLookahead() const override
+		{
+			return m_reader.supportsLookahead();
+		}
+
+		/// <summary>
+		/// 読み込み位置を変更しないでデータを読み込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 読み込み先
+		/// </param>
+		/// <param name="size">
+		/// 読み込むサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 実際に読み込んだサイズ（バイト）
+		/// </returns>
+		int64 lookahead(_Out_writes_bytes_all_(size) void* buffer, int64 size) const override
+		{
+			return lookahead(buffer, getPos(), size);
+		}
+
+		/// <summary>
+		/// 読み込み位置を変更しないでデータを読み込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 読み込み先
+		/// </param>
+		/// <param name="pos">
+		/// 先頭から数えた読み込み開始位置（バイト）
+		/// </param>
+		/// <param name="size">
+		/// 読み込むサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 実際に読み込んだサイズ（バイト）
+		/// </returns>
+		int64 lookahead(_Out_writes_bytes_all_(size) void* buffer, int64 pos, int64 size) const override
+		{
+			if (m_bufferPos <= pos && pos + size <= m_bufferPos + static_cast<int64>(m_available))
+			{
+				std::memcpy(buffer, m_buffer.data() + (pos - m_bufferPos), static_cast<size_t>(size));
+
+				return size;
+			}
+
+			return m_reader.lookahead(buffer, pos, size);
+		}
+	};
+}
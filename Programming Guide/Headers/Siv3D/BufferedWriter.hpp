@@ -0,0 +1,246 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cstring>
+# include <utility>
+# include <algorithm>
+# include <type_traits>
+# include "Fwd.hpp"
+# include "IWriter.hpp"
+# include "Array.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// 書き込みバッファ付きの IWriter
+	/// </summary>
+	/// <remarks>
+	/// 書き込んだデータはバッファにたまり、バッファが一杯になったときと flush() を呼んだときに
+	/// まとめて Writer に書き込まれます。小さな値を何度も書き込む場合に、
+	/// Writer の仮想関数呼び出しやシステムコールの回数を減らします。
+	/// バッファより大きなデータは、バッファを経由せずに直接書き込みます。
+	/// </remarks>
+	template <class Writer>
+	class BufferedWriter final : public IWriter
+	{
+	private:
+
+		static_assert(std::is_base_of<IWriter, Writer>::value, "BufferedWriter: Writer must be derived from IWriter");
+
+		Writer m_writer;
+
+		Array<uint8> m_buffer = Array<uint8>(DefaultBufferSize);
+
+		size_t m_size = 0;
+
+		size_t writeSlow(const void* buffer, size_t size)
+		{
+			flush();
+
+			if (size >= m_buffer.size())
+			{
+				return m_writer.write(buffer, size);
+			}
+
+			std::memcpy(m_buffer.data(), buffer, size);
+
+			m_size = size;
+
+			return size;
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトのバッファの大きさ（バイト）
+		/// </summary>
+		static constexpr size_t DefaultBufferSize = 64 * 1024;
+
+		/// <summary>
+		/// バッファの大きさの最小値（バイト）
+		/// </summary>
+		static constexpr size_t MinBufferSize = 16;
+
+		/// <summary>
+		/// Writer を作成します。
+		/// </summary>
+		/// <param name="args">
+		/// Writer のコンストラクタ引数
+		/// </param>
+		template <class ...Args, class = std::enable_if_t<std::is_constructible<Writer, Args&&...>::value>>
+		explicit BufferedWriter(Args&&... args)
+			: m_writer(std::forward<Args>(args)...) {}
+
+		BufferedWriter(const BufferedWriter&) = delete;
+
+		BufferedWriter& operator =(const BufferedWriter&) = delete;
+
+		BufferedWriter(BufferedWriter&& other)
+			: m_writer(std::move(other.m_writer))
+			, m_buffer(std::move(other.m_buffer))
+			, m_size(std::exchange(other.m_size, 0)) {}
+
+		/// <summary>
+		/// デストラクタ
+		/// </summary>
+		/// <remarks>
+		/// バッファに残っているデータを書き込みます。
+		/// </remarks>
+		~BufferedWriter()
+		{
+			flush();
+		}
+
+		/// <summary>
+		/// バッファの内容を Writer に書き込みます。
+		/// </summary>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void flush()
+		{
+			if (m_size)
+			{
+				m_writer.write(m_buffer.data(), std::exchange(m_size, 0));
+			}
+		}
+
+		/// <summary>
+		/// バッファの大きさを変更します。
+		/// </summary>
+		/// <param name="size">
+		/// バッファの大きさ（バイト）
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void setBufferSize(size_t size)
+		{
+			flush();
+
+			m_buffer.resize(size < MinBufferSize ? MinBufferSize : size);
+
+			m_buffer.shrink_to_fit();
+		}
+
+		/// <summary>
+		/// バッファの内容を書き込んでから、Writer を返します。
+		/// </summary>
+		/// <returns>
+		/// Writer
+		/// </returns>
+		Writer& getWriter()
+		{
+			flush();
+
+			return m_writer;
+		}
+
+		bool isOpened() const override
+		{
+			return m_writer.isOpened();
+		}
+
+		explicit operator bool() const { return isOpened(); }
+
+		/// <summary>
+		/// バッファの内容を含めたサイズを返します。
+		/// </summary>
+		/// <returns>
+		/// サイズ（バイト）
+		/// </returns>
+		int64 size() const override
+		{
+			return std::max(m_writer.size(), getPos());
+		}
+
+		/// <summary>
+		/// バッファの内容を含めた書き込み位置を返します。
+		/// </summary>
+		/// <returns>
+		/// 現在の書き込み位置（バイト）
+		/// </returns>
+		int64 getPos() const override
+		{
+			return m_writer.getPos() + static_cast<int64>(m_size);
+		}
+
+		/// <summary>
+		/// バッファの内容を書き込んでから、書き込み位置を変更します。
+		/// </summary>
+		/// <param name="pos">
+		/// 新しい書き込み位置（バイト）
+		/// </param>
+		/// <returns>
+		/// 書き込み位置の変更に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool setPos(int64 pos) override
+		{
+			flush();
+
+			return m_writer.setPos(pos);
+		}
+
+		using IWriter::write;
+
+		/// <summary>
+		/// データを書き込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 書き込むデータ
+		/// </param>
+		/// <param name="size">
+		/// 書き込むサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 実際に書き込んだサイズ（バイト）
+		/// </returns>
+		size_t write(_In_reads_bytes_(size) const void* buffer, size_t size) override
+		{
+			if (size <= m_buffer.size() - m_size)
+			{
+				std::memcpy(m_buffer.data() + m_size, buffer, size);
+
+				m_size += size;
+
+				return size;
+			}
+
+			return writeSlow(buffer, size);
+		}
+
+		/// <summary>
+		/// データを書き込みます。
+		/// </summary>
+		/// <param name="src">
+		/// 書き込むデータ
+		/// </param>
+		/// <returns>
+		/// 実際に書き込んだサイズ（バイト）
+		/// </returns>
+		template <class Type>
+		size_t write(const Type& src)
+		{
+			static_assert(std::is_trivially_copyable<Type>::value, "Type must be trivially copyable");
+
+			if (sizeof(Type) <= m_buffer.size() - m_size)
+			{
+				std::memcpy(m_buffer.data() + m_size, std::addressof(src), sizeof(Type));
+
+				m_size += sizeof(Type);
+
+				return sizeof(Type);
+			}
+
+			return writeSlow(std::addressof(src), sizeof(Type));
+		}
+	};
+}
@@ -9,22 +9,54 @@
 //-----------------------------------------------
 
 # pragma once
+# include <memory>
 # include "Format.hpp"
-# include "TextWriter.hpp"
+# include "UTF8Writer.hpp"
 
 namespace s3d
 {
 	/// <summary>
 	/// CSV データの書き出し
 	/// </summary>
+	/// <remarks>
+	/// レコードは UTF8Writer のバッファを通して書き出されるので、書き出す量によらず使うメモリは一定です。
+	/// レコードの中の " は "" にエスケープされます。
+	/// </remarks>
 	class CSVWriter
 	{
 	private:
 
-		TextWriter m_writer;
+		UTF8Writer m_writer;
+
+		String m_field;
 
 		bool m_isHead = true;
 
+		void writeField(StringView record)
+		{
+			if (!std::exchange(m_isHead, false))
+			{
+				m_writer.write(L',');
+			}
+
+			m_writer.write(L'\"');
+
+			const wchar* p = record.data();
+
+			const wchar* const last = p + record.length();
+
+			for (const wchar* quote; (quote = std::char_traits<wchar>::find(p, last - p, L'\"')) != nullptr; p = quote + 1)
+			{
+				m_writer.write(StringView(p, quote - p + 1));
+
+				m_writer.write(L'\"');
+			}
+
+			m_writer.write(StringView(p, last - p));
+
+			m_writer.write(L'\"');
+		}
+
 		void format()
 		{
 			return;
@@ -33,7 +65,9 @@ namespace s3d
 		template <class Type, class ... Args>
 		inline void format(const Type& record, const Args& ... records)
 		{
-			write(Format(record));
+			FormatTo(m_field, record);
+
+			writeField(m_field);
 
 			return format(records...);
 		}
@@ -54,6 +88,31 @@ namespace s3d
 		explicit CSVWriter(const FilePath& path)
 			: m_writer(path) {}
 
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <param name="writeBOM">
+		/// IWriter が空のとき、先頭に BOM を書き込むか
+		/// </param>
+		template <class Writer, class = std::enable_if_t<std::is_base_of<IWriter, std::decay_t<Writer>>::value>>
+		explicit CSVWriter(Writer&& writer, bool writeBOM = false)
+			: m_writer(std::forward<Writer>(writer), writeBOM) {}
+
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <param name="writeBOM">
+		/// IWriter が空のとき、先頭に BOM を書き込むか
+		/// </param>
+		explicit CSVWriter(const std::shared_ptr<IWriter>& writer, bool writeBOM = false)
+			: m_writer(writer, writeBOM) {}
+
 		/// <summary>
 		/// デストラクタ
 		/// </summary>
@@ -73,9 +132,50 @@ namespace s3d
 		/// </returns>
 		bool open(const FilePath& path)
 		{
+			close();
+
 			return m_writer.open(path);
 		}
 
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <param name="writeBOM">
+		/// IWriter が空のとき、先頭に BOM を書き込むか
+		/// </param>
+		/// <returns>
+		/// IWriter が開いている場合 true, それ以外の場合は false
+		/// </returns>
+		template <class Writer, class = std::enable_if_t<std::is_base_of<IWriter, std::decay_t<Writer>>::value>>
+		bool open(Writer&& writer, bool writeBOM = false)
+		{
+			close();
+
+			return m_writer.open(std::forward<Writer>(writer), writeBOM);
+		}
+
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <param name="writeBOM">
+		/// IWriter が空のとき、先頭に BOM を書き込むか
+		/// </param>
+		/// <returns>
+		/// IWriter が開いている場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const std::shared_ptr<IWriter>& writer, bool writeBOM = false)
+		{
+			close();
+
+			return m_writer.open(writer, writeBOM);
+		}
+
 		/// <summary>
 		/// CSV データを書き出し、ファイルをクローズします。
 		/// </summary>
@@ -95,6 +195,19 @@ namespace s3d
 			}
 
 			m_writer.close();
+
+			m_isHead = true;
+		}
+
+		/// <summary>
+		/// バッファの内容を書き出します。
+		/// </summary>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void flush()
+		{
+			m_writer.flush();
 		}
 
 		/// <summary>
@@ -127,16 +240,7 @@ namespace s3d
 		/// </returns>
 		void write(const String& record)
 		{
-			if (!std::exchange(m_isHead, false))
-			{
-				m_writer.write(L',');
-			}
-
-			m_writer.write(L'\"');
-
-			m_writer.write(record);
-
-			m_writer.write(L'\"');
+			writeField(record);
 		}
 
 		/// <summary>
@@ -215,7 +319,7 @@ namespace s3d
 		/// </returns>
 		void nextLine()
 		{
-			m_writer.write(L"\r\n");
+			m_writer.writeUTF8("\r\n", 2);
 
 			m_isHead = true;
 		}
@@ -556,10 +556,30 @@ namespace s3d
 		return os << CharType('(') << c.x << CharType(',') << c.y << CharType(',') << c.r << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const Circle& c)
+	{
+		FormatTuple(formatData, c.x, c.y, c.r);
+	}
+
 	template <class CharType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, Circle& c)
 	{
 		CharType unused;
 		return is >> unused >> c.x >> unused >> c.y >> unused >> c.r >> unused;
 	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Circle& c)
+	{
+		Circle result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.x, result.y, result.r);
+
+		if (r)
+		{
+			c = result;
+		}
+
+		return r;
+	}
 }
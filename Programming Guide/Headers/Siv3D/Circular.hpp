@@ -96,6 +96,12 @@ namespace s3d
 		return os << CharType('(') << c.r << CharType(',') << c.theta << CharType(')');
 	}
 
+	template <int32 Oclock>
+	inline void Formatter(FormatData& formatData, const CircularBase<Oclock>& c)
+	{
+		FormatTuple(formatData, c.r, c.theta);
+	}
+
 	/// <summary>
 	/// 入力ストリームに極座標を渡します。
 	/// </summary>
@@ -115,6 +121,21 @@ namespace s3d
 		return is >> unused >> c.r >> unused >> c.theta >> unused;
 	}
 
+	template <bool Oclock>
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, CircularBase<Oclock>& c)
+	{
+		CircularBase<Oclock> result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.r, result.theta);
+
+		if (r)
+		{
+			c = result;
+		}
+
+		return r;
+	}
+
 	template <int32 Oclock>
 	inline Vec2 operator + (const Vec2& pos, const CircularBase<Oclock>& c)
 	{
@@ -12,6 +12,8 @@
 # include <iostream>
 # include "Fwd.hpp"
 # include "StringView.hpp"
+# include "FromChars.hpp"
+# include "Format.hpp"
 
 namespace s3d
 {
@@ -322,6 +324,12 @@ namespace s3d
 			<< color.a << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const Color& color)
+	{
+		FormatTuple(formatData, static_cast<uint32>(color.r), static_cast<uint32>(color.g), static_cast<uint32>(color.b), static_cast<uint32>(color.a));
+	}
+
 	/// <summary>
 	/// 入力ストリームに色を渡します。
 	/// </summary>
@@ -361,6 +369,38 @@ namespace s3d
 
 		return is;
 	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Color& color)
+	{
+		detail::TextScanner scanner(first, last);
+
+		uint32 cols[4];
+		wchar unused;
+
+		scanner >> unused
+			>> cols[0] >> unused
+			>> cols[1] >> unused
+			>> cols[2] >> unused;
+
+		if (unused == L',')
+		{
+			scanner >> cols[3] >> unused;
+		}
+		else
+		{
+			cols[3] = 255;
+		}
+
+		if (scanner)
+		{
+			color.r = cols[0] & 0xFF;
+			color.g = cols[1] & 0xFF;
+			color.b = cols[2] & 0xFF;
+			color.a = cols[3] & 0xFF;
+		}
+
+		return scanner.result();
+	}
 }
 
 namespace s3d
@@ -796,6 +836,12 @@ namespace s3d
 			<< color.a << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const ColorF& color)
+	{
+		FormatTuple(formatData, color.r, color.g, color.b, color.a);
+	}
+
 	/// <summary>
 	/// 入力ストリームに色を渡します。
 	/// </summary>
@@ -830,6 +876,35 @@ namespace s3d
 		return is;
 	}
 
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, ColorF& color)
+	{
+		detail::TextScanner scanner(first, last);
+
+		ColorF result;
+		wchar unused;
+
+		scanner >> unused
+			>> result.r >> unused
+			>> result.g >> unused
+			>> result.b >> unused;
+
+		if (unused == L',')
+		{
+			scanner >> result.a >> unused;
+		}
+		else
+		{
+			result.a = 1.0;
+		}
+
+		if (scanner)
+		{
+			color = result;
+		}
+
+		return scanner.result();
+	}
+
 	/// <summary>
 	/// Color(255, 255, 255, alpha) を返します。
 	/// </summary>
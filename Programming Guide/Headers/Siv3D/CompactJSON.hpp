@@ -0,0 +1,936 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include <string>
+# include <cstring>
+# include <algorithm>
+# include <utility>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "String.hpp"
+# include "StringView.hpp"
+# include "Optional.hpp"
+# include "Parse.hpp"
+# include "Unicode.hpp"
+# include "JSONValue.hpp"
+# include "JSONPullParser.hpp"
+
+namespace s3d
+{
+	namespace detail
+	{
+		/// <summary>
+		/// CompactJSONDocument の 1 つの値
+		/// </summary>
+		/// <remarks>
+		/// 文字列は text 上の UTF-8 の範囲、配列とオブジェクトは nodes 上の連続した子の範囲を指します。
+		/// オブジェクトの子はキーと値の組を並べたもので、キーの UTF-8 のバイト列の順に整列しています。
+		/// </remarks>
+		struct CompactJSONNode
+		{
+			JSONValue::ValueType type;
+
+			// 文字列のバイト数、または配列の要素数、オブジェクトのメンバ数
+			uint32 size;
+
+			union
+			{
+				bool boolean;
+
+				double number;
+
+				// 文字列の text 上の位置、または最初の子の nodes 上の位置
+				uint32 offset;
+			};
+		};
+
+		static_assert(sizeof(CompactJSONNode) == 16, "CompactJSONNode must be 16 bytes");
+
+		/// <summary>
+		/// CompactJSONDocument の全ての値を保持する領域
+		/// </summary>
+		/// <remarks>
+		/// 値は nodes に、文字列は text にまとめて確保されるので、破棄は 2 回の解放で済みます。
+		/// </remarks>
+		struct CompactJSONStorage
+		{
+			std::string text;
+
+			Array<CompactJSONNode> nodes;
+
+			FilePath path;
+
+			size_t stringSize(uint32 i) const
+			{
+				return nodes[i].size;
+			}
+
+			const char* stringData(uint32 i) const
+			{
+				return text.data() + nodes[i].offset;
+			}
+
+			int32 compareKey(uint32 i, const char* key, size_t length) const
+			{
+				const size_t size = nodes[i].size;
+
+				const int32 result = std::memcmp(stringData(i), key, std::min(size, length));
+
+				if (result != 0)
+				{
+					return result;
+				}
+
+				return (size < length) ? -1 : (size > length) ? 1 : 0;
+			}
+
+			bool keyLess(const CompactJSONNode& a, const CompactJSONNode& b) const
+			{
+				const int32 result = std::memcmp(text.data() + a.offset, text.data() + b.offset, std::min(a.size, b.size));
+
+				return result < 0 || (result == 0 && a.size < b.size);
+			}
+
+			// オブジェクト first から count 組のキーと値を、キーの順に並べ替える
+			void sortMembers(uint32 first, uint32 count)
+			{
+				if (count < 2)
+				{
+					return;
+				}
+
+				CompactJSONNode* const members = nodes.data() + first;
+
+				// 小さなオブジェクトは、メモリを確保せずにその場で挿入ソートする
+				if (count <= 16)
+				{
+					for (uint32 k = 1; k < count; ++k)
+					{
+						const CompactJSONNode key = members[2 * k], value = members[2 * k + 1];
+
+						uint32 j = k;
+
+						for (; j > 0 && keyLess(key, members[2 * (j - 1)]); --j)
+						{
+							members[2 * j] = members[2 * (j - 1)];
+
+							members[2 * j + 1] = members[2 * (j - 1) + 1];
+						}
+
+						members[2 * j] = key;
+
+						members[2 * j + 1] = value;
+					}
+
+					return;
+				}
+
+				Array<std::pair<CompactJSONNode, CompactJSONNode>> sorted(count);
+
+				for (uint32 k = 0; k < count; ++k)
+				{
+					sorted[k] = { members[2 * k], members[2 * k + 1] };
+				}
+
+				std::stable_sort(sorted.begin(), sorted.end(), [this](const auto& a, const auto& b)
+				{
+					return keyLess(a.first, b.first);
+				});
+
+				for (uint32 k = 0; k < count; ++k)
+				{
+					members[2 * k] = sorted[k].first;
+
+					members[2 * k + 1] = sorted[k].second;
+				}
+			}
+
+			void fromValue(uint32 node, const JSONValue& value)
+			{
+				CompactJSONNode& n = nodes[node];
+
+				n.type = value.getType();
+
+				n.size = 0;
+
+				n.offset = 0;
+
+				switch (n.type)
+				{
+				case JSONValue::ValueType::Boolean:
+					n.boolean = value.getBool();
+					break;
+				case JSONValue::ValueType::Number:
+					n.number = value.getNumber();
+					break;
+				case JSONValue::ValueType::String:
+					{
+						const uint32 offset = static_cast<uint32>(text.size());
+
+						n.size = static_cast<uint32>(Unicode::AppendUTF8(value.getString(), text));
+
+						n.offset = offset;
+
+						break;
+					}
+				case JSONValue::ValueType::Array:
+					{
+						const JSONArray& array = value.getArray();
+
+						const uint32 first = static_cast<uint32>(nodes.size());
+
+						n.size = static_cast<uint32>(array.size());
+
+						n.offset = first;
+
+						nodes.resize(first + array.size());
+
+						for (size_t k = 0; k < array.size(); ++k)
+						{
+							fromValue(static_cast<uint32>(first + k), array[k]);
+						}
+
+						break;
+					}
+				case JSONValue::ValueType::Object:
+					{
+						const JSONObject& object = value.getObject();
+
+						const uint32 first = static_cast<uint32>(nodes.size());
+
+						n.size = static_cast<uint32>(object.size());
+
+						n.offset = first;
+
+						nodes.resize(first + 2 * object.size());
+
+						uint32 k = first;
+
+						for (const auto& member : object)
+						{
+							nodes[k].type = JSONValue::ValueType::String;
+
+							nodes[k].offset = static_cast<uint32>(text.size());
+
+							nodes[k].size = static_cast<uint32>(Unicode::AppendUTF8(member.first, text));
+
+							fromValue(k + 1, member.second);
+
+							k += 2;
+						}
+
+						sortMembers(first, static_cast<uint32>(object.size()));
+
+						break;
+					}
+				default:
+					break;
+				}
+			}
+
+			JSONValue toValue(uint32 node) const
+			{
+				const CompactJSONNode& n = nodes[node];
+
+				switch (n.type)
+				{
+				case JSONValue::ValueType::Boolean:
+					return JSONValue(n.boolean);
+				case JSONValue::ValueType::Number:
+					return JSONValue(n.number);
+				case JSONValue::ValueType::String:
+					return JSONValue(Unicode::FromUTF8(stringData(node), n.size));
+				case JSONValue::ValueType::Array:
+					{
+						JSONArray array;
+
+						array.reserve(n.size);
+
+						for (uint32 k = 0; k < n.size; ++k)
+						{
+							array.push_back(toValue(n.offset + k));
+						}
+
+						return JSONValue(array);
+					}
+				case JSONValue::ValueType::Object:
+					{
+						JSONObject object;
+
+						object.reserve(n.size);
+
+						for (uint32 k = 0; k < n.size; ++k)
+						{
+							const uint32 key = n.offset + 2 * k;
+
+							object[Unicode::FromUTF8(stringData(key), nodes[key].size)] = toValue(key + 1);
+						}
+
+						return JSONValue(object);
+					}
+				default:
+					return JSONValue();
+				}
+			}
+		};
+
+		/// <summary>
+		/// JSONIndex から CompactJSONStorage を作る
+		/// </summary>
+		class CompactJSONBuilder
+		{
+		private:
+
+			const JSONIndex& m_index;
+
+			CompactJSONStorage& m_storage;
+
+			// エスケープを含む文字列を展開して置く領域。最後に text の末尾に連結する
+			std::string m_unescaped;
+
+			String m_buffer;
+
+			void setString(uint32 node, uint32 i)
+			{
+				CompactJSONNode& n = m_storage.nodes[node];
+
+				bool escaped;
+
+				const char* first = m_index.text.data() + m_index.structurals[i] + 1;
+
+				const char* last = m_index.stringEnd(i, escaped);
+
+				n.type = JSONValue::ValueType::String;
+
+				if (!escaped)
+				{
+					n.offset = static_cast<uint32>(first - m_index.text.data());
+
+					n.size = static_cast<uint32>(last - first);
+
+					return;
+				}
+
+				m_buffer.clear();
+
+				m_index.appendString(i, m_buffer);
+
+				n.offset = static_cast<uint32>(m_index.text.size() + m_unescaped.size());
+
+				n.size = static_cast<uint32>(Unicode::AppendUTF8(m_buffer, m_unescaped));
+			}
+
+			void build(uint32 node, uint32 i)
+			{
+				switch (m_index.at(i))
+				{
+				case '{':
+				case '[':
+					{
+						const bool object = (m_index.at(i) == '{');
+
+						uint32 count = 0;
+
+						for (uint32 child = m_index.firstChild(i); child; child = m_index.nextSibling(child, object))
+						{
+							++count;
+						}
+
+						const uint32 first = static_cast<uint32>(m_storage.nodes.size());
+
+						m_storage.nodes.resize(first + (object ? 2 * count : count));
+
+						CompactJSONNode& n = m_storage.nodes[node];
+
+						n.type = object ? JSONValue::ValueType::Object : JSONValue::ValueType::Array;
+
+						n.size = count;
+
+						n.offset = first;
+
+						uint32 k = first;
+
+						for (uint32 child = m_index.firstChild(i); child; child = m_index.nextSibling(child, object))
+						{
+							if (object)
+							{
+								setString(k++, child - 2);
+							}
+
+							build(k++, child);
+						}
+
+						break;
+					}
+				case '"':
+					setString(node, i);
+					break;
+				case 't':
+				case 'f':
+					m_storage.nodes[node].type = JSONValue::ValueType::Boolean;
+					m_storage.nodes[node].boolean = (m_index.at(i) == 't');
+					break;
+				case 'n':
+					m_storage.nodes[node].type = JSONValue::ValueType::Null;
+					break;
+				default:
+					m_storage.nodes[node].type = JSONValue::ValueType::Number;
+					m_storage.nodes[node].number = m_index.getNumber(i);
+					break;
+				}
+			}
+
+			// 文字列が text 上で確定してから、オブジェクトのメンバを整列する
+			void sortObjects()
+			{
+				for (const auto& n : m_storage.nodes)
+				{
+					if (n.type == JSONValue::ValueType::Object)
+					{
+						m_storage.sortMembers(n.offset, n.size);
+					}
+				}
+			}
+
+		public:
+
+			CompactJSONBuilder(const JSONIndex& index, CompactJSONStorage& storage)
+				: m_index(index)
+				, m_storage(storage) {}
+
+			void build()
+			{
+				// 値とキーの数は、: , } ] 以外の構造文字の数に等しい
+				size_t count = 0;
+
+				for (const uint32 pos : m_index.structurals)
+				{
+					const char ch = m_index.text[pos];
+
+					count += (ch != ':' && ch != ',' && ch != '}' && ch != ']');
+				}
+
+				m_storage.nodes.reserve(count);
+
+				m_storage.nodes.resize(1);
+
+				build(0, 0);
+			}
+
+			void finish(std::string&& text)
+			{
+				m_storage.text = std::move(text);
+
+				m_storage.text.append(m_unescaped);
+
+				sortObjects();
+			}
+		};
+	}
+
+	/// <summary>
+	/// CompactJSONDocument の中の値への参照
+	/// </summary>
+	/// <remarks>
+	/// 参照元の CompactJSONDocument が破棄された後は使えません。
+	/// 存在しないキーやインデックスを指定すると、空の CompactJSONValue を返します。
+	/// </remarks>
+	class CompactJSONValue
+	{
+	private:
+
+		const detail::CompactJSONStorage* m_storage = nullptr;
+
+		uint32 m_node = 0;
+
+		const detail::CompactJSONNode& node() const
+		{
+			return m_storage->nodes[m_node];
+		}
+
+		template <class Type, std::enable_if_t<!std::is_arithmetic<Type>::value>* = nullptr>
+		Optional<Type> getOpt(const Type*) const
+		{
+			if (!isString())
+			{
+				return none;
+			}
+
+			return ParseOpt<Type>(getString());
+		}
+
+		Optional<String> getOpt(const String*) const
+		{
+			if (!isString())
+			{
+				return none;
+			}
+
+			return getString();
+		}
+
+		Optional<bool> getOpt(const bool*) const
+		{
+			if (!isBool())
+			{
+				return none;
+			}
+
+			return getBool();
+		}
+
+		template <class Type, std::enable_if_t<std::is_arithmetic<Type>::value>* = nullptr>
+		Optional<Type> getOpt(const Type*) const
+		{
+			if (!isNumber())
+			{
+				return none;
+			}
+
+			return static_cast<Type>(getNumber());
+		}
+
+	public:
+
+		CompactJSONValue() = default;
+
+		CompactJSONValue(const detail::CompactJSONStorage* storage, uint32 node)
+			: m_storage(storage)
+			, m_node(node) {}
+
+		/// <summary>
+		/// 値が存在するかを返します。
+		/// </summary>
+		/// <returns>
+		/// 値が存在する場合 true, 空の CompactJSONValue の場合は false
+		/// </returns>
+		explicit operator bool() const
+		{
+			return m_storage != nullptr;
+		}
+
+		/// <summary>
+		/// データの型を返します。
+		/// </summary>
+		/// <returns>
+		/// データの型。空の CompactJSONValue の場合は JSONValue::ValueType::Null
+		/// </returns>
+		JSONValue::ValueType getType() const
+		{
+			return m_storage ? node().type : JSONValue::ValueType::Null;
+		}
+
+		bool isNull() const
+		{
+			return getType() == JSONValue::ValueType::Null;
+		}
+
+		bool isBool() const
+		{
+			return getType() == JSONValue::ValueType::Boolean;
+		}
+
+		bool isNumber() const
+		{
+			return getType() == JSONValue::ValueType::Number;
+		}
+
+		bool isString() const
+		{
+			return getType() == JSONValue::ValueType::String;
+		}
+
+		bool isArray() const
+		{
+			return getType() == JSONValue::ValueType::Array;
+		}
+
+		bool isObject() const
+		{
+			return getType() == JSONValue::ValueType::Object;
+		}
+
+		/// <summary>
+		/// 配列の要素数、またはオブジェクトのメンバ数を返します。
+		/// </summary>
+		/// <returns>
+		/// 要素数。配列とオブジェクト以外では 0
+		/// </returns>
+		size_t size() const
+		{
+			return (isArray() || isObject()) ? node().size : 0;
+		}
+
+		/// <summary>
+		/// 配列の要素を返します。
+		/// </summary>
+		/// <param name="index">
+		/// インデックス
+		/// </param>
+		/// <returns>
+		/// 要素。配列でないか範囲外の場合は空の CompactJSONValue
+		/// </returns>
+		CompactJSONValue operator [](size_t index) const
+		{
+			if (!isArray() || index >= node().size)
+			{
+				return CompactJSONValue();
+			}
+
+			return CompactJSONValue(m_storage, node().offset + static_cast<uint32>(index));
+		}
+
+		/// <summary>
+		/// オブジェクトのメンバを二分探索で返します。
+		/// </summary>
+		/// <param name="key">
+		/// キー
+		/// </param>
+		/// <returns>
+		/// メンバ。オブジェクトでないかキーが存在しない場合は空の CompactJSONValue
+		/// </returns>
+		CompactJSONValue operator [](StringView key) const
+		{
+			if (!isObject())
+			{
+				return CompactJSONValue();
+			}
+
+			const std::string utf8 = Unicode::ToUTF8(key);
+
+			uint32 first = 0, count = node().size;
+
+			while (count > 0)
+			{
+				const uint32 half = count / 2;
+
+				if (m_storage->compareKey(node().offset + 2 * (first + half), utf8.data(), utf8.size()) < 0)
+				{
+					first += half + 1;
+
+					count -= half + 1;
+				}
+				else
+				{
+					count = half;
+				}
+			}
+
+			if (first < node().size && m_storage->compareKey(node().offset + 2 * first, utf8.data(), utf8.size()) == 0)
+			{
+				return CompactJSONValue(m_storage, node().offset + 2 * first + 1);
+			}
+
+			return CompactJSONValue();
+		}
+
+		bool contains(size_t index) const
+		{
+			return static_cast<bool>((*this)[index]);
+		}
+
+		bool contains(StringView key) const
+		{
+			return static_cast<bool>((*this)[key]);
+		}
+
+		/// <summary>
+		/// オブジェクトの index 番目 (キーの順) のキーを返します。
+		/// </summary>
+		/// <param name="index">
+		/// インデックス
+		/// </param>
+		/// <returns>
+		/// キー。オブジェクトでないか範囲外の場合は空の文字列
+		/// </returns>
+		String keyAt(size_t index) const
+		{
+			if (!isObject() || index >= node().size)
+			{
+				return String();
+			}
+
+			const uint32 key = node().offset + 2 * static_cast<uint32>(index);
+
+			return Unicode::FromUTF8(m_storage->stringData(key), m_storage->stringSize(key));
+		}
+
+		/// <summary>
+		/// オブジェクトの index 番目 (キーの順) のメンバを返します。
+		/// </summary>
+		/// <param name="index">
+		/// インデックス
+		/// </param>
+		/// <returns>
+		/// メンバ。オブジェクトでないか範囲外の場合は空の CompactJSONValue
+		/// </returns>
+		CompactJSONValue valueAt(size_t index) const
+		{
+			if (!isObject() || index >= node().size)
+			{
+				return CompactJSONValue();
+			}
+
+			return CompactJSONValue(m_storage, node().offset + 2 * static_cast<uint32>(index) + 1);
+		}
+
+		bool getBool() const
+		{
+			return isBool() && node().boolean;
+		}
+
+		double getNumber() const
+		{
+			return isNumber() ? node().number : 0.0;
+		}
+
+		String getString() const
+		{
+			return isString() ? Unicode::FromUTF8(m_storage->stringData(m_node), node().size) : String();
+		}
+
+		template <class Type>
+		Type get() const
+		{
+			return getOpt<Type>().value_or(Type());
+		}
+
+		template <class Type>
+		Optional<Type> getOpt() const
+		{
+			return getOpt(static_cast<const Type*>(nullptr));
+		}
+
+		template <class Type, class U>
+		Type getOr(U&& defaultValue) const
+		{
+			return getOpt<Type>().value_or(std::forward<U>(defaultValue));
+		}
+
+		/// <summary>
+		/// 値を JSONValue に変換します。
+		/// </summary>
+		/// <returns>
+		/// 値。空の CompactJSONValue の場合は null
+		/// </returns>
+		JSONValue toValue() const
+		{
+			return m_storage ? m_storage->toValue(m_node) : JSONValue();
+		}
+	};
+
+	/// <summary>
+	/// 1 つの領域にまとめて確保される JSON ドキュメント
+	/// </summary>
+	/// <remarks>
+	/// すべての値は 16 バイトの固定長で 1 つの配列に、文字列は入力のテキストの一部として保持します。
+	/// オブジェクトはキーの順に整列したキーと値の配列で、キーによるアクセスは二分探索です。
+	/// 値ごとのメモリ確保が無いため、破棄はドキュメントの大きさによらず 2 回の解放で済みます。
+	/// 値の変更はできません。JSONValue との相互変換ができます。コピーは内容を共有します。
+	/// </remarks>
+	class CompactJSONDocument
+	{
+	private:
+
+		std::shared_ptr<const detail::CompactJSONStorage> m_storage;
+
+		bool load(IReader& reader, const FilePath& path)
+		{
+			m_storage.reset();
+
+			detail::JSONIndex index;
+
+			if (!reader.isOpened() || !index.load(reader))
+			{
+				return false;
+			}
+
+			auto storage = std::make_shared<detail::CompactJSONStorage>();
+
+			detail::CompactJSONBuilder builder(index, *storage);
+
+			builder.build();
+
+			Array<uint32>().swap(index.structurals);
+
+			Array<uint32>().swap(index.jumps);
+
+			builder.finish(std::move(index.text));
+
+			storage->path = path;
+
+			m_storage = std::move(storage);
+
+			return true;
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		CompactJSONDocument() = default;
+
+		/// <summary>
+		/// JSON ファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		explicit CompactJSONDocument(const FilePath& path)
+		{
+			open(path);
+		}
+
+		/// <summary>
+		/// JSON ファイルを開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		template <class Reader, class = std::enable_if_t<std::is_base_of<IReader, std::decay_t<Reader>>::value>>
+		explicit CompactJSONDocument(Reader&& reader)
+		{
+			open(std::forward<Reader>(reader));
+		}
+
+		/// <summary>
+		/// JSONValue から作成します。
+		/// </summary>
+		/// <param name="value">
+		/// JSON データ
+		/// </param>
+		explicit CompactJSONDocument(const JSONValue& value)
+		{
+			auto storage = std::make_shared<detail::CompactJSONStorage>();
+
+			storage->nodes.resize(1);
+
+			storage->fromValue(0, value);
+
+			m_storage = std::move(storage);
+		}
+
+		/// <summary>
+		/// JSON ファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <returns>
+		/// ファイルのオープンと検証に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const FilePath& path)
+		{
+			BinaryReader reader(path);
+
+			return load(reader, path);
+		}
+
+		/// <summary>
+		/// IReader の現在の位置から末尾までを JSON として開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		/// <returns>
+		/// 読み込みと検証に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		template <class Reader, class = std::enable_if_t<std::is_base_of<IReader, std::decay_t<Reader>>::value>>
+		bool open(Reader&& reader)
+		{
+			return load(reader, FilePath());
+		}
+
+		/// <summary>
+		/// ドキュメントを破棄します。
+		/// </summary>
+		void close()
+		{
+			m_storage.reset();
+		}
+
+		bool isOpened() const
+		{
+			return static_cast<bool>(m_storage);
+		}
+
+		explicit operator bool() const
+		{
+			return isOpened();
+		}
+
+		/// <summary>
+		/// ルートの値を返します。
+		/// </summary>
+		/// <returns>
+		/// ルートの値。開いていない場合は空の CompactJSONValue
+		/// </returns>
+		CompactJSONValue root() const
+		{
+			return m_storage ? CompactJSONValue(m_storage.get(), 0) : CompactJSONValue();
+		}
+
+		/// <summary>
+		/// 値を取得します。
+		/// </summary>
+		/// <param name="path">
+		/// キー（L"KEYA" や L"KEYA.KEYB.KEYC" といった形式）
+		/// </param>
+		/// <returns>
+		/// 値。存在しない場合は空の CompactJSONValue
+		/// </returns>
+		CompactJSONValue operator [](const String& path) const
+		{
+			CompactJSONValue value = root();
+
+			for (const auto key : path.splitView(L'.'))
+			{
+				value = value[key];
+			}
+
+			return value;
+		}
+
+		/// <summary>
+		/// ルートの値を JSONValue に変換します。
+		/// </summary>
+		/// <returns>
+		/// JSON データ
+		/// </returns>
+		JSONValue toValue() const
+		{
+			return root().toValue();
+		}
+
+		/// <summary>
+		/// ドキュメントが確保しているメモリの大きさ（バイト）を返します。
+		/// </summary>
+		size_t memoryUsage() const
+		{
+			if (!m_storage)
+			{
+				return 0;
+			}
+
+			return m_storage->text.capacity() + m_storage->nodes.capacity() * sizeof(detail::CompactJSONNode);
+		}
+
+		/// <summary>
+		/// JSON ファイルのパスを返します。
+		/// </summary>
+		FilePath path() const
+		{
+			return m_storage ? m_storage->path : FilePath();
+		}
+	};
+}
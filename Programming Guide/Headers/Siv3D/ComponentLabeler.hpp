@@ -0,0 +1,672 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <algorithm>
+# include <memory>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "Image.hpp"
+# include "Polygon.hpp"
+# include "MultiPolygon.hpp"
+# include "ThreadPool.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// 連結成分
+	/// </summary>
+	struct ImageComponent
+	{
+		/// <summary>
+		/// ラベル。1 以上の値です。
+		/// </summary>
+		int32 label = 0;
+
+		/// <summary>
+		/// 外接矩形
+		/// </summary>
+		Rect boundingRect = { 0, 0, 0, 0 };
+
+		/// <summary>
+		/// ピクセル数。0 の場合、ラベルは使われていません。
+		/// </summary>
+		int32 area = 0;
+	};
+
+	namespace ComponentLabeling
+	{
+		namespace detail
+		{
+			// 右, 右下, 下, 左下, 左, 左上, 上, 右上（画面上で時計回り）
+			constexpr int32 DirectionX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+
+			constexpr int32 DirectionY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+			inline int32 FindRoot(int32* parent, int32 i)
+			{
+				while (parent[i] != i)
+				{
+					parent[i] = parent[parent[i]];
+
+					i = parent[i];
+				}
+
+				return i;
+			}
+
+			// 根は常に集合内で最小のインデックスになる
+			inline void Unite(int32* parent, int32 a, int32 b)
+			{
+				a = FindRoot(parent, a);
+
+				b = FindRoot(parent, b);
+
+				if (a < b)
+				{
+					parent[b] = a;
+				}
+				else if (b < a)
+				{
+					parent[a] = b;
+				}
+			}
+
+			// (x, y) を上の行の 3 つの近傍と結合する
+			inline void UniteAbove(const uint8* mask, int32* parent, int32 width, int32 x, int32 y)
+			{
+				const int32 i = y * width + x;
+
+				for (int32 dx = -1; dx <= 1; ++dx)
+				{
+					const int32 nx = x + dx;
+
+					if (0 <= nx && nx < width && mask[i - width + dx])
+					{
+						Unite(parent, i, i - width + dx);
+					}
+				}
+			}
+
+			// [y0, y1) の行を 8 連結で union-find に登録する。帯の外の行は参照しない
+			inline void LabelBand(const uint8* mask, int32* parent, int32 width, int32 y0, int32 y1)
+			{
+				for (int32 y = y0; y < y1; ++y)
+				{
+					for (int32 x = 0; x < width; ++x)
+					{
+						const int32 i = y * width + x;
+
+						parent[i] = i;
+
+						if (!mask[i])
+						{
+							continue;
+						}
+
+						if (x > 0 && mask[i - 1])
+						{
+							Unite(parent, i, i - 1);
+						}
+
+						if (y > y0)
+						{
+							UniteAbove(mask, parent, width, x, y);
+						}
+					}
+				}
+			}
+
+			// 走査順で最初のピクセル start から、外側の境界を時計回りにたどる
+			inline Array<Point> TraceBoundary(const int32* labels, int32 width, int32 height, int32 label, const Point& start)
+			{
+				const auto isLabel = [=](int32 x, int32 y)
+				{
+					return 0 <= x && x < width && 0 <= y && y < height && labels[y * width + x] == label;
+				};
+
+				Array<Point> points = { start };
+
+				Point current = start;
+
+				int32 previous = 0, first = -1;
+
+				for (;;)
+				{
+					int32 next = -1;
+
+					const int32 begin = (previous % 2 == 0) ? (previous + 7) % 8 : (previous + 6) % 8;
+
+					for (int32 k = 0; k < 8; ++k)
+					{
+						const int32 d = (begin + k) % 8;
+
+						if (isLabel(current.x + DirectionX[d], current.y + DirectionY[d]))
+						{
+							next = d;
+
+							break;
+						}
+					}
+
+					if (next < 0)
+					{
+						break;
+					}
+
+					// 始点に戻り、最初と同じ向きに進もうとしたら一周している
+					if (first < 0)
+					{
+						first = next;
+					}
+					else if (current == start && next == first)
+					{
+						points.pop_back();
+
+						break;
+					}
+
+					current.moveBy(DirectionX[next], DirectionY[next]);
+
+					previous = next;
+
+					points.push_back(current);
+				}
+
+				return points;
+			}
+		}
+	}
+
+	/// <summary>
+	/// 2 値画像の連結成分を求め、変更された領域だけを更新するラベリング
+	/// </summary>
+	/// <remarks>
+	/// 前景のピクセルを 8 連結でラベル付けし、成分ごとの外接矩形と面積を保持します。
+	/// 最初の build() は行の帯に分割してスレッドプールで並列に処理します。
+	/// update() は変更された矩形に触れる成分だけを作り直し、ほかの成分のラベルと輪郭はそのまま残します。
+	/// </remarks>
+	class ComponentLabeler
+	{
+	private:
+
+		std::shared_ptr<ThreadPool> m_pool;
+
+		bool m_useAlpha = false;
+
+		uint32 m_threshold = 127;
+
+		Size m_size = { 0, 0 };
+
+		Array<int32> m_labels;
+
+		// インデックスがラベル。0 番は背景
+		Array<ImageComponent> m_components;
+
+		Array<int32> m_freeLabels;
+
+		mutable Array<Array<Point>> m_contours;
+
+		bool isForeground(const Color& color) const
+		{
+			return (m_useAlpha ? color.a : color.grayscale()) > m_threshold;
+		}
+
+		int32 newLabel()
+		{
+			if (!m_freeLabels.empty())
+			{
+				const int32 label = m_freeLabels.back();
+
+				m_freeLabels.pop_back();
+
+				return label;
+			}
+
+			m_components.emplace_back();
+
+			m_contours.emplace_back();
+
+			return static_cast<int32>(m_components.size() - 1);
+		}
+
+		void releaseLabel(int32 label)
+		{
+			m_components[label] = ImageComponent();
+
+			m_contours[label].clear();
+
+			m_freeLabels.push_back(label);
+		}
+
+		void addPixel(int32 label, int32 x, int32 y)
+		{
+			ImageComponent& component = m_components[label];
+
+			if (component.area == 0)
+			{
+				component = { label, { x, y, 1, 1 }, 1 };
+
+				return;
+			}
+
+			Rect& r = component.boundingRect;
+
+			const int32 left = std::min(r.x, x), top = std::min(r.y, y);
+			const int32 right = std::max(r.x + r.w, x + 1), bottom = std::max(r.y + r.h, y + 1);
+
+			r = Rect(left, top, right - left, bottom - top);
+
+			++component.area;
+		}
+
+		static Rect Union(const Rect& a, const Rect& b)
+		{
+			const int32 left = std::min(a.x, b.x), top = std::min(a.y, b.y);
+			const int32 right = std::max(a.x + a.w, b.x + b.w), bottom = std::max(a.y + a.h, b.y + b.h);
+
+			return{ left, top, right - left, bottom - top };
+		}
+
+		Rect clip(const Rect& rect) const
+		{
+			const int32 left = Clamp(rect.x, 0, m_size.x), top = Clamp(rect.y, 0, m_size.y);
+			const int32 right = Clamp(rect.x + rect.w, left, m_size.x), bottom = Clamp(rect.y + rect.h, top, m_size.y);
+
+			return{ left, top, right - left, bottom - top };
+		}
+
+	public:
+
+		/// <summary>
+		/// ラベリングを作成します。
+		/// </summary>
+		/// <param name="useAlpha">
+		/// アルファ値で前景を判定する場合 true, 輝度で判定する場合 false
+		/// </param>
+		/// <param name="threshold">
+		/// この値より大きいピクセルを前景とします。
+		/// </param>
+		/// <param name="pool">
+		/// build() で使用するスレッドプール
+		/// </param>
+		explicit ComponentLabeler(bool useAlpha = false, uint32 threshold = 127, std::shared_ptr<ThreadPool> pool = Threading::GetPool())
+			: m_pool(std::move(pool))
+			, m_useAlpha(useAlpha)
+			, m_threshold(threshold) {}
+
+		/// <summary>
+		/// 画像全体をラベル付けします。
+		/// </summary>
+		/// <param name="image">
+		/// 入力画像
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void build(const Image& image)
+		{
+			m_size = image.size;
+
+			const int32 width = image.width, height = image.height;
+
+			const size_t num = static_cast<size_t>(width) * height;
+
+			m_labels.assign(num, 0);
+
+			m_components.assign(1, ImageComponent());
+
+			m_contours.assign(1, Array<Point>());
+
+			m_freeLabels.clear();
+
+			if (num == 0)
+			{
+				return;
+			}
+
+			Array<uint8> mask(num);
+
+			Array<int32> parent(num);
+
+			const int32 bandRows = std::max(height / static_cast<int32>(std::max<size_t>(m_pool->numThreads() * 4, 1)), 16);
+
+			const size_t numBands = (height + bandRows - 1) / bandRows;
+
+			// 帯の内部だけを並列に union-find で結合する
+			m_pool->parallelFor(0, numBands, [&](size_t band)
+			{
+				const int32 y0 = static_cast<int32>(band) * bandRows, y1 = std::min(y0 + bandRows, height);
+
+				for (int32 y = y0; y < y1; ++y)
+				{
+					const Color* row = image[y];
+
+					for (int32 x = 0; x < width; ++x)
+					{
+						mask[y * width + x] = isForeground(row[x]);
+					}
+				}
+
+				ComponentLabeling::detail::LabelBand(mask.data(), parent.data(), width, y0, y1);
+			});
+
+			// 帯の境界の行だけを逐次的に結合する
+			for (int32 y = bandRows; y < height; y += bandRows)
+			{
+				for (int32 x = 0; x < width; ++x)
+				{
+					if (mask[y * width + x])
+					{
+						ComponentLabeling::detail::UniteAbove(mask.data(), parent.data(), width, x, y);
+					}
+				}
+			}
+
+			// 根は集合内の最小インデックスなので、インデックス順に 1 回たどれば平坦化と番号付けが済む
+			for (size_t i = 0; i < num; ++i)
+			{
+				if (!mask[i])
+				{
+					continue;
+				}
+
+				const int32 p = parent[i];
+
+				if (p == static_cast<int32>(i))
+				{
+					const int32 label = newLabel();
+
+					m_labels[i] = label;
+				}
+				else
+				{
+					m_labels[i] = m_labels[parent[p]];
+
+					parent[i] = parent[p];
+				}
+			}
+
+			for (int32 y = 0; y < height; ++y)
+			{
+				for (int32 x = 0; x < width; ++x)
+				{
+					if (const int32 label = m_labels[y * width + x])
+					{
+						addPixel(label, x, y);
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// 変更された領域のラベルを更新します。
+		/// </summary>
+		/// <param name="image">
+		/// 変更後の画像。build() と同じ大きさである必要があります。
+		/// </param>
+		/// <param name="dirty">
+		/// 変更された領域
+		/// </param>
+		/// <remarks>
+		/// 変更された領域と、その周囲 1 ピクセルに触れる成分の外接矩形を合わせた範囲を作り直します。
+		/// その範囲の外側にある成分のラベルと輪郭は変わりません。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void update(const Image& image, const Rect& dirty)
+		{
+			if (image.size != m_size)
+			{
+				build(image);
+
+				return;
+			}
+
+			const int32 width = m_size.x;
+
+			Rect region = clip(Rect(dirty.x - 1, dirty.y - 1, dirty.w + 2, dirty.h + 2));
+
+			if (region.w == 0 || region.h == 0)
+			{
+				return;
+			}
+
+			// 範囲内にある成分の外接矩形で範囲を広げ、含まれる成分が変わらなくなるまで繰り返す
+			Array<int32> affected;
+
+			for (;;)
+			{
+				affected.clear();
+
+				Rect grown = region;
+
+				for (int32 y = region.y; y < region.y + region.h; ++y)
+				{
+					for (int32 x = region.x; x < region.x + region.w; ++x)
+					{
+						const int32 label = m_labels[y * width + x];
+
+						if (label && std::find(affected.begin(), affected.end(), label) == affected.end())
+						{
+							affected.push_back(label);
+
+							grown = Union(grown, m_components[label].boundingRect);
+						}
+					}
+				}
+
+				if (grown == region)
+				{
+					break;
+				}
+
+				region = grown;
+			}
+
+			for (const auto label : affected)
+			{
+				releaseLabel(label);
+			}
+
+			Array<uint8> mask(static_cast<size_t>(region.w) * region.h);
+
+			for (int32 y = 0; y < region.h; ++y)
+			{
+				const Color* row = image[region.y + y];
+
+				for (int32 x = 0; x < region.w; ++x)
+				{
+					mask[y * region.w + x] = isForeground(row[region.x + x]);
+
+					m_labels[(region.y + y) * width + region.x + x] = 0;
+				}
+			}
+
+			// 範囲の外の前景は範囲内の前景と隣接しないため、範囲内だけを塗りつぶせばよい
+			Array<Point> stack;
+
+			for (int32 y = 0; y < region.h; ++y)
+			{
+				for (int32 x = 0; x < region.w; ++x)
+				{
+					if (!mask[y * region.w + x] || m_labels[(region.y + y) * width + region.x + x])
+					{
+						continue;
+					}
+
+					const int32 label = newLabel();
+
+					stack.push_back({ x, y });
+
+					m_labels[(region.y + y) * width + region.x + x] = label;
+
+					while (!stack.empty())
+					{
+						const Point p = stack.back();
+
+						stack.pop_back();
+
+						addPixel(label, region.x + p.x, region.y + p.y);
+
+						for (int32 d = 0; d < 8; ++d)
+						{
+							const int32 nx = p.x + ComponentLabeling::detail::DirectionX[d];
+							const int32 ny = p.y + ComponentLabeling::detail::DirectionY[d];
+
+							if (0 <= nx && nx < region.w && 0 <= ny && ny < region.h && mask[ny * region.w + nx])
+							{
+								int32& target = m_labels[(region.y + ny) * width + region.x + nx];
+
+								if (!target)
+								{
+									target = label;
+
+									stack.push_back({ nx, ny });
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		void update(const Image& image, const Array<Rect>& dirtyRects)
+		{
+			for (const auto& dirty : dirtyRects)
+			{
+				update(image, dirty);
+			}
+		}
+
+		/// <summary>
+		/// ラベル付けした画像の幅と高さ（ピクセル）を返します。
+		/// </summary>
+		Size size() const
+		{
+			return m_size;
+		}
+
+		/// <summary>
+		/// 各ピクセルのラベルを返します。背景は 0 です。
+		/// </summary>
+		const Array<int32>& labels() const
+		{
+			return m_labels;
+		}
+
+		int32 labelAt(const Point& pos) const
+		{
+			return m_labels[pos.y * m_size.x + pos.x];
+		}
+
+		/// <summary>
+		/// 指定したラベルの成分を返します。
+		/// </summary>
+		/// <remarks>
+		/// 使われていないラベルの場合、area が 0 の成分を返します。
+		/// </remarks>
+		const ImageComponent& component(int32 label) const
+		{
+			return m_components[label];
+		}
+
+		/// <summary>
+		/// すべての成分を返します。
+		/// </summary>
+		/// <remarks>
+		/// ポリゴンを作成しないため、外接矩形と面積だけが必要な場合は contours() より高速です。
+		/// </remarks>
+		Array<ImageComponent> components() const
+		{
+			Array<ImageComponent> result;
+
+			for (const auto& component : m_components)
+			{
+				if (component.area)
+				{
+					result.push_back(component);
+				}
+			}
+
+			return result;
+		}
+
+		size_t num_components() const
+		{
+			return m_components.size() - 1 - m_freeLabels.size();
+		}
+
+		/// <summary>
+		/// 指定したラベルの成分の外側の輪郭を返します。
+		/// </summary>
+		/// <remarks>
+		/// 輪郭は成分が update() で作り直されるまでキャッシュされます。
+		/// </remarks>
+		/// <returns>
+		/// 輪郭のピクセルの座標
+		/// </returns>
+		const Array<Point>& boundary(int32 label) const
+		{
+			Array<Point>& cached = m_contours[label];
+
+			const ImageComponent& component = m_components[label];
+
+			if (cached.empty() && component.area)
+			{
+				const Rect& r = component.boundingRect;
+
+				for (int32 x = r.x; x < r.x + r.w; ++x)
+				{
+					if (m_labels[r.y * m_size.x + x] == label)
+					{
+						cached = ComponentLabeling::detail::TraceBoundary(m_labels.data(), m_size.x, m_size.y, label, { x, r.y });
+
+						break;
+					}
+				}
+			}
+
+			return cached;
+		}
+
+		/// <summary>
+		/// 指定したラベルの成分の外側の輪郭を多角形で返します。
+		/// </summary>
+		Polygon contour(int32 label) const
+		{
+			const auto& points = boundary(label);
+
+			return Polygon(Array<Vec2>(points.begin(), points.end()));
+		}
+
+		/// <summary>
+		/// すべての成分の外側の輪郭を返します。
+		/// </summary>
+		/// <remarks>
+		/// Imaging::FindExternalContours() と同じ用途に使えます。変更されていない成分の輪郭はキャッシュから作成します。
+		/// </remarks>
+		MultiPolygon contours() const
+		{
+			Array<Polygon> polygons;
+
+			for (const auto& component : m_components)
+			{
+				if (component.area)
+				{
+					polygons.push_back(contour(component.label));
+				}
+			}
+
+			return MultiPolygon(std::move(polygons));
+		}
+	};
+}
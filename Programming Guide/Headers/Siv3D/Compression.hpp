@@ -9,8 +9,14 @@
 //-----------------------------------------------
 
 # pragma once
+# include <cstring>
+# include <atomic>
+# include <future>
 # include "Fwd.hpp"
+# include "Array.hpp"
 # include "ByteArray.hpp"
+# include "Optional.hpp"
+# include "ThreadPool.hpp"
 
 namespace s3d
 {
@@ -29,5 +35,706 @@ namespace s3d
 		{
 			return Decompress(data.data(), static_cast<size_t>(data.size()));
 		}
+
+		/// <summary>
+		/// フレーム形式の圧縮のデフォルトのブロックの大きさ（バイト）
+		/// </summary>
+		constexpr size_t DefaultBlockSize = 256 * 1024;
+
+		/// <summary>
+		/// フレーム形式の圧縮のブロックの大きさの最小値（バイト）
+		/// </summary>
+		constexpr size_t MinBlockSize = 4 * 1024;
+
+		/// <summary>
+		/// フレーム形式の圧縮のブロックの大きさの最大値（バイト）
+		/// </summary>
+		constexpr size_t MaxBlockSize = 64 * 1024 * 1024;
+	}
+
+	/// <summary>
+	/// フレーム形式の圧縮で使う圧縮方式
+	/// </summary>
+	enum class CompressionCodec : uint8
+	{
+		/// <summary>
+		/// LZ4 のブロック形式。圧縮率は低いが高速で、実行中に読み書きするデータ向け
+		/// </summary>
+		Fast = 1,
+
+		/// <summary>
+		/// Compression::Compress() と同じ圧縮。低速だが圧縮率が高く、配布するデータ向け
+		/// </summary>
+		Standard = 2,
+	};
+
+	namespace detail
+	{
+		constexpr size_t FastHashBits = 14;
+
+		constexpr size_t FastHashSize = size_t(1) << FastHashBits;
+
+		inline uint32 FastRead32(const uint8* p)
+		{
+			uint32 value;
+
+			std::memcpy(&value, p, sizeof(value));
+
+			return value;
+		}
+
+		inline uint32 FastHash(uint32 sequence)
+		{
+			return (sequence * 2654435761u) >> (32 - FastHashBits);
+		}
+
+		inline size_t FastCompressBound(size_t size)
+		{
+			return size + size / 255 + 16;
+		}
+
+		inline uint8* FastWriteLength(uint8* op, size_t length)
+		{
+			for (; length >= 255; length -= 255)
+			{
+				*op++ = 255;
+			}
+
+			*op++ = static_cast<uint8>(length);
+
+			return op;
+		}
+
+		inline uint8* FastWriteLiterals(uint8* op, uint8*& token, const uint8* literals, size_t length)
+		{
+			token = op++;
+
+			*token = static_cast<uint8>((length < 15 ? length : 15) << 4);
+
+			if (length >= 15)
+			{
+				op = FastWriteLength(op, length - 15);
+			}
+
+			if (length)
+			{
+				std::memcpy(op, literals, length);
+			}
+
+			return op + length;
+		}
+
+		// LZ4 のブロック形式で圧縮する。dst には FastCompressBound(size) バイト、table には FastHashSize 個の 0 で初期化された要素が必要
+		inline size_t FastCompress(const uint8* src, size_t size, uint8* dst, uint32* table)
+		{
+			// LZ4 の制約: 最後の 5 バイトはリテラルで、最後のマッチは終端の 12 バイトより前から始まる
+			constexpr size_t LastLiterals = 5;
+
+			constexpr size_t MatchFindLimit = 12;
+
+			constexpr size_t MinMatch = 4;
+
+			const uint8* const end = src + size;
+
+			const uint8* anchor = src;
+
+			uint8* op = dst;
+
+			uint8* token = nullptr;
+
+			if (size > MatchFindLimit)
+			{
+				const uint8* const matchLimit = end - LastLiterals;
+
+				const uint8* const findLimit = end - MatchFindLimit;
+
+				const uint8* ip = src;
+
+				while (ip < findLimit)
+				{
+					const uint32 sequence = FastRead32(ip);
+
+					const uint32 hash = FastHash(sequence);
+
+					const uint8* ref = src + table[hash];
+
+					table[hash] = static_cast<uint32>(ip - src);
+
+					if (ref >= ip || (ip - ref) > 65535 || FastRead32(ref) != sequence)
+					{
+						// マッチしない区間が続くほど探す間隔を広げる
+						ip += 1 + ((ip - anchor) >> 6);
+
+						continue;
+					}
+
+					while (ip > anchor && ref > src && ip[-1] == ref[-1])
+					{
+						--ip;
+
+						--ref;
+					}
+
+					const uint8* matchEnd = ip + MinMatch;
+
+					for (const uint8* r = ref + MinMatch; matchEnd < matchLimit && *matchEnd == *r; ++r)
+					{
+						++matchEnd;
+					}
+
+					op = FastWriteLiterals(op, token, anchor, static_cast<size_t>(ip - anchor));
+
+					const size_t offset = static_cast<size_t>(ip - ref);
+
+					*op++ = static_cast<uint8>(offset);
+
+					*op++ = static_cast<uint8>(offset >> 8);
+
+					const size_t matchLength = static_cast<size_t>(matchEnd - ip) - MinMatch;
+
+					*token |= static_cast<uint8>(matchLength < 15 ? matchLength : 15);
+
+					if (matchLength >= 15)
+					{
+						op = FastWriteLength(op, matchLength - 15);
+					}
+
+					ip = anchor = matchEnd;
+
+					table[FastHash(FastRead32(ip - 2))] = static_cast<uint32>(ip - 2 - src);
+				}
+			}
+
+			op = FastWriteLiterals(op, token, anchor, static_cast<size_t>(end - anchor));
+
+			return static_cast<size_t>(op - dst);
+		}
+
+		// LZ4 のブロック形式のデータを展開する。展開後のサイズがちょうど dstSize でない場合は失敗
+		inline bool FastDecompress(const uint8* src, size_t srcSize, uint8* dst, size_t dstSize)
+		{
+			const uint8* ip = src;
+
+			const uint8* const srcEnd = src + srcSize;
+
+			uint8* op = dst;
+
+			uint8* const dstEnd = dst + dstSize;
+
+			const auto readLength = [&](size_t& length)
+			{
+				for (uint8 b = 255; b == 255; length += b)
+				{
+					if (ip == srcEnd)
+					{
+						return false;
+					}
+
+					b = *ip++;
+				}
+
+				return true;
+			};
+
+			for (;;)
+			{
+				if (ip == srcEnd)
+				{
+					return false;
+				}
+
+				const uint8 token = *ip++;
+
+				size_t literalLength = token >> 4;
+
+				if (literalLength == 15 && !readLength(literalLength))
+				{
+					return false;
+				}
+
+				if (literalLength > static_cast<size_t>(srcEnd - ip) || literalLength > static_cast<size_t>(dstEnd - op))
+				{
+					return false;
+				}
+
+				if (literalLength)
+				{
+					std::memcpy(op, ip, literalLength);
+				}
+
+				op += literalLength;
+
+				ip += literalLength;
+
+				if (ip == srcEnd)
+				{
+					return op == dstEnd;
+				}
+
+				if (srcEnd - ip < 2)
+				{
+					return false;
+				}
+
+				const size_t offset = ip[0] | (ip[1] << 8);
+
+				ip += 2;
+
+				size_t matchLength = token & 15;
+
+				if (matchLength == 15 && !readLength(matchLength))
+				{
+					return false;
+				}
+
+				matchLength += 4;
+
+				if (offset == 0 || offset > static_cast<size_t>(op - dst) || matchLength > static_cast<size_t>(dstEnd - op))
+				{
+					return false;
+				}
+
+				const uint8* ref = op - offset;
+
+				if (offset >= matchLength)
+				{
+					std::memcpy(op, ref, matchLength);
+				}
+				else
+				{
+					for (size_t i = 0; i < matchLength; ++i)
+					{
+						op[i] = ref[i];
+					}
+				}
+
+				op += matchLength;
+			}
+		}
+
+		struct CompressionFrameHeader
+		{
+			static constexpr uint32 Signature = 0x5A443353; // "S3DZ"
+
+			static constexpr uint8 Version = 1;
+
+			uint32 signature;
+
+			uint8 version;
+
+			CompressionCodec codec;
+
+			uint16 reserved;
+
+			uint32 blockSize;
+		};
+
+		static_assert(sizeof(CompressionFrameHeader) == 12, "CompressionFrameHeader must be 12 bytes");
+
+		// ブロックの先頭の 2 つの uint32 のうち、圧縮後のサイズに立てる、圧縮せずに格納したことを示すビット
+		constexpr uint32 StoredBlockFlag = 0x80000000u;
+
+		constexpr size_t BlockHeaderSize = 8;
+
+		// ブロックを圧縮し、ブロックのヘッダとあわせて out に書き込む
+		inline void CompressBlock(const uint8* src, size_t size, CompressionCodec codec, int32 level, Array<uint8>& out)
+		{
+			size_t compressedSize = 0;
+
+			if (codec == CompressionCodec::Fast)
+			{
+				Array<uint32> table(FastHashSize);
+
+				out.resize(BlockHeaderSize + FastCompressBound(size));
+
+				compressedSize = FastCompress(src, size, out.data() + BlockHeaderSize, table.data());
+			}
+			else
+			{
+				const ByteArray compressed = Compression::Compress(src, size, level);
+
+				compressedSize = static_cast<size_t>(compressed.size());
+
+				if (compressedSize && compressedSize < size)
+				{
+					out.resize(BlockHeaderSize + compressedSize);
+
+					std::memcpy(out.data() + BlockHeaderSize, compressed.data(), compressedSize);
+				}
+			}
+
+			uint32 words[2] = { static_cast<uint32>(compressedSize), static_cast<uint32>(size) };
+
+			if (!compressedSize || compressedSize >= size)
+			{
+				out.resize(BlockHeaderSize + size);
+
+				std::memcpy(out.data() + BlockHeaderSize, src, size);
+
+				words[0] = StoredBlockFlag | static_cast<uint32>(size);
+			}
+			else
+			{
+				out.resize(BlockHeaderSize + compressedSize);
+			}
+
+			std::memcpy(out.data(), words, BlockHeaderSize);
+		}
+
+		inline bool DecompressBlock(CompressionCodec codec, const uint8* src, size_t srcSize, bool stored, uint8* dst, size_t dstSize)
+		{
+			if (stored)
+			{
+				std::memcpy(dst, src, dstSize);
+
+				return true;
+			}
+
+			if (codec == CompressionCodec::Fast)
+			{
+				return FastDecompress(src, srcSize, dst, dstSize);
+			}
+
+			const ByteArray decompressed = Compression::Decompress(src, srcSize);
+
+			if (decompressed.size() != static_cast<int64>(dstSize))
+			{
+				return false;
+			}
+
+			std::memcpy(dst, decompressed.data(), dstSize);
+
+			return true;
+		}
+
+		inline bool IsValidFrameHeader(const CompressionFrameHeader& header)
+		{
+			return header.signature == CompressionFrameHeader::Signature
+				&& header.version == CompressionFrameHeader::Version
+				&& (header.codec == CompressionCodec::Fast || header.codec == CompressionCodec::Standard)
+				&& Compression::MinBlockSize <= header.blockSize && header.blockSize <= Compression::MaxBlockSize;
+		}
+
+		// ブロックのヘッダを検証し、格納されているデータのサイズを返す。終端のブロックと不正なヘッダでは 0
+		inline size_t BlockPayloadSize(const uint32 (&words)[2], const CompressionFrameHeader& header)
+		{
+			const bool stored = (words[0] & StoredBlockFlag) != 0;
+
+			const size_t payloadSize = words[0] & ~StoredBlockFlag;
+
+			// 圧縮したブロックは、元より小さくなる場合だけ格納される
+			if (words[1] == 0 || words[1] > header.blockSize || (stored ? (payloadSize != words[1]) : (payloadSize >= words[1])))
+			{
+				return 0;
+			}
+
+			return payloadSize;
+		}
+
+		// フレームの各ブロックについて function(data, payloadSize, stored, size) を順に呼ぶ。フレームが不正な場合は false
+		template <class Function>
+		inline bool ForEachFrameBlock(const uint8* data, size_t size, CompressionCodec& codec, Function function)
+		{
+			CompressionFrameHeader header;
+
+			if (size < sizeof(header))
+			{
+				return false;
+			}
+
+			std::memcpy(&header, data, sizeof(header));
+
+			if (!IsValidFrameHeader(header))
+			{
+				return false;
+			}
+
+			codec = header.codec;
+
+			for (size_t pos = sizeof(header);;)
+			{
+				uint32 words[2];
+
+				if (size - pos < BlockHeaderSize)
+				{
+					return false;
+				}
+
+				std::memcpy(words, data + pos, BlockHeaderSize);
+
+				pos += BlockHeaderSize;
+
+				if (words[0] == 0 && words[1] == 0)
+				{
+					return true;
+				}
+
+				const size_t payloadSize = BlockPayloadSize(words, header);
+
+				if (payloadSize == 0 || payloadSize > size - pos
+					|| !function(data + pos, payloadSize, (words[0] & StoredBlockFlag) != 0, static_cast<size_t>(words[1])))
+				{
+					return false;
+				}
+
+				pos += payloadSize;
+			}
+		}
+	}
+
+	namespace Compression
+	{
+		/// <summary>
+		/// データをブロックに分け、スレッドプールで並列に圧縮したフレームを作成します。
+		/// </summary>
+		/// <remarks>
+		/// ブロックは互いに独立して圧縮されるので、展開も並列に行えます。
+		/// 圧縮してもサイズが小さくならないブロックは、圧縮せずに格納します。
+		/// 作成したフレームは DecompressFrame(), DecompressFrameTo(), Decompressor で展開できます。
+		/// </remarks>
+		/// <param name="data">
+		/// 圧縮するデータ
+		/// </param>
+		/// <param name="size">
+		/// 圧縮するデータのサイズ（バイト）
+		/// </param>
+		/// <param name="codec">
+		/// 圧縮方式
+		/// </param>
+		/// <param name="level">
+		/// CompressionCodec::Standard の圧縮レベル
+		/// </param>
+		/// <param name="blockSize">
+		/// ブロックの大きさ（バイト）
+		/// </param>
+		/// <returns>
+		/// 圧縮したフレーム
+		/// </returns>
+		inline ByteArray CompressFrame(const void* data, size_t size, CompressionCodec codec = CompressionCodec::Fast, _Field_range_(1, 9) int32 level = 7, size_t blockSize = DefaultBlockSize)
+		{
+			blockSize = (blockSize < MinBlockSize) ? MinBlockSize : (blockSize > MaxBlockSize) ? MaxBlockSize : blockSize;
+
+			const uint8* src = static_cast<const uint8*>(data);
+
+			const size_t numBlocks = (size + blockSize - 1) / blockSize;
+
+			Array<Array<uint8>> blocks(numBlocks);
+
+			Threading::GetPool()->parallelFor(0, numBlocks, [&](size_t i)
+			{
+				const size_t offset = i * blockSize;
+
+				detail::CompressBlock(src + offset, (size - offset < blockSize) ? (size - offset) : blockSize, codec, level, blocks[i]);
+			});
+
+			const detail::CompressionFrameHeader header = { detail::CompressionFrameHeader::Signature, detail::CompressionFrameHeader::Version, codec, 0, static_cast<uint32>(blockSize) };
+
+			size_t frameSize = sizeof(header) + detail::BlockHeaderSize;
+
+			for (const auto& block : blocks)
+			{
+				frameSize += block.size();
+			}
+
+			Array<uint8> frame(frameSize);
+
+			uint8* dst = frame.data();
+
+			std::memcpy(dst, &header, sizeof(header));
+
+			dst += sizeof(header);
+
+			for (const auto& block : blocks)
+			{
+				std::memcpy(dst, block.data(), block.size());
+
+				dst += block.size();
+			}
+
+			std::memset(dst, 0, detail::BlockHeaderSize);
+
+			return ByteArray(std::move(frame));
+		}
+
+		inline ByteArray CompressFrame(const ByteArray& data, CompressionCodec codec = CompressionCodec::Fast, _Field_range_(1, 9) int32 level = 7, size_t blockSize = DefaultBlockSize)
+		{
+			return CompressFrame(data.data(), static_cast<size_t>(data.size()), codec, level, blockSize);
+		}
+
+		/// <summary>
+		/// スレッドプールでフレームを作成します。
+		/// </summary>
+		/// <remarks>
+		/// 呼び出したスレッドを止めずに圧縮するために使います。
+		/// ByteArray は内容を共有するので、data はコピーされません。
+		/// </remarks>
+		/// <param name="data">
+		/// 圧縮するデータ
+		/// </param>
+		/// <param name="codec">
+		/// 圧縮方式
+		/// </param>
+		/// <param name="level">
+		/// CompressionCodec::Standard の圧縮レベル
+		/// </param>
+		/// <returns>
+		/// 圧縮したフレームを受け取る std::future
+		/// </returns>
+		inline std::future<ByteArray> CompressFrameAsync(const ByteArray& data, CompressionCodec codec = CompressionCodec::Fast, _Field_range_(1, 9) int32 level = 7)
+		{
+			return Threading::GetPool()->submit([data, codec, level]()
+			{
+				return CompressFrame(data, codec, level);
+			});
+		}
+
+		/// <summary>
+		/// フレームを展開した後のサイズを返します。
+		/// </summary>
+		/// <remarks>
+		/// ブロックのヘッダだけを調べるので、データは展開しません。
+		/// </remarks>
+		/// <param name="data">
+		/// フレーム
+		/// </param>
+		/// <param name="size">
+		/// フレームのサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 展開後のサイズ（バイト）。フレームが不正な場合は none
+		/// </returns>
+		inline Optional<size_t> GetFrameContentSize(const void* data, size_t size)
+		{
+			CompressionCodec codec;
+
+			size_t total = 0;
+
+			if (!detail::ForEachFrameBlock(static_cast<const uint8*>(data), size, codec, [&](const uint8*, size_t, bool, size_t blockSize)
+			{
+				total += blockSize;
+
+				return true;
+			}))
+			{
+				return none;
+			}
+
+			return total;
+		}
+
+		/// <summary>
+		/// フレームを呼び出し側のバッファに展開します。
+		/// </summary>
+		/// <remarks>
+		/// CompressionCodec::Fast のフレームと、圧縮せずに格納されたブロックの展開ではメモリを確保しません。
+		/// CompressionCodec::Standard のブロックは Decompress() を使うため、ブロックごとにメモリを確保します。
+		/// </remarks>
+		/// <param name="data">
+		/// フレーム
+		/// </param>
+		/// <param name="size">
+		/// フレームのサイズ（バイト）
+		/// </param>
+		/// <param name="buffer">
+		/// 展開先
+		/// </param>
+		/// <param name="bufferSize">
+		/// 展開先のサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 展開したサイズ（バイト）。フレームが不正な場合と、展開先が小さすぎる場合は none
+		/// </returns>
+		inline Optional<size_t> DecompressFrameTo(const void* data, size_t size, void* buffer, size_t bufferSize)
+		{
+			CompressionCodec codec;
+
+			uint8* const dst = static_cast<uint8*>(buffer);
+
+			size_t total = 0;
+
+			if (!detail::ForEachFrameBlock(static_cast<const uint8*>(data), size, codec, [&](const uint8* src, size_t srcSize, bool stored, size_t blockSize)
+			{
+				if (blockSize > bufferSize - total || !detail::DecompressBlock(codec, src, srcSize, stored, dst + total, blockSize))
+				{
+					return false;
+				}
+
+				total += blockSize;
+
+				return true;
+			}))
+			{
+				return none;
+			}
+
+			return total;
+		}
+
+		/// <summary>
+		/// フレームをスレッドプールで並列に展開します。
+		/// </summary>
+		/// <param name="data">
+		/// フレーム
+		/// </param>
+		/// <param name="size">
+		/// フレームのサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 展開したデータ。フレームが不正な場合は空の ByteArray
+		/// </returns>
+		inline ByteArray DecompressFrame(const void* data, size_t size)
+		{
+			struct Block
+			{
+				const uint8* src;
+
+				size_t srcSize;
+
+				size_t offset;
+
+				size_t size;
+
+				bool stored;
+			};
+
+			CompressionCodec codec;
+
+			Array<Block> blocks;
+
+			size_t total = 0;
+
+			if (!detail::ForEachFrameBlock(static_cast<const uint8*>(data), size, codec, [&](const uint8* src, size_t srcSize, bool stored, size_t blockSize)
+			{
+				blocks.push_back({ src, srcSize, total, blockSize, stored });
+
+				total += blockSize;
+
+				return true;
+			}))
+			{
+				return ByteArray();
+			}
+
+			Array<uint8> output(total);
+
+			std::atomic<bool> failed{ false };
+
+			Threading::GetPool()->parallelFor(0, blocks.size(), [&](size_t i)
+			{
+				const Block& block = blocks[i];
+
+				if (!detail::DecompressBlock(codec, block.src, block.srcSize, block.stored, output.data() + block.offset, block.size))
+				{
+					failed = true;
+				}
+			});
+
+			return failed ? ByteArray() : ByteArray(std::move(output));
+		}
+
+		inline ByteArray DecompressFrame(const ByteArray& data)
+		{
+			return DecompressFrame(data.data(), static_cast<size_t>(data.size()));
+		}
 	}
 }
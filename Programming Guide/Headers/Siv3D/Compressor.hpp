@@ -0,0 +1,403 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cstring>
+# include <utility>
+# include <type_traits>
+# include "Fwd.hpp"
+# include "IWriter.hpp"
+# include "Array.hpp"
+# include "Compression.hpp"
+# include "ThreadPool.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// 書き込んだデータを圧縮して Writer に書き出す IWriter
+	/// </summary>
+	/// <remarks>
+	/// Compression::CompressFrame() と同じフレーム形式で書き出すので、
+	/// Compression::DecompressFrame() や Decompressor で展開できます。
+	/// 書き込んだデータはスレッドの数のブロックがたまるまでバッファにため、スレッドプールで並列に圧縮します。
+	/// 圧縮方式とブロックの大きさは、最初にデータを書き込む前に設定します。
+	/// フレームの終端は close() またはデストラクタで書き込まれます。
+	/// </remarks>
+	template <class Writer>
+	class Compressor final : public IWriter
+	{
+	private:
+
+		static_assert(std::is_base_of<IWriter, Writer>::value, "Compressor: Writer must be derived from IWriter");
+
+		Writer m_writer;
+
+		CompressionCodec m_codec = CompressionCodec::Fast;
+
+		int32 m_level = 7;
+
+		size_t m_blockSize = Compression::DefaultBlockSize;
+
+		Array<uint8> m_input;
+
+		size_t m_size = 0;
+
+		Array<Array<uint8>> m_blocks;
+
+		// 圧縮して書き出したデータのサイズ
+		int64 m_written = 0;
+
+		bool m_started = false;
+
+		bool m_closed = false;
+
+		// Writer への書き込みに失敗した。以降の書き込みはすべて失敗する
+		bool m_failed = false;
+
+		bool writeOut(const void* data, size_t size)
+		{
+			if (!m_failed && m_writer.write(data, size) != size)
+			{
+				m_failed = true;
+			}
+
+			return !m_failed;
+		}
+
+		void start()
+		{
+			if (m_started)
+			{
+				return;
+			}
+
+			m_started = true;
+
+			const size_t numThreads = Threading::GetPool()->numThreads();
+
+			m_input.resize(m_blockSize * (numThreads ? numThreads : 1));
+
+			const detail::CompressionFrameHeader header = { detail::CompressionFrameHeader::Signature, detail::CompressionFrameHeader::Version, m_codec, 0, static_cast<uint32>(m_blockSize) };
+
+			writeOut(&header, sizeof(header));
+		}
+
+		bool compressInput()
+		{
+			start();
+
+			if (m_failed)
+			{
+				return false;
+			}
+
+			if (!m_size)
+			{
+				return true;
+			}
+
+			const size_t numBlocks = (m_size + m_blockSize - 1) / m_blockSize;
+
+			if (m_blocks.size() < numBlocks)
+			{
+				m_blocks.resize(numBlocks);
+			}
+
+			Threading::GetPool()->parallelFor(0, numBlocks, [&](size_t i)
+			{
+				const size_t offset = i * m_blockSize;
+
+				detail::CompressBlock(m_input.data() + offset, (m_size - offset < m_blockSize) ? (m_size - offset) : m_blockSize, m_codec, m_level, m_blocks[i]);
+			});
+
+			for (size_t i = 0; i < numBlocks; ++i)
+			{
+				if (!writeOut(m_blocks[i].data(), m_blocks[i].size()))
+				{
+					m_size = 0;
+
+					return false;
+				}
+			}
+
+			m_written += m_size;
+
+			m_size = 0;
+
+			return true;
+		}
+
+	public:
+
+		/// <summary>
+		/// Writer を作成します。
+		/// </summary>
+		/// <param name="args">
+		/// Writer のコンストラクタ引数
+		/// </param>
+		template <class ...Args, class = std::enable_if_t<std::is_constructible<Writer, Args&&...>::value>>
+		explicit Compressor(Args&&... args)
+			: m_writer(std::forward<Args>(args)...) {}
+
+		Compressor(const Compressor&) = delete;
+
+		Compressor& operator =(const Compressor&) = delete;
+
+		Compressor(Compressor&& other)
+			: m_writer(std::move(other.m_writer))
+			, m_codec(other.m_codec)
+			, m_level(other.m_level)
+			, m_blockSize(other.m_blockSize)
+			, m_input(std::move(other.m_input))
+			, m_size(std::exchange(other.m_size, 0))
+			, m_blocks(std::move(other.m_blocks))
+			, m_written(other.m_written)
+			, m_started(other.m_started)
+			, m_closed(std::exchange(other.m_closed, true))
+			, m_failed(other.m_failed) {}
+
+		/// <summary>
+		/// デストラクタ
+		/// </summary>
+		/// <remarks>
+		/// close() を呼びます。
+		/// </remarks>
+		~Compressor()
+		{
+			close();
+		}
+
+		/// <summary>
+		/// 圧縮方式を設定します。
+		/// </summary>
+		/// <param name="codec">
+		/// 圧縮方式
+		/// </param>
+		/// <param name="level">
+		/// CompressionCodec::Standard の圧縮レベル
+		/// </param>
+		/// <returns>
+		/// 設定できた場合 true, すでにデータを書き込んでいる場合は false
+		/// </returns>
+		bool setCodec(CompressionCodec codec, _Field_range_(1, 9) int32 level = 7)
+		{
+			if (m_started)
+			{
+				return false;
+			}
+
+			m_codec = codec;
+
+			m_level = level;
+
+			return true;
+		}
+
+		/// <summary>
+		/// ブロックの大きさを設定します。
+		/// </summary>
+		/// <param name="size">
+		/// ブロックの大きさ（バイト）
+		/// </param>
+		/// <returns>
+		/// 設定できた場合 true, すでにデータを書き込んでいる場合は false
+		/// </returns>
+		bool setBlockSize(size_t size)
+		{
+			if (m_started)
+			{
+				return false;
+			}
+
+			m_blockSize = (size < Compression::MinBlockSize) ? Compression::MinBlockSize : (size > Compression::MaxBlockSize) ? Compression::MaxBlockSize : size;
+
+			return true;
+		}
+
+		/// <summary>
+		/// バッファにたまっているデータを圧縮して書き出します。
+		/// </summary>
+		/// <remarks>
+		/// ブロックの途中で呼ぶと小さなブロックができ、圧縮率が下がります。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void flush()
+		{
+			if (!m_closed)
+			{
+				compressInput();
+			}
+		}
+
+		/// <summary>
+		/// バッファにたまっているデータを圧縮して書き出し、フレームの終端を書き込みます。
+		/// </summary>
+		/// <remarks>
+		/// 閉じた後の書き込みは失敗します。
+		/// </remarks>
+		/// <returns>
+		/// フレームをすべて書き出せた場合 true, Writer への書き込みに失敗していた場合は false
+		/// </returns>
+		bool close()
+		{
+			if (m_closed)
+			{
+				return !m_failed;
+			}
+
+			if (compressInput())
+			{
+				const uint8 end[detail::BlockHeaderSize] = {};
+
+				writeOut(end, sizeof(end));
+			}
+
+			m_closed = true;
+
+			m_input.clear();
+
+			m_input.shrink_to_fit();
+
+			m_blocks.clear();
+
+			return !m_failed;
+		}
+
+		/// <summary>
+		/// バッファにたまっているデータを圧縮して書き出してから、Writer を返します。
+		/// </summary>
+		/// <returns>
+		/// Writer
+		/// </returns>
+		Writer& getWriter()
+		{
+			flush();
+
+			return m_writer;
+		}
+
+		/// <summary>
+		/// 書き込みができるかを返します。
+		/// </summary>
+		/// <returns>
+		/// 閉じておらず、Writer への書き込みに失敗していない場合 true, それ以外の場合は false
+		/// </returns>
+		bool isOpened() const override
+		{
+			return !m_closed && !m_failed && m_writer.isOpened();
+		}
+
+		explicit operator bool() const { return isOpened(); }
+
+		/// <summary>
+		/// 書き込んだデータの圧縮前のサイズを返します。
+		/// </summary>
+		/// <returns>
+		/// サイズ（バイト）
+		/// </returns>
+		int64 size() const override
+		{
+			return getPos();
+		}
+
+		/// <summary>
+		/// 書き込んだデータの圧縮前のサイズを返します。
+		/// </summary>
+		/// <returns>
+		/// 現在の書き込み位置（バイト）
+		/// </returns>
+		int64 getPos() const override
+		{
+			return m_written + static_cast<int64>(m_size);
+		}
+
+		/// <summary>
+		/// 書き込み位置は変更できません。
+		/// </summary>
+		/// <param name="pos">
+		/// 新しい書き込み位置（バイト）
+		/// </param>
+		/// <returns>
+		/// pos が現在の書き込み位置の場合 true, それ以外の場合は false
+		/// </returns>
+		bool setPos(int64 pos) override
+		{
+			return pos == getPos();
+		}
+
+		using IWriter::write;
+
+		/// <summary>
+		/// データを書き込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 書き込むデータ
+		/// </param>
+		/// <param name="size">
+		/// 書き込むサイズ（バイト）
+		/// </param>
+		/// <remarks>
+		/// Writer への書き込みに失敗すると、バッファにたまっていたデータは失われ、以降の書き込みはすべて失敗します。
+		/// </remarks>
+		/// <returns>
+		/// 実際に書き込んだサイズ（バイト）。Writer への書き込みに失敗した場合は、失敗する前に書き出せたサイズ
+		/// </returns>
+		size_t write(_In_reads_bytes_(size) const void* buffer, size_t size) override
+		{
+			if (m_closed || m_failed)
+			{
+				return 0;
+			}
+
+			start();
+
+			if (m_failed)
+			{
+				return 0;
+			}
+
+			const uint8* src = static_cast<const uint8*>(buffer);
+
+			// この呼び出しで受け取ったデータのうち、Writer に書き出したサイズと、バッファにあるサイズ
+			size_t committed = 0, buffered = 0;
+
+			for (size_t remaining = size; remaining;)
+			{
+				const size_t count = (remaining < m_input.size() - m_size) ? remaining : (m_input.size() - m_size);
+
+				std::memcpy(m_input.data() + m_size, src, count);
+
+				m_size += count;
+
+				src += count;
+
+				remaining -= count;
+
+				buffered += count;
+
+				if (m_size == m_input.size())
+				{
+					if (!compressInput())
+					{
+						return committed;
+					}
+
+					committed += buffered;
+
+					buffered = 0;
+				}
+			}
+
+			return size;
+		}
+	};
+}
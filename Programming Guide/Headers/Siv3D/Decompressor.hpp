@@ -0,0 +1,401 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cstring>
+# include <utility>
+# include <type_traits>
+# include "Fwd.hpp"
+# include "IReader.hpp"
+# include "Array.hpp"
+# include "Compression.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// Reader から読み込んだフレームを展開しながら読み込む IReader
+	/// </summary>
+	/// <remarks>
+	/// Compression::CompressFrame() と Compressor が作成したフレームを、1 ブロックずつ展開します。
+	/// 使うメモリはブロックの大きさ程度で、フレーム全体を展開しません。
+	/// 開いたときにブロックのヘッダをたどって展開後のサイズを調べるので、Reader は setPos() と skip() をサポートしている必要があります。
+	/// 読み込み位置を戻すと、フレームの先頭から必要なブロックまで読み直します。
+	/// </remarks>
+	template <class Reader>
+	class Decompressor final : public IReader
+	{
+	private:
+
+		static_assert(std::is_base_of<IReader, Reader>::value, "Decompressor: Reader must be derived from IReader");
+
+		Reader m_reader;
+
+		detail::CompressionFrameHeader m_header = {};
+
+		bool m_valid = false;
+
+		// 最初のブロックの Reader 上の位置
+		int64 m_frameStart = 0;
+
+		int64 m_contentSize = 0;
+
+		Array<uint8> m_block;
+
+		Array<uint8> m_compressed;
+
+		// m_block[0] の展開後の位置
+		int64 m_blockPos = 0;
+
+		size_t m_current = 0;
+
+		size_t m_available = 0;
+
+		bool readBlockHeader(uint32 (&words)[2], size_t& payloadSize)
+		{
+			if (m_reader.read(words, detail::BlockHeaderSize) != static_cast<int64>(detail::BlockHeaderSize))
+			{
+				return false;
+			}
+
+			payloadSize = detail::BlockPayloadSize(words, m_header);
+
+			return payloadSize != 0;
+		}
+
+		bool readHeader()
+		{
+			if (m_reader.read(&m_header, sizeof(m_header)) != sizeof(m_header) || !detail::IsValidFrameHeader(m_header))
+			{
+				return false;
+			}
+
+			m_frameStart = m_reader.getPos();
+
+			// ブロックのヘッダだけをたどって、展開後のサイズを調べる
+			for (;;)
+			{
+				uint32 words[2];
+
+				if (m_reader.read(words, detail::BlockHeaderSize) != static_cast<int64>(detail::BlockHeaderSize))
+				{
+					return false;
+				}
+
+				if (words[0] == 0 && words[1] == 0)
+				{
+					break;
+				}
+
+				const size_t payloadSize = detail::BlockPayloadSize(words, m_header);
+
+				if (payloadSize == 0)
+				{
+					return false;
+				}
+
+				const int64 blockStart = m_reader.getPos();
+
+				if (m_reader.skip(static_cast<int64>(payloadSize)) != blockStart + static_cast<int64>(payloadSize))
+				{
+					return false;
+				}
+
+				m_contentSize += words[1];
+			}
+
+			m_block.resize(m_header.blockSize);
+
+			return m_reader.setPos(m_frameStart);
+		}
+
+		// 展開後の位置 pos を含むブロックまで進み、そのブロックを展開する
+		bool loadBlock(int64 pos)
+		{
+			m_blockPos += m_available;
+
+			m_current = m_available = 0;
+
+			for (;;)
+			{
+				uint32 words[2];
+
+				size_t payloadSize;
+
+				if (!readBlockHeader(words, payloadSize))
+				{
+					return false;
+				}
+
+				const size_t blockSize = words[1];
+
+				if (pos >= m_blockPos + static_cast<int64>(blockSize))
+				{
+					m_reader.skip(static_cast<int64>(payloadSize));
+
+					m_blockPos += blockSize;
+
+					continue;
+				}
+
+				if (words[0] & detail::StoredBlockFlag)
+				{
+					if (m_reader.read(m_block.data(), payloadSize) != static_cast<int64>(payloadSize))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					m_compressed.resize(payloadSize);
+
+					if (m_reader.read(m_compressed.data(), payloadSize) != static_cast<int64>(payloadSize)
+						|| !detail::DecompressBlock(m_header.codec, m_compressed.data(), payloadSize, false, m_block.data(), blockSize))
+					{
+						return false;
+					}
+				}
+
+				m_available = blockSize;
+
+				m_current = static_cast<size_t>(pos - m_blockPos);
+
+				return true;
+			}
+		}
+
+	public:
+
+		/// <summary>
+		/// Reader を作成し、フレームのヘッダを読み込みます。
+		/// </summary>
+		/// <param name="args">
+		/// Reader のコンストラクタ引数
+		/// </param>
+		template <class ...Args, class = std::enable_if_t<std::is_constructible<Reader, Args&&...>::value>>
+		explicit Decompressor(Args&&... args)
+			: m_reader(std::forward<Args>(args)...)
+		{
+			m_valid = m_reader.isOpened() && readHeader();
+		}
+
+		Decompressor(const Decompressor&) = delete;
+
+		Decompressor& operator =(const Decompressor&) = delete;
+
+		Decompressor(Decompressor&& other)
+			: m_reader(std::move(other.m_reader))
+			, m_header(other.m_header)
+			, m_valid(std::exchange(other.m_valid, false))
+			, m_frameStart(other.m_frameStart)
+			, m_contentSize(other.m_contentSize)
+			, m_block(std::move(other.m_block))
+			, m_compressed(std::move(other.m_compressed))
+			, m_blockPos(other.m_blockPos)
+			, m_current(std::exchange(other.m_current, 0))
+			, m_available(std::exchange(other.m_available, 0)) {}
+
+		/// <summary>
+		/// フレームが正しく開けたかを返します。
+		/// </summary>
+		/// <remarks>
+		/// 展開中に不正なブロックが見つかった場合も false になります。
+		/// </remarks>
+		/// <returns>
+		/// Reader が開いていて、フレームが正しい場合 true, それ以外の場合は false
+		/// </returns>
+		bool isOpened() const override
+		{
+			return m_valid && m_reader.isOpened();
+		}
+
+		explicit operator bool() const { return isOpened(); }
+
+		/// <summary>
+		/// 展開後のサイズを返します。
+		/// </summary>
+		/// <returns>
+		/// 展開後のサイズ（バイト）
+		/// </returns>
+		int64 size() const override
+		{
+			return m_contentSize;
+		}
+
+		/// <summary>
+		/// 展開後のデータでの読み込み位置を返します。
+		/// </summary>
+		/// <returns>
+		/// 現在の読み込み位置（バイト）
+		/// </returns>
+		int64 getPos() const override
+		{
+			return m_blockPos + static_cast<int64>(m_current);
+		}
+
+		/// <summary>
+		/// 展開後のデータでの読み込み位置を変更します。
+		/// </summary>
+		/// <remarks>
+		/// 読み飛ばすブロックは展開しません。
+		/// </remarks>
+		/// <param name="pos">
+		/// 新しい読み込み位置（バイト）
+		/// </param>
+		/// <returns>
+		/// 読み込み位置の変更に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool setPos(int64 pos) override
+		{
+			if (!m_valid || pos < 0 || pos > m_contentSize)
+			{
+				return false;
+			}
+
+			if (m_blockPos <= pos && pos <= m_blockPos + static_cast<int64>(m_available))
+			{
+				m_current = static_cast<size_t>(pos - m_blockPos);
+
+				return true;
+			}
+
+			if (pos < m_blockPos)
+			{
+				if (!m_reader.setPos(m_frameStart))
+				{
+					return m_valid = false;
+				}
+
+				m_blockPos = 0;
+
+				m_current = m_available = 0;
+			}
+
+			if (pos == m_contentSize)
+			{
+				// 終端では読み込むブロックがないので、Reader の位置はそのままにする
+				m_blockPos = pos;
+
+				m_current = m_available = 0;
+
+				return true;
+			}
+
+			return m_valid = loadBlock(pos);
+		}
+
+		/// <summary>
+		/// 展開後のデータを読み飛ばします。
+		/// </summary>
+		/// <param name="offset">
+		/// 移動するサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 新しい読み込み位置
+		/// </returns>
+		int64 skip(int64 offset) override
+		{
+			const int64 pos = getPos();
+
+			setPos((offset < -pos) ? 0 : (offset > m_contentSize - pos) ? m_contentSize : (pos + offset));
+
+			return getPos();
+		}
+
+		using IReader::read;
+
+		/// <summary>
+		/// データを展開しながら読み込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 読み込み先
+		/// </param>
+		/// <param name="size">
+		/// 読み込むサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 実際に読み込んだサイズ（バイト）
+		/// </returns>
+		int64 read(_Out_writes_bytes_all_(size) void* buffer, int64 size) override
+		{
+			uint8* dst = static_cast<uint8*>(buffer);
+
+			int64 readSize = 0;
+
+			while (m_valid && readSize < size)
+			{
+				if (m_current == m_available)
+				{
+					if (getPos() == m_contentSize)
+					{
+						break;
+					}
+
+					if (!(m_valid = loadBlock(getPos())))
+					{
+						break;
+					}
+				}
+
+				const size_t count = (static_cast<uint64>(size - readSize) < m_available - m_current) ? static_cast<size_t>(size - readSize) : (m_available - m_current);
+
+				std::memcpy(dst + readSize, m_block.data() + m_current, count);
+
+				m_current += count;
+
+				readSize += count;
+			}
+
+			return readSize;
+		}
+
+		/// <summary>
+		/// 読み込み位置を変更してから、データを展開しながら読み込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 読み込み先
+		/// </param>
+		/// <param name="pos">
+		/// 展開後のデータの先頭から数えた読み込み開始位置（バイト）
+		/// </param>
+		/// <param name="size">
+		/// 読み込むサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 実際に読み込んだサイズ（バイト）
+		/// </returns>
+		int64 read(_Out_writes_bytes_all_(size) void* buffer, int64 pos, int64 size) override
+		{
+			if (!setPos(pos))
+			{
+				return 0;
+			}
+
+			return read(buffer, size);
+		}
+
+		/// <summary>
+		/// 読み込み位置を変更しないデータ読み込みをサポートしているかを返します。
+		/// </summary>
+		/// <returns>
+		/// つねに false
+		/// </returns>
+		bool supportsLookahead() const override { return false; }
+
+		int64 lookahead(void*, int64) const override
+		{
+			return 0;
+		}
+
+		int64 lookahead(void*, int64, int64) const override
+		{
+			return 0;
+		}
+	};
+}
@@ -217,10 +217,30 @@ namespace s3d
 		return os << CharType('(') << c.x << CharType(',') << c.y << CharType(',') << c.a << CharType(',') << c.b << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const Ellipse& c)
+	{
+		FormatTuple(formatData, c.x, c.y, c.a, c.b);
+	}
+
 	template <class CharType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, Ellipse& c)
 	{
 		CharType unused;
 		return is >> unused >> c.x >> unused >> c.y >> unused >> c.a >> unused >> c.b >> unused;
 	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Ellipse& c)
+	{
+		Ellipse result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.x, result.y, result.a, result.b);
+
+		if (r)
+		{
+			c = result;
+		}
+
+		return r;
+	}
 }
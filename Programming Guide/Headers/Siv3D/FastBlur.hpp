@@ -0,0 +1,325 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <array>
+# include <cmath>
+# include <algorithm>
+# include <utility>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "Image.hpp"
+
+namespace s3d
+{
+	namespace Imaging
+	{
+		namespace detail
+		{
+			// BORDER_REFLECT_101 と同じ境界の扱い
+			inline int32 Reflect101(int32 i, int32 n)
+			{
+				if (n == 1)
+				{
+					return 0;
+				}
+
+				const int32 period = 2 * n - 2;
+
+				i %= period;
+
+				if (i < 0)
+				{
+					i += period;
+				}
+
+				return i < n ? i : period - i;
+			}
+
+			// 4 チャンネルの浮動小数点画像
+			struct BlurBuffer
+			{
+				Array<float> data;
+
+				int32 width = 0;
+
+				int32 height = 0;
+
+				BlurBuffer() = default;
+
+				explicit BlurBuffer(const Image& image)
+					: data(image.num_pixels * 4)
+					, width(image.width)
+					, height(image.height)
+				{
+					float* p = data.data();
+
+					for (const auto& pixel : image)
+					{
+						*p++ = static_cast<float>(pixel.r);
+						*p++ = static_cast<float>(pixel.g);
+						*p++ = static_cast<float>(pixel.b);
+						*p++ = static_cast<float>(pixel.a);
+					}
+				}
+
+				void copyTo(Image& image) const
+				{
+					image.resize(width, height);
+
+					const float* p = data.data();
+
+					const auto toChannel = [](float v) { return static_cast<uint32>(Clamp(v + 0.5f, 0.0f, 255.0f)); };
+
+					for (auto& pixel : image)
+					{
+						pixel = Color(toChannel(p[0]), toChannel(p[1]), toChannel(p[2]), toChannel(p[3]));
+
+						p += 4;
+					}
+				}
+			};
+
+			// 半径 radius のボックスフィルタを水平方向に適用する。累積和により 1 ピクセルあたりの計算量は半径によらない
+			inline void BoxPassHorizontal(const BlurBuffer& src, BlurBuffer& dst, int32 radius)
+			{
+				const int32 width = src.width;
+
+				const double inv = 1.0 / (2 * radius + 1);
+
+				for (int32 y = 0; y < src.height; ++y)
+				{
+					const float* in = &src.data[static_cast<size_t>(y) * width * 4];
+
+					float* out = &dst.data[static_cast<size_t>(y) * width * 4];
+
+					std::array<double, 4> sum = {};
+
+					for (int32 i = -radius; i <= radius; ++i)
+					{
+						const float* p = in + Reflect101(i, width) * 4;
+
+						for (int32 c = 0; c < 4; ++c)
+						{
+							sum[c] += p[c];
+						}
+					}
+
+					for (int32 x = 0; x < width; ++x)
+					{
+						const float* add = in + Reflect101(x + radius + 1, width) * 4;
+
+						const float* sub = in + Reflect101(x - radius, width) * 4;
+
+						for (int32 c = 0; c < 4; ++c)
+						{
+							out[x * 4 + c] = static_cast<float>(sum[c] * inv);
+
+							sum[c] += add[c] - sub[c];
+						}
+					}
+				}
+			}
+
+			// 半径 radius のボックスフィルタを垂直方向に適用する。列ごとの累積和を行単位で更新する
+			inline void BoxPassVertical(const BlurBuffer& src, BlurBuffer& dst, int32 radius)
+			{
+				const size_t rowLength = static_cast<size_t>(src.width) * 4;
+
+				const int32 height = src.height;
+
+				const double inv = 1.0 / (2 * radius + 1);
+
+				Array<double> sum(rowLength, 0.0);
+
+				const auto row = [&](int32 y) { return &src.data[Reflect101(y, height) * rowLength]; };
+
+				for (int32 i = -radius; i <= radius; ++i)
+				{
+					const float* p = row(i);
+
+					for (size_t k = 0; k < rowLength; ++k)
+					{
+						sum[k] += p[k];
+					}
+				}
+
+				for (int32 y = 0; y < height; ++y)
+				{
+					float* out = &dst.data[y * rowLength];
+
+					const float* add = row(y + radius + 1);
+
+					const float* sub = row(y - radius);
+
+					for (size_t k = 0; k < rowLength; ++k)
+					{
+						out[k] = static_cast<float>(sum[k] * inv);
+
+						sum[k] += add[k] - sub[k];
+					}
+				}
+			}
+
+			// ガウスフィルタを n 回のボックスフィルタで近似するときの各半径 (Kovesi, "Fast Almost-Gaussian Filtering")
+			inline Array<int32> GaussianBoxRadii(double sigma, int32 n = 3)
+			{
+				const double wIdeal = std::sqrt(12.0 * sigma * sigma / n + 1.0);
+
+				int32 wl = static_cast<int32>(std::floor(wIdeal));
+
+				if (wl % 2 == 0)
+				{
+					--wl;
+				}
+
+				const int32 wu = wl + 2;
+
+				const int32 m = static_cast<int32>(std::round((12.0 * sigma * sigma - n * wl * wl - 4.0 * n * wl - 3.0 * n) / (-4.0 * wl - 4.0)));
+
+				Array<int32> radii;
+
+				for (int32 i = 0; i < n; ++i)
+				{
+					radii.push_back(((i < m) ? wl : wu) / 2);
+				}
+
+				return radii;
+			}
+
+			// 半径 radius (カーネルの大きさ 2 * radius + 1) のガウスフィルタの標準偏差
+			inline double GaussianSigma(int32 radius)
+			{
+				return 0.3 * (radius - 1) + 0.8;
+			}
+
+			// BlurMethod::ConstantTime のボックスフィルタ。buffer は作業領域として上書きされる
+			inline void BoxBlur(BlurBuffer& buffer, Image& dst, int32 horizontal, int32 vertical)
+			{
+				BlurBuffer tmp = buffer;
+
+				BoxPassHorizontal(buffer, tmp, std::max(horizontal, 0));
+
+				BoxPassVertical(tmp, buffer, std::max(vertical, 0));
+
+				buffer.copyTo(dst);
+			}
+
+			// BlurMethod::ConstantTime のガウスフィルタ。buffer は作業領域として上書きされる
+			inline void GaussianBoxBlur(BlurBuffer& buffer, Image& dst, int32 horizontal, int32 vertical)
+			{
+				BlurBuffer tmp = buffer;
+
+				for (const auto radius : GaussianBoxRadii(GaussianSigma(std::max(horizontal, 0))))
+				{
+					BoxPassHorizontal(buffer, tmp, radius);
+
+					std::swap(buffer, tmp);
+				}
+
+				for (const auto radius : GaussianBoxRadii(GaussianSigma(std::max(vertical, 0))))
+				{
+					BoxPassVertical(buffer, tmp, radius);
+
+					std::swap(buffer, tmp);
+				}
+
+				buffer.copyTo(dst);
+			}
+		}
+
+		/// <summary>
+		/// 画像をぼかします。
+		/// </summary>
+		/// <param name="src">
+		/// 入力画像
+		/// </param>
+		/// <param name="dst">
+		/// 出力画像
+		/// </param>
+		/// <param name="horizontal">
+		/// 水平方向のカーネルの半径
+		/// </param>
+		/// <param name="vertical">
+		/// 垂直方向のカーネルの半径
+		/// </param>
+		/// <param name="method">
+		/// 計算方法。BlurMethod::ConstantTime の場合、累積和により半径によらず一定の計算量で同じボックスフィルタを計算します。
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void Blur(const Image& src, Image& dst, int32 horizontal, int32 vertical, BlurMethod method)
+		{
+			if (method == BlurMethod::Exact)
+			{
+				Blur(src, dst, horizontal, vertical);
+
+				return;
+			}
+
+			if (src.isEmpty)
+			{
+				dst.clear();
+
+				return;
+			}
+
+			detail::BlurBuffer buffer(src);
+
+			detail::BoxBlur(buffer, dst, horizontal, vertical);
+		}
+
+		/// <summary>
+		/// 画像にガウスぼかしを適用します。
+		/// </summary>
+		/// <param name="src">
+		/// 入力画像
+		/// </param>
+		/// <param name="dst">
+		/// 出力画像
+		/// </param>
+		/// <param name="horizontal">
+		/// 水平方向のカーネルの半径
+		/// </param>
+		/// <param name="vertical">
+		/// 垂直方向のカーネルの半径
+		/// </param>
+		/// <param name="method">
+		/// 計算方法。BlurMethod::ConstantTime の場合、同じ標準偏差を持つ 3 回のボックスフィルタで近似し、半径によらず一定の計算量になります。
+		/// </param>
+		/// <remarks>
+		/// 近似の精度は Imaging::SSIM() で BlurMethod::Exact の結果と比較できます。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void GaussianBlur(const Image& src, Image& dst, int32 horizontal, int32 vertical, BlurMethod method)
+		{
+			if (method == BlurMethod::Exact)
+			{
+				GaussianBlur(src, dst, horizontal, vertical);
+
+				return;
+			}
+
+			if (src.isEmpty)
+			{
+				dst.clear();
+
+				return;
+			}
+
+			detail::BlurBuffer buffer(src);
+
+			detail::GaussianBoxBlur(buffer, dst, horizontal, vertical);
+		}
+	}
+}
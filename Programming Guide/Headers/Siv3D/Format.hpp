@@ -16,6 +16,7 @@
 # include "Number.hpp"
 # include "Array.hpp"
 # include "String.hpp"
+# include "FormatFloat.hpp"
 # include "PyFmt.hpp"
 
 namespace s3d
@@ -50,6 +51,24 @@ namespace s3d
 			constexpr DecimalPlace(int32 v = 5) : value(v) {}
 			int32 value;
 		} decimalPlace;
+
+		struct RoundTrip
+		{
+			constexpr RoundTrip(bool v = false) : value(v) {}
+			bool value;
+		} roundTrip;
+
+		/// <summary>
+		/// 文字列のメモリを保持したまま、状態を初期化します。
+		/// </summary>
+		void clear()
+		{
+			string.clear();
+
+			decimalPlace = DecimalPlace();
+
+			roundTrip = RoundTrip();
+		}
 	};
 
 	/// <summary>
@@ -105,6 +124,51 @@ namespace s3d
 		return std::move(formatData.string);
 	}
 
+	/// <summary>
+	/// 一連の引数を文字列に変換し、既存の文字列に書き込みます。
+	/// </summary>
+	/// <param name="dst">
+	/// 書き込み先の文字列。以前の内容は消去されますが、確保済みのメモリは再利用されます。
+	/// </param>
+	/// <param name="args">
+	/// 変換する値
+	/// </param>
+	/// <remarks>
+	/// 毎フレーム同じ文字列を作り直す場合、Format() の代わりに使うとメモリ確保を避けられます。
+	/// </remarks>
+	template <class ... Args>
+	inline void FormatTo(String& dst, const Args& ... args)
+	{
+		static_assert(format_validation<Args...>::value, "type \"char*\" cannot be used in FormatTo()");
+
+		FormatData formatData;
+
+		formatData.string.swap(dst);
+
+		formatData.string.clear();
+
+		Format(formatData, args...);
+
+		dst.swap(formatData.string);
+	}
+
+	/// <summary>
+	/// 一連の引数を文字列に変換し、formatData の末尾に追加します。
+	/// </summary>
+	/// <param name="formatData">
+	/// 書き込み先。clear() して使い回すとメモリ確保を避けられます。
+	/// </param>
+	/// <param name="args">
+	/// 変換する値
+	/// </param>
+	template <class ... Args>
+	inline void FormatTo(FormatData& formatData, const Args& ... args)
+	{
+		static_assert(format_validation<Args...>::value, "type \"char*\" cannot be used in FormatTo()");
+
+		Format(formatData, args...);
+	}
+
 	/// <summary>
 	/// 引数を文字列に変換します。
 	/// </summary>
@@ -170,6 +234,7 @@ namespace s3d
 	/// <remarks>
 	/// この関数が返すマニピュレータを Format の引数にすると、
 	/// 該当 Format() 内のそれ以降の浮動小数点数の変換に適用されます。
+	/// RoundTrip の指定は解除されます。負の値は 0 として扱われます。
 	/// </remarks>
 	/// <returns>
 	/// Format に渡すマニピュレータ
@@ -179,6 +244,15 @@ namespace s3d
 		return FormatData::DecimalPlace(width);
 	}
 
+	/// <summary>
+	/// 浮動小数点数を、元の値に戻せる短い桁数で変換するマニピュレータ
+	/// </summary>
+	/// <remarks>
+	/// 出力は必ず元の値に戻りますが、まれに最短より 1 桁長くなります。
+	/// Format の引数にすると、該当 Format() 内のそれ以降の浮動小数点数の変換に、次に DecimalPlace を指定するまで適用されます。
+	/// </remarks>
+	constexpr FormatData::RoundTrip RoundTrip = FormatData::RoundTrip(true);
+
 	namespace literals
 	{
 		inline namespace formatting_literals
@@ -216,7 +290,9 @@ namespace s3d
 
 	inline void Formatter(FormatData& formatData, double value)
 	{
-		formatData.string.append(ToString(value, formatData.decimalPlace.value));
+		const detail::FormatFloat buffer = formatData.roundTrip.value
+			? detail::FormatFloat(value) : detail::FormatFloat(value, formatData.decimalPlace.value);
+		formatData.string.append(buffer.data(), buffer.size());
 	}
 
 	void Formatter(FormatData& formatData, const void* value);
@@ -282,6 +358,13 @@ namespace s3d
 	inline void Formatter(FormatData& formatData, const FormatData::DecimalPlace decimalPlace)
 	{
 		formatData.decimalPlace = decimalPlace;
+
+		formatData.roundTrip = FormatData::RoundTrip();
+	}
+
+	inline void Formatter(FormatData& formatData, const FormatData::RoundTrip roundTrip)
+	{
+		formatData.roundTrip = roundTrip;
 	}
 
 	inline void Formatter(FormatData& formatData, const wchar* const str)
@@ -371,29 +454,44 @@ namespace s3d
 		formatData.string.append(wos.str());
 	}
 
-	void Formatter(FormatData& formatData, const Color& value);
-	void Formatter(FormatData& formatData, const ColorF& value);
-	void Formatter(FormatData& formatData, const HSV& value);
-	void Formatter(FormatData& formatData, const Point& value);
-	void Formatter(FormatData& formatData, const Float2& value);
-	void Formatter(FormatData& formatData, const Vec2& value);
-	void Formatter(FormatData& formatData, const Float3& value);
-	void Formatter(FormatData& formatData, const Vec3& value);
-	void Formatter(FormatData& formatData, const Float4& value);
-	void Formatter(FormatData& formatData, const Vec4& value);
+	// 色、図形、ベクトル、行列の Formatter は、各型のヘッダでストリームを使わずに定義されています。
+	// ライブラリがエクスポートする同じ引数の関数とシンボルが重複しないよう、上の関数テンプレートの特殊化またはオーバーロードとして定義します。
 	void Formatter(FormatData& formatData, const __m128& value);
-	void Formatter(FormatData& formatData, const Circular& value);
-	void Formatter(FormatData& formatData, const LineInt& value);
-	void Formatter(FormatData& formatData, const Line& value);
-	void Formatter(FormatData& formatData, const Rect& value);
-	void Formatter(FormatData& formatData, const RectF& value);
-	void Formatter(FormatData& formatData, const Circle& value);
-	void Formatter(FormatData& formatData, const Ellipse& value);
-	void Formatter(FormatData& formatData, const Triangle& value);
-	void Formatter(FormatData& formatData, const Quad& value);
-	void Formatter(FormatData& formatData, const RoundRect& value);
-	void Formatter(FormatData& formatData, const Mat3x2& value);
-	void Formatter(FormatData& formatData, const Quaternion& value);
-	void Formatter(FormatData& formatData, const Mat4x4& value);
-	void Formatter(FormatData& formatData, const Ray& value);
+
+	namespace detail
+	{
+		inline void FormatTupleTail(FormatData&)
+		{
+			return;
+		}
+
+		template <class Type, class ... Args>
+		inline void FormatTupleTail(FormatData& formatData, const Type& value, const Args& ... args)
+		{
+			formatData.string.push_back(L',');
+
+			Formatter(formatData, value);
+
+			FormatTupleTail(formatData, args...);
+		}
+	}
+
+	/// <summary>
+	/// 値を (a,b,c) の形式で formatData に追加します。
+	/// </summary>
+	/// <remarks>
+	/// ユーザー定義型の Formatter を、ストリームを使わずに書くための補助関数です。
+	/// 各要素は Formatter で変換されるため、DecimalPlace と RoundTrip が適用されます。
+	/// </remarks>
+	template <class Type, class ... Args>
+	inline void FormatTuple(FormatData& formatData, const Type& value, const Args& ... args)
+	{
+		formatData.string.push_back(L'(');
+
+		Formatter(formatData, value);
+
+		detail::FormatTupleTail(formatData, args...);
+
+		formatData.string.push_back(L')');
+	}
 }
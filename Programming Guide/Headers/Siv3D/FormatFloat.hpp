@@ -0,0 +1,508 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cmath>
+# include <cstdio>
+# include <cstring>
+# include "Fwd.hpp"
+# include "String.hpp"
+# include "Utility.hpp"
+
+namespace s3d
+{
+	namespace detail
+	{
+		/// <summary>
+		/// Grisu2 (Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers") による
+		/// 浮動小数点数の最短表現の計算
+		/// </summary>
+		/// <remarks>
+		/// 結果の桁列は必ず元の値に戻りますが、最短であるとは限りません。
+		/// 最短の桁列が丸めの境界に近い値（約 1600 個に 1 個）では、1 桁長い桁列を返します。
+		/// </remarks>
+		namespace Grisu2
+		{
+			struct DiyFp
+			{
+				uint64 f;
+
+				int32 e;
+
+				static DiyFp Sub(const DiyFp& x, const DiyFp& y)
+				{
+					return{ x.f - y.f, x.e };
+				}
+
+				// 128 ビット積の上位 64 ビットを丸めて返す
+				static DiyFp Mul(const DiyFp& x, const DiyFp& y)
+				{
+					const uint64 uLo = x.f & 0xFFFFFFFFu, uHi = x.f >> 32;
+					const uint64 vLo = y.f & 0xFFFFFFFFu, vHi = y.f >> 32;
+
+					const uint64 p0 = uLo * vLo, p1 = uLo * vHi, p2 = uHi * vLo, p3 = uHi * vHi;
+
+					uint64 q = (p0 >> 32) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+
+					q += uint64(1) << 31;
+
+					return{ p3 + (p1 >> 32) + (p2 >> 32) + (q >> 32), x.e + y.e + 64 };
+				}
+
+				static DiyFp Normalize(DiyFp x)
+				{
+					while ((x.f >> 63) == 0)
+					{
+						x.f <<= 1;
+						--x.e;
+					}
+
+					return x;
+				}
+
+				static DiyFp NormalizeTo(const DiyFp& x, int32 e)
+				{
+					return{ x.f << (x.e - e), e };
+				}
+			};
+
+			struct Boundaries
+			{
+				DiyFp w, minus, plus;
+			};
+
+			// value と、value に丸められる区間の両端
+			inline Boundaries ComputeBoundaries(double value)
+			{
+				constexpr int32 Bias = 1075;
+				constexpr uint64 HiddenBit = uint64(1) << 52;
+
+				uint64 bits;
+
+				std::memcpy(&bits, &value, sizeof(bits));
+
+				const uint64 E = bits >> 52, F = bits & (HiddenBit - 1);
+
+				const DiyFp v = (E == 0) ? DiyFp{ F, 1 - Bias } : DiyFp{ F + HiddenBit, static_cast<int32>(E) - Bias };
+
+				const bool lowerIsCloser = (F == 0 && E > 1);
+
+				const DiyFp plus = DiyFp::Normalize({ 2 * v.f + 1, v.e - 1 });
+
+				const DiyFp minus = lowerIsCloser ? DiyFp{ 4 * v.f - 1, v.e - 2 } : DiyFp{ 2 * v.f - 1, v.e - 1 };
+
+				return{ DiyFp::Normalize(v), DiyFp::NormalizeTo(minus, plus.e), plus };
+			}
+
+			struct CachedPower
+			{
+				uint64 f;
+
+				int32 e;
+
+				int32 k;
+			};
+
+			constexpr int32 Alpha = -60;
+
+			constexpr int32 Gamma = -32;
+
+			// 10^k (k = -300, -292, ..., 324) を 64 ビットの仮数部と 2 の指数で表したもの
+			inline CachedPower GetCachedPower(int32 e)
+			{
+				static constexpr CachedPower Powers[] =
+				{
+					{ 0xAB70FE17C79AC6CA, -1060, -300 },
+					{ 0xFF77B1FCBEBCDC4F, -1034, -292 },
+					{ 0xBE5691EF416BD60C, -1007, -284 },
+					{ 0x8DD01FAD907FFC3C, -980, -276 },
+					{ 0xD3515C2831559A83, -954, -268 },
+					{ 0x9D71AC8FADA6C9B5, -927, -260 },
+					{ 0xEA9C227723EE8BCB, -901, -252 },
+					{ 0xAECC49914078536D, -874, -244 },
+					{ 0x823C12795DB6CE57, -847, -236 },
+					{ 0xC21094364DFB5637, -821, -228 },
+					{ 0x9096EA6F3848984F, -794, -220 },
+					{ 0xD77485CB25823AC7, -768, -212 },
+					{ 0xA086CFCD97BF97F4, -741, -204 },
+					{ 0xEF340A98172AACE5, -715, -196 },
+					{ 0xB23867FB2A35B28E, -688, -188 },
+					{ 0x84C8D4DFD2C63F3B, -661, -180 },
+					{ 0xC5DD44271AD3CDBA, -635, -172 },
+					{ 0x936B9FCEBB25C996, -608, -164 },
+					{ 0xDBAC6C247D62A584, -582, -156 },
+					{ 0xA3AB66580D5FDAF6, -555, -148 },
+					{ 0xF3E2F893DEC3F126, -529, -140 },
+					{ 0xB5B5ADA8AAFF80B8, -502, -132 },
+					{ 0x87625F056C7C4A8B, -475, -124 },
+					{ 0xC9BCFF6034C13053, -449, -116 },
+					{ 0x964E858C91BA2655, -422, -108 },
+					{ 0xDFF9772470297EBD, -396, -100 },
+					{ 0xA6DFBD9FB8E5B88F, -369, -92 },
+					{ 0xF8A95FCF88747D94, -343, -84 },
+					{ 0xB94470938FA89BCF, -316, -76 },
+					{ 0x8A08F0F8BF0F156B, -289, -68 },
+					{ 0xCDB02555653131B6, -263, -60 },
+					{ 0x993FE2C6D07B7FAC, -236, -52 },
+					{ 0xE45C10C42A2B3B06, -210, -44 },
+					{ 0xAA242499697392D3, -183, -36 },
+					{ 0xFD87B5F28300CA0E, -157, -28 },
+					{ 0xBCE5086492111AEB, -130, -20 },
+					{ 0x8CBCCC096F5088CC, -103, -12 },
+					{ 0xD1B71758E219652C, -77, -4 },
+					{ 0x9C40000000000000, -50, 4 },
+					{ 0xE8D4A51000000000, -24, 12 },
+					{ 0xAD78EBC5AC620000, 3, 20 },
+					{ 0x813F3978F8940984, 30, 28 },
+					{ 0xC097CE7BC90715B3, 56, 36 },
+					{ 0x8F7E32CE7BEA5C70, 83, 44 },
+					{ 0xD5D238A4ABE98068, 109, 52 },
+					{ 0x9F4F2726179A2245, 136, 60 },
+					{ 0xED63A231D4C4FB27, 162, 68 },
+					{ 0xB0DE65388CC8ADA8, 189, 76 },
+					{ 0x83C7088E1AAB65DB, 216, 84 },
+					{ 0xC45D1DF942711D9A, 242, 92 },
+					{ 0x924D692CA61BE758, 269, 100 },
+					{ 0xDA01EE641A708DEA, 295, 108 },
+					{ 0xA26DA3999AEF774A, 322, 116 },
+					{ 0xF209787BB47D6B85, 348, 124 },
+					{ 0xB454E4A179DD1877, 375, 132 },
+					{ 0x865B86925B9BC5C2, 402, 140 },
+					{ 0xC83553C5C8965D3D, 428, 148 },
+					{ 0x952AB45CFA97A0B3, 455, 156 },
+					{ 0xDE469FBD99A05FE3, 481, 164 },
+					{ 0xA59BC234DB398C25, 508, 172 },
+					{ 0xF6C69A72A3989F5C, 534, 180 },
+					{ 0xB7DCBF5354E9BECE, 561, 188 },
+					{ 0x88FCF317F22241E2, 588, 196 },
+					{ 0xCC20CE9BD35C78A5, 614, 204 },
+					{ 0x98165AF37B2153DF, 641, 212 },
+					{ 0xE2A0B5DC971F303A, 667, 220 },
+					{ 0xA8D9D1535CE3B396, 694, 228 },
+					{ 0xFB9B7CD9A4A7443C, 720, 236 },
+					{ 0xBB764C4CA7A44410, 747, 244 },
+					{ 0x8BAB8EEFB6409C1A, 774, 252 },
+					{ 0xD01FEF10A657842C, 800, 260 },
+					{ 0x9B10A4E5E9913129, 827, 268 },
+					{ 0xE7109BFBA19C0C9D, 853, 276 },
+					{ 0xAC2820D9623BF429, 880, 284 },
+					{ 0x80444B5E7AA7CF85, 907, 292 },
+					{ 0xBF21E44003ACDD2D, 933, 300 },
+					{ 0x8E679C2F5E44FF8F, 960, 308 },
+					{ 0xD433179D9C8CB841, 986, 316 },
+					{ 0x9E19DB92B4E31BA9, 1013, 324 }
+				};
+
+				const int32 f = Alpha - e - 1;
+
+				const int32 k = (f * 78913) / (1 << 18) + static_cast<int32>(f > 0);
+
+				return Powers[(300 + k + 7) / 8];
+			}
+
+			inline int32 FindLargestPow10(uint32 n, uint32& pow10)
+			{
+				static constexpr uint32 Pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+				int32 digits = 10;
+
+				while (digits > 1 && n < Pow10[digits - 1])
+				{
+					--digits;
+				}
+
+				pow10 = Pow10[digits - 1];
+
+				return digits;
+			}
+
+			inline void Round(char* buffer, int32 length, uint64 dist, uint64 delta, uint64 rest, uint64 tenK)
+			{
+				while (rest < dist && delta - rest >= tenK && (rest + tenK < dist || dist - rest > rest + tenK - dist))
+				{
+					--buffer[length - 1];
+					rest += tenK;
+				}
+			}
+
+			inline void GenerateDigits(char* buffer, int32& length, int32& decimalExponent, const DiyFp& minus, const DiyFp& w, const DiyFp& plus)
+			{
+				uint64 delta = DiyFp::Sub(plus, minus).f;
+
+				uint64 dist = DiyFp::Sub(plus, w).f;
+
+				const DiyFp one{ uint64(1) << -plus.e, plus.e };
+
+				uint32 p1 = static_cast<uint32>(plus.f >> -one.e);
+
+				uint64 p2 = plus.f & (one.f - 1);
+
+				uint32 pow10;
+
+				int32 n = FindLargestPow10(p1, pow10);
+
+				while (n > 0)
+				{
+					buffer[length++] = static_cast<char>('0' + p1 / pow10);
+
+					p1 %= pow10;
+
+					--n;
+
+					const uint64 rest = (uint64(p1) << -one.e) + p2;
+
+					if (rest <= delta)
+					{
+						decimalExponent += n;
+
+						Round(buffer, length, dist, delta, rest, uint64(pow10) << -one.e);
+
+						return;
+					}
+
+					pow10 /= 10;
+				}
+
+				int32 m = 0;
+
+				for (;;)
+				{
+					p2 *= 10;
+
+					buffer[length++] = static_cast<char>('0' + (p2 >> -one.e));
+
+					p2 &= one.f - 1;
+
+					++m;
+
+					delta *= 10;
+
+					dist *= 10;
+
+					if (p2 <= delta)
+					{
+						break;
+					}
+				}
+
+				decimalExponent -= m;
+
+				Round(buffer, length, dist, delta, p2, one.f);
+			}
+
+			// 正の有限値 value の桁列を buffer に書き、value = buffer * 10^decimalExponent となる指数を返す
+			inline void Generate(char* buffer, int32& length, int32& decimalExponent, double value)
+			{
+				const Boundaries b = ComputeBoundaries(value);
+
+				const CachedPower cached = GetCachedPower(b.plus.e);
+
+				const DiyFp c{ cached.f, cached.e };
+
+				const DiyFp w = DiyFp::Mul(b.w, c);
+
+				const DiyFp minus = DiyFp::Mul(b.minus, c);
+
+				const DiyFp plus = DiyFp::Mul(b.plus, c);
+
+				length = 0;
+
+				decimalExponent = -cached.k;
+
+				GenerateDigits(buffer, length, decimalExponent, { minus.f + 1, minus.e }, w, { plus.f - 1, plus.e });
+			}
+		}
+
+		/// <summary>
+		/// 浮動小数点数を、ヒープを確保せずに文字列に変換するバッファ
+		/// </summary>
+		class FormatFloat
+		{
+		private:
+
+			enum { BUFFER_SIZE = 384 };
+
+			wchar m_buffer[BUFFER_SIZE];
+
+			size_t m_size = 0;
+
+			void put(wchar ch)
+			{
+				m_buffer[m_size++] = ch;
+			}
+
+			bool putSpecial(double value)
+			{
+				if (std::isnan(value))
+				{
+					put(L'n'); put(L'a'); put(L'n');
+
+					return true;
+				}
+
+				if (std::signbit(value))
+				{
+					put(L'-');
+				}
+
+				if (std::isinf(value))
+				{
+					put(L'i'); put(L'n'); put(L'f');
+
+					return true;
+				}
+
+				return false;
+			}
+
+		public:
+
+			/// <summary>
+			/// 浮動小数点数の最大の小数点以下の桁数
+			/// </summary>
+			static constexpr int32 MaxDecimalPlace = 64;
+
+			/// <summary>
+			/// 値を復元できる短い桁数で変換します。
+			/// </summary>
+			/// <remarks>
+			/// Grisu2 の性質上、まれに最短より 1 桁長くなります。
+			/// 10 進の指数が [-5, 15] の範囲では小数で、それ以外では 1.5e+20 のような指数表記で出力します。
+			/// </remarks>
+			explicit FormatFloat(double value)
+			{
+				if (putSpecial(value))
+				{
+					return;
+				}
+
+				if (value == 0.0)
+				{
+					put(L'0');
+
+					return;
+				}
+
+				char digits[32];
+
+				int32 length, exponent;
+
+				Grisu2::Generate(digits, length, exponent, std::abs(value));
+
+				const int32 n = length + exponent;
+
+				if (length <= n && n <= 16)
+				{
+					for (int32 i = 0; i < length; ++i) put(digits[i]);
+					for (int32 i = length; i < n; ++i) put(L'0');
+				}
+				else if (0 < n && n <= 16)
+				{
+					for (int32 i = 0; i < n; ++i) put(digits[i]);
+					put(L'.');
+					for (int32 i = n; i < length; ++i) put(digits[i]);
+				}
+				else if (-5 < n && n <= 0)
+				{
+					put(L'0');
+					put(L'.');
+					for (int32 i = n; i < 0; ++i) put(L'0');
+					for (int32 i = 0; i < length; ++i) put(digits[i]);
+				}
+				else
+				{
+					put(digits[0]);
+
+					if (length > 1)
+					{
+						put(L'.');
+						for (int32 i = 1; i < length; ++i) put(digits[i]);
+					}
+
+					int32 e = n - 1;
+
+					put(L'e');
+					put(e < 0 ? L'-' : L'+');
+
+					e = std::abs(e);
+
+					if (e >= 100)
+					{
+						put(static_cast<wchar>(L'0' + e / 100));
+						e %= 100;
+					}
+
+					put(static_cast<wchar>(L'0' + e / 10));
+					put(static_cast<wchar>(L'0' + e % 10));
+				}
+			}
+
+			/// <summary>
+			/// 小数点以下 decimalPlace 桁に丸めて変換します。
+			/// </summary>
+			/// <remarks>
+			/// ToString(double, int32) と同じく、小数点以下の末尾の 0 は出力しません。
+			/// decimalPlace は [0, MaxDecimalPlace] の範囲に切り詰められます。
+			/// 小数点は C ロケールの設定にかかわらず '.' です。
+			/// </remarks>
+			FormatFloat(double value, int32 decimalPlace)
+			{
+				if (putSpecial(value))
+				{
+					return;
+				}
+
+				m_size = 0;
+
+				char text[BUFFER_SIZE];
+
+				const int32 length = std::snprintf(text, sizeof(text), "%.*f", Clamp(decimalPlace, 0, MaxDecimalPlace), value);
+
+				// snprintf の小数点は C ロケールに従うので、数字と符号以外の文字（1 文字以上）を '.' に置き換える
+				bool hasPoint = false;
+
+				for (int32 i = 0; i < length; ++i)
+				{
+					const char ch = text[i];
+
+					if (('0' <= ch && ch <= '9') || ch == '-')
+					{
+						put(ch);
+					}
+					else if (!hasPoint)
+					{
+						put(L'.');
+
+						hasPoint = true;
+					}
+				}
+
+				if (hasPoint)
+				{
+					while (m_buffer[m_size - 1] == L'0')
+					{
+						--m_size;
+					}
+
+					if (m_buffer[m_size - 1] == L'.')
+					{
+						--m_size;
+					}
+				}
+			}
+
+			size_t size() const { return m_size; }
+
+			const wchar* data() const { return m_buffer; }
+
+			String str() const { return String(m_buffer, m_size); }
+		};
+	}
+}
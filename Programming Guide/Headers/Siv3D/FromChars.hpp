@@ -0,0 +1,952 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cstring>
+# include <limits>
+# include <type_traits>
+# include "Fwd.hpp"
+# include "String.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// FromChars の結果
+	/// </summary>
+	struct FromCharsResult
+	{
+		/// <summary>
+		/// 読み取りを終えた位置。失敗した場合は読み取りを始めた位置
+		/// </summary>
+		const wchar* ptr;
+
+		/// <summary>
+		/// 読み取りに成功したか
+		/// </summary>
+		bool ok;
+
+		explicit operator bool() const
+		{
+			return ok;
+		}
+	};
+
+	namespace detail
+	{
+		inline bool IsSpace(wchar ch)
+		{
+			return ch == L' ' || (L'\t' <= ch && ch <= L'\r');
+		}
+
+		inline const wchar* SkipSpaces(const wchar* first, const wchar* last)
+		{
+			while (first != last && IsSpace(*first))
+			{
+				++first;
+			}
+
+			return first;
+		}
+
+		inline int32 DigitValue(wchar ch)
+		{
+			if (L'0' <= ch && ch <= L'9')
+			{
+				return ch - L'0';
+			}
+			else if (L'a' <= ch && ch <= L'z')
+			{
+				return ch - L'a' + 10;
+			}
+			else if (L'A' <= ch && ch <= L'Z')
+			{
+				return ch - L'A' + 10;
+			}
+
+			return 36;
+		}
+
+		inline bool MatchNoCase(const wchar* first, const wchar* last, const char* word)
+		{
+			for (; *word; ++first, ++word)
+			{
+				if (first == last || (*first | 0x20) != *word)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		/// <summary>
+		/// 符号なし整数の絶対値を読み取ります。radix が 0 の場合は 0x で 16 進数、0 で 8 進数、それ以外は 10 進数とみなします。
+		/// </summary>
+		inline FromCharsResult ParseMagnitude(const wchar* first, const wchar* last, uint64& magnitude, bool& overflow, int32 radix)
+		{
+			const wchar* p = first;
+
+			const bool hexPrefix = (last - p >= 3) && p[0] == L'0' && (p[1] | 0x20) == L'x' && DigitValue(p[2]) < 16;
+
+			if (radix == 0)
+			{
+				radix = hexPrefix ? 16 : (p != last && *p == L'0') ? 8 : 10;
+			}
+
+			if (radix == 16 && hexPrefix)
+			{
+				p += 2;
+			}
+
+			if (radix < 2 || 36 < radix)
+			{
+				return{ first, false };
+			}
+
+			const wchar* const digitsBegin = p;
+
+			const uint64 limit = std::numeric_limits<uint64>::max() / radix;
+
+			uint64 value = 0;
+
+			overflow = false;
+
+			for (; p != last; ++p)
+			{
+				const uint32 digit = DigitValue(*p);
+
+				if (digit >= static_cast<uint32>(radix))
+				{
+					break;
+				}
+
+				if (value > limit || value * radix > std::numeric_limits<uint64>::max() - digit)
+				{
+					overflow = true;
+				}
+
+				value = value * radix + digit;
+			}
+
+			if (p == digitsBegin)
+			{
+				return{ first, false };
+			}
+
+			magnitude = value;
+
+			return{ p, true };
+		}
+
+		/// <summary>
+		/// 桁数が多い、または指数が大きい 10 進数を正確に 2 進数に丸めるための多倍長 10 進数
+		/// </summary>
+		/// <remarks>
+		/// Go の strconv パッケージの decimal 型と同じアルゴリズムです。
+		/// </remarks>
+		class Decimal
+		{
+		private:
+
+			enum { MaxDigits = 800, MaxShift = 60 };
+
+			uint8 m_digits[MaxDigits];
+
+			int32 m_numDigits = 0;
+
+			int32 m_decimalPoint = 0;
+
+			bool m_truncated = false;
+
+			void trim()
+			{
+				while (m_numDigits > 0 && m_digits[m_numDigits - 1] == 0)
+				{
+					--m_numDigits;
+				}
+
+				if (m_numDigits == 0)
+				{
+					m_decimalPoint = 0;
+				}
+			}
+
+			void rightShift(uint32 k)
+			{
+				int32 r = 0, w = 0;
+
+				uint64 n = 0;
+
+				for (; (n >> k) == 0; ++r)
+				{
+					if (r >= m_numDigits)
+					{
+						if (n == 0)
+						{
+							m_numDigits = 0;
+
+							return;
+						}
+
+						while ((n >> k) == 0)
+						{
+							n *= 10;
+							++r;
+						}
+
+						break;
+					}
+
+					n = n * 10 + m_digits[r];
+				}
+
+				m_decimalPoint -= r - 1;
+
+				const uint64 mask = (uint64(1) << k) - 1;
+
+				for (; r < m_numDigits; ++r)
+				{
+					const uint8 digit = static_cast<uint8>(n >> k);
+
+					n &= mask;
+
+					m_digits[w++] = digit;
+
+					n = n * 10 + m_digits[r];
+				}
+
+				while (n > 0)
+				{
+					const uint8 digit = static_cast<uint8>(n >> k);
+
+					n &= mask;
+
+					if (w < MaxDigits)
+					{
+						m_digits[w++] = digit;
+					}
+					else if (digit > 0)
+					{
+						m_truncated = true;
+					}
+
+					n *= 10;
+				}
+
+				m_numDigits = w;
+
+				trim();
+			}
+
+			void leftShift(uint32 k)
+			{
+				uint8 buffer[MaxDigits + 20];
+
+				int32 w = sizeof(buffer);
+
+				uint64 n = 0;
+
+				for (int32 r = m_numDigits - 1; r >= 0; --r)
+				{
+					n += uint64(m_digits[r]) << k;
+
+					buffer[--w] = static_cast<uint8>(n % 10);
+
+					n /= 10;
+				}
+
+				while (n > 0)
+				{
+					buffer[--w] = static_cast<uint8>(n % 10);
+
+					n /= 10;
+				}
+
+				const int32 produced = static_cast<int32>(sizeof(buffer)) - w;
+
+				const int32 kept = produced < MaxDigits ? produced : MaxDigits;
+
+				std::memcpy(m_digits, buffer + w, kept);
+
+				for (int32 i = kept; i < produced; ++i)
+				{
+					if (buffer[w + i] != 0)
+					{
+						m_truncated = true;
+					}
+				}
+
+				m_decimalPoint += produced - m_numDigits;
+
+				m_numDigits = kept;
+
+				trim();
+			}
+
+			void shift(int32 k)
+			{
+				if (m_numDigits == 0)
+				{
+					return;
+				}
+
+				for (; k > MaxShift; k -= MaxShift)
+				{
+					leftShift(MaxShift);
+				}
+
+				for (; k < -MaxShift; k += MaxShift)
+				{
+					rightShift(MaxShift);
+				}
+
+				if (k > 0)
+				{
+					leftShift(k);
+				}
+				else if (k < 0)
+				{
+					rightShift(-k);
+				}
+			}
+
+			bool shouldRoundUp(int32 n) const
+			{
+				if (n < 0 || n >= m_numDigits)
+				{
+					return false;
+				}
+
+				if (m_digits[n] == 5 && n + 1 == m_numDigits)
+				{
+					// ちょうど半分のときは偶数丸め
+					return m_truncated || (n > 0 && (m_digits[n - 1] & 1));
+				}
+
+				return m_digits[n] >= 5;
+			}
+
+			uint64 roundedInteger() const
+			{
+				if (m_decimalPoint > 20)
+				{
+					return std::numeric_limits<uint64>::max();
+				}
+
+				uint64 n = 0;
+
+				int32 i = 0;
+
+				for (; i < m_decimalPoint && i < m_numDigits; ++i)
+				{
+					n = n * 10 + m_digits[i];
+				}
+
+				for (; i < m_decimalPoint; ++i)
+				{
+					n *= 10;
+				}
+
+				return shouldRoundUp(m_decimalPoint) ? n + 1 : n;
+			}
+
+		public:
+
+			/// <summary>
+			/// 仮数部の文字列 [first, last)（数字と小数点 1 つ）と 10 進の指数から作成します。
+			/// </summary>
+			Decimal(const wchar* first, const wchar* last, int32 exponent)
+			{
+				int32 count = 0;
+
+				bool sawDot = false;
+
+				for (; first != last; ++first)
+				{
+					if (*first == L'.')
+					{
+						sawDot = true;
+
+						m_decimalPoint = count;
+
+						continue;
+					}
+
+					const uint8 digit = static_cast<uint8>(*first - L'0');
+
+					if (digit == 0 && m_numDigits == 0)
+					{
+						--m_decimalPoint;
+
+						continue;
+					}
+
+					++count;
+
+					if (m_numDigits < MaxDigits)
+					{
+						m_digits[m_numDigits++] = digit;
+					}
+					else if (digit != 0)
+					{
+						m_truncated = true;
+					}
+				}
+
+				if (!sawDot)
+				{
+					m_decimalPoint = count;
+				}
+
+				m_decimalPoint += exponent;
+
+				trim();
+			}
+
+			/// <summary>
+			/// 最も近い浮動小数点数のビット表現（符号を除く）に丸めます。
+			/// </summary>
+			template <int32 MantissaBits, int32 ExponentBits>
+			uint64 toBits()
+			{
+				constexpr int32 Bias = -(1 << (ExponentBits - 1)) + 1;
+
+				constexpr int32 MaxBiasedExponent = (1 << ExponentBits) - 1;
+
+				static constexpr int32 PowTable[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+
+				constexpr int32 PowTableSize = sizeof(PowTable) / sizeof(PowTable[0]);
+
+				if (m_numDigits == 0 || m_decimalPoint < -330)
+				{
+					return 0;
+				}
+
+				if (m_decimalPoint > 310)
+				{
+					return uint64(MaxBiasedExponent) << MantissaBits;
+				}
+
+				int32 exponent = 0;
+
+				while (m_decimalPoint > 0)
+				{
+					const int32 n = m_decimalPoint >= PowTableSize ? 27 : PowTable[m_decimalPoint];
+
+					shift(-n);
+
+					exponent += n;
+				}
+
+				while (m_decimalPoint < 0 || (m_decimalPoint == 0 && m_digits[0] < 5))
+				{
+					const int32 n = -m_decimalPoint >= PowTableSize ? 27 : (m_decimalPoint == 0 ? 1 : PowTable[-m_decimalPoint]);
+
+					shift(n);
+
+					exponent -= n;
+				}
+
+				// 値は [0.5, 1) にあるので [1, 2) にそろえる
+				--exponent;
+
+				if (exponent < Bias + 1)
+				{
+					const int32 n = Bias + 1 - exponent;
+
+					shift(-n);
+
+					exponent += n;
+				}
+
+				if (exponent - Bias >= MaxBiasedExponent)
+				{
+					return uint64(MaxBiasedExponent) << MantissaBits;
+				}
+
+				shift(1 + MantissaBits);
+
+				uint64 mantissa = roundedInteger();
+
+				if (mantissa == (uint64(2) << MantissaBits))
+				{
+					mantissa >>= 1;
+
+					++exponent;
+
+					if (exponent - Bias >= MaxBiasedExponent)
+					{
+						return uint64(MaxBiasedExponent) << MantissaBits;
+					}
+				}
+
+				if ((mantissa & (uint64(1) << MantissaBits)) == 0)
+				{
+					// 非正規化数
+					exponent = Bias;
+				}
+
+				return (mantissa & ((uint64(1) << MantissaBits) - 1))
+					| (uint64((exponent - Bias) & MaxBiasedExponent) << MantissaBits);
+			}
+		};
+
+		template <class Float>
+		struct FloatTraits;
+
+		template <>
+		struct FloatTraits<double>
+		{
+			using Bits = uint64;
+
+			static constexpr int32 MantissaBits = 52;
+
+			static constexpr int32 ExponentBits = 11;
+
+			static constexpr int32 MaxExactPow10 = 22;
+
+			static double Pow10(int32 n)
+			{
+				static constexpr double table[] =
+				{
+					1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+					1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+				};
+
+				return table[n];
+			}
+		};
+
+		template <>
+		struct FloatTraits<float>
+		{
+			using Bits = uint32;
+
+			static constexpr int32 MantissaBits = 23;
+
+			static constexpr int32 ExponentBits = 8;
+
+			static constexpr int32 MaxExactPow10 = 10;
+
+			static float Pow10(int32 n)
+			{
+				static constexpr float table[] =
+				{
+					1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+				};
+
+				return table[n];
+			}
+		};
+
+		/// <summary>
+		/// 10 進数の文字列を最も近い浮動小数点数に変換します。
+		/// </summary>
+		/// <remarks>
+		/// 仮数部が 2^MantissaBits+1 以下で 10 の累乗が正確に表せる場合は浮動小数点演算 1 回で、
+		/// それ以外の場合は多倍長 10 進数で正しく丸めます。
+		/// </remarks>
+		template <class Float>
+		inline FromCharsResult ParseFloat(const wchar* first, const wchar* last, Float& value)
+		{
+			using Traits = FloatTraits<Float>;
+
+			const wchar* p = first;
+
+			bool negative = false;
+
+			if (p != last && (*p == L'-' || *p == L'+'))
+			{
+				negative = (*p == L'-');
+
+				++p;
+			}
+
+			if (p != last && ((*p | 0x20) == L'i' || (*p | 0x20) == L'n'))
+			{
+				if (MatchNoCase(p, last, "inf"))
+				{
+					p += MatchNoCase(p, last, "infinity") ? 8 : 3;
+
+					value = negative ? -std::numeric_limits<Float>::infinity() : std::numeric_limits<Float>::infinity();
+
+					return{ p, true };
+				}
+				else if (MatchNoCase(p, last, "nan"))
+				{
+					value = std::numeric_limits<Float>::quiet_NaN();
+
+					return{ p + 3, true };
+				}
+
+				return{ first, false };
+			}
+
+			const wchar* const mantissaBegin = p;
+
+			uint64 mantissa = 0;
+
+			int32 numDigits = 0, exponent = 0;
+
+			bool sawDigit = false, truncated = false;
+
+			for (; p != last && L'0' <= *p && *p <= L'9'; ++p)
+			{
+				sawDigit = true;
+
+				if (numDigits < 19)
+				{
+					mantissa = mantissa * 10 + (*p - L'0');
+
+					numDigits += (mantissa != 0);
+				}
+				else
+				{
+					truncated |= (*p != L'0');
+
+					++exponent;
+				}
+			}
+
+			if (p != last && *p == L'.')
+			{
+				++p;
+
+				for (; p != last && L'0' <= *p && *p <= L'9'; ++p)
+				{
+					sawDigit = true;
+
+					if (numDigits < 19)
+					{
+						mantissa = mantissa * 10 + (*p - L'0');
+
+						numDigits += (mantissa != 0);
+
+						--exponent;
+					}
+					else
+					{
+						truncated |= (*p != L'0');
+					}
+				}
+			}
+
+			if (!sawDigit)
+			{
+				return{ first, false };
+			}
+
+			const wchar* const mantissaEnd = p;
+
+			int32 explicitExponent = 0;
+
+			if (p != last && (*p | 0x20) == L'e')
+			{
+				const wchar* q = p + 1;
+
+				bool negativeExponent = false;
+
+				if (q != last && (*q == L'-' || *q == L'+'))
+				{
+					negativeExponent = (*q == L'-');
+
+					++q;
+				}
+
+				if (q != last && L'0' <= *q && *q <= L'9')
+				{
+					for (; q != last && L'0' <= *q && *q <= L'9'; ++q)
+					{
+						if (explicitExponent < 100000)
+						{
+							explicitExponent = explicitExponent * 10 + (*q - L'0');
+						}
+					}
+
+					if (negativeExponent)
+					{
+						explicitExponent = -explicitExponent;
+					}
+
+					p = q;
+				}
+			}
+
+			exponent += explicitExponent;
+
+			Float result;
+
+			if (mantissa == 0)
+			{
+				result = Float(0);
+			}
+			else if (!truncated && (mantissa >> (Traits::MantissaBits + 1)) == 0
+				&& -Traits::MaxExactPow10 <= exponent && exponent <= Traits::MaxExactPow10)
+			{
+				// 仮数部も 10 の累乗も正確に表せるので、1 回の丸めで正しい結果になる
+				result = (exponent < 0) ? static_cast<Float>(mantissa) / Traits::Pow10(-exponent)
+					: static_cast<Float>(mantissa) * Traits::Pow10(exponent);
+			}
+			else
+			{
+				const typename Traits::Bits bits = static_cast<typename Traits::Bits>(
+					Decimal(mantissaBegin, mantissaEnd, explicitExponent).template toBits<Traits::MantissaBits, Traits::ExponentBits>());
+
+				std::memcpy(&result, &bits, sizeof(result));
+			}
+
+			value = negative ? -result : result;
+
+			return{ p, true };
+		}
+	}
+
+	/// <summary>
+	/// 文字列の先頭から整数を読み取ります。
+	/// </summary>
+	/// <param name="first">
+	/// 文字列の先頭
+	/// </param>
+	/// <param name="last">
+	/// 文字列の終端
+	/// </param>
+	/// <param name="value">
+	/// 読み取った値の格納先。失敗した場合は変更されません。
+	/// </param>
+	/// <param name="radix">
+	/// 使用する基数、0 の場合は自動
+	/// </param>
+	/// <remarks>
+	/// 先頭の空白は読み飛ばしません。符号 + と -、radix が 16 または 0 のときの 0x 接頭辞を受け付けます。
+	/// 値が Type の範囲を超える場合は失敗します。ロケールには依存しません。
+	/// </remarks>
+	/// <returns>
+	/// 読み取りを終えた位置と成否
+	/// </returns>
+	template <class Type, std::enable_if_t<std::is_integral<Type>::value && !std::is_same<Type, bool>::value>* = nullptr>
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Type& value, int32 radix = 10)
+	{
+		const wchar* p = first;
+
+		bool negative = false;
+
+		if (p != last && (*p == L'-' || *p == L'+'))
+		{
+			negative = (*p == L'-');
+
+			++p;
+		}
+
+		if (negative && std::is_unsigned<Type>::value)
+		{
+			return{ first, false };
+		}
+
+		uint64 magnitude = 0;
+
+		bool overflow = false;
+
+		const FromCharsResult result = detail::ParseMagnitude(p, last, magnitude, overflow, radix);
+
+		if (!result)
+		{
+			return{ first, false };
+		}
+
+		const uint64 maxMagnitude = negative ? uint64(0) - static_cast<uint64>(std::numeric_limits<Type>::min())
+			: static_cast<uint64>(std::numeric_limits<Type>::max());
+
+		if (overflow || magnitude > maxMagnitude)
+		{
+			return{ result.ptr, false };
+		}
+
+		value = static_cast<Type>(negative ? uint64(0) - magnitude : magnitude);
+
+		return result;
+	}
+
+	/// <summary>
+	/// 文字列の先頭から浮動小数点数を読み取ります。
+	/// </summary>
+	/// <param name="first">
+	/// 文字列の先頭
+	/// </param>
+	/// <param name="last">
+	/// 文字列の終端
+	/// </param>
+	/// <param name="value">
+	/// 読み取った値の格納先。失敗した場合は変更されません。
+	/// </param>
+	/// <remarks>
+	/// 1.5, -.5, 2e-3, inf, nan の形式を受け付け、最も近い値に正しく丸めます。
+	/// 先頭の空白は読み飛ばしません。ロケールには依存せず、小数点は常に . です。
+	/// 範囲を超える値は無限大になります。
+	/// </remarks>
+	/// <returns>
+	/// 読み取りを終えた位置と成否
+	/// </returns>
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, double& value)
+	{
+		return detail::ParseFloat(first, last, value);
+	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, float& value)
+	{
+		return detail::ParseFloat(first, last, value);
+	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, long double& value)
+	{
+		double result;
+
+		const FromCharsResult r = detail::ParseFloat(first, last, result);
+
+		if (r)
+		{
+			value = result;
+		}
+
+		return r;
+	}
+
+	/// <summary>
+	/// 文字列から値を読み取ります。
+	/// </summary>
+	/// <param name="str">
+	/// 文字列
+	/// </param>
+	/// <param name="value">
+	/// 読み取った値の格納先。失敗した場合は変更されません。
+	/// </param>
+	/// <returns>
+	/// 読み取りを終えた位置と成否
+	/// </returns>
+	template <class Type>
+	inline FromCharsResult FromChars(StringView str, Type& value)
+	{
+		return FromChars(str.data(), str.data() + str.length(), value);
+	}
+
+	namespace detail
+	{
+		/// <summary>
+		/// 括弧とカンマで区切られたテキストから値を順に読み取るクラス
+		/// </summary>
+		/// <remarks>
+		/// std::wistream と同じように >> で値を読み取ります。各値の前の空白は読み飛ばします。
+		/// 一度失敗すると、それ以降の読み取りはすべて失敗します。
+		/// </remarks>
+		class TextScanner
+		{
+		private:
+
+			const wchar* m_first;
+
+			const wchar* m_ptr;
+
+			const wchar* m_last;
+
+			bool m_ok = true;
+
+		public:
+
+			TextScanner(const wchar* first, const wchar* last)
+				: m_first(first)
+				, m_ptr(first)
+				, m_last(last) {}
+
+			/// <summary>
+			/// 空白を読み飛ばした後の 1 文字を読み取ります。
+			/// </summary>
+			TextScanner& operator >>(wchar& ch)
+			{
+				if (m_ok)
+				{
+					m_ptr = SkipSpaces(m_ptr, m_last);
+
+					if (m_ptr == m_last)
+					{
+						m_ok = false;
+					}
+					else
+					{
+						ch = *m_ptr++;
+					}
+				}
+
+				return *this;
+			}
+
+			/// <summary>
+			/// 空白を読み飛ばした後の値を FromChars で読み取ります。
+			/// </summary>
+			template <class Type>
+			TextScanner& operator >>(Type& value)
+			{
+				if (m_ok)
+				{
+					const FromCharsResult result = FromChars(SkipSpaces(m_ptr, m_last), m_last, value);
+
+					m_ptr = result.ptr;
+
+					m_ok = result.ok;
+				}
+
+				return *this;
+			}
+
+			explicit operator bool() const
+			{
+				return m_ok;
+			}
+
+			FromCharsResult result() const
+			{
+				return{ m_ok ? m_ptr : m_first, m_ok };
+			}
+		};
+
+		inline void ScanTupleTail(TextScanner&)
+		{
+			return;
+		}
+
+		template <class Type, class ... Args>
+		inline void ScanTupleTail(TextScanner& scanner, Type& value, Args& ... args)
+		{
+			wchar unused;
+
+			scanner >> value >> unused;
+
+			ScanTupleTail(scanner, args...);
+		}
+
+		/// <summary>
+		/// (a,b,c) の形式のテキストから値を順に読み取ります。
+		/// </summary>
+		/// <remarks>
+		/// operator >> と同じく、括弧と区切りは任意の 1 文字として読み飛ばします。
+		/// </remarks>
+		template <class ... Args>
+		inline FromCharsResult ScanTuple(const wchar* first, const wchar* last, Args& ... args)
+		{
+			TextScanner scanner(first, last);
+
+			wchar unused;
+
+			scanner >> unused;
+
+			ScanTupleTail(scanner, args...);
+
+			return scanner.result();
+		}
+	}
+}
@@ -31,6 +31,12 @@ namespace s3d
 	//
 	template <class Type> class Grid;
 
+	//////////////////////////////////////////////////////
+	//
+	//	ArrayView.hpp
+	//
+	template <class Type> class ArrayView;
+
 	//////////////////////////////////////////////////////
 	//
 	//	String.hpp
@@ -44,6 +50,14 @@ namespace s3d
 	//	StringView.hpp
 	//
 	class StringView;
+	class StringSplitRange;
+	class StringTokenRange;
+
+	//////////////////////////////////////////////////////
+	//
+	//	Regex.hpp
+	//
+	class RegexObject;
 
 	//////////////////////////////////////////////////////
 	//
@@ -85,6 +99,12 @@ namespace s3d
 	class MicrosecClock;
 	class RDTSCClock;
 
+	//////////////////////////////////////////////////////
+	//
+	//	ThreadPool.hpp
+	//
+	class ThreadPool;
+
 	//////////////////////////////////////////////////////
 	//
 	//	FileSystem.hpp
@@ -124,6 +144,30 @@ namespace s3d
 	//
 	class BinaryReader;
 
+	//////////////////////////////////////////////////////
+	//
+	//	BufferedReader.hpp
+	//
+	template <class Reader> class BufferedReader;
+
+	//////////////////////////////////////////////////////
+	//
+	//	Decompressor.hpp
+	//
+	template <class Reader> class Decompressor;
+
+	//////////////////////////////////////////////////////
+	//
+	//	MemoryMappedFile.hpp
+	//
+	class MemoryMappedFile;
+
+	//////////////////////////////////////////////////////
+	//
+	//	MappedFileReader.hpp
+	//
+	class MappedFileReader;
+
 	//////////////////////////////////////////////////////
 	//
 	//	IWriter.hpp
@@ -142,6 +186,18 @@ namespace s3d
 	//
 	class BinaryWriter;
 
+	//////////////////////////////////////////////////////
+	//
+	//	BufferedWriter.hpp
+	//
+	template <class Writer> class BufferedWriter;
+
+	//////////////////////////////////////////////////////
+	//
+	//	Compressor.hpp
+	//
+	template <class Writer> class Compressor;
+
 	//////////////////////////////////////////////////////
 	//
 	//	TextReader.hpp
@@ -154,6 +210,12 @@ namespace s3d
 	//
 	class TextWriter;
 
+	//////////////////////////////////////////////////////
+	//
+	//	UTF8Writer.hpp
+	//
+	class UTF8Writer;
+
 	//////////////////////////////////////////////////////
 	//
 	//	MD5.hpp
@@ -186,12 +248,25 @@ namespace s3d
 	//
 	class FileArchive;
 
+	//////////////////////////////////////////////////////
+	//
+	//	IndexedFileArchive.hpp
+	//
+	enum class ArchiveCodec : uint8;
+	class IndexedFileArchive;
+
 	//////////////////////////////////////////////////////
 	//
 	//	CSVReader.hpp
 	//
 	class CSVReader;
 
+	//////////////////////////////////////////////////////
+	//
+	//	MappedCSVReader.hpp
+	//
+	class MappedCSVReader;
+
 	//////////////////////////////////////////////////////
 	//
 	//	CSVWriter.hpp
@@ -229,12 +304,45 @@ namespace s3d
 	//
 	class JSONReader;
 
+	//////////////////////////////////////////////////////
+	//
+	//	JSONPullParser.hpp
+	//
+	enum class JSONEvent;
+	class JSONPullParser;
+
+	//////////////////////////////////////////////////////
+	//
+	//	JSONDocument.hpp
+	//
+	class JSONElement;
+	class JSONDocument;
+
+	//////////////////////////////////////////////////////
+	//
+	//	CompactJSON.hpp
+	//
+	class CompactJSONValue;
+	class CompactJSONDocument;
+
+	//////////////////////////////////////////////////////
+	//
+	//	JSONWriter.hpp
+	//
+	class JSONWriter;
+
 	//////////////////////////////////////////////////////
 	//
 	//	ZIPReader.hpp
 	//
 	class ZIPReader;
 
+	//////////////////////////////////////////////////////
+	//
+	//	Compression.hpp
+	//
+	enum class CompressionCodec : uint8;
+
 	//////////////////////////////////////////////////////
 	//
 	//	ZIPWriter.hpp
@@ -447,12 +555,57 @@ namespace s3d
 	enum class Interpolation;
 	enum class ImageAddressMode;
 	enum class AdaptiveMethod;
+	enum class BlurMethod;
 	enum class Interpolation;
 	enum class FloodFillConnectivity;
 	enum class CascadeType;
 	class Image;
 	class ImageRegion;
 
+	//////////////////////////////////////////////////////
+	//
+	//	ImageView.hpp
+	//
+	class ImageView;
+
+	//////////////////////////////////////////////////////
+	//
+	//	SharedImage.hpp
+	//
+	class SharedImage;
+
+	//////////////////////////////////////////////////////
+	//
+	//	ParallelImaging.hpp
+	//
+	class ImageTileScheduler;
+
+	//////////////////////////////////////////////////////
+	//
+	//	ImagePipeline.hpp
+	//
+	class ImagePipeline;
+
+	//////////////////////////////////////////////////////
+	//
+	//	ImageStream.hpp
+	//
+	class ImageStreamReader;
+	class ImageStreamWriter;
+
+	//////////////////////////////////////////////////////
+	//
+	//	MipChain.hpp
+	//
+	struct MipChain;
+
+	//////////////////////////////////////////////////////
+	//
+	//	ComponentLabeler.hpp
+	//
+	struct ImageComponent;
+	class ComponentLabeler;
+
 	//////////////////////////////////////////////////////
 	//
 	//	TextureFormat.hpp
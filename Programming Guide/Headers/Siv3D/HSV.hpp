@@ -183,6 +183,12 @@ namespace s3d
 			<< hsv.v << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const HSV& hsv)
+	{
+		FormatTuple(formatData, hsv.h, hsv.s, hsv.v);
+	}
+
 	/// <summary>
 	/// 入力ストリームに色を渡します。
 	/// </summary>
@@ -206,6 +212,20 @@ namespace s3d
 			>> hsv.v >> unused;
 	}
 
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, HSV& hsv)
+	{
+		HSV result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.h, result.s, result.v);
+
+		if (r)
+		{
+			hsv = result;
+		}
+
+		return r;
+	}
+
 	/// <summary>
 	/// HSV の値を加算します。
 	/// </summary>
@@ -214,6 +214,23 @@ namespace s3d
 		Gaussian,
 	};
 
+	/// <summary>
+	/// ぼかしの計算方法
+	/// </summary>
+	enum class BlurMethod
+	{
+		/// <summary>
+		/// 指定した大きさのカーネルで正確に計算
+		/// </summary>
+		Exact,
+
+		/// <summary>
+		/// カーネルの大きさによらず 1 ピクセルあたり一定の計算量
+		/// （ボックスフィルタは累積和、ガウスフィルタは 3 回のボックスフィルタによる近似）
+		/// </summary>
+		ConstantTime,
+	};
+
 	/// <summary>
 	/// 画像拡大縮小の手法
 	/// </summary>
@@ -2017,6 +2034,19 @@ namespace s3d
 
 	public:
 
+		/// <summary>
+		/// 参照している画像を返します。
+		/// </summary>
+		const Image& image() const { return m_imageRef; }
+
+		/// <summary>
+		/// 参照している領域を返します。
+		/// </summary>
+		/// <remarks>
+		/// 画像の範囲外を含む場合があります。ImageView に変換すると画像の範囲に切り詰められます。
+		/// </remarks>
+		const Rect& rect() const { return m_rect; }
+
 		void write(Image& image, const Point& pos = { 0, 0 }, const Color& color = Palette::White) const;
 
 		void overwrite(Image& image, const Point& pos = { 0, 0 }, const Color& color = Palette::White) const;
@@ -0,0 +1,594 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cassert>
+# include <deque>
+# include <exception>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "String.hpp"
+# include "Optional.hpp"
+# include "ByteArray.hpp"
+# include "CharacterSet.hpp"
+# include "FileSystem.hpp"
+# include "Image.hpp"
+# include "ThreadPool.hpp"
+
+namespace s3d
+{
+	namespace Threading
+	{
+		/// <summary>
+		/// バッチ処理の結果を受け取る順序
+		/// </summary>
+		enum class BatchOrder
+		{
+			/// <summary>
+			/// 追加した順
+			/// </summary>
+			InOrder,
+
+			/// <summary>
+			/// 処理が完了した順
+			/// </summary>
+			AsCompleted,
+		};
+
+		/// <summary>
+		/// バッチ処理の設定
+		/// </summary>
+		struct BatchOptions
+		{
+			/// <summary>
+			/// 同時に処理中、または受け取り待ちにできる最大の件数
+			/// </summary>
+			/// <remarks>
+			/// 上限に達すると、結果が受け取られるまで新しい処理を開始しません。
+			/// </remarks>
+			size_t maxInFlight = 16;
+
+			/// <summary>
+			/// 結果を受け取る順序
+			/// </summary>
+			BatchOrder order = BatchOrder::InOrder;
+		};
+
+		/// <summary>
+		/// 処理件数に上限のあるバッチ処理キュー
+		/// </summary>
+		/// <remarks>
+		/// ジョブは共有のスレッドプールで実行されます。
+		/// 結果を待っている間、呼び出し側のスレッドもプールのタスクを実行します。
+		/// </remarks>
+		template <class Result>
+		class BatchQueue : private Uncopyable
+		{
+		private:
+
+			struct Slot
+			{
+				Optional<Result> result;
+
+				// ジョブが投げた例外。take() で呼び出し側に再送出する
+				std::exception_ptr exception;
+
+				bool isReady() const
+				{
+					return result.has_value() || static_cast<bool>(exception);
+				}
+			};
+
+			// ジョブと共有する同期オブジェクト。
+			// ジョブは this を参照しないので、結果を書き込んだ直後にキューが破棄されても安全
+			struct State
+			{
+				std::mutex mutex;
+
+				std::condition_variable completed;
+			};
+
+			std::shared_ptr<ThreadPool> m_pool;
+
+			BatchOptions m_options;
+
+			// 追加順に並んだ、処理中または受け取り待ちのジョブ
+			std::deque<std::shared_ptr<Slot>> m_slots;
+
+			std::shared_ptr<State> m_state = std::make_shared<State>();
+
+			typename std::deque<std::shared_ptr<Slot>>::iterator findReady()
+			{
+				std::lock_guard<std::mutex> lock(m_state->mutex);
+
+				if (m_options.order == BatchOrder::InOrder)
+				{
+					return (!m_slots.empty() && m_slots.front()->isReady()) ? m_slots.begin() : m_slots.end();
+				}
+
+				return std::find_if(m_slots.begin(), m_slots.end(), [](const std::shared_ptr<Slot>& slot) { return slot->isReady(); });
+			}
+
+		public:
+
+			explicit BatchQueue(const BatchOptions& options = BatchOptions(), std::shared_ptr<ThreadPool> pool = GetPool())
+				: m_pool(std::move(pool))
+				, m_options(options)
+			{
+				m_options.maxInFlight = std::max<size_t>(m_options.maxInFlight, 1);
+			}
+
+			~BatchQueue()
+			{
+				while (!m_slots.empty())
+				{
+					try
+					{
+						take();
+					}
+					catch (...)
+					{
+						// 受け取られなかったジョブの例外は捨てる
+					}
+				}
+			}
+
+			/// <summary>
+			/// 処理中または受け取り待ちのジョブの数を返します。
+			/// </summary>
+			size_t inFlight() const
+			{
+				return m_slots.size();
+			}
+
+			/// <summary>
+			/// 新しいジョブを追加できるかを返します。
+			/// </summary>
+			bool canPush() const
+			{
+				return m_slots.size() < m_options.maxInFlight;
+			}
+
+			/// <summary>
+			/// ジョブを追加します。
+			/// </summary>
+			/// <remarks>
+			/// canPush() が false の場合は、先に take() で結果を受け取る必要があります。
+			/// </remarks>
+			void push(std::function<Result()> job)
+			{
+				assert(canPush());
+
+				auto slot = std::make_shared<Slot>();
+
+				m_slots.push_back(slot);
+
+				m_pool->submit([state = m_state, slot, job = std::move(job)]()
+				{
+					Optional<Result> result;
+
+					std::exception_ptr exception;
+
+					try
+					{
+						result = job();
+					}
+					catch (...)
+					{
+						exception = std::current_exception();
+					}
+
+					std::lock_guard<std::mutex> lock(state->mutex);
+
+					slot->result = std::move(result);
+
+					slot->exception = exception;
+
+					state->completed.notify_all();
+				});
+			}
+
+			/// <summary>
+			/// 結果を 1 件受け取ります。
+			/// </summary>
+			/// <remarks>
+			/// ジョブが例外を投げた場合は、その例外をここで再送出します。
+			/// </remarks>
+			/// <returns>
+			/// 結果。処理中のジョブが無い場合は none
+			/// </returns>
+			Optional<Result> take()
+			{
+				if (m_slots.empty())
+				{
+					return none;
+				}
+
+				for (;;)
+				{
+					const auto it = findReady();
+
+					if (it != m_slots.end())
+					{
+						const std::shared_ptr<Slot> slot = *it;
+
+						m_slots.erase(it);
+
+						if (slot->exception)
+						{
+							std::rethrow_exception(slot->exception);
+						}
+
+						return std::move(slot->result);
+					}
+
+					if (!m_pool->runPendingTask())
+					{
+						std::unique_lock<std::mutex> lock(m_state->mutex);
+
+						m_state->completed.wait_for(lock, std::chrono::milliseconds(1));
+					}
+				}
+			}
+		};
+
+		/// <summary>
+		/// 画像の読み込み結果
+		/// </summary>
+		struct ImageLoadResult
+		{
+			/// <summary>
+			/// 入力のリストでのインデックス
+			/// </summary>
+			size_t index = 0;
+
+			FilePath path;
+
+			Image image;
+
+			/// <summary>
+			/// 失敗した場合の理由。成功した場合は空
+			/// </summary>
+			String error;
+
+			explicit operator bool() const { return error.isEmpty; }
+		};
+
+		/// <summary>
+		/// 画像の書き出し結果
+		/// </summary>
+		struct ImageEncodeResult
+		{
+			/// <summary>
+			/// ImageBatchEncoder に追加した順番
+			/// </summary>
+			size_t index = 0;
+
+			/// <summary>
+			/// 保存先のパス。メモリ上にエンコードした場合は空
+			/// </summary>
+			FilePath path;
+
+			/// <summary>
+			/// エンコードしたデータ。ファイルに保存した場合は空
+			/// </summary>
+			ByteArray data;
+
+			/// <summary>
+			/// 失敗した場合の理由。成功した場合は空
+			/// </summary>
+			String error;
+
+			explicit operator bool() const { return error.isEmpty; }
+		};
+
+		/// <summary>
+		/// 複数の画像ファイルを並列に読み込むクラス
+		/// </summary>
+		/// <remarks>
+		/// LoadImages() と異なり、すべての画像を同時にメモリに保持しません。
+		/// next() で受け取られていない画像は最大 BatchOptions::maxInFlight 枚です。
+		/// </remarks>
+		class ImageBatchLoader
+		{
+		private:
+
+			Array<FilePath> m_paths;
+
+			size_t m_next = 0;
+
+			BatchQueue<ImageLoadResult> m_queue;
+
+			void fill()
+			{
+				while (m_next < m_paths.size() && m_queue.canPush())
+				{
+					const size_t index = m_next++;
+
+					const FilePath path = m_paths[index];
+
+					m_queue.push([index, path]()
+					{
+						ImageLoadResult result;
+
+						result.index = index;
+
+						result.path = path;
+
+						try
+						{
+							result.image = Image(path);
+
+							if (result.image.isEmpty)
+							{
+								result.error = FileSystem::Exists(path) ? L"failed to decode the image" : L"file not found";
+							}
+						}
+						catch (const std::exception& e)
+						{
+							result.error = CharacterSet::Widen(e.what());
+						}
+						catch (...)
+						{
+							result.error = L"unknown exception";
+						}
+
+						return result;
+					});
+				}
+			}
+
+		public:
+
+			/// <summary>
+			/// 画像ファイルの読み込みを開始します。
+			/// </summary>
+			/// <param name="paths">
+			/// 画像ファイルのパス
+			/// </param>
+			/// <param name="options">
+			/// バッチ処理の設定
+			/// </param>
+			explicit ImageBatchLoader(const Array<FilePath>& paths, const BatchOptions& options = BatchOptions())
+				: m_paths(paths)
+				, m_queue(options)
+			{
+				fill();
+			}
+
+			/// <summary>
+			/// 次の読み込み結果を受け取ります。
+			/// </summary>
+			/// <returns>
+			/// 読み込み結果。すべての結果を受け取った場合は none
+			/// </returns>
+			Optional<ImageLoadResult> next()
+			{
+				Optional<ImageLoadResult> result = m_queue.take();
+
+				fill();
+
+				return result;
+			}
+
+			/// <summary>
+			/// すべての読み込み結果を順にコールバックに渡します。
+			/// </summary>
+			/// <param name="callback">
+			/// 結果を受け取る関数。呼び出し側のスレッドで呼ばれます。
+			/// </param>
+			/// <returns>
+			/// すべての読み込みに成功した場合 true, それ以外の場合は false
+			/// </returns>
+			bool forEach(const std::function<void(ImageLoadResult&)>& callback)
+			{
+				bool succeeded = true;
+
+				while (auto result = next())
+				{
+					succeeded &= static_cast<bool>(*result);
+
+					callback(*result);
+				}
+
+				return succeeded;
+			}
+		};
+
+		/// <summary>
+		/// 複数の画像を並列にエンコード・保存するクラス
+		/// </summary>
+		/// <remarks>
+		/// 処理中の件数が BatchOptions::maxInFlight に達すると、追加の関数は空きができるまで待機します。
+		/// 完了した結果は、追加の関数または finish() の中で、呼び出し側のスレッドからコールバックに渡されます。
+		/// </remarks>
+		class ImageBatchEncoder
+		{
+		private:
+
+			std::function<void(ImageEncodeResult&)> m_callback;
+
+			BatchQueue<ImageEncodeResult> m_queue;
+
+			size_t m_next = 0;
+
+			bool m_succeeded = true;
+
+			void deliver(ImageEncodeResult& result)
+			{
+				m_succeeded &= static_cast<bool>(result);
+
+				if (m_callback)
+				{
+					m_callback(result);
+				}
+			}
+
+			void push(std::function<void(ImageEncodeResult&)> job)
+			{
+				while (!m_queue.canPush())
+				{
+					deliver(*m_queue.take());
+				}
+
+				const size_t index = m_next++;
+
+				m_queue.push([index, job = std::move(job)]()
+				{
+					ImageEncodeResult result;
+
+					result.index = index;
+
+					try
+					{
+						job(result);
+					}
+					catch (const std::exception& e)
+					{
+						result.error = CharacterSet::Widen(e.what());
+					}
+					catch (...)
+					{
+						result.error = L"unknown exception";
+					}
+
+					return result;
+				});
+			}
+
+		public:
+
+			/// <summary>
+			/// エンコーダを作成します。
+			/// </summary>
+			/// <param name="callback">
+			/// 結果を受け取る関数
+			/// </param>
+			/// <param name="options">
+			/// バッチ処理の設定
+			/// </param>
+			explicit ImageBatchEncoder(std::function<void(ImageEncodeResult&)> callback = nullptr, const BatchOptions& options = BatchOptions())
+				: m_callback(std::move(callback))
+				, m_queue(options) {}
+
+			/// <summary>
+			/// デストラクタ
+			/// </summary>
+			/// <remarks>
+			/// 残っているすべての処理の完了を待ち、結果をコールバックに渡します。
+			/// ジョブやコールバックが投げた例外は捨てられるので、エラーを受け取るには先に finish() を呼んでください。
+			/// </remarks>
+			~ImageBatchEncoder()
+			{
+				for (;;)
+				{
+					try
+					{
+						finish();
+
+						break;
+					}
+					catch (...)
+					{
+						// 例外を投げた結果はキューから取り除かれているので、残りの処理を続ける
+					}
+				}
+			}
+
+			/// <summary>
+			/// 任意の関数で画像をエンコードします。
+			/// </summary>
+			/// <param name="image">
+			/// エンコードする画像
+			/// </param>
+			/// <param name="encoder">
+			/// エンコードする関数
+			/// </param>
+			/// <returns>
+			/// なし
+			/// </returns>
+			void encode(Image image, std::function<ByteArray(const Image&)> encoder)
+			{
+				auto shared = std::make_shared<Image>(std::move(image));
+
+				push([shared, encoder = std::move(encoder)](ImageEncodeResult& result)
+				{
+					result.data = encoder(*shared);
+
+					if (!result.data)
+					{
+						result.error = L"failed to encode the image";
+					}
+				});
+			}
+
+			void encodePNG(Image image, PNGFilter::Flag filterFlag = PNGFilter::Default)
+			{
+				encode(std::move(image), [=](const Image& img) { return img.encodePNG(filterFlag); });
+			}
+
+			void encodeJPEG(Image image, int32 quality = 90)
+			{
+				encode(std::move(image), [=](const Image& img) { return img.encodeJPEG(quality); });
+			}
+
+			void encodeWebP(Image image, double quality = 95.0, WebPMethod method = WebPMethod::Default)
+			{
+				encode(std::move(image), [=](const Image& img) { return img.encodeWebP(quality, method); });
+			}
+
+			/// <summary>
+			/// 画像をファイルに保存します。
+			/// </summary>
+			/// <param name="image">
+			/// 保存する画像
+			/// </param>
+			/// <param name="path">
+			/// 保存するファイル名
+			/// </param>
+			/// <param name="format">
+			/// 保存する際の画像フォーマット。ImageFormat::Unspecified の場合、拡張子から自動で判断します。
+			/// </param>
+			/// <returns>
+			/// なし
+			/// </returns>
+			void save(Image image, const FilePath& path, ImageFormat format = ImageFormat::Unspecified)
+			{
+				auto shared = std::make_shared<Image>(std::move(image));
+
+				push([shared, path, format](ImageEncodeResult& result)
+				{
+					result.path = path;
+
+					if (!shared->save(path, format))
+					{
+						result.error = L"failed to save the image";
+					}
+				});
+			}
+
+			/// <summary>
+			/// 追加したすべての処理の完了を待ち、結果をコールバックに渡します。
+			/// </summary>
+			/// <returns>
+			/// これまでのすべての処理に成功した場合 true, それ以外の場合は false
+			/// </returns>
+			bool finish()
+			{
+				while (auto result = m_queue.take())
+				{
+					deliver(*result);
+				}
+
+				return m_succeeded;
+			}
+		};
+	}
+}
@@ -0,0 +1,1137 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <algorithm>
+# include <cmath>
+# include <cstring>
+# include <immintrin.h>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "Color.hpp"
+# include "Image.hpp"
+# include "ImageKernels.hpp"
+# include "ImageView.hpp"
+# include "MathConstants.hpp"
+# include "LineString.hpp"
+# include "Polygon.hpp"
+# include "MultiPolygon.hpp"
+# include "Shape.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// CPU による画像の合成
+	/// </summary>
+	/// <remarks>
+	/// Image::write() や Polygon::write() などと同じ合成を、SIMD によるブレンドと
+	/// スパン単位の塗りつぶしで行います。クリッピングは図形ごとに 1 回だけ行います。
+	/// 通常のブレンドは BlendColor() とビット単位で一致し、書き込み先のアルファ値を保持します。
+	/// </remarks>
+	namespace ImageCompositor
+	{
+		/// <summary>
+		/// 基準となるスカラー実装
+		/// </summary>
+		namespace Scalar
+		{
+			inline uint32 Div255(uint32 x)
+			{
+				return (x + 1 + (x >> 8)) >> 8;
+			}
+
+			inline void Blend(const Color* src, Color* dst, size_t num)
+			{
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Color s = src[i], d = dst[i];
+
+					const uint32 a = s.a, ia = 255 - a;
+
+					dst[i] = Color(Div255(s.r * a + d.r * ia), Div255(s.g * a + d.g * ia), Div255(s.b * a + d.b * ia), d.a);
+				}
+			}
+
+			inline void BlendPremultiplied(const Color* src, Color* dst, size_t num)
+			{
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Color s = src[i], d = dst[i];
+
+					const uint32 ia = 255 - s.a;
+
+					dst[i] = Color(std::min(s.r + Div255(d.r * ia), 255u), std::min(s.g + Div255(d.g * ia), 255u),
+						std::min(s.b + Div255(d.b * ia), 255u), std::min(s.a + Div255(d.a * ia), 255u));
+				}
+			}
+
+			inline void BlendSolid(Color* dst, size_t num, const Color& color)
+			{
+				const uint32 a = color.a, ia = 255 - a;
+
+				const uint32 r = color.r * a, g = color.g * a, b = color.b * a;
+
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Color d = dst[i];
+
+					dst[i] = Color(Div255(r + d.r * ia), Div255(g + d.g * ia), Div255(b + d.b * ia), d.a);
+				}
+			}
+
+			inline void Multiply(const Color* src, Color* dst, size_t num, const Color& color)
+			{
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Color s = src[i];
+
+					dst[i] = Color(Div255(s.r * color.r), Div255(s.g * color.g), Div255(s.b * color.b), Div255(s.a * color.a));
+				}
+			}
+
+			inline void Premultiply(const Color* src, Color* dst, size_t num)
+			{
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Color s = src[i];
+
+					dst[i] = Color(Div255(s.r * s.a), Div255(s.g * s.a), Div255(s.b * s.a), s.a);
+				}
+			}
+		}
+
+		/// <summary>
+		/// SSE2 による実装（1 命令で 4 ピクセル）
+		/// </summary>
+		/// <remarks>
+		/// 各チャンネルを 16 ビットに展開し、s * a + d * (255 - a) (最大 65025) を 16 ビットのまま計算します。
+		/// </remarks>
+		namespace SSE2
+		{
+			namespace detail
+			{
+				inline __m128i Div255(__m128i x)
+				{
+					return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+				}
+
+				// 16 ビットに展開した 2 ピクセルの各アルファを 4 チャンネルに複製する
+				inline __m128i SplatAlpha(__m128i v)
+				{
+					return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				}
+
+				inline __m128i Lerp(__m128i s, __m128i d, __m128i a)
+				{
+					const __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+
+					return Div255(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, ia)));
+				}
+
+				inline __m128i KeepAlpha(__m128i rgb, __m128i d)
+				{
+					const __m128i mask = _mm_set1_epi32(0xFF000000);
+
+					return _mm_or_si128(_mm_andnot_si128(mask, rgb), _mm_and_si128(mask, d));
+				}
+
+				inline __m128i Splat(const Color& color)
+				{
+					uint32 value;
+
+					std::memcpy(&value, &color, sizeof(value));
+
+					return _mm_set1_epi32(static_cast<int32>(value));
+				}
+			}
+
+			inline void Blend(const Color* src, Color* dst, size_t num)
+			{
+				const __m128i zero = _mm_setzero_si128();
+
+				size_t i = 0;
+
+				for (; i + 4 <= num; i += 4)
+				{
+					const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+					const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+					const __m128i slo = _mm_unpacklo_epi8(s, zero), shi = _mm_unpackhi_epi8(s, zero);
+					const __m128i lo = detail::Lerp(slo, _mm_unpacklo_epi8(d, zero), detail::SplatAlpha(slo));
+					const __m128i hi = detail::Lerp(shi, _mm_unpackhi_epi8(d, zero), detail::SplatAlpha(shi));
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), detail::KeepAlpha(_mm_packus_epi16(lo, hi), d));
+				}
+
+				Scalar::Blend(src + i, dst + i, num - i);
+			}
+
+			inline void BlendPremultiplied(const Color* src, Color* dst, size_t num)
+			{
+				const __m128i zero = _mm_setzero_si128();
+
+				const __m128i full = _mm_set1_epi16(255);
+
+				size_t i = 0;
+
+				for (; i + 4 <= num; i += 4)
+				{
+					const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+					const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+					const __m128i ialo = _mm_sub_epi16(full, detail::SplatAlpha(_mm_unpacklo_epi8(s, zero)));
+					const __m128i iahi = _mm_sub_epi16(full, detail::SplatAlpha(_mm_unpackhi_epi8(s, zero)));
+
+					const __m128i lo = detail::Div255(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), ialo));
+					const __m128i hi = detail::Div255(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), iahi));
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epu8(s, _mm_packus_epi16(lo, hi)));
+				}
+
+				Scalar::BlendPremultiplied(src + i, dst + i, num - i);
+			}
+
+			inline void BlendSolid(Color* dst, size_t num, const Color& color)
+			{
+				const __m128i zero = _mm_setzero_si128();
+
+				const __m128i c = _mm_unpacklo_epi8(detail::Splat(color), zero);
+
+				const __m128i a = detail::SplatAlpha(c);
+
+				const __m128i ca = _mm_mullo_epi16(c, a);
+
+				const __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+
+				size_t i = 0;
+
+				for (; i + 4 <= num; i += 4)
+				{
+					const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+					const __m128i lo = detail::Div255(_mm_add_epi16(ca, _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), ia)));
+					const __m128i hi = detail::Div255(_mm_add_epi16(ca, _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), ia)));
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), detail::KeepAlpha(_mm_packus_epi16(lo, hi), d));
+				}
+
+				Scalar::BlendSolid(dst + i, num - i, color);
+			}
+
+			inline void Multiply(const Color* src, Color* dst, size_t num, const Color& color)
+			{
+				const __m128i zero = _mm_setzero_si128();
+
+				const __m128i c = _mm_unpacklo_epi8(detail::Splat(color), zero);
+
+				size_t i = 0;
+
+				for (; i + 4 <= num; i += 4)
+				{
+					const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+					const __m128i lo = detail::Div255(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), c));
+					const __m128i hi = detail::Div255(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), c));
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+				}
+
+				Scalar::Multiply(src + i, dst + i, num - i, color);
+			}
+
+			inline void Premultiply(const Color* src, Color* dst, size_t num)
+			{
+				const __m128i zero = _mm_setzero_si128();
+
+				size_t i = 0;
+
+				for (; i + 4 <= num; i += 4)
+				{
+					const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+					const __m128i slo = _mm_unpacklo_epi8(s, zero), shi = _mm_unpackhi_epi8(s, zero);
+					const __m128i lo = detail::Div255(_mm_mullo_epi16(slo, detail::SplatAlpha(slo)));
+					const __m128i hi = detail::Div255(_mm_mullo_epi16(shi, detail::SplatAlpha(shi)));
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), detail::KeepAlpha(_mm_packus_epi16(lo, hi), s));
+				}
+
+				Scalar::Premultiply(src + i, dst + i, num - i);
+			}
+		}
+
+		/// <summary>
+		/// AVX2 による実装（1 命令で 8 ピクセル）
+		/// </summary>
+		/// <remarks>
+		/// 展開と再パックはどちらも 128 ビットレーン単位で行われるため、ピクセルの順序は保たれます。
+		/// </remarks>
+		namespace AVX2
+		{
+			namespace detail
+			{
+				inline __m256i Div255(__m256i x)
+				{
+					return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+				}
+
+				inline __m256i SplatAlpha(__m256i v)
+				{
+					return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				}
+
+				inline __m256i Lerp(__m256i s, __m256i d, __m256i a)
+				{
+					const __m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+
+					return Div255(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, ia)));
+				}
+
+				inline __m256i KeepAlpha(__m256i rgb, __m256i d)
+				{
+					const __m256i mask = _mm256_set1_epi32(0xFF000000);
+
+					return _mm256_or_si256(_mm256_andnot_si256(mask, rgb), _mm256_and_si256(mask, d));
+				}
+			}
+
+			inline void Blend(const Color* src, Color* dst, size_t num)
+			{
+				const __m256i zero = _mm256_setzero_si256();
+
+				size_t i = 0;
+
+				for (; i + 8 <= num; i += 8)
+				{
+					const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+					const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+
+					const __m256i slo = _mm256_unpacklo_epi8(s, zero), shi = _mm256_unpackhi_epi8(s, zero);
+					const __m256i lo = detail::Lerp(slo, _mm256_unpacklo_epi8(d, zero), detail::SplatAlpha(slo));
+					const __m256i hi = detail::Lerp(shi, _mm256_unpackhi_epi8(d, zero), detail::SplatAlpha(shi));
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), detail::KeepAlpha(_mm256_packus_epi16(lo, hi), d));
+				}
+
+				SSE2::Blend(src + i, dst + i, num - i);
+			}
+
+			inline void BlendPremultiplied(const Color* src, Color* dst, size_t num)
+			{
+				const __m256i zero = _mm256_setzero_si256();
+
+				const __m256i full = _mm256_set1_epi16(255);
+
+				size_t i = 0;
+
+				for (; i + 8 <= num; i += 8)
+				{
+					const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+					const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+
+					const __m256i ialo = _mm256_sub_epi16(full, detail::SplatAlpha(_mm256_unpacklo_epi8(s, zero)));
+					const __m256i iahi = _mm256_sub_epi16(full, detail::SplatAlpha(_mm256_unpackhi_epi8(s, zero)));
+
+					const __m256i lo = detail::Div255(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), ialo));
+					const __m256i hi = detail::Div255(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), iahi));
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_adds_epu8(s, _mm256_packus_epi16(lo, hi)));
+				}
+
+				SSE2::BlendPremultiplied(src + i, dst + i, num - i);
+			}
+
+			inline void BlendSolid(Color* dst, size_t num, const Color& color)
+			{
+				const __m256i zero = _mm256_setzero_si256();
+
+				const __m256i c = _mm256_broadcastsi128_si256(_mm_unpacklo_epi8(SSE2::detail::Splat(color), _mm_setzero_si128()));
+
+				const __m256i a = detail::SplatAlpha(c);
+
+				const __m256i ca = _mm256_mullo_epi16(c, a);
+
+				const __m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+
+				size_t i = 0;
+
+				for (; i + 8 <= num; i += 8)
+				{
+					const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+
+					const __m256i lo = detail::Div255(_mm256_add_epi16(ca, _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), ia)));
+					const __m256i hi = detail::Div255(_mm256_add_epi16(ca, _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), ia)));
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), detail::KeepAlpha(_mm256_packus_epi16(lo, hi), d));
+				}
+
+				SSE2::BlendSolid(dst + i, num - i, color);
+			}
+		}
+
+		inline void Blend(const Color* src, Color* dst, size_t num)
+		{
+			ImageKernels::detail::UseAVX2() ? AVX2::Blend(src, dst, num) : ImageKernels::detail::UseSSE2() ? SSE2::Blend(src, dst, num) : Scalar::Blend(src, dst, num);
+		}
+
+		inline void BlendPremultiplied(const Color* src, Color* dst, size_t num)
+		{
+			ImageKernels::detail::UseAVX2() ? AVX2::BlendPremultiplied(src, dst, num) : ImageKernels::detail::UseSSE2() ? SSE2::BlendPremultiplied(src, dst, num) : Scalar::BlendPremultiplied(src, dst, num);
+		}
+
+		inline void BlendSolid(Color* dst, size_t num, const Color& color)
+		{
+			ImageKernels::detail::UseAVX2() ? AVX2::BlendSolid(dst, num, color) : ImageKernels::detail::UseSSE2() ? SSE2::BlendSolid(dst, num, color) : Scalar::BlendSolid(dst, num, color);
+		}
+
+		inline void Multiply(const Color* src, Color* dst, size_t num, const Color& color)
+		{
+			ImageKernels::detail::UseSSE2() ? SSE2::Multiply(src, dst, num, color) : Scalar::Multiply(src, dst, num, color);
+		}
+
+		/// <summary>
+		/// 画像の RGB にアルファ値を乗算します。
+		/// </summary>
+		/// <param name="image">
+		/// 画像
+		/// </param>
+		/// <remarks>
+		/// WritePremultiplied() の入力を作成します。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void Premultiply(Image& image)
+		{
+			if (!image.isEmpty)
+			{
+				ImageKernels::detail::UseSSE2() ? SSE2::Premultiply(image[0], image[0], image.num_pixels) : Scalar::Premultiply(image[0], image[0], image.num_pixels);
+			}
+		}
+
+		namespace detail
+		{
+			// src を dst の pos に置いたときの、書き込み先の範囲と src 内の開始位置
+			inline bool ClipBlit(const Size& srcSize, const Size& dstSize, const Point& pos, Rect& dstRect, Point& srcPos)
+			{
+				const int32 left = std::max(pos.x, 0), top = std::max(pos.y, 0);
+				const int32 right = std::min(pos.x + srcSize.x, dstSize.x), bottom = std::min(pos.y + srcSize.y, dstSize.y);
+
+				if (left >= right || top >= bottom)
+				{
+					return false;
+				}
+
+				dstRect = Rect(left, top, right - left, bottom - top);
+
+				srcPos = Point(left - pos.x, top - pos.y);
+
+				return true;
+			}
+
+			template <class RowFunction>
+			inline void ForEachBlitRow(const ImageView& src, Image& dst, const Point& pos, RowFunction rowFunction)
+			{
+				Rect dstRect;
+
+				Point srcPos;
+
+				if (src.isEmpty || dst.isEmpty || !ClipBlit(src.size, dst.size, pos, dstRect, srcPos))
+				{
+					return;
+				}
+
+				for (int32 y = 0; y < dstRect.h; ++y)
+				{
+					rowFunction(src[srcPos.y + y] + srcPos.x, dst[dstRect.y + y] + dstRect.x, static_cast<size_t>(dstRect.w));
+				}
+			}
+		}
+
+		/// <summary>
+		/// 画像を別の画像にアルファブレンドして書き込みます。
+		/// </summary>
+		/// <param name="src">
+		/// 書き込む画像のビュー
+		/// </param>
+		/// <param name="dst">
+		/// 書き込み先の画像
+		/// </param>
+		/// <param name="pos">
+		/// 書き込み開始位置
+		/// </param>
+		/// <param name="color">
+		/// 乗算する色
+		/// </param>
+		/// <remarks>
+		/// Image::write() と同じ合成を行います。src と dst は同じ画像であってはいけません。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void Write(const ImageView& src, Image& dst, const Point& pos = { 0, 0 }, const Color& color = Palette::White)
+		{
+			if (color == Palette::White)
+			{
+				detail::ForEachBlitRow(src, dst, pos, [](const Color* s, Color* d, size_t n) { Blend(s, d, n); });
+
+				return;
+			}
+
+			Array<Color> buffer(src.width);
+
+			detail::ForEachBlitRow(src, dst, pos, [&](const Color* s, Color* d, size_t n)
+			{
+				Multiply(s, buffer.data(), n, color);
+
+				Blend(buffer.data(), d, n);
+			});
+		}
+
+		/// <summary>
+		/// アルファ値を乗算済みの画像を別の画像に合成して書き込みます。
+		/// </summary>
+		/// <param name="src">
+		/// アルファ値を乗算済みの画像のビュー
+		/// </param>
+		/// <param name="dst">
+		/// 書き込み先の画像
+		/// </param>
+		/// <param name="pos">
+		/// 書き込み開始位置
+		/// </param>
+		/// <remarks>
+		/// dst = src + dst * (255 - src.a) / 255 をアルファを含む全チャンネルで計算します。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void WritePremultiplied(const ImageView& src, Image& dst, const Point& pos = { 0, 0 })
+		{
+			detail::ForEachBlitRow(src, dst, pos, [](const Color* s, Color* d, size_t n) { BlendPremultiplied(s, d, n); });
+		}
+
+		/// <summary>
+		/// 画像を別の画像に上書きします。
+		/// </summary>
+		/// <param name="src">
+		/// 書き込む画像のビュー
+		/// </param>
+		/// <param name="dst">
+		/// 書き込み先の画像
+		/// </param>
+		/// <param name="pos">
+		/// 書き込み開始位置
+		/// </param>
+		/// <param name="color">
+		/// 乗算する色
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void Overwrite(const ImageView& src, Image& dst, const Point& pos = { 0, 0 }, const Color& color = Palette::White)
+		{
+			if (color == Palette::White)
+			{
+				detail::ForEachBlitRow(src, dst, pos, [](const Color* s, Color* d, size_t n) { std::memmove(d, s, n * sizeof(Color)); });
+
+				return;
+			}
+
+			detail::ForEachBlitRow(src, dst, pos, [&](const Color* s, Color* d, size_t n) { Multiply(s, d, n, color); });
+		}
+
+		/// <summary>
+		/// 多角形をスパンに分解する走査変換器
+		/// </summary>
+		/// <remarks>
+		/// 辺を上端の y でソートした辺テーブルと、現在の行と交差する辺だけを持つアクティブ辺リストで、
+		/// 行ごとに塗りつぶす区間を求めます。ピクセルの中心 (x + 0.5, y + 0.5) が内側にあるピクセルを塗ります。
+		/// </remarks>
+		class ScanConverter
+		{
+		public:
+
+			enum class FillRule
+			{
+				/// <summary>
+				/// 交差数が奇数の領域を塗ります。穴のある多角形に使います。
+				/// </summary>
+				EvenOdd,
+
+				/// <summary>
+				/// 巻き数が 0 でない領域を塗ります。同じ向きの輪郭の和集合になります。
+				/// </summary>
+				NonZero,
+			};
+
+		private:
+
+			struct Edge
+			{
+				double yTop, yBottom, x, dxdy;
+
+				int32 winding;
+			};
+
+			struct ActiveEdge
+			{
+				double x, dxdy, yBottom;
+
+				int32 winding;
+			};
+
+			Array<Edge> m_edges;
+
+		public:
+
+			void clear()
+			{
+				m_edges.clear();
+			}
+
+			bool isEmpty() const
+			{
+				return m_edges.empty();
+			}
+
+			/// <summary>
+			/// 閉じた輪郭を追加します。
+			/// </summary>
+			/// <param name="points">
+			/// 頂点
+			/// </param>
+			/// <param name="num">
+			/// 頂点の数
+			/// </param>
+			/// <param name="offset">
+			/// 各頂点に加える位置
+			/// </param>
+			void addContour(const Vec2* points, size_t num, const Vec2& offset = { 0, 0 })
+			{
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Vec2 p = points[i] + offset, q = points[(i + 1) % num] + offset;
+
+					if (p.y == q.y)
+					{
+						continue;
+					}
+
+					const bool down = p.y < q.y;
+
+					const Vec2& top = down ? p : q;
+
+					const Vec2& bottom = down ? q : p;
+
+					m_edges.push_back({ top.y, bottom.y, top.x, (bottom.x - top.x) / (bottom.y - top.y), down ? 1 : -1 });
+				}
+			}
+
+			void addContour(const Array<Vec2>& points, const Vec2& offset = { 0, 0 })
+			{
+				addContour(points.data(), points.size(), offset);
+			}
+
+			/// <summary>
+			/// 凸多角形を、ほかの凸多角形と同じ向きにそろえて追加します。
+			/// </summary>
+			/// <remarks>
+			/// FillRule::NonZero で、重なった部分を 1 回だけ塗るために使います。
+			/// </remarks>
+			void addConvex(const Vec2* points, size_t num, const Vec2& offset = { 0, 0 })
+			{
+				double area = 0.0;
+
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Vec2& p = points[i], &q = points[(i + 1) % num];
+
+					area += p.x * q.y - q.x * p.y;
+				}
+
+				if (area >= 0.0)
+				{
+					addContour(points, num, offset);
+
+					return;
+				}
+
+				Array<Vec2> reversed(points, points + num);
+
+				std::reverse(reversed.begin(), reversed.end());
+
+				addContour(reversed, offset);
+			}
+
+			/// <summary>
+			/// 太さを持つ折れ線を追加します。
+			/// </summary>
+			/// <param name="points">
+			/// 頂点
+			/// </param>
+			/// <param name="thickness">
+			/// 線の太さ
+			/// </param>
+			/// <param name="isClosed">
+			/// 終点と始点を結ぶか
+			/// </param>
+			/// <remarks>
+			/// 各線分の矩形と各頂点の正方形を追加します。FillRule::NonZero で走査します。
+			/// </remarks>
+			void addStroke(const Array<Vec2>& points, double thickness, bool isClosed, const Vec2& offset = { 0, 0 })
+			{
+				const double h = std::max(thickness, 1.0) * 0.5;
+
+				const size_t segments = points.size() < 2 ? 0 : (isClosed ? points.size() : points.size() - 1);
+
+				for (size_t i = 0; i < segments; ++i)
+				{
+					const Vec2& p = points[i], &q = points[(i + 1) % points.size()];
+
+					const Vec2 d = q - p;
+
+					const double length = std::sqrt(d.x * d.x + d.y * d.y);
+
+					if (length == 0.0)
+					{
+						continue;
+					}
+
+					const Vec2 n(-d.y / length * h, d.x / length * h);
+
+					const Vec2 quad[4] = { p + n, q + n, q - n, p - n };
+
+					addConvex(quad, 4, offset);
+				}
+
+				for (const auto& p : points)
+				{
+					const Vec2 square[4] = { { p.x - h, p.y - h }, { p.x + h, p.y - h }, { p.x + h, p.y + h }, { p.x - h, p.y + h } };
+
+					addConvex(square, 4, offset);
+				}
+			}
+
+			/// <summary>
+			/// 追加した輪郭を走査し、塗りつぶす区間を行ごとに返します。
+			/// </summary>
+			/// <param name="clip">
+			/// 出力する範囲。(0, 0) から clip までの区間だけを返します。
+			/// </param>
+			/// <param name="rule">
+			/// 内側の判定方法
+			/// </param>
+			/// <param name="spanFunction">
+			/// (y, x0, x1) を引数にとる関数。[x0, x1) を塗ります。
+			/// </param>
+			/// <returns>
+			/// なし
+			/// </returns>
+			template <class SpanFunction>
+			void rasterize(const Size& clip, FillRule rule, SpanFunction spanFunction)
+			{
+				if (m_edges.empty() || clip.x <= 0 || clip.y <= 0)
+				{
+					return;
+				}
+
+				std::sort(m_edges.begin(), m_edges.end(), [](const Edge& a, const Edge& b) { return a.yTop < b.yTop; });
+
+				double yMax = m_edges.front().yBottom;
+
+				for (const auto& edge : m_edges)
+				{
+					yMax = std::max(yMax, edge.yBottom);
+				}
+
+				// 中心が [yTop, yBottom) に入る行だけを走査し、範囲外の行は辺の追加前に切り捨てる
+				const int32 yBegin = std::max(static_cast<int32>(std::ceil(m_edges.front().yTop - 0.5)), 0);
+
+				const int32 yEnd = std::min(static_cast<int32>(std::ceil(yMax - 0.5)), clip.y);
+
+				Array<ActiveEdge> active;
+
+				size_t next = 0;
+
+				for (int32 y = yBegin; y < yEnd; ++y)
+				{
+					const double yc = y + 0.5;
+
+					for (; next < m_edges.size() && m_edges[next].yTop <= yc; ++next)
+					{
+						const Edge& e = m_edges[next];
+
+						if (e.yBottom > yc)
+						{
+							active.push_back({ e.x + (yc - e.yTop) * e.dxdy, e.dxdy, e.yBottom, e.winding });
+						}
+					}
+
+					active.erase(std::remove_if(active.begin(), active.end(), [=](const ActiveEdge& e) { return e.yBottom <= yc; }), active.end());
+
+					// 前の行からの順序はほぼ保たれているため挿入ソートで並べ替える
+					for (size_t i = 1; i < active.size(); ++i)
+					{
+						for (size_t k = i; k > 0 && active[k].x < active[k - 1].x; --k)
+						{
+							std::swap(active[k], active[k - 1]);
+						}
+					}
+
+					int32 winding = 0;
+
+					double spanBegin = 0.0;
+
+					for (const auto& e : active)
+					{
+						const bool wasInside = (rule == FillRule::EvenOdd) ? (winding & 1) != 0 : winding != 0;
+
+						winding += e.winding;
+
+						const bool isInside = (rule == FillRule::EvenOdd) ? (winding & 1) != 0 : winding != 0;
+
+						if (!wasInside && isInside)
+						{
+							spanBegin = e.x;
+						}
+						else if (wasInside && !isInside)
+						{
+							const int32 x0 = std::max(static_cast<int32>(std::ceil(spanBegin - 0.5)), 0);
+
+							const int32 x1 = std::min(static_cast<int32>(std::ceil(e.x - 0.5)), clip.x);
+
+							if (x0 < x1)
+							{
+								spanFunction(y, x0, x1);
+							}
+						}
+					}
+
+					for (auto& e : active)
+					{
+						e.x += e.dxdy;
+					}
+				}
+			}
+		};
+
+		namespace detail
+		{
+			inline void FillSpans(ScanConverter& converter, ScanConverter::FillRule rule, Image& image, const Color& color, bool blend)
+			{
+				if (blend && color.a == 0)
+				{
+					return;
+				}
+
+				const bool overwrite = !blend || color.a == 255;
+
+				converter.rasterize(image.size, rule, [&](int32 y, int32 x0, int32 x1)
+				{
+					Color* const row = image[y];
+
+					if (overwrite)
+					{
+						std::fill(row + x0, row + x1, color);
+					}
+					else
+					{
+						BlendSolid(row + x0, static_cast<size_t>(x1 - x0), color);
+					}
+				});
+			}
+
+			inline Array<Vec2> EllipseContour(const Vec2& center, double a, double b)
+			{
+				const int32 n = Clamp(static_cast<int32>(std::max(a, b) * 2.0), 12, 2048);
+
+				Array<Vec2> points(n);
+
+				for (int32 i = 0; i < n; ++i)
+				{
+					const double t = Math::TwoPi * i / n;
+
+					points[i] = Vec2(center.x + a * std::cos(t), center.y + b * std::sin(t));
+				}
+
+				return points;
+			}
+
+			inline Array<Vec2> RectContour(const RectF& rect)
+			{
+				return{ { rect.x, rect.y }, { rect.x + rect.w, rect.y }, { rect.x + rect.w, rect.y + rect.h }, { rect.x, rect.y + rect.h } };
+			}
+
+			inline void AddPolygon(ScanConverter& converter, const Polygon& polygon, const Vec2& offset)
+			{
+				converter.addContour(polygon.outer(), offset);
+
+				for (const auto& hole : polygon.inners())
+				{
+					converter.addContour(hole, offset);
+				}
+			}
+
+			inline void AddPolygonFrame(ScanConverter& converter, const Polygon& polygon, double thickness, const Vec2& offset)
+			{
+				converter.addStroke(polygon.outer(), thickness, true, offset);
+
+				for (const auto& hole : polygon.inners())
+				{
+					converter.addStroke(hole, thickness, true, offset);
+				}
+			}
+		}
+
+		/// <summary>
+		/// 多角形を塗りつぶします。
+		/// </summary>
+		/// <param name="image">
+		/// 書き込み先の画像
+		/// </param>
+		/// <param name="polygon">
+		/// 多角形
+		/// </param>
+		/// <param name="pos">
+		/// 多角形に加える位置
+		/// </param>
+		/// <param name="color">
+		/// 塗りつぶしの色
+		/// </param>
+		/// <param name="blend">
+		/// アルファブレンドする場合 true (Polygon::write)、上書きする場合 false (Polygon::overwrite)
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void FillPolygon(Image& image, const Polygon& polygon, const Point& pos = { 0, 0 }, const Color& color = Palette::Black, bool blend = true)
+		{
+			ScanConverter converter;
+
+			detail::AddPolygon(converter, polygon, pos);
+
+			detail::FillSpans(converter, ScanConverter::FillRule::EvenOdd, image, color, blend);
+		}
+
+		inline void FillPolygon(Image& image, const MultiPolygon& polygons, const Point& pos = { 0, 0 }, const Color& color = Palette::Black, bool blend = true)
+		{
+			for (const auto& polygon : polygons)
+			{
+				FillPolygon(image, polygon, pos, color, blend);
+			}
+		}
+
+		/// <summary>
+		/// 多角形の輪郭を描きます。
+		/// </summary>
+		/// <remarks>
+		/// 輪郭の線分が重なる部分も 1 回だけ塗ります。
+		/// </remarks>
+		inline void FillPolygonFrame(Image& image, const Polygon& polygon, int32 thickness = 1, const Point& pos = { 0, 0 }, const Color& color = Palette::Black, bool blend = true)
+		{
+			ScanConverter converter;
+
+			detail::AddPolygonFrame(converter, polygon, thickness, pos);
+
+			detail::FillSpans(converter, ScanConverter::FillRule::NonZero, image, color, blend);
+		}
+
+		inline void FillPolygonFrame(Image& image, const MultiPolygon& polygons, int32 thickness = 1, const Point& pos = { 0, 0 }, const Color& color = Palette::Black, bool blend = true)
+		{
+			for (const auto& polygon : polygons)
+			{
+				FillPolygonFrame(image, polygon, thickness, pos, color, blend);
+			}
+		}
+
+		/// <summary>
+		/// 折れ線を描きます。
+		/// </summary>
+		/// <param name="image">
+		/// 書き込み先の画像
+		/// </param>
+		/// <param name="lines">
+		/// 折れ線
+		/// </param>
+		/// <param name="thickness">
+		/// 線の太さ
+		/// </param>
+		/// <param name="color">
+		/// 線の色
+		/// </param>
+		/// <param name="isClosed">
+		/// 終点と始点を結ぶか
+		/// </param>
+		/// <param name="blend">
+		/// アルファブレンドする場合 true (LineString::write)、上書きする場合 false (LineString::overwrite)
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void StrokeLineString(Image& image, const LineString& lines, int32 thickness = 1, const Color& color = Palette::Black, bool isClosed = false, bool blend = true)
+		{
+			ScanConverter converter;
+
+			converter.addStroke(Array<Vec2>(lines.begin(), lines.end()), thickness, isClosed);
+
+			detail::FillSpans(converter, ScanConverter::FillRule::NonZero, image, color, blend);
+		}
+
+		/// <summary>
+		/// 図形を塗りつぶします。
+		/// </summary>
+		/// <param name="image">
+		/// 書き込み先の画像
+		/// </param>
+		/// <param name="shape">
+		/// 図形
+		/// </param>
+		/// <param name="color">
+		/// 塗りつぶしの色
+		/// </param>
+		/// <param name="blend">
+		/// アルファブレンドする場合 true (Shape::write)、上書きする場合 false (Shape::overwrite)
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void FillShape(Image& image, const Shape& shape, const Color& color = Palette::Black, bool blend = true)
+		{
+			ScanConverter converter;
+
+			auto rule = ScanConverter::FillRule::EvenOdd;
+
+			switch (shape.type())
+			{
+			case Shape::Type::Point:
+				converter.addContour(detail::RectContour(RectF(shape.storage.point, 1, 1)));
+				break;
+			case Shape::Type::Vec2:
+				converter.addContour(detail::RectContour(RectF(shape.storage.vec2 - Vec2(0.5, 0.5), 1, 1)));
+				break;
+			case Shape::Type::LineInt:
+				converter.addStroke({ shape.storage.lineInt.begin, shape.storage.lineInt.end }, 1.0, false);
+				rule = ScanConverter::FillRule::NonZero;
+				break;
+			case Shape::Type::Line:
+				converter.addStroke({ shape.storage.line.begin, shape.storage.line.end }, 1.0, false);
+				rule = ScanConverter::FillRule::NonZero;
+				break;
+			case Shape::Type::Rect:
+				converter.addContour(detail::RectContour(shape.storage.rect));
+				break;
+			case Shape::Type::RectF:
+				converter.addContour(detail::RectContour(shape.storage.rectF));
+				break;
+			case Shape::Type::Circle:
+				converter.addContour(detail::EllipseContour(shape.storage.circle.center, shape.storage.circle.r, shape.storage.circle.r));
+				break;
+			case Shape::Type::Ellipse:
+				converter.addContour(detail::EllipseContour(shape.storage.ellipse.center, shape.storage.ellipse.a, shape.storage.ellipse.b));
+				break;
+			case Shape::Type::Triangle:
+				converter.addContour({ shape.storage.triangle.p0, shape.storage.triangle.p1, shape.storage.triangle.p2 });
+				break;
+			case Shape::Type::Quad:
+				converter.addContour(shape.storage.quad->p, 4);
+				break;
+			case Shape::Type::RoundRect:
+				detail::AddPolygon(converter, shape.storage.roundRect.asPolygon(), { 0, 0 });
+				break;
+			case Shape::Type::LineString:
+				converter.addStroke(Array<Vec2>(shape.storage.lineString->begin(), shape.storage.lineString->end()), 1.0, false);
+				rule = ScanConverter::FillRule::NonZero;
+				break;
+			case Shape::Type::Polygon:
+				detail::AddPolygon(converter, *shape.storage.polygon, { 0, 0 });
+				break;
+			case Shape::Type::MultiPolygon:
+				FillPolygon(image, *shape.storage.multiPolygon, { 0, 0 }, color, blend);
+				return;
+			default:
+				return;
+			}
+
+			detail::FillSpans(converter, rule, image, color, blend);
+		}
+
+		/// <summary>
+		/// 図形の輪郭を描きます。
+		/// </summary>
+		/// <param name="image">
+		/// 書き込み先の画像
+		/// </param>
+		/// <param name="shape">
+		/// 図形
+		/// </param>
+		/// <param name="thickness">
+		/// 線の太さ
+		/// </param>
+		/// <param name="color">
+		/// 線の色
+		/// </param>
+		/// <param name="blend">
+		/// アルファブレンドする場合 true (Shape::writeFrame)、上書きする場合 false (Shape::overwriteFrame)
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void FillShapeFrame(Image& image, const Shape& shape, int32 thickness = 1, const Color& color = Palette::Black, bool blend = true)
+		{
+			ScanConverter converter;
+
+			switch (shape.type())
+			{
+			case Shape::Type::LineInt:
+				converter.addStroke({ shape.storage.lineInt.begin, shape.storage.lineInt.end }, thickness, false);
+				break;
+			case Shape::Type::Line:
+				converter.addStroke({ shape.storage.line.begin, shape.storage.line.end }, thickness, false);
+				break;
+			case Shape::Type::Rect:
+				converter.addStroke(detail::RectContour(shape.storage.rect), thickness, true);
+				break;
+			case Shape::Type::RectF:
+				converter.addStroke(detail::RectContour(shape.storage.rectF), thickness, true);
+				break;
+			case Shape::Type::Circle:
+				converter.addStroke(detail::EllipseContour(shape.storage.circle.center, shape.storage.circle.r, shape.storage.circle.r), thickness, true);
+				break;
+			case Shape::Type::Ellipse:
+				converter.addStroke(detail::EllipseContour(shape.storage.ellipse.center, shape.storage.ellipse.a, shape.storage.ellipse.b), thickness, true);
+				break;
+			case Shape::Type::Triangle:
+				converter.addStroke({ shape.storage.triangle.p0, shape.storage.triangle.p1, shape.storage.triangle.p2 }, thickness, true);
+				break;
+			case Shape::Type::Quad:
+				converter.addStroke(Array<Vec2>(shape.storage.quad->p, shape.storage.quad->p + 4), thickness, true);
+				break;
+			case Shape::Type::RoundRect:
+				detail::AddPolygonFrame(converter, shape.storage.roundRect.asPolygon(), thickness, { 0, 0 });
+				break;
+			case Shape::Type::LineString:
+				converter.addStroke(Array<Vec2>(shape.storage.lineString->begin(), shape.storage.lineString->end()), thickness, false);
+				break;
+			case Shape::Type::Polygon:
+				detail::AddPolygonFrame(converter, *shape.storage.polygon, thickness, { 0, 0 });
+				break;
+			case Shape::Type::MultiPolygon:
+				FillPolygonFrame(image, *shape.storage.multiPolygon, thickness, { 0, 0 }, color, blend);
+				return;
+			default:
+				FillShape(image, shape, color, blend);
+				return;
+			}
+
+			detail::FillSpans(converter, ScanConverter::FillRule::NonZero, image, color, blend);
+		}
+	}
+}
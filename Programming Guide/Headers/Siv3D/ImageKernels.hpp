@@ -0,0 +1,608 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <array>
+# include <cmath>
+# include <immintrin.h>
+# include "Fwd.hpp"
+# include "Color.hpp"
+# include "Image.hpp"
+# include "SIMD.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// Image のピクセル単位の処理を行うカーネル
+	/// </summary>
+	/// <remarks>
+	/// Scalar 版が処理結果の基準で、SSE2 版と AVX2 版は Scalar 版とビット単位で一致する結果を返します。
+	/// 名前空間直下の関数は SIMD::GetKernel() に応じて実装を選択します。
+	/// src と dst は同じポインタでもかまいません。
+	/// </remarks>
+	namespace ImageKernels
+	{
+		/// <summary>
+		/// LUT を使う処理のためのテーブル
+		/// </summary>
+		using LUT = std::array<uint8, 256>;
+
+		/// <summary>
+		/// 減色処理のテーブルを作成します。
+		/// </summary>
+		/// <param name="level">
+		/// 階調数 [2, 256]
+		/// </param>
+		/// <returns>
+		/// 減色処理のテーブル
+		/// </returns>
+		inline LUT MakePostarizeLUT(int32 level)
+		{
+			const int32 levN = Clamp(level, 2, 256) - 1;
+
+			LUT table;
+
+			for (size_t i = 0; i < 256; ++i)
+			{
+				table[i] = static_cast<uint8>(std::floor(i / 255.0 * levN) * (255.0 / levN));
+			}
+
+			return table;
+		}
+
+		/// <summary>
+		/// ガンマ補正のテーブルを作成します。
+		/// </summary>
+		/// <param name="gamma">
+		/// ガンマ値
+		/// </param>
+		/// <returns>
+		/// ガンマ補正のテーブル
+		/// </returns>
+		inline LUT MakeGammaLUT(double gamma)
+		{
+			const double invGamma = 1.0 / std::max(gamma, 0.0001);
+
+			LUT table;
+
+			for (size_t i = 0; i < 256; ++i)
+			{
+				table[i] = static_cast<uint8>(std::pow(i / 255.0, invGamma) * 255.0 + 0.5);
+			}
+
+			return table;
+		}
+
+		/// <summary>
+		/// RGB 成分に LUT を適用します。
+		/// </summary>
+		/// <remarks>
+		/// 1 バイト単位の表引きは SIMD 化しても速くならないため、すべての実装で共通です。
+		/// </remarks>
+		inline void ApplyLUT(const Color* src, Color* dst, size_t num, const LUT& table)
+		{
+			for (size_t i = 0; i < num; ++i)
+			{
+				const Color c = src[i];
+
+				dst[i] = Color(table[c.r], table[c.g], table[c.b], c.a);
+			}
+		}
+
+		/// <summary>
+		/// 基準となるスカラー実装
+		/// </summary>
+		namespace Scalar
+		{
+			inline void Negate(const Color* src, Color* dst, size_t num)
+			{
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Color c = src[i];
+
+					dst[i] = Color(255 - c.r, 255 - c.g, 255 - c.b, c.a);
+				}
+			}
+
+			inline void Grayscale(const Color* src, Color* dst, size_t num)
+			{
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Color c = src[i];
+
+					const uint8 y = c.grayscale();
+
+					dst[i] = Color(y, y, y, c.a);
+				}
+			}
+
+			inline void Sepia(const Color* src, Color* dst, size_t num, int32 level)
+			{
+				const double levn = Clamp(level, 0, 255);
+				const double levr = 0.956 * levn;
+				const double levg = 0.274 * levn;
+				const double levb = -1.108 * levn;
+
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Color c = src[i];
+
+					const double y = 0.299 * c.r + 0.587 * c.g + 0.114 * c.b;
+					const double r = levr + y;
+					const double g = levg + y;
+					const double b = levb + y;
+
+					dst[i] = Color(r >= 255.0 ? 255 : r <= 0.0 ? 0 : static_cast<uint8>(r),
+								   g >= 255.0 ? 255 : g <= 0.0 ? 0 : static_cast<uint8>(g),
+								   b >= 255.0 ? 255 : b <= 0.0 ? 0 : static_cast<uint8>(b),
+								   c.a);
+				}
+			}
+
+			inline void Brighten(const Color* src, Color* dst, size_t num, int32 level)
+			{
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Color c = src[i];
+
+					dst[i] = Color(Clamp(static_cast<int32>(c.r) + level, 0, 255),
+								   Clamp(static_cast<int32>(c.g) + level, 0, 255),
+								   Clamp(static_cast<int32>(c.b) + level, 0, 255),
+								   c.a);
+				}
+			}
+
+			inline void Threshold(const Color* src, Color* dst, size_t num, uint8 threshold, bool inverse)
+			{
+				const uint32 on = inverse ? 0 : 255;
+				const uint32 off = inverse ? 255 : 0;
+
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Color c = src[i];
+
+					const uint32 v = (c.grayscale() > threshold) ? on : off;
+
+					dst[i] = Color(v, v, v, c.a);
+				}
+			}
+
+			inline void ARGBtoABGR(const Color* src, Color* dst, size_t num)
+			{
+				for (size_t i = 0; i < num; ++i)
+				{
+					const Color c = src[i];
+
+					dst[i] = Color(c.b, c.g, c.r, c.a);
+				}
+			}
+		}
+
+		/// <summary>
+		/// SSE2 による実装（1 命令で 4 ピクセル）
+		/// </summary>
+		namespace SSE2
+		{
+			namespace detail
+			{
+				// 0.299 * r + 0.587 * g + 0.114 * b を Color::grayscale() と同じ順序の倍精度演算で計算する
+				inline __m128d Luma(__m128i r, __m128i g, __m128i b)
+				{
+					const __m128d wr = _mm_mul_pd(_mm_set1_pd(0.299), _mm_cvtepi32_pd(r));
+					const __m128d wg = _mm_mul_pd(_mm_set1_pd(0.587), _mm_cvtepi32_pd(g));
+					const __m128d wb = _mm_mul_pd(_mm_set1_pd(0.114), _mm_cvtepi32_pd(b));
+
+					return _mm_add_pd(_mm_add_pd(wr, wg), wb);
+				}
+
+				// 4 ピクセルの輝度を、下位 2 ピクセル分と上位 2 ピクセル分に分けて返す
+				inline void Luma(__m128i pixels, __m128d& lo, __m128d& hi)
+				{
+					const __m128i mask = _mm_set1_epi32(0xFF);
+					const __m128i r = _mm_and_si128(pixels, mask);
+					const __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 8), mask);
+					const __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 16), mask);
+
+					lo = Luma(r, g, b);
+					hi = Luma(_mm_srli_si128(r, 8), _mm_srli_si128(g, 8), _mm_srli_si128(b, 8));
+				}
+
+				inline __m128i Truncate(__m128d lo, __m128d hi)
+				{
+					return _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+				}
+
+				inline __m128d Saturate(__m128d v)
+				{
+					return _mm_min_pd(_mm_max_pd(v, _mm_setzero_pd()), _mm_set1_pd(255.0));
+				}
+
+				// 0-255 の値を持つ 32 ビットレーンを RGB に展開し、元のアルファを付ける
+				inline __m128i Splat(__m128i v, __m128i pixels)
+				{
+					const __m128i rgb = _mm_or_si128(_mm_or_si128(v, _mm_slli_epi32(v, 8)), _mm_slli_epi32(v, 16));
+
+					return _mm_or_si128(rgb, _mm_and_si128(pixels, _mm_set1_epi32(0xFF000000)));
+				}
+			}
+
+			inline void Negate(const Color* src, Color* dst, size_t num)
+			{
+				const __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+
+				size_t i = 0;
+
+				for (; i + 4 <= num; i += 4)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(v, mask));
+				}
+
+				Scalar::Negate(src + i, dst + i, num - i);
+			}
+
+			inline void Grayscale(const Color* src, Color* dst, size_t num)
+			{
+				size_t i = 0;
+
+				for (; i + 4 <= num; i += 4)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+					__m128d ylo, yhi;
+
+					detail::Luma(v, ylo, yhi);
+
+					const __m128i y = detail::Truncate(ylo, yhi);
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), detail::Splat(y, v));
+				}
+
+				Scalar::Grayscale(src + i, dst + i, num - i);
+			}
+
+			inline void Sepia(const Color* src, Color* dst, size_t num, int32 level)
+			{
+				const double levn = Clamp(level, 0, 255);
+				const __m128d levr = _mm_set1_pd(0.956 * levn);
+				const __m128d levg = _mm_set1_pd(0.274 * levn);
+				const __m128d levb = _mm_set1_pd(-1.108 * levn);
+
+				size_t i = 0;
+
+				for (; i + 4 <= num; i += 4)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+					__m128d ylo, yhi;
+
+					detail::Luma(v, ylo, yhi);
+
+					const __m128i r = detail::Truncate(detail::Saturate(_mm_add_pd(levr, ylo)), detail::Saturate(_mm_add_pd(levr, yhi)));
+					const __m128i g = detail::Truncate(detail::Saturate(_mm_add_pd(levg, ylo)), detail::Saturate(_mm_add_pd(levg, yhi)));
+					const __m128i b = detail::Truncate(detail::Saturate(_mm_add_pd(levb, ylo)), detail::Saturate(_mm_add_pd(levb, yhi)));
+
+					const __m128i rgb = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_slli_epi32(b, 16));
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(rgb, _mm_and_si128(v, _mm_set1_epi32(0xFF000000))));
+				}
+
+				Scalar::Sepia(src + i, dst + i, num - i, level);
+			}
+
+			inline void Brighten(const Color* src, Color* dst, size_t num, int32 level)
+			{
+				const int32 amount = Clamp(level < 0 ? -level : level, 0, 255);
+				const __m128i delta = _mm_set1_epi32(amount | (amount << 8) | (amount << 16));
+
+				size_t i = 0;
+
+				for (; i + 4 <= num; i += 4)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+					const __m128i result = (level < 0) ? _mm_subs_epu8(v, delta) : _mm_adds_epu8(v, delta);
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+				}
+
+				Scalar::Brighten(src + i, dst + i, num - i, level);
+			}
+
+			inline void Threshold(const Color* src, Color* dst, size_t num, uint8 threshold, bool inverse)
+			{
+				const __m128i t = _mm_set1_epi32(threshold);
+				const __m128i flip = inverse ? _mm_set1_epi32(0xFF) : _mm_setzero_si128();
+
+				size_t i = 0;
+
+				for (; i + 4 <= num; i += 4)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+					__m128d ylo, yhi;
+
+					detail::Luma(v, ylo, yhi);
+
+					const __m128i y = detail::Truncate(ylo, yhi);
+
+					const __m128i on = _mm_xor_si128(_mm_and_si128(_mm_cmpgt_epi32(y, t), _mm_set1_epi32(0xFF)), flip);
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), detail::Splat(on, v));
+				}
+
+				Scalar::Threshold(src + i, dst + i, num - i, threshold, inverse);
+			}
+
+			inline void ARGBtoABGR(const Color* src, Color* dst, size_t num)
+			{
+				const __m128i agMask = _mm_set1_epi32(0xFF00FF00);
+				const __m128i rbMask = _mm_set1_epi32(0x00FF00FF);
+
+				size_t i = 0;
+
+				for (; i + 4 <= num; i += 4)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+					const __m128i rb = _mm_and_si128(v, rbMask);
+
+					const __m128i swapped = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_and_si128(v, agMask), swapped));
+				}
+
+				Scalar::ARGBtoABGR(src + i, dst + i, num - i);
+			}
+		}
+
+		/// <summary>
+		/// AVX2 による実装（1 命令で 8 ピクセル）
+		/// </summary>
+		namespace AVX2
+		{
+			namespace detail
+			{
+				inline __m256d Luma(__m128i rgb32)
+				{
+					const __m128i mask = _mm_set1_epi32(0xFF);
+					const __m256d r = _mm256_cvtepi32_pd(_mm_and_si128(rgb32, mask));
+					const __m256d g = _mm256_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(rgb32, 8), mask));
+					const __m256d b = _mm256_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(rgb32, 16), mask));
+
+					return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(0.299), r), _mm256_mul_pd(_mm256_set1_pd(0.587), g)), _mm256_mul_pd(_mm256_set1_pd(0.114), b));
+				}
+
+				inline __m256i Truncate(__m256d lo, __m256d hi)
+				{
+					return _mm256_set_m128i(_mm256_cvttpd_epi32(hi), _mm256_cvttpd_epi32(lo));
+				}
+
+				inline __m256d Saturate(__m256d v)
+				{
+					return _mm256_min_pd(_mm256_max_pd(v, _mm256_setzero_pd()), _mm256_set1_pd(255.0));
+				}
+
+				inline __m256i Splat(__m256i v, __m256i pixels)
+				{
+					const __m256i rgb = _mm256_or_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 8)), _mm256_slli_epi32(v, 16));
+
+					return _mm256_or_si256(rgb, _mm256_and_si256(pixels, _mm256_set1_epi32(0xFF000000)));
+				}
+			}
+
+			inline void Negate(const Color* src, Color* dst, size_t num)
+			{
+				const __m256i mask = _mm256_set1_epi32(0x00FFFFFF);
+
+				size_t i = 0;
+
+				for (; i + 8 <= num; i += 8)
+				{
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(v, mask));
+				}
+
+				SSE2::Negate(src + i, dst + i, num - i);
+			}
+
+			inline void Grayscale(const Color* src, Color* dst, size_t num)
+			{
+				size_t i = 0;
+
+				for (; i + 8 <= num; i += 8)
+				{
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+
+					const __m256i y = detail::Truncate(detail::Luma(_mm256_castsi256_si128(v)), detail::Luma(_mm256_extracti128_si256(v, 1)));
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), detail::Splat(y, v));
+				}
+
+				SSE2::Grayscale(src + i, dst + i, num - i);
+			}
+
+			inline void Sepia(const Color* src, Color* dst, size_t num, int32 level)
+			{
+				const double levn = Clamp(level, 0, 255);
+				const __m256d levr = _mm256_set1_pd(0.956 * levn);
+				const __m256d levg = _mm256_set1_pd(0.274 * levn);
+				const __m256d levb = _mm256_set1_pd(-1.108 * levn);
+
+				size_t i = 0;
+
+				for (; i + 8 <= num; i += 8)
+				{
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+
+					const __m256d ylo = detail::Luma(_mm256_castsi256_si128(v));
+					const __m256d yhi = detail::Luma(_mm256_extracti128_si256(v, 1));
+
+					const __m256i r = detail::Truncate(detail::Saturate(_mm256_add_pd(levr, ylo)), detail::Saturate(_mm256_add_pd(levr, yhi)));
+					const __m256i g = detail::Truncate(detail::Saturate(_mm256_add_pd(levg, ylo)), detail::Saturate(_mm256_add_pd(levg, yhi)));
+					const __m256i b = detail::Truncate(detail::Saturate(_mm256_add_pd(levb, ylo)), detail::Saturate(_mm256_add_pd(levb, yhi)));
+
+					const __m256i rgb = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)), _mm256_slli_epi32(b, 16));
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(rgb, _mm256_and_si256(v, _mm256_set1_epi32(0xFF000000))));
+				}
+
+				SSE2::Sepia(src + i, dst + i, num - i, level);
+			}
+
+			inline void Brighten(const Color* src, Color* dst, size_t num, int32 level)
+			{
+				const int32 amount = Clamp(level < 0 ? -level : level, 0, 255);
+				const __m256i delta = _mm256_set1_epi32(amount | (amount << 8) | (amount << 16));
+
+				size_t i = 0;
+
+				for (; i + 8 <= num; i += 8)
+				{
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+
+					const __m256i result = (level < 0) ? _mm256_subs_epu8(v, delta) : _mm256_adds_epu8(v, delta);
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), result);
+				}
+
+				SSE2::Brighten(src + i, dst + i, num - i, level);
+			}
+
+			inline void Threshold(const Color* src, Color* dst, size_t num, uint8 threshold, bool inverse)
+			{
+				const __m256i t = _mm256_set1_epi32(threshold);
+				const __m256i flip = inverse ? _mm256_set1_epi32(0xFF) : _mm256_setzero_si256();
+
+				size_t i = 0;
+
+				for (; i + 8 <= num; i += 8)
+				{
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+
+					const __m256i y = detail::Truncate(detail::Luma(_mm256_castsi256_si128(v)), detail::Luma(_mm256_extracti128_si256(v, 1)));
+
+					const __m256i on = _mm256_xor_si256(_mm256_and_si256(_mm256_cmpgt_epi32(y, t), _mm256_set1_epi32(0xFF)), flip);
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), detail::Splat(on, v));
+				}
+
+				SSE2::Threshold(src + i, dst + i, num - i, threshold, inverse);
+			}
+
+			inline void ARGBtoABGR(const Color* src, Color* dst, size_t num)
+			{
+				const __m256i agMask = _mm256_set1_epi32(0xFF00FF00);
+				const __m256i rbMask = _mm256_set1_epi32(0x00FF00FF);
+
+				size_t i = 0;
+
+				for (; i + 8 <= num; i += 8)
+				{
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+
+					const __m256i rb = _mm256_and_si256(v, rbMask);
+
+					const __m256i swapped = _mm256_or_si256(_mm256_slli_epi32(rb, 16), _mm256_srli_epi32(rb, 16));
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(_mm256_and_si256(v, agMask), swapped));
+				}
+
+				SSE2::ARGBtoABGR(src + i, dst + i, num - i);
+			}
+		}
+
+		namespace detail
+		{
+			inline bool UseAVX2()
+			{
+				return SIMD::GetKernel() == SIMDKernel::AVX2;
+			}
+
+			inline bool UseSSE2()
+			{
+				return SIMD::GetKernel() != SIMDKernel::Scalar;
+			}
+		}
+
+		inline void Negate(const Color* src, Color* dst, size_t num)
+		{
+			detail::UseAVX2() ? AVX2::Negate(src, dst, num) : detail::UseSSE2() ? SSE2::Negate(src, dst, num) : Scalar::Negate(src, dst, num);
+		}
+
+		inline void Grayscale(const Color* src, Color* dst, size_t num)
+		{
+			detail::UseAVX2() ? AVX2::Grayscale(src, dst, num) : detail::UseSSE2() ? SSE2::Grayscale(src, dst, num) : Scalar::Grayscale(src, dst, num);
+		}
+
+		inline void Sepia(const Color* src, Color* dst, size_t num, int32 level)
+		{
+			detail::UseAVX2() ? AVX2::Sepia(src, dst, num, level) : detail::UseSSE2() ? SSE2::Sepia(src, dst, num, level) : Scalar::Sepia(src, dst, num, level);
+		}
+
+		inline void Postarize(const Color* src, Color* dst, size_t num, int32 level)
+		{
+			ApplyLUT(src, dst, num, MakePostarizeLUT(level));
+		}
+
+		inline void Brighten(const Color* src, Color* dst, size_t num, int32 level)
+		{
+			detail::UseAVX2() ? AVX2::Brighten(src, dst, num, level) : detail::UseSSE2() ? SSE2::Brighten(src, dst, num, level) : Scalar::Brighten(src, dst, num, level);
+		}
+
+		inline void GammaCorrect(const Color* src, Color* dst, size_t num, double gamma)
+		{
+			ApplyLUT(src, dst, num, MakeGammaLUT(gamma));
+		}
+
+		inline void Threshold(const Color* src, Color* dst, size_t num, uint8 threshold, bool inverse = false)
+		{
+			detail::UseAVX2() ? AVX2::Threshold(src, dst, num, threshold, inverse) : detail::UseSSE2() ? SSE2::Threshold(src, dst, num, threshold, inverse) : Scalar::Threshold(src, dst, num, threshold, inverse);
+		}
+
+		inline void ARGBtoABGR(const Color* src, Color* dst, size_t num)
+		{
+			detail::UseAVX2() ? AVX2::ARGBtoABGR(src, dst, num) : detail::UseSSE2() ? SSE2::ARGBtoABGR(src, dst, num) : Scalar::ARGBtoABGR(src, dst, num);
+		}
+
+		/// <summary>
+		/// Image 全体にカーネルを適用します。
+		/// </summary>
+		/// <param name="src">
+		/// 入力画像
+		/// </param>
+		/// <param name="dst">
+		/// 出力画像
+		/// </param>
+		/// <param name="kernel">
+		/// (src, dst, num) を引数にとるカーネル
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		template <class Kernel>
+		inline void Apply(const Image& src, Image& dst, Kernel kernel)
+		{
+			if (&src != &dst)
+			{
+				dst.resize(src.size);
+			}
+
+			if (src.isEmpty)
+			{
+				return;
+			}
+
+			kernel(src[0], dst[0], static_cast<size_t>(src.num_pixels));
+		}
+	}
+}
@@ -0,0 +1,350 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cstring>
+# include "Fwd.hpp"
+# include "PropertyMacro.hpp"
+# include "Array.hpp"
+# include "Optional.hpp"
+# include "Image.hpp"
+# include "ImageKernels.hpp"
+# include "ParallelImaging.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// 画像処理を遅延評価するパイプライン
+	/// </summary>
+	/// <remarks>
+	/// 記録したピクセル単位の処理は、出力の行ごとに 1 回のパスにまとめて実行されます。
+	/// 反転と回転は中間画像を作らず、読み出し位置の変換として実行されます。
+	/// 元の画像は execute() が終わるまで有効である必要があります。
+	/// </remarks>
+	class ImagePipeline
+	{
+	private:
+
+		struct Stage
+		{
+			std::function<void(Color*, size_t)> kernel;
+
+			// RGB 各成分に独立に作用する処理の場合のみ有効
+			Optional<ImageKernels::LUT> lut;
+		};
+
+		// 出力座標 (x, y) から入力座標への変換: (m11 * x + m12 * y + ox, m21 * x + m22 * y + oy)
+		struct Remap
+		{
+			int32 m11 = 1, m12 = 0, m21 = 0, m22 = 1;
+
+			int32 ox = 0, oy = 0;
+		};
+
+		const Image* m_source;
+
+		Array<Stage> m_stages;
+
+		Remap m_remap;
+
+		Size m_size;
+
+		ImagePipeline& addChannelStage(std::function<void(Color*, size_t)> kernel, const ImageKernels::LUT& lut)
+		{
+			m_stages.push_back({ std::move(kernel), lut });
+
+			return *this;
+		}
+
+		ImagePipeline& addStage(std::function<void(Color*, size_t)> kernel)
+		{
+			m_stages.push_back({ std::move(kernel), none });
+
+			return *this;
+		}
+
+		// 新しい出力座標 p' から直前の出力座標 p への変換 p = B * p' + d を合成する
+		ImagePipeline& addRemap(int32 b11, int32 b12, int32 b21, int32 b22, int32 dx, int32 dy, bool swapSize)
+		{
+			const Remap a = m_remap;
+
+			m_remap.m11 = a.m11 * b11 + a.m12 * b21;
+			m_remap.m12 = a.m11 * b12 + a.m12 * b22;
+			m_remap.m21 = a.m21 * b11 + a.m22 * b21;
+			m_remap.m22 = a.m21 * b12 + a.m22 * b22;
+			m_remap.ox = a.m11 * dx + a.m12 * dy + a.ox;
+			m_remap.oy = a.m21 * dx + a.m22 * dy + a.oy;
+
+			if (swapSize)
+			{
+				std::swap(m_size.x, m_size.y);
+			}
+
+			return *this;
+		}
+
+		// 連続する成分ごとの処理を 1 つの LUT にまとめる
+		Array<std::function<void(Color*, size_t)>> compile() const
+		{
+			Array<std::function<void(Color*, size_t)>> kernels;
+
+			for (size_t i = 0; i < m_stages.size();)
+			{
+				size_t last = i;
+
+				while (last < m_stages.size() && m_stages[last].lut)
+				{
+					++last;
+				}
+
+				if (last - i >= 2)
+				{
+					ImageKernels::LUT table = *m_stages[i].lut;
+
+					for (size_t k = i + 1; k < last; ++k)
+					{
+						const ImageKernels::LUT& next = *m_stages[k].lut;
+
+						for (auto& value : table)
+						{
+							value = next[value];
+						}
+					}
+
+					kernels.push_back([table](Color* pixels, size_t num)
+					{
+						ImageKernels::ApplyLUT(pixels, pixels, num, table);
+					});
+
+					i = last;
+				}
+				else
+				{
+					kernels.push_back(m_stages[i].kernel);
+
+					++i;
+				}
+			}
+
+			return kernels;
+		}
+
+	public:
+
+		/// <summary>
+		/// パイプラインを作成します。
+		/// </summary>
+		/// <param name="image">
+		/// 元の画像
+		/// </param>
+		explicit ImagePipeline(const Image& image)
+			: m_source(&image)
+			, m_size(image.size) {}
+
+		/// <summary>
+		/// 処理後の画像のサイズ
+		/// </summary>
+		Property_Get(Size, size) const { return m_size; }
+
+		ImagePipeline& negate()
+		{
+			ImageKernels::LUT lut;
+
+			for (size_t i = 0; i < 256; ++i)
+			{
+				lut[i] = static_cast<uint8>(255 - i);
+			}
+
+			return addChannelStage([](Color* pixels, size_t num) { ImageKernels::Negate(pixels, pixels, num); }, lut);
+		}
+
+		ImagePipeline& grayscale()
+		{
+			return addStage([](Color* pixels, size_t num) { ImageKernels::Grayscale(pixels, pixels, num); });
+		}
+
+		ImagePipeline& sepia(int32 level = 25)
+		{
+			return addStage([=](Color* pixels, size_t num) { ImageKernels::Sepia(pixels, pixels, num, level); });
+		}
+
+		ImagePipeline& postarize(int32 level)
+		{
+			const ImageKernels::LUT lut = ImageKernels::MakePostarizeLUT(level);
+
+			return addChannelStage([=](Color* pixels, size_t num) { ImageKernels::ApplyLUT(pixels, pixels, num, lut); }, lut);
+		}
+
+		ImagePipeline& brighten(int32 level)
+		{
+			ImageKernels::LUT lut;
+
+			for (size_t i = 0; i < 256; ++i)
+			{
+				lut[i] = static_cast<uint8>(Clamp(static_cast<int32>(i) + level, 0, 255));
+			}
+
+			return addChannelStage([=](Color* pixels, size_t num) { ImageKernels::Brighten(pixels, pixels, num, level); }, lut);
+		}
+
+		ImagePipeline& gammaCorrect(double gamma)
+		{
+			const ImageKernels::LUT lut = ImageKernels::MakeGammaLUT(gamma);
+
+			return addChannelStage([=](Color* pixels, size_t num) { ImageKernels::ApplyLUT(pixels, pixels, num, lut); }, lut);
+		}
+
+		ImagePipeline& threshold(uint8 threshold, bool inverse = false)
+		{
+			return addStage([=](Color* pixels, size_t num) { ImageKernels::Threshold(pixels, pixels, num, threshold, inverse); });
+		}
+
+		ImagePipeline& ARGBtoABGR()
+		{
+			return addStage([](Color* pixels, size_t num) { ImageKernels::ARGBtoABGR(pixels, pixels, num); });
+		}
+
+		/// <summary>
+		/// 上下を反転します。
+		/// </summary>
+		ImagePipeline& flip()
+		{
+			return addRemap(1, 0, 0, -1, 0, m_size.y - 1, false);
+		}
+
+		/// <summary>
+		/// 左右を反転します。
+		/// </summary>
+		ImagePipeline& mirror()
+		{
+			return addRemap(-1, 0, 0, 1, m_size.x - 1, 0, false);
+		}
+
+		/// <summary>
+		/// 時計回りに 90° 回転します。
+		/// </summary>
+		ImagePipeline& rotate90()
+		{
+			return addRemap(0, 1, -1, 0, 0, m_size.y - 1, true);
+		}
+
+		/// <summary>
+		/// 180° 回転します。
+		/// </summary>
+		ImagePipeline& rotate180()
+		{
+			return addRemap(-1, 0, 0, -1, m_size.x - 1, m_size.y - 1, false);
+		}
+
+		/// <summary>
+		/// 反時計回りに 90° 回転します。
+		/// </summary>
+		ImagePipeline& rotate270()
+		{
+			return addRemap(0, -1, 1, 0, m_size.x - 1, 0, true);
+		}
+
+		/// <summary>
+		/// 記録した処理を実行して、結果を dst に書き込みます。
+		/// </summary>
+		/// <param name="dst">
+		/// 出力先の画像。元の画像と同じでもかまいません。
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void execute(Image& dst) const
+		{
+			if (&dst == m_source)
+			{
+				Image result;
+
+				execute(result);
+
+				dst.swap(result);
+
+				return;
+			}
+
+			const Image& src = *m_source;
+
+			dst.resize(m_size);
+
+			if (src.isEmpty)
+			{
+				return;
+			}
+
+			const auto kernels = compile();
+
+			const int32 width = m_size.x;
+
+			const int32 srcWidth = src.width;
+
+			const Color* const srcPixels = src[0];
+
+			const int32 step = m_remap.m11 + m_remap.m21 * srcWidth;
+
+			const int32 bandRows = std::max<int32>(1, static_cast<int32>(ImageTileScheduler::DefaultBandBytes / dst.stride));
+
+			const size_t numBands = (m_size.y + bandRows - 1) / bandRows;
+
+			Threading::GetPool()->parallelFor(0, numBands, [&](size_t band)
+			{
+				const int32 y0 = static_cast<int32>(band) * bandRows;
+
+				const int32 y1 = std::min(y0 + bandRows, m_size.y);
+
+				for (int32 y = y0; y < y1; ++y)
+				{
+					Color* const out = dst[y];
+
+					const int32 sx = m_remap.m12 * y + m_remap.ox;
+
+					const int32 sy = m_remap.m22 * y + m_remap.oy;
+
+					const Color* in = srcPixels + (sy * srcWidth + sx);
+
+					if (step == 1)
+					{
+						std::memcpy(out, in, width * sizeof(Color));
+					}
+					else
+					{
+						for (int32 x = 0; x < width; ++x, in += step)
+						{
+							out[x] = *in;
+						}
+					}
+
+					for (const auto& kernel : kernels)
+					{
+						kernel(out, width);
+					}
+				}
+			});
+		}
+
+		/// <summary>
+		/// 記録した処理を実行した新しい画像を返します。
+		/// </summary>
+		/// <returns>
+		/// 処理後の画像
+		/// </returns>
+		Image execute() const
+		{
+			Image result;
+
+			execute(result);
+
+			return result;
+		}
+	};
+}
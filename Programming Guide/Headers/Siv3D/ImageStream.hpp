@@ -0,0 +1,1244 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cstdio>
+# include <memory>
+# include <limits>
+# include <algorithm>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "Image.hpp"
+# include "IReader.hpp"
+# include "IWriter.hpp"
+# include "BinaryReader.hpp"
+# include "BinaryWriter.hpp"
+# include "FileSystem.hpp"
+
+namespace s3d
+{
+	namespace detail
+	{
+		inline uint32 LoadLE16(const uint8* p)
+		{
+			return p[0] | (p[1] << 8);
+		}
+
+		inline uint32 LoadLE32(const uint8* p)
+		{
+			return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32>(p[3]) << 24);
+		}
+
+		inline void StoreLE16(uint8* p, uint32 value)
+		{
+			p[0] = static_cast<uint8>(value);
+			p[1] = static_cast<uint8>(value >> 8);
+		}
+
+		inline void StoreLE32(uint8* p, uint32 value)
+		{
+			p[0] = static_cast<uint8>(value);
+			p[1] = static_cast<uint8>(value >> 8);
+			p[2] = static_cast<uint8>(value >> 16);
+			p[3] = static_cast<uint8>(value >> 24);
+		}
+
+		// BMP の BI_BITFIELDS のマスク 1 つ分
+		struct BitfieldChannel
+		{
+			uint32 mask = 0;
+
+			uint32 shift = 0;
+
+			uint32 max = 0;
+
+			void set(uint32 m)
+			{
+				mask = m;
+
+				shift = 0;
+
+				max = 0;
+
+				if (!m)
+				{
+					return;
+				}
+
+				while (!((m >> shift) & 1))
+				{
+					++shift;
+				}
+
+				max = m >> shift;
+			}
+
+			uint32 extract(uint32 pixel, uint32 defaultValue) const
+			{
+				if (!mask)
+				{
+					return defaultValue;
+				}
+
+				const uint32 value = (pixel & mask) >> shift;
+
+				return (max == 255) ? value : static_cast<uint32>((static_cast<uint64>(value) * 255 + max / 2) / max);
+			}
+		};
+	}
+
+	/// <summary>
+	/// 画像ファイルを 1 行ずつ読み込むクラス
+	/// </summary>
+	/// <remarks>
+	/// 画像全体をメモリに展開しないため、Image::MaxSize を超える大きさの画像も読み込めます。
+	/// 行単位で読み書きできる無圧縮の形式に対応しています。
+	/// BMP は 24 ビットと 32 ビット（BI_RGB, BI_BITFIELDS）、PPM は P5 と P6 を読み込めます。
+	/// ボトムアップの BMP は行の位置を IReader::read(buffer, pos, size) で指定して読み込みます。
+	/// PNG, JPEG などの圧縮された形式には対応しておらず、open() は失敗します。それらの形式は Image で読み込んでください。
+	/// </remarks>
+	class ImageStreamReader
+	{
+	private:
+
+		std::shared_ptr<IReader> m_reader;
+
+		ImageFormat m_format = ImageFormat::Unknown;
+
+		Size m_size = { 0, 0 };
+
+		// 最初の行のファイル上の位置と、1 行のバイト数
+		int64 m_dataOffset = 0;
+
+		int64 m_stride = 0;
+
+		uint32 m_bytesPerPixel = 0;
+
+		bool m_bottomUp = false;
+
+		// PPM の最大値。0 の場合は BMP
+		uint32 m_maxValue = 0;
+
+		detail::BitfieldChannel m_channels[4];
+
+		int32 m_row = 0;
+
+		Array<uint8> m_buffer;
+
+		bool readBMPHeader()
+		{
+			uint8 header[70] = {};
+
+			if (m_reader->read(header, 0, 54) != 54 || header[0] != 'B' || header[1] != 'M')
+			{
+				return false;
+			}
+
+			const uint32 dataOffset = detail::LoadLE32(header + 10);
+			const uint32 infoSize = detail::LoadLE32(header + 14);
+			const int32 width = static_cast<int32>(detail::LoadLE32(header + 18));
+			const int32 height = static_cast<int32>(detail::LoadLE32(header + 22));
+			const uint32 bitCount = detail::LoadLE16(header + 28);
+			const uint32 compression = detail::LoadLE32(header + 30);
+
+			// BI_RGB = 0, BI_BITFIELDS = 3
+			if (infoSize < 40 || width <= 0 || height == 0 || height == std::numeric_limits<int32>::min()
+				|| !(bitCount == 24 || bitCount == 32) || !(compression == 0 || (compression == 3 && bitCount == 32)))
+			{
+				return false;
+			}
+
+			if (compression == 3)
+			{
+				// マスクは BITMAPINFOHEADER の直後、V4 以降のヘッダでは内部の同じ位置にある。アルファのマスクは V3 以降のみ
+				const int64 maskSize = (infoSize >= 56) ? 16 : 12;
+
+				if (m_reader->read(header + 54, 54, maskSize) != maskSize)
+				{
+					return false;
+				}
+
+				for (size_t i = 0; i < 4; ++i)
+				{
+					m_channels[i].set(i * 4 < static_cast<size_t>(maskSize) ? detail::LoadLE32(header + 54 + i * 4) : 0);
+				}
+
+				if (!m_channels[0].mask || !m_channels[1].mask || !m_channels[2].mask)
+				{
+					return false;
+				}
+			}
+			else if (bitCount == 32)
+			{
+				// BI_RGB の 32 ビットの上位 8 ビットは使われないので、アルファは 255 にする
+				m_channels[0].set(0x00FF0000);
+				m_channels[1].set(0x0000FF00);
+				m_channels[2].set(0x000000FF);
+				m_channels[3].set(0);
+			}
+
+			m_size.set(width, height < 0 ? -height : height);
+			m_bottomUp = (height > 0);
+			m_bytesPerPixel = bitCount / 8;
+			m_stride = ((static_cast<int64>(width) * bitCount + 31) / 32) * 4;
+			m_dataOffset = dataOffset;
+
+			return true;
+		}
+
+		bool readPPMToken(uint32& value)
+		{
+			uint8 c = 0;
+
+			// 空白とコメントを読み飛ばす
+			for (;;)
+			{
+				if (m_reader->read(&c, 1) != 1)
+				{
+					return false;
+				}
+
+				if (c == '#')
+				{
+					while (c != '\n' && c != '\r')
+					{
+						if (m_reader->read(&c, 1) != 1)
+						{
+							return false;
+						}
+					}
+				}
+				else if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+				{
+					break;
+				}
+			}
+
+			value = 0;
+
+			while ('0' <= c && c <= '9')
+			{
+				value = value * 10 + (c - '0');
+
+				if (value > 0xFFFFFF)
+				{
+					return false;
+				}
+
+				if (m_reader->read(&c, 1) != 1)
+				{
+					return false;
+				}
+			}
+
+			// 数値の直後の空白 1 文字まで読む。最大値の場合はその次から画素が始まる
+			return (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+		}
+
+		bool readPPMHeader()
+		{
+			uint8 magic[2];
+
+			if (m_reader->read(magic, 0, 2) != 2 || magic[0] != 'P' || !(magic[1] == '5' || magic[1] == '6'))
+			{
+				return false;
+			}
+
+			if (!m_reader->setPos(2))
+			{
+				return false;
+			}
+
+			uint32 width, height, maxValue;
+
+			if (!readPPMToken(width) || !readPPMToken(height) || !readPPMToken(maxValue)
+				|| width == 0 || height == 0 || maxValue == 0 || maxValue > 65535
+				|| width > static_cast<uint32>(std::numeric_limits<int32>::max()) || height > static_cast<uint32>(std::numeric_limits<int32>::max()))
+			{
+				return false;
+			}
+
+			const uint32 channels = (magic[1] == '6') ? 3 : 1;
+
+			m_size.set(static_cast<int32>(width), static_cast<int32>(height));
+			m_bottomUp = false;
+			m_bytesPerPixel = channels * (maxValue < 256 ? 1 : 2);
+			m_stride = static_cast<int64>(width) * m_bytesPerPixel;
+			m_dataOffset = m_reader->getPos();
+			m_maxValue = maxValue;
+
+			return true;
+		}
+
+		uint32 ppmSample(const uint8* p) const
+		{
+			const uint32 value = (m_maxValue < 256) ? p[0] : ((p[0] << 8) | p[1]);
+
+			return (m_maxValue == 255) ? value : (std::min(value, m_maxValue) * 255 + m_maxValue / 2) / m_maxValue;
+		}
+
+		void convertRow(Color* dst) const
+		{
+			const uint8* src = m_buffer.data();
+
+			if (m_format == ImageFormat::PPM)
+			{
+				const uint32 sampleSize = (m_maxValue < 256) ? 1 : 2;
+
+				for (int32 x = 0; x < m_size.x; ++x, src += m_bytesPerPixel)
+				{
+					if (m_bytesPerPixel == sampleSize)
+					{
+						const uint32 v = ppmSample(src);
+
+						dst[x] = Color(v, v, v, 255);
+					}
+					else
+					{
+						dst[x] = Color(ppmSample(src), ppmSample(src + sampleSize), ppmSample(src + sampleSize * 2), 255);
+					}
+				}
+			}
+			else if (m_bytesPerPixel == 3)
+			{
+				for (int32 x = 0; x < m_size.x; ++x, src += 3)
+				{
+					dst[x] = Color(src[2], src[1], src[0], 255);
+				}
+			}
+			else
+			{
+				for (int32 x = 0; x < m_size.x; ++x, src += 4)
+				{
+					const uint32 pixel = detail::LoadLE32(src);
+
+					dst[x] = Color(m_channels[0].extract(pixel, 0), m_channels[1].extract(pixel, 0), m_channels[2].extract(pixel, 0), m_channels[3].extract(pixel, 255));
+				}
+			}
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		ImageStreamReader() = default;
+
+		/// <summary>
+		/// 画像ファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <param name="format">
+		/// 画像のフォーマット。ImageFormat::Unspecified の場合、ファイルの先頭から判断します。
+		/// </param>
+		explicit ImageStreamReader(const FilePath& path, ImageFormat format = ImageFormat::Unspecified)
+		{
+			open(path, format);
+		}
+
+		/// <summary>
+		/// 画像ファイルを開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		/// <param name="format">
+		/// 画像のフォーマット。ImageFormat::Unspecified の場合、データの先頭から判断します。
+		/// </param>
+		template <class Reader, class = std::enable_if_t<std::is_base_of<IReader, Reader>::value>>
+		explicit ImageStreamReader(Reader&& reader, ImageFormat format = ImageFormat::Unspecified)
+		{
+			open(std::move(reader), format);
+		}
+
+		/// <summary>
+		/// 画像ファイルを開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		/// <param name="format">
+		/// 画像のフォーマット。ImageFormat::Unspecified の場合、データの先頭から判断します。
+		/// </param>
+		explicit ImageStreamReader(const std::shared_ptr<IReader>& reader, ImageFormat format = ImageFormat::Unspecified)
+		{
+			open(reader, format);
+		}
+
+		/// <summary>
+		/// 画像ファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <param name="format">
+		/// 画像のフォーマット。ImageFormat::Unspecified の場合、ファイルの先頭から判断します。
+		/// </param>
+		/// <returns>
+		/// ファイルのオープンに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const FilePath& path, ImageFormat format = ImageFormat::Unspecified)
+		{
+			return open(std::make_shared<BinaryReader>(path), format);
+		}
+
+		/// <summary>
+		/// 画像ファイルを開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		/// <param name="format">
+		/// 画像のフォーマット。ImageFormat::Unspecified の場合、データの先頭から判断します。
+		/// </param>
+		/// <returns>
+		/// ファイルのオープンに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		template <class Reader, class = std::enable_if_t<std::is_base_of<IReader, Reader>::value>>
+		bool open(Reader&& reader, ImageFormat format = ImageFormat::Unspecified)
+		{
+			return open(std::make_shared<Reader>(std::move(reader)), format);
+		}
+
+		/// <summary>
+		/// 画像ファイルを開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		/// <param name="format">
+		/// 画像のフォーマット。ImageFormat::Unspecified の場合、データの先頭から判断します。
+		/// </param>
+		/// <returns>
+		/// ファイルのオープンに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const std::shared_ptr<IReader>& reader, ImageFormat format = ImageFormat::Unspecified)
+		{
+			close();
+
+			if (!reader || !reader->isOpened())
+			{
+				return false;
+			}
+
+			m_reader = reader;
+
+			if (format == ImageFormat::Unspecified)
+			{
+				uint8 magic[2] = {};
+
+				m_reader->read(magic, 0, 2);
+
+				format = (magic[0] == 'B' && magic[1] == 'M') ? ImageFormat::BMP
+					: (magic[0] == 'P' && (magic[1] == '5' || magic[1] == '6')) ? ImageFormat::PPM : ImageFormat::Unknown;
+			}
+
+			const bool succeeded = (format == ImageFormat::BMP) ? readBMPHeader()
+				: (format == ImageFormat::PPM) ? readPPMHeader() : false;
+
+			if (!succeeded)
+			{
+				close();
+
+				return false;
+			}
+
+			m_format = format;
+
+			m_buffer.resize(static_cast<size_t>(m_stride));
+
+			return true;
+		}
+
+		/// <summary>
+		/// 画像ファイルをクローズします。
+		/// </summary>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void close()
+		{
+			m_reader.reset();
+
+			m_format = ImageFormat::Unknown;
+
+			m_size.set(0, 0);
+
+			m_maxValue = 0;
+
+			m_row = 0;
+
+			m_buffer.clear();
+		}
+
+		/// <summary>
+		/// 画像ファイルがオープンされているかを返します。
+		/// </summary>
+		/// <returns>
+		/// ファイルがオープンされている場合 true, それ以外の場合は false
+		/// </returns>
+		bool isOpened() const
+		{
+			return m_format != ImageFormat::Unknown;
+		}
+
+		/// <summary>
+		/// 画像ファイルがオープンされているかを返します。
+		/// </summary>
+		/// <returns>
+		/// ファイルがオープンされている場合 true, それ以外の場合は false
+		/// </returns>
+		explicit operator bool() const { return isOpened(); }
+
+		/// <summary>
+		/// 画像のフォーマットを返します。
+		/// </summary>
+		/// <returns>
+		/// 画像のフォーマット
+		/// </returns>
+		ImageFormat format() const
+		{
+			return m_format;
+		}
+
+		/// <summary>
+		/// 画像の幅と高さ（ピクセル）を返します。
+		/// </summary>
+		/// <returns>
+		/// 画像の幅と高さ（ピクセル）
+		/// </returns>
+		Size size() const
+		{
+			return m_size;
+		}
+
+		/// <summary>
+		/// 次に読み込む行の位置を返します。
+		/// </summary>
+		/// <returns>
+		/// 次に読み込む行の位置
+		/// </returns>
+		int32 currentRow() const
+		{
+			return m_row;
+		}
+
+		/// <summary>
+		/// 画像を最大 rows 行読み込みます。
+		/// </summary>
+		/// <param name="dst">
+		/// 読み込み先。幅 × rows 個の Color を書き込めるバッファ
+		/// </param>
+		/// <param name="rows">
+		/// 読み込む行数
+		/// </param>
+		/// <returns>
+		/// 実際に読み込んだ行数
+		/// </returns>
+		int32 readRows(Color* dst, int32 rows)
+		{
+			int32 count = 0;
+
+			for (; isOpened() && count < rows && m_row < m_size.y; ++count, ++m_row, dst += m_size.x)
+			{
+				const int64 row = m_bottomUp ? (m_size.y - 1 - m_row) : m_row;
+
+				if (m_reader->read(m_buffer.data(), m_dataOffset + row * m_stride, m_stride) != m_stride)
+				{
+					break;
+				}
+
+				convertRow(dst);
+			}
+
+			return count;
+		}
+
+		/// <summary>
+		/// 画像を 1 行読み込みます。
+		/// </summary>
+		/// <param name="dst">
+		/// 読み込み先。幅の数の Color を書き込めるバッファ
+		/// </param>
+		/// <returns>
+		/// 読み込みに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool readRow(Color* dst)
+		{
+			return readRows(dst, 1) == 1;
+		}
+	};
+
+	/// <summary>
+	/// 画像ファイルを 1 行ずつ書き出すクラス
+	/// </summary>
+	/// <remarks>
+	/// 対応している形式は BMP（32 ビット、アルファ付きの BI_BITFIELDS、トップダウン）と PPM（P6、アルファは失われます）です。
+	/// PNG, JPEG などの圧縮された形式には対応していません。
+	/// ヘッダは開いたときに書き込むので、IWriter の書き込み位置を戻す必要はありません。
+	/// BMP はファイルサイズが 4 GiB 未満になる大きさまで書き出せます。
+	/// すべての行を書き込んだあと close() を呼ぶと、画像ファイルが完成します。
+	/// </remarks>
+	class ImageStreamWriter
+	{
+	private:
+
+		std::shared_ptr<IWriter> m_writer;
+
+		ImageFormat m_format = ImageFormat::Unknown;
+
+		Size m_size = { 0, 0 };
+
+		int32 m_row = 0;
+
+		bool m_failed = false;
+
+		Array<uint8> m_buffer;
+
+		bool writeBytes(const void* data, size_t size)
+		{
+			if (!m_failed && m_writer->write(data, size) != size)
+			{
+				m_failed = true;
+			}
+
+			return !m_failed;
+		}
+
+		bool writeBMPHeader()
+		{
+			constexpr uint32 headerSize = 14 + 108;
+
+			const uint64 fileSize = headerSize + static_cast<uint64>(m_size.x) * m_size.y * 4;
+
+			if (fileSize > std::numeric_limits<uint32>::max())
+			{
+				return false;
+			}
+
+			uint8 header[headerSize] = {};
+
+			header[0] = 'B';
+			header[1] = 'M';
+			detail::StoreLE32(header + 2, static_cast<uint32>(fileSize));
+			detail::StoreLE32(header + 10, headerSize);
+
+			// BITMAPV4HEADER。高さが負の値のときはトップダウン
+			detail::StoreLE32(header + 14, 108);
+			detail::StoreLE32(header + 18, static_cast<uint32>(m_size.x));
+			detail::StoreLE32(header + 22, static_cast<uint32>(-m_size.y));
+			detail::StoreLE16(header + 26, 1);
+			detail::StoreLE16(header + 28, 32);
+			detail::StoreLE32(header + 30, 3);
+			detail::StoreLE32(header + 34, static_cast<uint32>(fileSize - headerSize));
+			detail::StoreLE32(header + 38, 2835);
+			detail::StoreLE32(header + 42, 2835);
+			detail::StoreLE32(header + 54, 0x00FF0000);
+			detail::StoreLE32(header + 58, 0x0000FF00);
+			detail::StoreLE32(header + 62, 0x000000FF);
+			detail::StoreLE32(header + 66, 0xFF000000);
+			// LCS_sRGB
+			detail::StoreLE32(header + 70, 0x73524742);
+
+			return writeBytes(header, sizeof(header));
+		}
+
+		bool writePPMHeader()
+		{
+			char header[64];
+
+			const int length = std::snprintf(header, sizeof(header), "P6\n%d %d\n255\n", m_size.x, m_size.y);
+
+			return writeBytes(header, static_cast<size_t>(length));
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		ImageStreamWriter() = default;
+
+		/// <summary>
+		/// 画像ファイルを作成します。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <param name="size">
+		/// 画像の幅と高さ（ピクセル）
+		/// </param>
+		/// <param name="format">
+		/// 画像のフォーマット。ImageFormat::Unspecified の場合、拡張子から自動で判断します。
+		/// </param>
+		ImageStreamWriter(const FilePath& path, const Size& size, ImageFormat format = ImageFormat::Unspecified)
+		{
+			open(path, size, format);
+		}
+
+		/// <summary>
+		/// 画像を Writer に書き出す準備をします。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <param name="size">
+		/// 画像の幅と高さ（ピクセル）
+		/// </param>
+		/// <param name="format">
+		/// 画像のフォーマット
+		/// </param>
+		ImageStreamWriter(const std::shared_ptr<IWriter>& writer, const Size& size, ImageFormat format)
+		{
+			open(writer, size, format);
+		}
+
+		ImageStreamWriter(const ImageStreamWriter&) = delete;
+
+		ImageStreamWriter& operator =(const ImageStreamWriter&) = delete;
+
+		/// <summary>
+		/// デストラクタ
+		/// </summary>
+		/// <remarks>
+		/// close() されていない場合は close() を呼びます。
+		/// </remarks>
+		~ImageStreamWriter()
+		{
+			close();
+		}
+
+		/// <summary>
+		/// 画像ファイルを作成します。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <param name="size">
+		/// 画像の幅と高さ（ピクセル）
+		/// </param>
+		/// <param name="format">
+		/// 画像のフォーマット。ImageFormat::Unspecified の場合、拡張子から自動で判断します。
+		/// </param>
+		/// <returns>
+		/// ファイルの作成に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const FilePath& path, const Size& size, ImageFormat format = ImageFormat::Unspecified)
+		{
+			if (format == ImageFormat::Unspecified)
+			{
+				const String extension = FileSystem::Extension(path);
+
+				format = (extension == L"bmp") ? ImageFormat::BMP
+					: (extension == L"ppm" || extension == L"pnm") ? ImageFormat::PPM : ImageFormat::Unknown;
+			}
+
+			if (format != ImageFormat::BMP && format != ImageFormat::PPM)
+			{
+				close();
+
+				return false;
+			}
+
+			return open(std::make_shared<BinaryWriter>(path), size, format);
+		}
+
+		/// <summary>
+		/// 画像を Writer に書き出す準備をします。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <param name="size">
+		/// 画像の幅と高さ（ピクセル）
+		/// </param>
+		/// <param name="format">
+		/// 画像のフォーマット。ImageFormat::BMP または ImageFormat::PPM
+		/// </param>
+		/// <returns>
+		/// ヘッダの書き込みに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const std::shared_ptr<IWriter>& writer, const Size& size, ImageFormat format)
+		{
+			close();
+
+			if (!writer || !writer->isOpened() || size.x <= 0 || size.y <= 0
+				|| (format != ImageFormat::BMP && format != ImageFormat::PPM))
+			{
+				return false;
+			}
+
+			m_writer = writer;
+
+			m_format = format;
+
+			m_size = size;
+
+			m_failed = false;
+
+			if (!((format == ImageFormat::BMP) ? writeBMPHeader() : writePPMHeader()))
+			{
+				m_writer.reset();
+
+				m_format = ImageFormat::Unknown;
+
+				return false;
+			}
+
+			m_buffer.resize(static_cast<size_t>(size.x) * (format == ImageFormat::BMP ? 4 : 3));
+
+			return true;
+		}
+
+		/// <summary>
+		/// 画像の書き出しを完了します。
+		/// </summary>
+		/// <returns>
+		/// すべての行が書き込まれ、画像ファイルが完成した場合 true, それ以外の場合は false
+		/// </returns>
+		bool close()
+		{
+			if (!m_writer)
+			{
+				return false;
+			}
+
+			const bool completed = !m_failed && (m_row == m_size.y);
+
+			m_writer.reset();
+
+			m_format = ImageFormat::Unknown;
+
+			m_size.set(0, 0);
+
+			m_row = 0;
+
+			m_buffer.clear();
+
+			return completed;
+		}
+
+		/// <summary>
+		/// 画像を書き出す準備ができているかを返します。
+		/// </summary>
+		/// <returns>
+		/// 開いていて、書き込みに失敗していない場合 true, それ以外の場合は false
+		/// </returns>
+		bool isOpened() const
+		{
+			return m_writer && !m_failed;
+		}
+
+		explicit operator bool() const { return isOpened(); }
+
+		/// <summary>
+		/// 画像のフォーマットを返します。
+		/// </summary>
+		/// <returns>
+		/// 画像のフォーマット
+		/// </returns>
+		ImageFormat format() const
+		{
+			return m_format;
+		}
+
+		/// <summary>
+		/// 画像の幅と高さ（ピクセル）を返します。
+		/// </summary>
+		/// <returns>
+		/// 画像の幅と高さ（ピクセル）
+		/// </returns>
+		Size size() const
+		{
+			return m_size;
+		}
+
+		/// <summary>
+		/// 次に書き込む行の位置を返します。
+		/// </summary>
+		/// <returns>
+		/// 次に書き込む行の位置
+		/// </returns>
+		int32 currentRow() const
+		{
+			return m_row;
+		}
+
+		/// <summary>
+		/// 画像を rows 行書き込みます。
+		/// </summary>
+		/// <param name="src">
+		/// 書き込むデータ。幅 × rows 個の Color
+		/// </param>
+		/// <param name="rows">
+		/// 書き込む行数
+		/// </param>
+		/// <returns>
+		/// 書き込みに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool writeRows(const Color* src, int32 rows)
+		{
+			if (!isOpened() || rows < 0 || rows > m_size.y - m_row)
+			{
+				return false;
+			}
+
+			for (int32 i = 0; i < rows; ++i, ++m_row, src += m_size.x)
+			{
+				uint8* dst = m_buffer.data();
+
+				if (m_format == ImageFormat::BMP)
+				{
+					for (int32 x = 0; x < m_size.x; ++x, dst += 4)
+					{
+						dst[0] = static_cast<uint8>(src[x].b);
+						dst[1] = static_cast<uint8>(src[x].g);
+						dst[2] = static_cast<uint8>(src[x].r);
+						dst[3] = static_cast<uint8>(src[x].a);
+					}
+				}
+				else
+				{
+					for (int32 x = 0; x < m_size.x; ++x, dst += 3)
+					{
+						dst[0] = static_cast<uint8>(src[x].r);
+						dst[1] = static_cast<uint8>(src[x].g);
+						dst[2] = static_cast<uint8>(src[x].b);
+					}
+				}
+
+				if (!writeBytes(m_buffer.data(), m_buffer.size()))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		/// <summary>
+		/// 画像を 1 行書き込みます。
+		/// </summary>
+		/// <param name="src">
+		/// 書き込むデータ。幅の数の Color
+		/// </param>
+		/// <returns>
+		/// 書き込みに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool writeRow(const Color* src)
+		{
+			return writeRows(src, 1);
+		}
+	};
+
+	namespace Imaging
+	{
+		namespace detail
+		{
+			// 出力の 1 画素に寄与する入力の範囲と重み
+			struct ResampleSpan
+			{
+				Array<int32> index;
+
+				Array<double> weight;
+
+				Array<uint32> offset;
+			};
+
+			// 面積平均法の重み。入力 [s * dstLength, (s + 1) * dstLength) と出力 [d * srcLength, (d + 1) * srcLength) の重なりを整数で求める
+			inline ResampleSpan MakeAreaSpan(int32 srcLength, int32 dstLength)
+			{
+				ResampleSpan span;
+
+				span.offset.push_back(0);
+
+				for (int64 d = 0; d < dstLength; ++d)
+				{
+					const int64 begin = d * srcLength;
+					const int64 end = (d + 1) * srcLength;
+
+					for (int64 s = begin / dstLength; s * dstLength < end && s < srcLength; ++s)
+					{
+						const int64 overlap = std::min(end, (s + 1) * dstLength) - std::max(begin, s * dstLength);
+
+						if (overlap > 0)
+						{
+							span.index.push_back(static_cast<int32>(s));
+							span.weight.push_back(static_cast<double>(overlap) / srcLength);
+						}
+					}
+
+					span.offset.push_back(static_cast<uint32>(span.index.size()));
+				}
+
+				return span;
+			}
+
+			// 画素の中心を合わせたバイリニア補間（Nearest の場合は最近傍）の重み
+			inline ResampleSpan MakeLinearSpan(int32 srcLength, int32 dstLength, bool nearest)
+			{
+				ResampleSpan span;
+
+				span.offset.push_back(0);
+
+				const double scale = static_cast<double>(srcLength) / dstLength;
+
+				for (int32 d = 0; d < dstLength; ++d)
+				{
+					if (nearest)
+					{
+						span.index.push_back(std::min(static_cast<int32>((d + 0.5) * scale), srcLength - 1));
+						span.weight.push_back(1.0);
+					}
+					else
+					{
+						const double s = Clamp((d + 0.5) * scale - 0.5, 0.0, srcLength - 1.0);
+						const int32 s0 = static_cast<int32>(s);
+						const int32 s1 = std::min(s0 + 1, srcLength - 1);
+						const double f = s - s0;
+
+						span.index.push_back(s0);
+						span.weight.push_back(1.0 - f);
+						span.index.push_back(s1);
+						span.weight.push_back(f);
+					}
+
+					span.offset.push_back(static_cast<uint32>(span.index.size()));
+				}
+
+				return span;
+			}
+
+			inline ResampleSpan MakeSpan(int32 srcLength, int32 dstLength, Interpolation interpolation)
+			{
+				if (interpolation == Interpolation::Area)
+				{
+					return MakeAreaSpan(srcLength, dstLength);
+				}
+
+				return MakeLinearSpan(srcLength, dstLength, interpolation == Interpolation::Nearest);
+			}
+
+			inline void ResampleRow(const Color* src, const ResampleSpan& span, Array<ColorF>& dst)
+			{
+				for (size_t d = 0; d < dst.size(); ++d)
+				{
+					double r = 0.0, g = 0.0, b = 0.0, a = 0.0;
+
+					for (uint32 i = span.offset[d]; i < span.offset[d + 1]; ++i)
+					{
+						const Color& c = src[span.index[i]];
+						const double w = span.weight[i];
+
+						r += c.r * w; g += c.g * w; b += c.b * w; a += c.a * w;
+					}
+
+					dst[d] = ColorF(r, g, b, a);
+				}
+			}
+
+			inline uint32 ToChannel(double value)
+			{
+				return static_cast<uint32>(Clamp(value + 0.5, 0.0, 255.0));
+			}
+		}
+
+		/// <summary>
+		/// 画像を 1 行ずつ読み込みながら拡大縮小し、1 行ずつ書き出します。
+		/// </summary>
+		/// <param name="reader">
+		/// 入力画像
+		/// </param>
+		/// <param name="writer">
+		/// 出力画像。writer.size() が拡大縮小後の大きさになります。
+		/// </param>
+		/// <param name="interpolation">
+		/// 拡大縮小の手法。Nearest, Linear, Area に対応し、Cubic と Lanczos は Linear として扱います。
+		/// Unspecified の場合、縮小では Area を、それ以外では Linear を使います。
+		/// </param>
+		/// <remarks>
+		/// 使用するメモリは入力と出力の幅に比例し、画像の高さには依存しません。
+		/// 大きさが同じ場合は形式の変換になります。
+		/// </remarks>
+		/// <returns>
+		/// 成功した場合 true, それ以外の場合は false
+		/// </returns>
+		inline bool Scale(ImageStreamReader& reader, ImageStreamWriter& writer, Interpolation interpolation = Interpolation::Unspecified)
+		{
+			if (!reader || !writer)
+			{
+				return false;
+			}
+
+			const Size srcSize = reader.size();
+
+			const Size dstSize = writer.size();
+
+			if (srcSize.x <= 0 || srcSize.y <= 0 || dstSize.x <= 0 || dstSize.y <= 0)
+			{
+				return false;
+			}
+
+			if (interpolation == Interpolation::Unspecified)
+			{
+				interpolation = (dstSize.x <= srcSize.x && dstSize.y <= srcSize.y) ? Interpolation::Area : Interpolation::Linear;
+			}
+
+			const detail::ResampleSpan spanX = detail::MakeSpan(srcSize.x, dstSize.x, interpolation);
+
+			const detail::ResampleSpan spanY = detail::MakeSpan(srcSize.y, dstSize.y, interpolation);
+
+			Array<Color> srcRow(srcSize.x);
+
+			Array<Color> dstRow(dstSize.x);
+
+			Array<ColorF> accumulated(dstSize.x);
+
+			// 水平方向に縮小済みの入力行のキャッシュ。縦方向の窓は入力の行順に前進する
+			Array<Array<ColorF>> window;
+
+			int32 windowBegin = 0;
+
+			int32 rowsRead = 0;
+
+			for (int32 d = 0; d < dstSize.y; ++d)
+			{
+				const uint32 first = spanY.offset[d];
+
+				const uint32 last = spanY.offset[d + 1];
+
+				const int32 needBegin = spanY.index[first];
+
+				const int32 needEnd = spanY.index[last - 1] + 1;
+
+				while (windowBegin < needBegin && !window.empty())
+				{
+					window.erase(window.begin());
+
+					++windowBegin;
+				}
+
+				if (window.empty())
+				{
+					windowBegin = std::max(windowBegin, needBegin);
+				}
+
+				while (rowsRead < needEnd)
+				{
+					if (!reader.readRow(srcRow.data()))
+					{
+						return false;
+					}
+
+					if (rowsRead >= windowBegin)
+					{
+						Array<ColorF> row(dstSize.x);
+
+						detail::ResampleRow(srcRow.data(), spanX, row);
+
+						window.push_back(std::move(row));
+					}
+
+					++rowsRead;
+				}
+
+				for (auto& c : accumulated)
+				{
+					c = ColorF(0.0, 0.0, 0.0, 0.0);
+				}
+
+				for (uint32 i = first; i < last; ++i)
+				{
+					const Array<ColorF>& row = window[spanY.index[i] - windowBegin];
+
+					const double w = spanY.weight[i];
+
+					for (int32 x = 0; x < dstSize.x; ++x)
+					{
+						accumulated[x].r += row[x].r * w;
+						accumulated[x].g += row[x].g * w;
+						accumulated[x].b += row[x].b * w;
+						accumulated[x].a += row[x].a * w;
+					}
+				}
+
+				for (int32 x = 0; x < dstSize.x; ++x)
+				{
+					const ColorF& c = accumulated[x];
+
+					dstRow[x] = Color(detail::ToChannel(c.r), detail::ToChannel(c.g), detail::ToChannel(c.b), detail::ToChannel(c.a));
+				}
+
+				if (!writer.writeRow(dstRow.data()))
+				{
+					return false;
+				}
+			}
+
+			return writer.close();
+		}
+
+		/// <summary>
+		/// 縦横比を保ったまま、指定した範囲に収まる大きさを返します。
+		/// </summary>
+		inline Size FitSize(const Size& size, int32 width, int32 height, bool scaleUp = true)
+		{
+			if (size.x <= 0 || size.y <= 0)
+			{
+				return{ 0, 0 };
+			}
+
+			if (!scaleUp && size.x <= width && size.y <= height)
+			{
+				return size;
+			}
+
+			const double scale = std::min(static_cast<double>(width) / size.x, static_cast<double>(height) / size.y);
+
+			return{ std::max(static_cast<int32>(size.x * scale), 1), std::max(static_cast<int32>(size.y * scale), 1) };
+		}
+
+		/// <summary>
+		/// 画像ファイルを、全体をメモリに読み込まずに拡大縮小して保存します。
+		/// </summary>
+		inline bool Scale(const FilePath& from, const FilePath& to, const Size& size, Interpolation interpolation = Interpolation::Unspecified)
+		{
+			ImageStreamReader reader(from);
+
+			if (!reader)
+			{
+				return false;
+			}
+
+			ImageStreamWriter writer(to, size);
+
+			return Scale(reader, writer, interpolation);
+		}
+
+		/// <summary>
+		/// 画像ファイルを、全体をメモリに読み込まずに縦横比を保って指定した範囲に収まるよう拡大縮小して保存します。
+		/// </summary>
+		inline bool Fit(const FilePath& from, const FilePath& to, int32 width, int32 height, bool scaleUp = true, Interpolation interpolation = Interpolation::Unspecified)
+		{
+			ImageStreamReader reader(from);
+
+			if (!reader)
+			{
+				return false;
+			}
+
+			ImageStreamWriter writer(to, FitSize(reader.size(), width, height, scaleUp));
+
+			return Scale(reader, writer, interpolation);
+		}
+	}
+}
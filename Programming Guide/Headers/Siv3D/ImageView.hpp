@@ -0,0 +1,553 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <algorithm>
+# include <cstring>
+# include <memory>
+# include <functional>
+# include "Fwd.hpp"
+# include "Image.hpp"
+# include "ImageKernels.hpp"
+# include "FastBlur.hpp"
+# include "ImageStream.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// 画像の矩形領域を参照するビュー
+	/// </summary>
+	/// <remarks>
+	/// ピクセルをコピーせず、先頭のポインタと行の間隔（ピクセル）で元の画像を参照します。
+	/// 元の画像のピクセルが解放・再確保されるとビューは無効になります。
+	/// SharedImage から作成したビューは、ピクセルの所有権を共有するため無効になりません。
+	/// </remarks>
+	class ImageView
+	{
+	private:
+
+		std::shared_ptr<const Image> m_owner;
+
+		const Color* m_data = nullptr;
+
+		uint32 m_width = 0;
+
+		uint32 m_height = 0;
+
+		uint32 m_pitch = 0;
+
+		static Rect ClipRect(const Rect& rect, int32 width, int32 height)
+		{
+			const int32 left = Clamp(rect.x, 0, width);
+			const int32 top = Clamp(rect.y, 0, height);
+			const int32 right = Clamp(rect.x + rect.w, left, width);
+			const int32 bottom = Clamp(rect.y + rect.h, top, height);
+
+			return{ left, top, right - left, bottom - top };
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		ImageView() = default;
+
+		/// <summary>
+		/// 画像全体を参照するビューを作成します。
+		/// </summary>
+		/// <param name="image">
+		/// 画像
+		/// </param>
+		ImageView(const Image& image)
+			: m_data(image.isEmpty ? nullptr : image[0])
+			, m_width(image.width)
+			, m_height(image.height)
+			, m_pitch(image.width) {}
+
+		/// <summary>
+		/// 画像の一部を参照するビューを作成します。
+		/// </summary>
+		/// <param name="region">
+		/// 画像の領域。画像の範囲に切り詰められます。
+		/// </param>
+		ImageView(const ImageRegion& region)
+			: ImageView(ImageView(region.image()).sub(region.rect())) {}
+
+		/// <summary>
+		/// メモリ上のピクセルを参照するビューを作成します。
+		/// </summary>
+		/// <param name="data">
+		/// 先頭のピクセル
+		/// </param>
+		/// <param name="size">
+		/// 幅と高さ（ピクセル）
+		/// </param>
+		/// <param name="pitch">
+		/// 行の間隔（ピクセル）
+		/// </param>
+		ImageView(const Color* data, const Size& size, uint32 pitch)
+			: m_data(size.x > 0 && size.y > 0 ? data : nullptr)
+			, m_width(size.x > 0 && size.y > 0 ? size.x : 0)
+			, m_height(size.x > 0 && size.y > 0 ? size.y : 0)
+			, m_pitch(pitch) {}
+
+		/// <summary>
+		/// ピクセルの所有権を共有するビューを作成します。
+		/// </summary>
+		/// <param name="owner">
+		/// 画像
+		/// </param>
+		explicit ImageView(const std::shared_ptr<const Image>& owner)
+			: ImageView(owner ? ImageView(*owner) : ImageView())
+		{
+			m_owner = owner;
+		}
+
+		/// <summary>
+		/// ビューの一部を参照するビューを返します。
+		/// </summary>
+		/// <param name="rect">
+		/// このビュー内の領域。ビューの範囲に切り詰められます。
+		/// </param>
+		/// <returns>
+		/// 新しいビュー
+		/// </returns>
+		ImageView sub(const Rect& rect) const
+		{
+			const Rect r = ClipRect(rect, width, height);
+
+			ImageView view(r.w && r.h ? m_data + static_cast<size_t>(r.y) * m_pitch + r.x : nullptr, r.size, m_pitch);
+
+			view.m_owner = m_owner;
+
+			return view;
+		}
+
+		ImageView operator ()(int32 x, int32 y, int32 w, int32 h) const
+		{
+			return sub({ x, y, w, h });
+		}
+
+		ImageView operator ()(const Rect& rect) const
+		{
+			return sub(rect);
+		}
+
+		/// <summary>
+		/// 指定した行の先頭ポインタを返します。
+		/// </summary>
+		const Color* operator [](uint32 y) const
+		{
+			return m_data + static_cast<size_t>(m_pitch) * y;
+		}
+
+		const Color& operator [](const Point& pos) const
+		{
+			return m_data[static_cast<size_t>(m_pitch) * pos.y + pos.x];
+		}
+
+		/// <summary>
+		/// ビューの幅（ピクセル）
+		/// </summary>
+		Property_Get(int32, width) const { return m_width; }
+
+		/// <summary>
+		/// ビューの高さ（ピクセル）
+		/// </summary>
+		Property_Get(int32, height) const { return m_height; }
+
+		/// <summary>
+		/// ビューの幅と高さ（ピクセル）
+		/// </summary>
+		Property_Get(Size, size) const { return{ width, height }; }
+
+		/// <summary>
+		/// 行の間隔（ピクセル）
+		/// </summary>
+		Property_Get(uint32, pitch) const { return m_pitch; }
+
+		/// <summary>
+		/// 行の間隔（バイト）
+		/// </summary>
+		Property_Get(uint32, stride) const { return m_pitch * sizeof(Color); }
+
+		/// <summary>
+		/// ビューのピクセル数
+		/// </summary>
+		Property_Get(uint32, num_pixels) const { return m_width * m_height; }
+
+		/// <summary>
+		/// ビューが空かどうかを示します。
+		/// </summary>
+		Property_Get(bool, isEmpty) const { return m_data == nullptr; }
+
+		/// <summary>
+		/// 行の間に隙間がなく、ピクセルが連続しているかを示します。
+		/// </summary>
+		Property_Get(bool, isContiguous) const { return m_pitch == m_width || m_height <= 1; }
+
+		/// <summary>
+		/// 参照しているピクセルをコピーした画像を返します。
+		/// </summary>
+		/// <returns>
+		/// 新しい画像
+		/// </returns>
+		Image toImage() const
+		{
+			Image image(size);
+
+			overwrite(image);
+
+			return image;
+		}
+
+		/// <summary>
+		/// 参照しているピクセルを別の画像に上書きします。
+		/// </summary>
+		/// <param name="image">
+		/// 書き込み先の画像
+		/// </param>
+		/// <param name="pos">
+		/// 書き込み開始位置
+		/// </param>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void overwrite(Image& image, const Point& pos = { 0, 0 }) const
+		{
+			const Rect dst = ClipRect(Rect(pos, size), image.width, image.height);
+
+			if (dst.w == 0 || dst.h == 0)
+			{
+				return;
+			}
+
+			const int32 offsetX = dst.x - pos.x, offsetY = dst.y - pos.y;
+
+			for (int32 y = 0; y < dst.h; ++y)
+			{
+				std::memmove(&image[dst.y + y][dst.x], operator[](offsetY + y) + offsetX, dst.w * sizeof(Color));
+			}
+		}
+	};
+
+	namespace ImageKernels
+	{
+		namespace detail
+		{
+			// ビューが参照する範囲と画像のピクセルが重なっているか
+			inline bool Overlaps(const ImageView& view, const Image& image)
+			{
+				if (view.isEmpty || image.isEmpty)
+				{
+					return false;
+				}
+
+				const std::less<const Color*> less;
+
+				const Color* viewBegin = view[0];
+				const Color* viewEnd = view[view.height - 1] + view.width;
+				const Color* imageBegin = image[0];
+				const Color* imageEnd = imageBegin + image.num_pixels;
+
+				return less(viewBegin, imageEnd) && less(imageBegin, viewEnd);
+			}
+		}
+
+		/// <summary>
+		/// ビューの各行にカーネルを適用します。
+		/// </summary>
+		/// <param name="src">
+		/// 入力画像のビュー
+		/// </param>
+		/// <param name="dst">
+		/// 出力画像
+		/// </param>
+		/// <param name="kernel">
+		/// (src, dst, num) を引数にとるカーネル
+		/// </param>
+		/// <remarks>
+		/// ピクセルが連続している場合は 1 回の呼び出しで全体を処理します。
+		/// ビューが dst 全体を参照している場合はその場で処理し、dst の一部を参照している場合は先にピクセルをコピーします。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		template <class Kernel>
+		inline void Apply(const ImageView& src, Image& dst, Kernel kernel)
+		{
+			if (src.isEmpty)
+			{
+				dst.clear();
+
+				return;
+			}
+
+			const bool inPlace = !dst.isEmpty && dst[0] == src[0] && dst.size == src.size;
+
+			if (!inPlace && detail::Overlaps(src, dst))
+			{
+				// dst を書き換えるとビューの参照先が壊れたり解放されたりするので、コピーを入力にする
+				const Image copy = src.toImage();
+
+				Apply(ImageView(copy), dst, kernel);
+
+				return;
+			}
+
+			if (!inPlace)
+			{
+				dst.resize(src.size);
+			}
+
+			if (src.isContiguous)
+			{
+				kernel(src[0], dst[0], static_cast<size_t>(src.num_pixels));
+
+				return;
+			}
+
+			for (int32 y = 0; y < src.height; ++y)
+			{
+				kernel(src[y], dst[y], static_cast<size_t>(src.width));
+			}
+		}
+	}
+
+	/// <summary>
+	/// ImageView や ImageRegion を入力にとる関数は、ピクセルをコピーせずに参照して処理します。
+	/// </summary>
+	namespace Imaging
+	{
+		inline void Negate(const ImageView& src, Image& dst)
+		{
+			ImageKernels::Apply(src, dst, [](const Color* s, Color* d, size_t n) { ImageKernels::Negate(s, d, n); });
+		}
+
+		inline void Grayscale(const ImageView& src, Image& dst)
+		{
+			ImageKernels::Apply(src, dst, [](const Color* s, Color* d, size_t n) { ImageKernels::Grayscale(s, d, n); });
+		}
+
+		inline void Sepia(const ImageView& src, Image& dst, int32 level = 25)
+		{
+			ImageKernels::Apply(src, dst, [=](const Color* s, Color* d, size_t n) { ImageKernels::Sepia(s, d, n, level); });
+		}
+
+		inline void Postarize(const ImageView& src, Image& dst, int32 level)
+		{
+			const auto table = ImageKernels::MakePostarizeLUT(level);
+
+			ImageKernels::Apply(src, dst, [&](const Color* s, Color* d, size_t n) { ImageKernels::ApplyLUT(s, d, n, table); });
+		}
+
+		inline void Brighten(const ImageView& src, Image& dst, int32 level)
+		{
+			ImageKernels::Apply(src, dst, [=](const Color* s, Color* d, size_t n) { ImageKernels::Brighten(s, d, n, level); });
+		}
+
+		inline void GammaCorrect(const ImageView& src, Image& dst, double gamma)
+		{
+			const auto table = ImageKernels::MakeGammaLUT(gamma);
+
+			ImageKernels::Apply(src, dst, [&](const Color* s, Color* d, size_t n) { ImageKernels::ApplyLUT(s, d, n, table); });
+		}
+
+		inline void Threshold(const ImageView& src, Image& dst, uint8 threshold, bool inverse = false)
+		{
+			ImageKernels::Apply(src, dst, [=](const Color* s, Color* d, size_t n) { ImageKernels::Threshold(s, d, n, threshold, inverse); });
+		}
+
+		inline void SwapARGBtoABGR(const ImageView& src, Image& dst)
+		{
+			ImageKernels::Apply(src, dst, [](const Color* s, Color* d, size_t n) { ImageKernels::ARGBtoABGR(s, d, n); });
+		}
+
+		namespace detail
+		{
+			inline BlurBuffer MakeBlurBuffer(const ImageView& view)
+			{
+				BlurBuffer buffer;
+
+				buffer.data.resize(view.num_pixels * 4);
+
+				buffer.width = view.width;
+
+				buffer.height = view.height;
+
+				float* p = buffer.data.data();
+
+				for (int32 y = 0; y < view.height; ++y)
+				{
+					const Color* row = view[y];
+
+					for (int32 x = 0; x < view.width; ++x)
+					{
+						*p++ = static_cast<float>(row[x].r);
+						*p++ = static_cast<float>(row[x].g);
+						*p++ = static_cast<float>(row[x].b);
+						*p++ = static_cast<float>(row[x].a);
+					}
+				}
+
+				return buffer;
+			}
+		}
+
+		/// <summary>
+		/// ビューが参照する領域をぼかします。
+		/// </summary>
+		/// <param name="src">
+		/// 入力画像のビュー
+		/// </param>
+		/// <param name="dst">
+		/// 出力画像
+		/// </param>
+		/// <param name="horizontal">
+		/// 水平方向のカーネルの半径
+		/// </param>
+		/// <param name="vertical">
+		/// 垂直方向のカーネルの半径
+		/// </param>
+		/// <param name="method">
+		/// 計算方法。Image を渡す Imaging::Blur() と同じ結果になります。
+		/// </param>
+		/// <remarks>
+		/// 境界はビューの端で折り返し、ビューの外側のピクセルは参照しません。
+		/// BlurMethod::Exact の場合は、ビューを一度 Image にコピーします。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void Blur(const ImageView& src, Image& dst, int32 horizontal, int32 vertical, BlurMethod method = BlurMethod::Exact)
+		{
+			if (src.isEmpty)
+			{
+				dst.clear();
+
+				return;
+			}
+
+			if (method == BlurMethod::Exact)
+			{
+				Blur(src.toImage(), dst, horizontal, vertical);
+
+				return;
+			}
+
+			detail::BlurBuffer buffer = detail::MakeBlurBuffer(src);
+
+			detail::BoxBlur(buffer, dst, horizontal, vertical);
+		}
+
+		/// <summary>
+		/// ビューが参照する領域にガウスぼかしを適用します。
+		/// </summary>
+		/// <param name="src">
+		/// 入力画像のビュー
+		/// </param>
+		/// <param name="dst">
+		/// 出力画像
+		/// </param>
+		/// <param name="horizontal">
+		/// 水平方向のカーネルの半径
+		/// </param>
+		/// <param name="vertical">
+		/// 垂直方向のカーネルの半径
+		/// </param>
+		/// <param name="method">
+		/// 計算方法。Image を渡す Imaging::GaussianBlur() と同じ結果になります。
+		/// </param>
+		/// <remarks>
+		/// 境界はビューの端で折り返し、ビューの外側のピクセルは参照しません。
+		/// BlurMethod::Exact の場合は、ビューを一度 Image にコピーします。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void GaussianBlur(const ImageView& src, Image& dst, int32 horizontal, int32 vertical, BlurMethod method = BlurMethod::Exact)
+		{
+			if (src.isEmpty)
+			{
+				dst.clear();
+
+				return;
+			}
+
+			if (method == BlurMethod::Exact)
+			{
+				GaussianBlur(src.toImage(), dst, horizontal, vertical);
+
+				return;
+			}
+
+			detail::BlurBuffer buffer = detail::MakeBlurBuffer(src);
+
+			detail::GaussianBoxBlur(buffer, dst, horizontal, vertical);
+		}
+
+		/// <summary>
+		/// ビューが参照する領域を ImageStreamWriter に書き込みます。
+		/// </summary>
+		/// <param name="src">
+		/// 入力画像のビュー
+		/// </param>
+		/// <param name="writer">
+		/// ビューと同じ大きさで開かれた ImageStreamWriter
+		/// </param>
+		/// <remarks>
+		/// 行ごとに書き込むため、一時的な画像を作成しません。
+		/// </remarks>
+		/// <returns>
+		/// すべての行の書き込みに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		inline bool Encode(const ImageView& src, ImageStreamWriter& writer)
+		{
+			if (src.isEmpty || !writer || writer.size() != src.size || writer.currentRow() != 0)
+			{
+				return false;
+			}
+
+			for (int32 y = 0; y < src.height; ++y)
+			{
+				if (!writer.writeRow(src[y]))
+				{
+					return false;
+				}
+			}
+
+			return writer.close();
+		}
+
+		/// <summary>
+		/// ビューが参照する領域を画像ファイルに保存します。
+		/// </summary>
+		/// <param name="src">
+		/// 入力画像のビュー
+		/// </param>
+		/// <param name="path">
+		/// 保存するファイルのパス
+		/// </param>
+		/// <param name="format">
+		/// 画像のフォーマット。ImageStreamWriter が対応する BMP と PPM を指定できます。
+		/// ImageFormat::Unspecified の場合、拡張子から自動で判断します。
+		/// </param>
+		/// <returns>
+		/// 保存に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		inline bool Save(const ImageView& src, const FilePath& path, ImageFormat format = ImageFormat::Unspecified)
+		{
+			ImageStreamWriter writer(path, src.size, format);
+
+			return Encode(src, writer);
+		}
+	}
+}
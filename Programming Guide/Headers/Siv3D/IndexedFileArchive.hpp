@@ -0,0 +1,772 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include <limits>
+# include <algorithm>
+# include <type_traits>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "String.hpp"
+# include "StringView.hpp"
+# include "ArrayView.hpp"
+# include "ByteArray.hpp"
+# include "Compression.hpp"
+# include "FileSystem.hpp"
+# include "ThreadPool.hpp"
+# include "BinaryWriter.hpp"
+# include "BufferedWriter.hpp"
+# include "MappedFileReader.hpp"
+# include "ArchivedFileReader.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// アーカイブのエントリの圧縮方式
+	/// </summary>
+	enum class ArchiveCodec : uint8
+	{
+		/// <summary>
+		/// 圧縮しない
+		/// </summary>
+		Stored,
+
+		/// <summary>
+		/// Compression::Compress() で圧縮する
+		/// </summary>
+		Compressed,
+	};
+
+	namespace detail
+	{
+		struct IndexedArchiveHeader
+		{
+			static constexpr uint32 Signature = 0x41443353; // "S3DA"
+
+			static constexpr uint32 Version = 2;
+
+			uint32 signature;
+
+			uint32 version;
+
+			uint64 numEntries;
+
+			// 目次の位置。目次の直後にパスの文字列が続く
+			uint64 tocOffset;
+
+			uint64 numNameChars;
+		};
+
+		struct IndexedArchiveEntry
+		{
+			uint64 hash;
+
+			uint64 offset;
+
+			uint64 compressedSize;
+
+			uint64 size;
+
+			uint32 nameOffset;
+
+			uint16 nameLength;
+
+			ArchiveCodec codec;
+
+			uint8 reserved;
+		};
+
+		static_assert(sizeof(IndexedArchiveHeader) == 32, "IndexedArchiveHeader must be 32 bytes");
+
+		static_assert(sizeof(IndexedArchiveEntry) == 40, "IndexedArchiveEntry must be 40 bytes");
+
+		// 区切り文字を '/' に、ASCII の大文字を小文字にそろえる
+		inline constexpr wchar NormalizeArchivePathChar(wchar ch)
+		{
+			return (ch == L'\\') ? L'/' : (L'A' <= ch && ch <= L'Z') ? static_cast<wchar>(ch + (L'a' - L'A')) : ch;
+		}
+
+		inline uint64 ArchivePathHash(StringView path)
+		{
+			uint64 hash = 14695981039346656037ull;
+
+			for (const wchar ch : path)
+			{
+				hash = (hash ^ static_cast<uint16>(NormalizeArchivePathChar(ch))) * 1099511628211ull;
+			}
+
+			return hash;
+		}
+
+		inline bool ArchivePathEquals(StringView a, StringView b)
+		{
+			if (a.length() != b.length())
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < a.length(); ++i)
+			{
+				if (NormalizeArchivePathChar(a[i]) != NormalizeArchivePathChar(b[i]))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+	}
+
+	namespace Archive
+	{
+		/// <summary>
+		/// ディレクトリの中のファイルから IndexedFileArchive 形式のアーカイブを作成します。
+		/// </summary>
+		/// <remarks>
+		/// ファイルの読み込みと圧縮はスレッドプールで並列に行います。
+		/// 圧縮してもサイズが小さくならないファイルは、圧縮せずに格納します。
+		/// </remarks>
+		/// <param name="from">
+		/// アーカイブするディレクトリのパス
+		/// </param>
+		/// <param name="to">
+		/// 作成するアーカイブのパス
+		/// </param>
+		/// <param name="codec">
+		/// エントリの圧縮方式
+		/// </param>
+		/// <param name="level">
+		/// 圧縮レベル
+		/// </param>
+		/// <returns>
+		/// 作成に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		inline bool CreateIndexed(const FilePath& from, const FilePath& to, ArchiveCodec codec = ArchiveCodec::Compressed, _Field_range_(1, 9) int32 level = 7)
+		{
+			using Entry = detail::IndexedArchiveEntry;
+
+			// 一度にメモリに読み込むファイルの合計サイズの目安
+			constexpr int64 MaxBatchBytes = 64 * 1024 * 1024;
+
+			const FilePath root = FileSystem::FullPath(from);
+
+			Array<FilePath> files;
+
+			for (const auto& path : FileSystem::DirectoryContents(root))
+			{
+				if (FileSystem::IsFile(path))
+				{
+					files.push_back(path);
+				}
+			}
+
+			Array<Entry> entries(files.size(), Entry{});
+
+			Array<wchar> names;
+
+			for (size_t i = 0; i < files.size(); ++i)
+			{
+				FilePath name = FileSystem::Relative(files[i], root);
+
+				for (auto& ch : name)
+				{
+					if (ch == L'\\')
+					{
+						ch = L'/';
+					}
+				}
+
+				if (name.length > std::numeric_limits<uint16>::max()
+					|| names.size() > std::numeric_limits<uint32>::max())
+				{
+					return false;
+				}
+
+				entries[i].hash = detail::ArchivePathHash(name);
+				entries[i].nameOffset = static_cast<uint32>(names.size());
+				entries[i].nameLength = static_cast<uint16>(name.length);
+
+				names.insert(names.end(), name.begin(), name.end());
+			}
+
+			BufferedWriter<BinaryWriter> writer(to);
+
+			if (!writer)
+			{
+				return false;
+			}
+
+			detail::IndexedArchiveHeader header = {};
+
+			bool succeeded = (writer.write(header) == sizeof(header));
+
+			const auto pool = Threading::GetPool();
+
+			const size_t maxBatchFiles = std::max<size_t>(pool->numThreads(), 1) * 16;
+
+			Array<ByteArray> blobs;
+
+			for (size_t first = 0; first < files.size() && succeeded;)
+			{
+				size_t last = first;
+
+				// 1 つのファイルが上限を超える場合も、少なくとも 1 ファイルは進める
+				for (int64 batchBytes = 0; last < files.size() && (last == first || ((last - first) < maxBatchFiles && batchBytes < MaxBatchBytes)); ++last)
+				{
+					batchBytes += FileSystem::FileSize(files[last]);
+				}
+
+				blobs.assign(last - first, ByteArray());
+
+				pool->parallelFor(first, last, [&](size_t i)
+				{
+					ByteArray source(files[i]);
+
+					Entry& entry = entries[i];
+
+					entry.size = source.size();
+
+					entry.codec = ArchiveCodec::Stored;
+
+					if (codec == ArchiveCodec::Compressed && source.size())
+					{
+						ByteArray compressed = Compression::Compress(source.data(), static_cast<size_t>(source.size()), level);
+
+						if (compressed.size() && compressed.size() < source.size())
+						{
+							entry.codec = ArchiveCodec::Compressed;
+
+							blobs[i - first] = std::move(compressed);
+
+							return;
+						}
+					}
+
+					blobs[i - first] = std::move(source);
+				});
+
+				for (size_t i = first; i < last; ++i)
+				{
+					const ByteArray& blob = blobs[i - first];
+
+					entries[i].offset = writer.getPos();
+
+					entries[i].compressedSize = blob.size();
+
+					if (blob.size())
+					{
+						succeeded &= (writer.write(blob.data(), static_cast<size_t>(blob.size())) == static_cast<size_t>(blob.size()));
+					}
+				}
+
+				first = last;
+			}
+
+			std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+
+			header.signature = detail::IndexedArchiveHeader::Signature;
+			header.version = detail::IndexedArchiveHeader::Version;
+			header.numEntries = entries.size();
+			header.tocOffset = writer.getPos();
+			header.numNameChars = names.size();
+
+			const size_t tocSize = entries.size() * sizeof(Entry);
+
+			const size_t namesSize = names.size() * sizeof(wchar);
+
+			if (tocSize)
+			{
+				succeeded &= (writer.write(entries.data(), tocSize) == tocSize);
+
+				succeeded &= (writer.write(names.data(), namesSize) == namesSize);
+			}
+
+			succeeded &= writer.setPos(0);
+
+			succeeded &= (writer.write(header) == sizeof(header));
+
+			return succeeded;
+		}
+	}
+
+	/// <summary>
+	/// 目次付きのアーカイブ
+	/// </summary>
+	/// <remarks>
+	/// Archive::CreateIndexed() で作成したアーカイブを読み込みます。
+	/// 目次はパスのハッシュ値の順に並んでいて、ファイルの数によらずほぼ一定の時間でエントリを探せます。
+	/// エントリはファイルごとに圧縮され、load() は最初にデータを読むまで展開しません。
+	/// パスの区切り文字は '/' と '\\' のどちらでもよく、ASCII の大文字と小文字は区別しません。
+	/// パスを指定して開いた場合はファイルをメモリにマップし、loadByteArray() と loadView() は
+	/// 別のスレッドから同時に呼び出せます。
+	/// </remarks>
+	class IndexedFileArchive
+	{
+	private:
+
+		using Entry = detail::IndexedArchiveEntry;
+
+		std::shared_ptr<IReader> m_reader;
+
+		// パスを指定して開いた場合のみ
+		std::shared_ptr<MappedFileReader> m_mapped;
+
+		Array<Entry> m_entries;
+
+		Array<wchar> m_names;
+
+		// ハッシュ値の上位 m_bucketBits ビットごとの、最初のエントリの番号
+		Array<uint32> m_buckets;
+
+		uint32 m_bucketBits = 0;
+
+		size_t bucketOf(uint64 hash) const
+		{
+			return m_bucketBits ? static_cast<size_t>(hash >> (64 - m_bucketBits)) : 0;
+		}
+
+		StringView nameOf(const Entry& entry) const
+		{
+			return StringView(m_names.data() + entry.nameOffset, entry.nameLength);
+		}
+
+		const Entry* find(StringView path) const
+		{
+			if (m_entries.empty())
+			{
+				return nullptr;
+			}
+
+			const uint64 hash = detail::ArchivePathHash(path);
+
+			const size_t bucket = bucketOf(hash);
+
+			for (uint32 i = m_buckets[bucket]; i < m_buckets[bucket + 1]; ++i)
+			{
+				const Entry& entry = m_entries[i];
+
+				if (entry.hash == hash && detail::ArchivePathEquals(nameOf(entry), path))
+				{
+					return &entry;
+				}
+			}
+
+			return nullptr;
+		}
+
+		bool readIndex()
+		{
+			detail::IndexedArchiveHeader header;
+
+			const int64 fileSize = m_reader->size();
+
+			if (!m_reader->isOpened()
+				|| m_reader->read(&header, 0, sizeof(header)) != sizeof(header)
+				|| header.signature != detail::IndexedArchiveHeader::Signature
+				|| header.version != detail::IndexedArchiveHeader::Version
+				|| header.tocOffset < sizeof(header)
+				|| header.tocOffset > static_cast<uint64>(fileSize)
+				|| header.numEntries > std::numeric_limits<uint32>::max()
+				|| header.numEntries > (fileSize - header.tocOffset) / sizeof(Entry)
+				|| header.numNameChars > (fileSize - header.tocOffset - header.numEntries * sizeof(Entry)) / sizeof(wchar))
+			{
+				return false;
+			}
+
+			const int64 tocSize = static_cast<int64>(header.numEntries * sizeof(Entry));
+
+			const int64 namesSize = static_cast<int64>(header.numNameChars * sizeof(wchar));
+
+			m_entries.resize(static_cast<size_t>(header.numEntries));
+
+			m_names.resize(static_cast<size_t>(header.numNameChars));
+
+			if (m_reader->read(m_entries.data(), header.tocOffset, tocSize) != tocSize
+				|| m_reader->read(m_names.data(), header.tocOffset + tocSize, namesSize) != namesSize)
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < m_entries.size(); ++i)
+			{
+				const Entry& entry = m_entries[i];
+
+				if ((i && entry.hash < m_entries[i - 1].hash)
+					|| entry.offset < sizeof(header)
+					|| entry.offset > header.tocOffset
+					|| entry.compressedSize > header.tocOffset - entry.offset
+					|| static_cast<uint64>(entry.nameOffset) + entry.nameLength > header.numNameChars
+					|| (entry.codec == ArchiveCodec::Stored && entry.compressedSize != entry.size)
+					|| entry.codec > ArchiveCodec::Compressed)
+				{
+					return false;
+				}
+			}
+
+			m_bucketBits = 0;
+
+			while ((size_t(1) << m_bucketBits) < m_entries.size())
+			{
+				++m_bucketBits;
+			}
+
+			const size_t numBuckets = size_t(1) << m_bucketBits;
+
+			m_buckets.resize(numBuckets + 1);
+
+			uint32 index = 0;
+
+			for (size_t bucket = 0; bucket < numBuckets; ++bucket)
+			{
+				m_buckets[bucket] = index;
+
+				while (index < m_entries.size() && bucketOf(m_entries[index].hash) == bucket)
+				{
+					++index;
+				}
+			}
+
+			m_buckets[numBuckets] = index;
+
+			return true;
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		IndexedFileArchive() = default;
+
+		/// <summary>
+		/// アーカイブファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		explicit IndexedFileArchive(const FilePath& path)
+		{
+			open(path);
+		}
+
+		/// <summary>
+		/// IReader からアーカイブを開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		template <class Reader, class = std::enable_if_t<std::is_base_of<IReader, Reader>::value>>
+		explicit IndexedFileArchive(Reader&& reader)
+		{
+			open(std::move(reader));
+		}
+
+		/// <summary>
+		/// IReader からアーカイブを開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		explicit IndexedFileArchive(const std::shared_ptr<IReader>& reader)
+		{
+			open(reader);
+		}
+
+		/// <summary>
+		/// アーカイブファイルをメモリにマップして開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <returns>
+		/// アーカイブのオープンに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const FilePath& path)
+		{
+			auto mapped = std::make_shared<MappedFileReader>(path);
+
+			if (!open(mapped))
+			{
+				return false;
+			}
+
+			m_mapped = std::move(mapped);
+
+			return true;
+		}
+
+		/// <summary>
+		/// IReader からアーカイブを開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		/// <returns>
+		/// アーカイブのオープンに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		template <class Reader, class = std::enable_if_t<std::is_base_of<IReader, Reader>::value>>
+		bool open(Reader&& reader)
+		{
+			return open(std::make_shared<Reader>(std::move(reader)));
+		}
+
+		/// <summary>
+		/// IReader からアーカイブを開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		/// <returns>
+		/// アーカイブのオープンに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const std::shared_ptr<IReader>& reader)
+		{
+			close();
+
+			if (!reader)
+			{
+				return false;
+			}
+
+			m_reader = reader;
+
+			if (!readIndex())
+			{
+				close();
+
+				return false;
+			}
+
+			return true;
+		}
+
+		/// <summary>
+		/// アーカイブを閉じます。
+		/// </summary>
+		/// <remarks>
+		/// load() で作成した ArchivedFileReader は、閉じた後も読み込めます。
+		/// </remarks>
+		void close()
+		{
+			m_reader.reset();
+
+			m_mapped.reset();
+
+			m_entries.clear();
+
+			m_names.clear();
+
+			m_buckets.clear();
+
+			m_bucketBits = 0;
+		}
+
+		bool isOpened() const
+		{
+			return static_cast<bool>(m_reader);
+		}
+
+		explicit operator bool() const { return isOpened(); }
+
+		/// <summary>
+		/// アーカイブに含まれるファイルの数を返します。
+		/// </summary>
+		/// <returns>
+		/// ファイルの数
+		/// </returns>
+		size_t numFiles() const
+		{
+			return m_entries.size();
+		}
+
+		/// <summary>
+		/// アーカイブに含まれるファイルのパスを返します。
+		/// </summary>
+		/// <param name="index">
+		/// 0 から numFiles() - 1 までのインデックス。順番はパスのハッシュ値の順です。
+		/// </param>
+		/// <returns>
+		/// アーカイブ内のパスへの参照
+		/// </returns>
+		StringView name(size_t index) const
+		{
+			return nameOf(m_entries[index]);
+		}
+
+		/// <summary>
+		/// アーカイブに含まれるファイルのパスの一覧を返します。
+		/// </summary>
+		/// <remarks>
+		/// 文字列をコピーせずにパスを調べる場合は numFiles() と name() を使います。
+		/// </remarks>
+		/// <returns>
+		/// パスの一覧
+		/// </returns>
+		Array<FilePath> contents() const
+		{
+			Array<FilePath> paths;
+
+			paths.reserve(m_entries.size());
+
+			for (const auto& entry : m_entries)
+			{
+				paths.push_back(nameOf(entry).to_string());
+			}
+
+			return paths;
+		}
+
+		/// <summary>
+		/// アーカイブにファイルが含まれているかを返します。
+		/// </summary>
+		/// <param name="path">
+		/// アーカイブ内のパス
+		/// </param>
+		/// <returns>
+		/// ファイルが含まれている場合 true, それ以外の場合は false
+		/// </returns>
+		bool contains(StringView path) const
+		{
+			return find(path) != nullptr;
+		}
+
+		/// <summary>
+		/// ファイルの展開後のサイズを返します。
+		/// </summary>
+		/// <param name="path">
+		/// アーカイブ内のパス
+		/// </param>
+		/// <returns>
+		/// ファイルのサイズ（バイト）。ファイルが含まれていない場合は 0
+		/// </returns>
+		int64 fileSize(StringView path) const
+		{
+			const Entry* entry = find(path);
+
+			return entry ? static_cast<int64>(entry->size) : 0;
+		}
+
+		/// <summary>
+		/// ファイルを読み込む ArchivedFileReader を返します。
+		/// </summary>
+		/// <remarks>
+		/// 圧縮されたファイルは、ArchivedFileReader から最初にデータを読み込んだときに展開されます。
+		/// </remarks>
+		/// <param name="path">
+		/// アーカイブ内のパス
+		/// </param>
+		/// <returns>
+		/// ArchivedFileReader. ファイルが含まれていない場合は空の ArchivedFileReader
+		/// </returns>
+		ArchivedFileReader load(StringView path) const
+		{
+			const Entry* entry = find(path);
+
+			if (!entry)
+			{
+				return ArchivedFileReader();
+			}
+
+			if (entry->codec == ArchiveCodec::Stored)
+			{
+				return ArchivedFileReader(m_reader, entry->offset, entry->size);
+			}
+
+			return ArchivedFileReader(m_reader, entry->offset, entry->compressedSize, entry->size);
+		}
+
+		/// <summary>
+		/// ファイルの内容を ByteArray に読み込みます。
+		/// </summary>
+		/// <param name="path">
+		/// アーカイブ内のパス
+		/// </param>
+		/// <returns>
+		/// ファイルの内容。ファイルが含まれていないか、展開に失敗した場合は空の ByteArray
+		/// </returns>
+		ByteArray loadByteArray(StringView path) const
+		{
+			const Entry* entry = find(path);
+
+			if (!entry)
+			{
+				return ByteArray();
+			}
+
+			const int64 compressedSize = static_cast<int64>(entry->compressedSize);
+
+			Array<uint8> buffer;
+
+			const uint8* data = nullptr;
+
+			if (m_mapped)
+			{
+				data = m_mapped->data() + entry->offset;
+			}
+			else
+			{
+				buffer.resize(static_cast<size_t>(compressedSize));
+
+				if (m_reader->read(buffer.data(), entry->offset, compressedSize) != compressedSize)
+				{
+					return ByteArray();
+				}
+
+				if (entry->codec == ArchiveCodec::Stored)
+				{
+					return ByteArray(std::move(buffer));
+				}
+
+				data = buffer.data();
+			}
+
+			if (entry->codec == ArchiveCodec::Stored)
+			{
+				return ByteArray(data, compressedSize);
+			}
+
+			ByteArray decompressed = Compression::Decompress(data, static_cast<size_t>(compressedSize));
+
+			if (decompressed.size() != static_cast<int64>(entry->size))
+			{
+				return ByteArray();
+			}
+
+			return decompressed;
+		}
+
+		/// <summary>
+		/// 圧縮されていないファイルの内容への参照を返します。
+		/// </summary>
+		/// <remarks>
+		/// パスを指定して開いたアーカイブでのみ使え、マップされたメモリを直接指すのでコピーしません。
+		/// 参照はアーカイブを閉じるまで有効です。
+		/// </remarks>
+		/// <param name="path">
+		/// アーカイブ内のパス
+		/// </param>
+		/// <returns>
+		/// ファイルの内容への参照。ファイルが含まれていないか、圧縮されているか、
+		/// アーカイブをメモリにマップしていない場合は空の参照
+		/// </returns>
+		ArrayView<uint8> loadView(StringView path) const
+		{
+			const Entry* entry = find(path);
+
+			if (!entry || !m_mapped || entry->codec != ArchiveCodec::Stored)
+			{
+				return ArrayView<uint8>();
+			}
+
+			return m_mapped->lookaheadSubset(entry->offset, entry->size);
+		}
+	};
+}
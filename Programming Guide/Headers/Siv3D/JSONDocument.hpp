@@ -0,0 +1,504 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include <utility>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "String.hpp"
+# include "StringView.hpp"
+# include "Optional.hpp"
+# include "Parse.hpp"
+# include "Unicode.hpp"
+# include "JSONValue.hpp"
+# include "JSONPullParser.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// JSONDocument の中の値への参照
+	/// </summary>
+	/// <remarks>
+	/// 値を変換せずにテキスト上の位置だけを持ち、アクセスされたときに必要な部分だけを読み取ります。
+	/// 参照元の JSONDocument が閉じられた後は使えません。
+	/// 存在しないキーやインデックスを指定すると、空の JSONElement を返します。
+	/// </remarks>
+	class JSONElement
+	{
+	private:
+
+		const detail::JSONIndex* m_index = nullptr;
+
+		uint32 m_pos = 0;
+
+		template <class Type, std::enable_if_t<!std::is_arithmetic<Type>::value>* = nullptr>
+		Optional<Type> getOpt(const Type*) const
+		{
+			if (!isString())
+			{
+				return none;
+			}
+
+			return ParseOpt<Type>(getString());
+		}
+
+		Optional<String> getOpt(const String*) const
+		{
+			if (!isString())
+			{
+				return none;
+			}
+
+			return getString();
+		}
+
+		Optional<bool> getOpt(const bool*) const
+		{
+			if (!isBool())
+			{
+				return none;
+			}
+
+			return getBool();
+		}
+
+		template <class Type, std::enable_if_t<std::is_arithmetic<Type>::value>* = nullptr>
+		Optional<Type> getOpt(const Type*) const
+		{
+			if (!isNumber())
+			{
+				return none;
+			}
+
+			return static_cast<Type>(getNumber());
+		}
+
+	public:
+
+		JSONElement() = default;
+
+		JSONElement(const detail::JSONIndex* index, uint32 pos)
+			: m_index(index)
+			, m_pos(pos) {}
+
+		/// <summary>
+		/// 値が存在するかを返します。
+		/// </summary>
+		/// <returns>
+		/// 値が存在する場合 true, 空の JSONElement の場合は false
+		/// </returns>
+		explicit operator bool() const
+		{
+			return m_index != nullptr;
+		}
+
+		/// <summary>
+		/// データの型を返します。
+		/// </summary>
+		/// <returns>
+		/// データの型。空の JSONElement の場合は JSONValue::ValueType::Null
+		/// </returns>
+		JSONValue::ValueType getType() const
+		{
+			if (!m_index)
+			{
+				return JSONValue::ValueType::Null;
+			}
+
+			switch (m_index->at(m_pos))
+			{
+			case '{':
+				return JSONValue::ValueType::Object;
+			case '[':
+				return JSONValue::ValueType::Array;
+			case '"':
+				return JSONValue::ValueType::String;
+			case 't':
+			case 'f':
+				return JSONValue::ValueType::Boolean;
+			case 'n':
+				return JSONValue::ValueType::Null;
+			default:
+				return JSONValue::ValueType::Number;
+			}
+		}
+
+		bool isNull() const
+		{
+			return getType() == JSONValue::ValueType::Null;
+		}
+
+		bool isBool() const
+		{
+			return getType() == JSONValue::ValueType::Boolean;
+		}
+
+		bool isNumber() const
+		{
+			return getType() == JSONValue::ValueType::Number;
+		}
+
+		bool isString() const
+		{
+			return getType() == JSONValue::ValueType::String;
+		}
+
+		bool isArray() const
+		{
+			return getType() == JSONValue::ValueType::Array;
+		}
+
+		bool isObject() const
+		{
+			return getType() == JSONValue::ValueType::Object;
+		}
+
+		/// <summary>
+		/// 配列の要素数、またはオブジェクトのメンバ数を返します。
+		/// </summary>
+		/// <returns>
+		/// 要素数。配列とオブジェクト以外では 0
+		/// </returns>
+		size_t size() const
+		{
+			const bool object = isObject();
+
+			if (!object && !isArray())
+			{
+				return 0;
+			}
+
+			size_t count = 0;
+
+			for (uint32 child = m_index->firstChild(m_pos); child; child = m_index->nextSibling(child, object))
+			{
+				++count;
+			}
+
+			return count;
+		}
+
+		/// <summary>
+		/// 配列の要素を返します。
+		/// </summary>
+		/// <param name="index">
+		/// インデックス
+		/// </param>
+		/// <returns>
+		/// 要素。配列でないか範囲外の場合は空の JSONElement
+		/// </returns>
+		JSONElement operator [](size_t index) const
+		{
+			if (!isArray())
+			{
+				return JSONElement();
+			}
+
+			for (uint32 child = m_index->firstChild(m_pos); child; child = m_index->nextSibling(child, false))
+			{
+				if (index-- == 0)
+				{
+					return JSONElement(m_index, child);
+				}
+			}
+
+			return JSONElement();
+		}
+
+		/// <summary>
+		/// オブジェクトのメンバを返します。
+		/// </summary>
+		/// <param name="key">
+		/// キー
+		/// </param>
+		/// <returns>
+		/// メンバ。オブジェクトでないかキーが存在しない場合は空の JSONElement
+		/// </returns>
+		JSONElement operator [](StringView key) const
+		{
+			if (!isObject())
+			{
+				return JSONElement();
+			}
+
+			const std::string utf8 = Unicode::ToUTF8(key);
+
+			for (uint32 child = m_index->firstChild(m_pos); child; child = m_index->nextSibling(child, true))
+			{
+				if (m_index->stringEquals(child - 2, utf8, key))
+				{
+					return JSONElement(m_index, child);
+				}
+			}
+
+			return JSONElement();
+		}
+
+		bool contains(size_t index) const
+		{
+			return static_cast<bool>((*this)[index]);
+		}
+
+		bool contains(StringView key) const
+		{
+			return static_cast<bool>((*this)[key]);
+		}
+
+		/// <summary>
+		/// 真偽値を返します。
+		/// </summary>
+		/// <returns>
+		/// 真偽値。真偽値でない場合は false
+		/// </returns>
+		bool getBool() const
+		{
+			return m_index && m_index->at(m_pos) == 't';
+		}
+
+		/// <summary>
+		/// 数値を返します。
+		/// </summary>
+		/// <returns>
+		/// 数値。数値でない場合は 0.0
+		/// </returns>
+		double getNumber() const
+		{
+			return isNumber() ? m_index->getNumber(m_pos) : 0.0;
+		}
+
+		/// <summary>
+		/// 文字列を返します。
+		/// </summary>
+		/// <returns>
+		/// 文字列。文字列でない場合は空の文字列
+		/// </returns>
+		String getString() const
+		{
+			return isString() ? m_index->getString(m_pos) : String();
+		}
+
+		/// <summary>
+		/// 配列の要素を返します。
+		/// </summary>
+		/// <returns>
+		/// 要素の配列。配列でない場合は空の配列
+		/// </returns>
+		Array<JSONElement> getArray() const
+		{
+			Array<JSONElement> elements;
+
+			if (isArray())
+			{
+				for (uint32 child = m_index->firstChild(m_pos); child; child = m_index->nextSibling(child, false))
+				{
+					elements.emplace_back(m_index, child);
+				}
+			}
+
+			return elements;
+		}
+
+		/// <summary>
+		/// オブジェクトのメンバを、テキスト上の順に返します。
+		/// </summary>
+		/// <returns>
+		/// キーとメンバの組の配列。オブジェクトでない場合は空の配列
+		/// </returns>
+		Array<std::pair<String, JSONElement>> getObject() const
+		{
+			Array<std::pair<String, JSONElement>> members;
+
+			if (isObject())
+			{
+				for (uint32 child = m_index->firstChild(m_pos); child; child = m_index->nextSibling(child, true))
+				{
+					members.emplace_back(m_index->getString(child - 2), JSONElement(m_index, child));
+				}
+			}
+
+			return members;
+		}
+
+		template <class Type>
+		Type get() const
+		{
+			return getOpt<Type>().value_or(Type());
+		}
+
+		template <class Type>
+		Optional<Type> getOpt() const
+		{
+			return getOpt(static_cast<const Type*>(nullptr));
+		}
+
+		template <class Type, class U>
+		Type getOr(U&& defaultValue) const
+		{
+			return getOpt<Type>().value_or(std::forward<U>(defaultValue));
+		}
+
+		/// <summary>
+		/// 値を JSONValue に変換します。
+		/// </summary>
+		/// <returns>
+		/// 値。空の JSONElement の場合は null
+		/// </returns>
+		JSONValue toValue() const
+		{
+			return m_index ? m_index->toValue(m_pos) : JSONValue();
+		}
+	};
+
+	/// <summary>
+	/// 必要な部分だけを読み取る JSON ドキュメント
+	/// </summary>
+	/// <remarks>
+	/// JSONReader と異なり、JSONValue のツリーを作りません。
+	/// 読み込んだテキストと、SIMD で作った構造インデックスだけを保持し、
+	/// JSONElement でアクセスされた値をその都度テキストから読み取ります。
+	/// 入力は UTF-8 (BOM は省略可) です。コピーは読み込んだ内容を共有します。
+	/// </remarks>
+	class JSONDocument
+	{
+	private:
+
+		std::shared_ptr<const detail::JSONIndex> m_index;
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		JSONDocument() = default;
+
+		/// <summary>
+		/// JSON ファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		explicit JSONDocument(const FilePath& path)
+		{
+			open(path);
+		}
+
+		/// <summary>
+		/// JSON ファイルを開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		template <class Reader, class = std::enable_if_t<std::is_base_of<IReader, std::decay_t<Reader>>::value>>
+		explicit JSONDocument(Reader&& reader)
+		{
+			open(std::forward<Reader>(reader));
+		}
+
+		/// <summary>
+		/// JSON ファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <returns>
+		/// ファイルのオープンと検証に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const FilePath& path)
+		{
+			BinaryReader reader(path);
+
+			m_index = detail::LoadJSON(reader, path);
+
+			return isOpened();
+		}
+
+		/// <summary>
+		/// IReader の現在の位置から末尾までを JSON として開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		/// <returns>
+		/// 読み込みと検証に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		template <class Reader, class = std::enable_if_t<std::is_base_of<IReader, std::decay_t<Reader>>::value>>
+		bool open(Reader&& reader)
+		{
+			m_index = detail::LoadJSON(reader, FilePath());
+
+			return isOpened();
+		}
+
+		/// <summary>
+		/// JSON ファイルを閉じます。
+		/// </summary>
+		void close()
+		{
+			m_index.reset();
+		}
+
+		/// <summary>
+		/// JSON ファイルが開いているかを返します。
+		/// </summary>
+		/// <returns>
+		/// ファイルが開いている場合 true, それ以外の場合は false
+		/// </returns>
+		bool isOpened() const
+		{
+			return static_cast<bool>(m_index);
+		}
+
+		explicit operator bool() const
+		{
+			return isOpened();
+		}
+
+		/// <summary>
+		/// ルートの値を返します。
+		/// </summary>
+		/// <returns>
+		/// ルートの値。開いていない場合は空の JSONElement
+		/// </returns>
+		JSONElement root() const
+		{
+			return m_index ? JSONElement(m_index.get(), 0) : JSONElement();
+		}
+
+		/// <summary>
+		/// 値を取得します。
+		/// </summary>
+		/// <param name="path">
+		/// キー（L"KEYA" や L"KEYA.KEYB.KEYC" といった形式）
+		/// </param>
+		/// <returns>
+		/// 値。存在しない場合は空の JSONElement
+		/// </returns>
+		JSONElement operator [](const String& path) const
+		{
+			JSONElement element = root();
+
+			for (const auto key : path.splitView(L'.'))
+			{
+				element = element[key];
+			}
+
+			return element;
+		}
+
+		/// <summary>
+		/// JSON ファイルのパスを返します。
+		/// </summary>
+		FilePath path() const
+		{
+			return m_index ? m_index->path : FilePath();
+		}
+	};
+}
@@ -0,0 +1,1160 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include <string>
+# include <cstring>
+# include <intrin.h>
+# include <emmintrin.h>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "String.hpp"
+# include "StringView.hpp"
+# include "IReader.hpp"
+# include "BinaryReader.hpp"
+# include "FromChars.hpp"
+# include "Unicode.hpp"
+# include "JSONValue.hpp"
+
+namespace s3d
+{
+	namespace detail
+	{
+		// SIMD の読み込みが文字列の末尾を越えてもよいように、末尾に追加する 0 の数
+		constexpr size_t JSONPadding = 32;
+
+		inline uint32 JSONLowestSetBit(uint32 mask)
+		{
+			unsigned long index;
+
+			_BitScanForward(&index, mask);
+
+			return index;
+		}
+
+		// 下位 16 ビットの各ビットを、そのビット以下のすべてのビットの XOR にする
+		inline uint32 JSONPrefixXor(uint32 mask)
+		{
+			mask ^= mask << 1;
+			mask ^= mask << 2;
+			mask ^= mask << 4;
+			mask ^= mask << 8;
+			return mask & 0xFFFF;
+		}
+
+		inline bool IsJSONDelimiter(char ch)
+		{
+			switch (ch)
+			{
+			case ' ': case '\t': case '\n': case '\r':
+			case ',': case ':': case '[': case ']': case '{': case '}': case '"':
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		inline bool IsJSONHex(char ch)
+		{
+			return ('0' <= ch && ch <= '9') || ('a' <= ch && ch <= 'f') || ('A' <= ch && ch <= 'F');
+		}
+
+		inline uint32 JSONHexValue(const char* p)
+		{
+			uint32 value = 0;
+
+			for (size_t i = 0; i < 4; ++i)
+			{
+				const char ch = p[i];
+
+				value = (value << 4) | (ch <= '9' ? ch - '0' : (ch | 0x20) - 'a' + 10);
+			}
+
+			return value;
+		}
+
+		inline bool IsJSONEscape(const char* p, const char* last)
+		{
+			switch (*p)
+			{
+			case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+				return true;
+			case 'u':
+				return (last - p > 4) && IsJSONHex(p[1]) && IsJSONHex(p[2]) && IsJSONHex(p[3]) && IsJSONHex(p[4]);
+			default:
+				return false;
+			}
+		}
+
+		inline bool IsJSONNumber(const char* p, const char* last)
+		{
+			if (p != last && *p == '-')
+			{
+				++p;
+			}
+
+			if (p == last)
+			{
+				return false;
+			}
+
+			if (*p == '0')
+			{
+				++p;
+			}
+			else if ('1' <= *p && *p <= '9')
+			{
+				while (p != last && '0' <= *p && *p <= '9') ++p;
+			}
+			else
+			{
+				return false;
+			}
+
+			if (p != last && *p == '.')
+			{
+				if (++p == last || !('0' <= *p && *p <= '9'))
+				{
+					return false;
+				}
+
+				while (p != last && '0' <= *p && *p <= '9') ++p;
+			}
+
+			if (p != last && (*p == 'e' || *p == 'E'))
+			{
+				if (++p != last && (*p == '+' || *p == '-'))
+				{
+					++p;
+				}
+
+				if (p == last || !('0' <= *p && *p <= '9'))
+				{
+					return false;
+				}
+
+				while (p != last && '0' <= *p && *p <= '9') ++p;
+			}
+
+			return p == last;
+		}
+
+		// 文字列中の次の " または \ を探す。閉じる " が必ずあり、末尾に JSONPadding の余白がある前提
+		inline const char* FindJSONQuoteOrBackslash(const char* p)
+		{
+			const __m128i quote = _mm_set1_epi8('"');
+
+			const __m128i backslash = _mm_set1_epi8('\\');
+
+			for (;; p += 16)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+				const uint32 mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+
+				if (mask)
+				{
+					return p + JSONLowestSetBit(mask);
+				}
+			}
+		}
+
+		/// <summary>
+		/// 読み込んだ JSON テキストと構造インデックス
+		/// </summary>
+		/// <remarks>
+		/// structurals には、文字列の外にある { } [ ] : , と、文字列の開始位置、数値やリテラルの開始位置が順に入ります。
+		/// jumps は { と [ の要素に対して、対応する } と ] の structurals 上の位置を持ちます。
+		/// </remarks>
+		struct JSONIndex
+		{
+			std::string text;
+
+			size_t size = 0;
+
+			Array<uint32> structurals;
+
+			Array<uint32> jumps;
+
+			FilePath path;
+
+			char at(uint32 i) const
+			{
+				return text[structurals[i]];
+			}
+
+			bool isOpen(uint32 i) const
+			{
+				const char ch = at(i);
+
+				return ch == '{' || ch == '[';
+			}
+
+			// 値 i の次の要素の位置
+			uint32 after(uint32 i) const
+			{
+				return (isOpen(i) ? jumps[i] : i) + 1;
+			}
+
+			// 値 i が配列かオブジェクトの要素であるとき、次の兄弟の値の位置。最後の要素であれば 0
+			uint32 nextSibling(uint32 i, bool inObject) const
+			{
+				const uint32 next = after(i);
+
+				if (at(next) != ',')
+				{
+					return 0;
+				}
+
+				return next + (inObject ? 3 : 1);
+			}
+
+			// 配列かオブジェクト i の最初の値の位置。空であれば 0
+			uint32 firstChild(uint32 i) const
+			{
+				if (jumps[i] == i + 1)
+				{
+					return 0;
+				}
+
+				return i + (at(i) == '{' ? 3 : 1);
+			}
+
+			const char* scalarEnd(uint32 i) const
+			{
+				const char* p = text.data() + structurals[i];
+
+				const char* const last = text.data() + size;
+
+				while (p != last && !IsJSONDelimiter(*p))
+				{
+					++p;
+				}
+
+				return p;
+			}
+
+			double getNumber(uint32 i) const
+			{
+				const char* first = text.data() + structurals[i];
+
+				const char* last = scalarEnd(i);
+
+				constexpr size_t StackLength = 64;
+
+				wchar stack[StackLength];
+
+				String heap;
+
+				wchar* buffer = stack;
+
+				const size_t length = last - first;
+
+				if (length > StackLength)
+				{
+					heap.resize(length);
+
+					buffer = &heap[0];
+				}
+
+				std::copy(first, last, buffer);
+
+				double value = 0.0;
+
+				FromChars(buffer, buffer + length, value);
+
+				return value;
+			}
+
+			// 文字列 i の閉じる " の位置を返す
+			const char* stringEnd(uint32 i, bool& escaped) const
+			{
+				const char* p = text.data() + structurals[i] + 1;
+
+				escaped = false;
+
+				for (;;)
+				{
+					p = FindJSONQuoteOrBackslash(p);
+
+					if (*p == '"')
+					{
+						return p;
+					}
+
+					escaped = true;
+
+					p += 2;
+				}
+			}
+
+			void appendString(uint32 i, String& out) const
+			{
+				const char* p = text.data() + structurals[i] + 1;
+
+				for (;;)
+				{
+					const char* run = p;
+
+					p = FindJSONQuoteOrBackslash(p);
+
+					if (p != run)
+					{
+						const size_t offset = out.length;
+
+						out.resize(offset + (p - run));
+
+						out.resize(offset + Unicode::UTF8ToUTF16(run, p - run, &out[offset]));
+					}
+
+					if (*p == '"')
+					{
+						return;
+					}
+
+					++p;
+
+					switch (*p++)
+					{
+					case 'b': out.push_back(L'\b'); break;
+					case 'f': out.push_back(L'\f'); break;
+					case 'n': out.push_back(L'\n'); break;
+					case 'r': out.push_back(L'\r'); break;
+					case 't': out.push_back(L'\t'); break;
+					case 'u':
+						{
+							uint32 unit = JSONHexValue(p);
+
+							p += 4;
+
+							if (0xD800 <= unit && unit < 0xDC00 && p[0] == '\\' && p[1] == 'u' && IsJSONEscape(p + 1, text.data() + size))
+							{
+								const uint32 low = JSONHexValue(p + 2);
+
+								if (0xDC00 <= low && low < 0xE000)
+								{
+									out.push_back(static_cast<wchar>(unit));
+
+									unit = low;
+
+									p += 6;
+								}
+							}
+							else if (0xDC00 <= unit && unit < 0xE000)
+							{
+								unit = Unicode::ReplacementCharacter;
+							}
+
+							if (0xD800 <= unit && unit < 0xDC00)
+							{
+								unit = Unicode::ReplacementCharacter;
+							}
+
+							out.push_back(static_cast<wchar>(unit));
+
+							break;
+						}
+					default: out.push_back(static_cast<wchar>(p[-1])); break;
+					}
+				}
+			}
+
+			String getString(uint32 i) const
+			{
+				String result;
+
+				appendString(i, result);
+
+				return result;
+			}
+
+			// 文字列 i が、UTF-8 の key と等しいかを返す
+			bool stringEquals(uint32 i, const std::string& key, StringView key16) const
+			{
+				bool escaped;
+
+				const char* first = text.data() + structurals[i] + 1;
+
+				const char* last = stringEnd(i, escaped);
+
+				if (!escaped)
+				{
+					return static_cast<size_t>(last - first) == key.size() && std::memcmp(first, key.data(), key.size()) == 0;
+				}
+
+				return getString(i) == key16;
+			}
+
+			JSONValue toValue(uint32 i) const
+			{
+				switch (at(i))
+				{
+				case '{':
+					{
+						JSONObject object;
+
+						for (uint32 child = firstChild(i); child; child = nextSibling(child, true))
+						{
+							object[getString(child - 2)] = toValue(child);
+						}
+
+						return JSONValue(object);
+					}
+				case '[':
+					{
+						JSONArray array;
+
+						for (uint32 child = firstChild(i); child; child = nextSibling(child, false))
+						{
+							array.push_back(toValue(child));
+						}
+
+						return JSONValue(array);
+					}
+				case '"':
+					return JSONValue(getString(i));
+				case 't':
+					return JSONValue(true);
+				case 'f':
+					return JSONValue(false);
+				case 'n':
+					return JSONValue();
+				default:
+					return JSONValue(getNumber(i));
+				}
+			}
+
+			// 1 段階目: 16 バイトずつ、文字列の内外を判別しながら構造文字と値の開始位置を集める
+			bool indexStructurals()
+			{
+				const char* const data = text.data();
+
+				const __m128i quote = _mm_set1_epi8('"');
+				const __m128i backslash = _mm_set1_epi8('\\');
+				const __m128i lowerBrace = _mm_set1_epi8('{');
+				const __m128i upperBrace = _mm_set1_epi8('}');
+				const __m128i colon = _mm_set1_epi8(':');
+				const __m128i comma = _mm_set1_epi8(',');
+				const __m128i space = _mm_set1_epi8(' ');
+				const __m128i tab = _mm_set1_epi8('\t');
+				const __m128i lf = _mm_set1_epi8('\n');
+				const __m128i cr = _mm_set1_epi8('\r');
+				const __m128i caseBit = _mm_set1_epi8(0x20);
+				const __m128i control = _mm_set1_epi8(0x1F);
+
+				uint32 prevInString = 0, prevScalar = 0, errors = 0;
+
+				bool escapeNext = false;
+
+				structurals.reserve(size / 8);
+
+				for (size_t i = 0; i < size; i += 16)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+					const uint32 valid = (size - i >= 16) ? 0xFFFF : ((1u << (size - i)) - 1);
+
+					const uint32 backslashes = _mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)) & valid;
+
+					uint32 escaped = 0;
+
+					if (backslashes || escapeNext)
+					{
+						for (uint32 bit = 0; bit < 16; ++bit)
+						{
+							if (escapeNext)
+							{
+								escaped |= (1u << bit);
+
+								escapeNext = false;
+
+								if (!IsJSONEscape(data + i + bit, data + size))
+								{
+									errors = 1;
+								}
+							}
+							else if (backslashes & (1u << bit))
+							{
+								escapeNext = true;
+							}
+						}
+					}
+
+					const uint32 quotes = _mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) & valid & ~escaped;
+
+					const uint32 inString = JSONPrefixXor(quotes) ^ prevInString;
+
+					prevInString = (inString & 0x8000) ? 0xFFFF : 0;
+
+					const __m128i lowered = _mm_or_si128(v, caseBit);
+
+					const uint32 operators = _mm_movemask_epi8(_mm_or_si128(
+						_mm_or_si128(_mm_cmpeq_epi8(lowered, lowerBrace), _mm_cmpeq_epi8(lowered, upperBrace)),
+						_mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)))) & valid;
+
+					const uint32 whitespaces = _mm_movemask_epi8(_mm_or_si128(
+						_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+						_mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr))));
+
+					const uint32 controls = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, control), control)) & valid;
+
+					errors |= controls & inString;
+
+					const uint32 outside = ~inString & ~quotes & valid;
+
+					const uint32 scalars = outside & ~operators & ~whitespaces;
+
+					const uint32 scalarStarts = scalars & ~((scalars << 1) | prevScalar);
+
+					prevScalar = (scalars >> 15) & 1;
+
+					for (uint32 bits = ((operators & outside) | (quotes & inString) | scalarStarts) & 0xFFFF; bits; bits &= bits - 1)
+					{
+						structurals.push_back(static_cast<uint32>(i + JSONLowestSetBit(bits)));
+					}
+				}
+
+				return !errors && !prevInString && !escapeNext;
+			}
+
+			// 2 段階目: 文法を検証し、{ と [ に対応する閉じ括弧の位置を記録する
+			bool validate()
+			{
+				enum class Expect { Value, ValueOrClose, Key, KeyOrClose, Colon, CommaOrClose, End };
+
+				jumps.assign(structurals.size(), 0);
+
+				Array<uint32> stack;
+
+				Expect expect = Expect::Value;
+
+				for (uint32 i = 0; i < structurals.size(); ++i)
+				{
+					const char ch = at(i);
+
+					bool closed = false, value = false;
+
+					switch (expect)
+					{
+					case Expect::ValueOrClose:
+						if (ch == ']')
+						{
+							closed = true;
+
+							break;
+						}
+						// fallthrough
+					case Expect::Value:
+						if (ch == '{')
+						{
+							stack.push_back(i);
+
+							expect = Expect::KeyOrClose;
+						}
+						else if (ch == '[')
+						{
+							stack.push_back(i);
+
+							expect = Expect::ValueOrClose;
+						}
+						else if (ch == '"')
+						{
+							value = true;
+						}
+						else
+						{
+							const char* first = text.data() + structurals[i];
+
+							const char* last = scalarEnd(i);
+
+							const size_t length = last - first;
+
+							if (!((length == 4 && std::memcmp(first, "true", 4) == 0)
+								|| (length == 5 && std::memcmp(first, "false", 5) == 0)
+								|| (length == 4 && std::memcmp(first, "null", 4) == 0)
+								|| IsJSONNumber(first, last)))
+							{
+								return false;
+							}
+
+							value = true;
+						}
+						break;
+					case Expect::KeyOrClose:
+						if (ch == '}')
+						{
+							closed = true;
+
+							break;
+						}
+						// fallthrough
+					case Expect::Key:
+						if (ch != '"')
+						{
+							return false;
+						}
+
+						expect = Expect::Colon;
+						break;
+					case Expect::Colon:
+						if (ch != ':')
+						{
+							return false;
+						}
+
+						expect = Expect::Value;
+						break;
+					case Expect::CommaOrClose:
+						if (ch == ',')
+						{
+							expect = (at(stack.back()) == '{') ? Expect::Key : Expect::Value;
+						}
+						else if (ch == ((at(stack.back()) == '{') ? '}' : ']'))
+						{
+							closed = true;
+						}
+						else
+						{
+							return false;
+						}
+						break;
+					case Expect::End:
+						return false;
+					}
+
+					if (closed)
+					{
+						jumps[stack.back()] = i;
+
+						stack.pop_back();
+
+						value = true;
+					}
+
+					if (value)
+					{
+						expect = stack.empty() ? Expect::End : Expect::CommaOrClose;
+					}
+				}
+
+				return expect == Expect::End;
+			}
+
+			bool load(IReader& reader)
+			{
+				const int64 length = reader.size() - reader.getPos();
+
+				if (length < 0 || static_cast<uint64>(length) >= 0xFFFFFFFFull)
+				{
+					return false;
+				}
+
+				text.assign(static_cast<size_t>(length) + JSONPadding, '\0');
+
+				if (reader.read(&text[0], length) != length)
+				{
+					return false;
+				}
+
+				size = static_cast<size_t>(length);
+
+				if (size >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0)
+				{
+					text.erase(0, 3);
+
+					size -= 3;
+				}
+
+				return indexStructurals() && validate();
+			}
+		};
+
+		inline std::shared_ptr<const JSONIndex> LoadJSON(IReader& reader, const FilePath& path)
+		{
+			auto index = std::make_shared<JSONIndex>();
+
+			if (!reader.isOpened() || !index->load(reader))
+			{
+				return nullptr;
+			}
+
+			index->path = path;
+
+			return index;
+		}
+	}
+
+	/// <summary>
+	/// JSONPullParser が返すイベント
+	/// </summary>
+	enum class JSONEvent
+	{
+		/// <summary>
+		/// まだ読み込んでいない、または開いていない
+		/// </summary>
+		None,
+
+		StartObject,
+
+		EndObject,
+
+		StartArray,
+
+		EndArray,
+
+		/// <summary>
+		/// オブジェクトのキー
+		/// </summary>
+		Key,
+
+		String,
+
+		Number,
+
+		Boolean,
+
+		Null,
+
+		/// <summary>
+		/// すべての値を読み終えた
+		/// </summary>
+		EndDocument,
+	};
+
+	/// <summary>
+	/// JSON のプル型パーサ
+	/// </summary>
+	/// <remarks>
+	/// JSONValue のツリーを作らずに、値を 1 つずつイベントとして読み進めます。
+	/// open() はテキストを読み込み、SIMD で構造文字の位置を索引してから文法を検証するので、
+	/// 開くことに成功した JSON を読み進める途中でエラーが起きることはありません。
+	/// 入力は UTF-8 (BOM は省略可) です。
+	/// parse() を使うと、ハンドラのメンバ関数が呼ばれる SAX 型のパーサとして使えます。
+	/// </remarks>
+	class JSONPullParser
+	{
+	private:
+
+		std::shared_ptr<const detail::JSONIndex> m_index;
+
+		// 開いている { と [ の structurals 上の位置
+		Array<uint32> m_stack;
+
+		uint32 m_pos = 0;
+
+		uint32 m_next = 0;
+
+		JSONEvent m_event = JSONEvent::None;
+
+		bool m_expectKey = false;
+
+		void reset()
+		{
+			m_stack.clear();
+
+			m_pos = m_next = 0;
+
+			m_event = JSONEvent::None;
+
+			m_expectKey = false;
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		JSONPullParser() = default;
+
+		/// <summary>
+		/// JSON ファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		explicit JSONPullParser(const FilePath& path)
+		{
+			open(path);
+		}
+
+		/// <summary>
+		/// JSON ファイルを開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		template <class Reader, class = std::enable_if_t<std::is_base_of<IReader, std::decay_t<Reader>>::value>>
+		explicit JSONPullParser(Reader&& reader)
+		{
+			open(std::forward<Reader>(reader));
+		}
+
+		/// <summary>
+		/// JSON ファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <returns>
+		/// ファイルのオープンと検証に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const FilePath& path)
+		{
+			BinaryReader reader(path);
+
+			close();
+
+			m_index = detail::LoadJSON(reader, path);
+
+			return isOpened();
+		}
+
+		/// <summary>
+		/// IReader の現在の位置から末尾までを JSON として開きます。
+		/// </summary>
+		/// <param name="reader">
+		/// IReader
+		/// </param>
+		/// <returns>
+		/// 読み込みと検証に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		template <class Reader, class = std::enable_if_t<std::is_base_of<IReader, std::decay_t<Reader>>::value>>
+		bool open(Reader&& reader)
+		{
+			close();
+
+			m_index = detail::LoadJSON(reader, FilePath());
+
+			return isOpened();
+		}
+
+		/// <summary>
+		/// JSON ファイルを閉じます。
+		/// </summary>
+		void close()
+		{
+			m_index.reset();
+
+			reset();
+		}
+
+		/// <summary>
+		/// JSON ファイルが開いているかを返します。
+		/// </summary>
+		/// <returns>
+		/// ファイルが開いている場合 true, それ以外の場合は false
+		/// </returns>
+		bool isOpened() const
+		{
+			return static_cast<bool>(m_index);
+		}
+
+		explicit operator bool() const
+		{
+			return isOpened();
+		}
+
+		/// <summary>
+		/// 先頭から読み直します。
+		/// </summary>
+		void rewind()
+		{
+			reset();
+		}
+
+		/// <summary>
+		/// 次のイベントに進みます。
+		/// </summary>
+		/// <returns>
+		/// 次のイベント。最後まで読んだ場合は JSONEvent::EndDocument
+		/// </returns>
+		JSONEvent next()
+		{
+			if (!m_index || m_event == JSONEvent::EndDocument)
+			{
+				return m_event;
+			}
+
+			const auto& index = *m_index;
+
+			for (;; ++m_next)
+			{
+				if (m_next >= index.structurals.size())
+				{
+					return m_event = JSONEvent::EndDocument;
+				}
+
+				const char ch = index.at(m_next);
+
+				if (ch == ':')
+				{
+					continue;
+				}
+
+				if (ch == ',')
+				{
+					m_expectKey = (index.at(m_stack.back()) == '{');
+
+					continue;
+				}
+
+				break;
+			}
+
+			m_pos = m_next++;
+
+			switch (index.at(m_pos))
+			{
+			case '{':
+				m_stack.push_back(m_pos);
+
+				m_expectKey = true;
+
+				return m_event = JSONEvent::StartObject;
+			case '[':
+				m_stack.push_back(m_pos);
+
+				m_expectKey = false;
+
+				return m_event = JSONEvent::StartArray;
+			case '}':
+				m_stack.pop_back();
+
+				m_expectKey = false;
+
+				return m_event = JSONEvent::EndObject;
+			case ']':
+				m_stack.pop_back();
+
+				return m_event = JSONEvent::EndArray;
+			case '"':
+				if (m_expectKey)
+				{
+					m_expectKey = false;
+
+					return m_event = JSONEvent::Key;
+				}
+
+				return m_event = JSONEvent::String;
+			case 't':
+			case 'f':
+				return m_event = JSONEvent::Boolean;
+			case 'n':
+				return m_event = JSONEvent::Null;
+			default:
+				return m_event = JSONEvent::Number;
+			}
+		}
+
+		/// <summary>
+		/// 現在のイベントを返します。
+		/// </summary>
+		JSONEvent event() const
+		{
+			return m_event;
+		}
+
+		/// <summary>
+		/// 現在開いている配列とオブジェクトの深さを返します。
+		/// </summary>
+		size_t depth() const
+		{
+			return m_stack.size();
+		}
+
+		/// <summary>
+		/// 現在のイベントが StartObject か StartArray のとき、その中身を読み飛ばして対応する EndObject か EndArray に進みます。
+		/// </summary>
+		/// <remarks>
+		/// 閉じ括弧の位置は open() で記録してあるので、中身の大きさによらず定数時間で終わります。
+		/// </remarks>
+		/// <returns>
+		/// 読み飛ばした後のイベント
+		/// </returns>
+		JSONEvent skipValue()
+		{
+			if (m_event == JSONEvent::StartObject || m_event == JSONEvent::StartArray)
+			{
+				m_next = m_index->jumps[m_pos];
+
+				return next();
+			}
+
+			return m_event;
+		}
+
+		/// <summary>
+		/// 現在のキーまたは文字列の値を返します。
+		/// </summary>
+		/// <returns>
+		/// キーまたは文字列。それ以外のイベントでは空の文字列
+		/// </returns>
+		String getString() const
+		{
+			String result;
+
+			getString(result);
+
+			return result;
+		}
+
+		/// <summary>
+		/// 現在のキーまたは文字列の値を取得します。
+		/// </summary>
+		/// <param name="out">
+		/// 取得した文字列の格納先。容量は再利用されます。
+		/// </param>
+		/// <returns>
+		/// 現在のイベントが Key か String の場合 true, それ以外の場合は false
+		/// </returns>
+		bool getString(String& out) const
+		{
+			out.clear();
+
+			if (m_event != JSONEvent::Key && m_event != JSONEvent::String)
+			{
+				return false;
+			}
+
+			m_index->appendString(m_pos, out);
+
+			return true;
+		}
+
+		/// <summary>
+		/// 現在の数値を返します。
+		/// </summary>
+		/// <returns>
+		/// 数値。それ以外のイベントでは 0.0
+		/// </returns>
+		double getNumber() const
+		{
+			return m_event == JSONEvent::Number ? m_index->getNumber(m_pos) : 0.0;
+		}
+
+		/// <summary>
+		/// 現在の真偽値を返します。
+		/// </summary>
+		/// <returns>
+		/// 真偽値。それ以外のイベントでは false
+		/// </returns>
+		bool getBool() const
+		{
+			return m_event == JSONEvent::Boolean && m_index->at(m_pos) == 't';
+		}
+
+		/// <summary>
+		/// 現在の値を JSONValue に変換します。
+		/// </summary>
+		/// <remarks>
+		/// 現在のイベントが StartObject か StartArray の場合は中身全体を変換し、対応する EndObject か EndArray に進みます。
+		/// 大きなファイルの一部分だけをツリーとして扱いたいときに使います。
+		/// </remarks>
+		/// <returns>
+		/// 値。値のイベントでない場合は null
+		/// </returns>
+		JSONValue getValue()
+		{
+			switch (m_event)
+			{
+			case JSONEvent::StartObject:
+			case JSONEvent::StartArray:
+				{
+					JSONValue value = m_index->toValue(m_pos);
+
+					skipValue();
+
+					return value;
+				}
+			case JSONEvent::String:
+			case JSONEvent::Number:
+			case JSONEvent::Boolean:
+				return m_index->toValue(m_pos);
+			default:
+				return JSONValue();
+			}
+		}
+
+		/// <summary>
+		/// 残りのすべてのイベントを、ハンドラのメンバ関数の呼び出しとして通知します。
+		/// </summary>
+		/// <remarks>
+		/// Handler は次のメンバ関数を持つ必要があります。false を返すと、その時点で中断します。
+		/// bool startObject(), bool endObject(), bool startArray(), bool endArray(),
+		/// bool key(const String&), bool string(const String&), bool number(double), bool boolean(bool), bool null()
+		/// キーと文字列は 1 つのバッファを使い回して渡されます。
+		/// </remarks>
+		/// <param name="handler">
+		/// ハンドラ
+		/// </param>
+		/// <returns>
+		/// 最後まで読んだ場合 true, ハンドラが中断した場合は false
+		/// </returns>
+		template <class Handler>
+		bool parse(Handler& handler)
+		{
+			String buffer;
+
+			for (;;)
+			{
+				bool result = true;
+
+				switch (next())
+				{
+				case JSONEvent::StartObject:
+					result = handler.startObject();
+					break;
+				case JSONEvent::EndObject:
+					result = handler.endObject();
+					break;
+				case JSONEvent::StartArray:
+					result = handler.startArray();
+					break;
+				case JSONEvent::EndArray:
+					result = handler.endArray();
+					break;
+				case JSONEvent::Key:
+					getString(buffer);
+					result = handler.key(buffer);
+					break;
+				case JSONEvent::String:
+					getString(buffer);
+					result = handler.string(buffer);
+					break;
+				case JSONEvent::Number:
+					result = handler.number(getNumber());
+					break;
+				case JSONEvent::Boolean:
+					result = handler.boolean(getBool());
+					break;
+				case JSONEvent::Null:
+					result = handler.null();
+					break;
+				default:
+					return m_event == JSONEvent::EndDocument;
+				}
+
+				if (!result)
+				{
+					return false;
+				}
+			}
+		}
+
+		/// <summary>
+		/// JSON ファイルのパスを返します。
+		/// </summary>
+		FilePath path() const
+		{
+			return m_index ? m_index->path : FilePath();
+		}
+	};
+}
@@ -0,0 +1,528 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include <cmath>
+# include <utility>
+# include <type_traits>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "String.hpp"
+# include "StringView.hpp"
+# include "FormatInt.hpp"
+# include "FormatFloat.hpp"
+# include "JSONValue.hpp"
+# include "UTF8Writer.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// JSON の書き出し
+	/// </summary>
+	/// <remarks>
+	/// JSONValue::to_str() と異なり、値を 1 つずつ UTF-8 に変換しながら IWriter に書き出すので、
+	/// 出力の大きさによらず使うメモリは一定です。
+	/// オブジェクトの中では、値の前に key() でキーを書き込みます。
+	/// 数値は値を復元できる最短の桁数で書き出し、NaN と無限大は null として書き出します。
+	/// </remarks>
+	class JSONWriter
+	{
+	private:
+
+		enum : uint8
+		{
+			InObject = 1,
+
+			HasElements = 2,
+		};
+
+		UTF8Writer m_writer;
+
+		Array<uint8> m_stack;
+
+		size_t m_indent = 0;
+
+		bool m_afterKey = false;
+
+		void writeASCII(const wchar* data, size_t length)
+		{
+			char buffer[64];
+
+			for (size_t i = 0; i < length; ++i)
+			{
+				buffer[i] = static_cast<char>(data[i]);
+			}
+
+			m_writer.writeUTF8(buffer, length);
+		}
+
+		void newLine()
+		{
+			if (!m_indent)
+			{
+				return;
+			}
+
+			m_writer.write(L'\n');
+
+			for (size_t i = 0; i < m_stack.size() * m_indent; ++i)
+			{
+				m_writer.write(L' ');
+			}
+		}
+
+		void beginValue()
+		{
+			if (std::exchange(m_afterKey, false) || m_stack.empty())
+			{
+				return;
+			}
+
+			if (m_stack.back() & HasElements)
+			{
+				m_writer.write(L',');
+			}
+
+			m_stack.back() |= HasElements;
+
+			newLine();
+		}
+
+		void beginContainer(wchar open, uint8 type)
+		{
+			beginValue();
+
+			m_writer.write(open);
+
+			m_stack.push_back(type);
+		}
+
+		void endContainer(wchar close)
+		{
+			if (m_stack.empty())
+			{
+				return;
+			}
+
+			const bool hasElements = (m_stack.back() & HasElements) != 0;
+
+			m_stack.pop_back();
+
+			if (hasElements)
+			{
+				newLine();
+			}
+
+			m_writer.write(close);
+		}
+
+		void writeString(StringView str)
+		{
+			static const char hex[] = "0123456789abcdef";
+
+			m_writer.write(L'"');
+
+			const wchar* p = str.data();
+
+			const wchar* const last = p + str.length();
+
+			while (p != last)
+			{
+				const wchar* run = p;
+
+				while (p != last && *p >= 0x20 && *p != L'"' && *p != L'\\')
+				{
+					++p;
+				}
+
+				if (p != run)
+				{
+					m_writer.write(StringView(run, p - run));
+				}
+
+				if (p == last)
+				{
+					break;
+				}
+
+				const wchar ch = *p++;
+
+				switch (ch)
+				{
+				case L'"': m_writer.writeUTF8("\\\"", 2); break;
+				case L'\\': m_writer.writeUTF8("\\\\", 2); break;
+				case L'\b': m_writer.writeUTF8("\\b", 2); break;
+				case L'\f': m_writer.writeUTF8("\\f", 2); break;
+				case L'\n': m_writer.writeUTF8("\\n", 2); break;
+				case L'\r': m_writer.writeUTF8("\\r", 2); break;
+				case L'\t': m_writer.writeUTF8("\\t", 2); break;
+				default:
+					{
+						const char escaped[6] = { '\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0xF] };
+
+						m_writer.writeUTF8(escaped, 6);
+
+						break;
+					}
+				}
+			}
+
+			m_writer.write(L'"');
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		JSONWriter() = default;
+
+		/// <summary>
+		/// 書き出し用のファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		explicit JSONWriter(const FilePath& path)
+		{
+			open(path);
+		}
+
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		template <class Writer, class = std::enable_if_t<std::is_base_of<IWriter, std::decay_t<Writer>>::value>>
+		explicit JSONWriter(Writer&& writer)
+		{
+			open(std::forward<Writer>(writer));
+		}
+
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		explicit JSONWriter(const std::shared_ptr<IWriter>& writer)
+		{
+			open(writer);
+		}
+
+		/// <summary>
+		/// デストラクタ
+		/// </summary>
+		~JSONWriter()
+		{
+			close();
+		}
+
+		/// <summary>
+		/// 書き出し用のファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <returns>
+		/// ファイルのオープンに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const FilePath& path)
+		{
+			close();
+
+			return m_writer.open(path, OpenMode::Trunc, false);
+		}
+
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <returns>
+		/// IWriter が開いている場合 true, それ以外の場合は false
+		/// </returns>
+		template <class Writer, class = std::enable_if_t<std::is_base_of<IWriter, std::decay_t<Writer>>::value>>
+		bool open(Writer&& writer)
+		{
+			close();
+
+			return m_writer.open(std::forward<Writer>(writer));
+		}
+
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <returns>
+		/// IWriter が開いている場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const std::shared_ptr<IWriter>& writer)
+		{
+			close();
+
+			return m_writer.open(writer);
+		}
+
+		/// <summary>
+		/// 閉じていない配列とオブジェクトを閉じ、すべての内容を書き出してから閉じます。
+		/// </summary>
+		void close()
+		{
+			if (!isOpened())
+			{
+				return;
+			}
+
+			while (!m_stack.empty())
+			{
+				(m_stack.back() & InObject) ? endObject() : endArray();
+			}
+
+			m_writer.close();
+
+			m_afterKey = false;
+		}
+
+		/// <summary>
+		/// バッファの内容を書き出します。
+		/// </summary>
+		void flush()
+		{
+			m_writer.flush();
+		}
+
+		bool isOpened() const
+		{
+			return m_writer.isOpened();
+		}
+
+		explicit operator bool() const
+		{
+			return isOpened();
+		}
+
+		/// <summary>
+		/// インデントの幅を設定します。
+		/// </summary>
+		/// <param name="spaces">
+		/// 1 段のインデントの空白の数。0 の場合は改行せずに書き出します。
+		/// </param>
+		void setIndent(size_t spaces)
+		{
+			m_indent = spaces;
+		}
+
+		/// <summary>
+		/// 書き出しに使うバッファの大きさを変更します。
+		/// </summary>
+		/// <param name="size">
+		/// バッファの大きさ（バイト）
+		/// </param>
+		void setBufferSize(size_t size)
+		{
+			m_writer.setBufferSize(size);
+		}
+
+		/// <summary>
+		/// 開いている配列とオブジェクトの深さを返します。
+		/// </summary>
+		size_t depth() const
+		{
+			return m_stack.size();
+		}
+
+		void startObject()
+		{
+			beginContainer(L'{', InObject);
+		}
+
+		void endObject()
+		{
+			endContainer(L'}');
+		}
+
+		void startArray()
+		{
+			beginContainer(L'[', 0);
+		}
+
+		void endArray()
+		{
+			endContainer(L']');
+		}
+
+		/// <summary>
+		/// オブジェクトのキーを書き込みます。
+		/// </summary>
+		/// <param name="name">
+		/// キー
+		/// </param>
+		void key(StringView name)
+		{
+			beginValue();
+
+			writeString(name);
+
+			m_writer.write(L':');
+
+			if (m_indent)
+			{
+				m_writer.write(L' ');
+			}
+
+			m_afterKey = true;
+		}
+
+		void write(StringView str)
+		{
+			beginValue();
+
+			writeString(str);
+		}
+
+		void write(const String& str)
+		{
+			write(StringView(str));
+		}
+
+		void write(const wchar* str)
+		{
+			write(StringView(str));
+		}
+
+		void write(bool value)
+		{
+			beginValue();
+
+			value ? m_writer.writeUTF8("true", 4) : m_writer.writeUTF8("false", 5);
+		}
+
+		void write(double value)
+		{
+			beginValue();
+
+			if (!std::isfinite(value))
+			{
+				m_writer.writeUTF8("null", 4);
+
+				return;
+			}
+
+			const detail::FormatFloat formatted(value);
+
+			writeASCII(formatted.data(), formatted.size());
+		}
+
+		void write(float value)
+		{
+			write(static_cast<double>(value));
+		}
+
+		template <class Type, std::enable_if_t<std::is_integral<Type>::value && !std::is_same<Type, bool>::value && !std::is_same<Type, wchar>::value>* = nullptr>
+		void write(Type value)
+		{
+			beginValue();
+
+			using Int = std::conditional_t<std::is_signed<Type>::value, int64, uint64>;
+
+			const detail::FormatInt formatted(static_cast<Int>(value));
+
+			writeASCII(formatted.data(), formatted.size());
+		}
+
+		void writeNull()
+		{
+			beginValue();
+
+			m_writer.writeUTF8("null", 4);
+		}
+
+		/// <summary>
+		/// JSONValue を書き込みます。
+		/// </summary>
+		/// <param name="value">
+		/// JSON データ
+		/// </param>
+		void write(const JSONValue& value)
+		{
+			switch (value.getType())
+			{
+			case JSONValue::ValueType::Boolean:
+				write(value.getBool());
+				break;
+			case JSONValue::ValueType::Number:
+				write(value.getNumber());
+				break;
+			case JSONValue::ValueType::String:
+				write(value.getString());
+				break;
+			case JSONValue::ValueType::Array:
+				startArray();
+
+				for (const auto& element : value.getArray())
+				{
+					write(element);
+				}
+
+				endArray();
+				break;
+			case JSONValue::ValueType::Object:
+				startObject();
+
+				for (const auto& member : value.getObject())
+				{
+					key(member.first);
+
+					write(member.second);
+				}
+
+				endObject();
+				break;
+			default:
+				writeNull();
+				break;
+			}
+		}
+
+		/// <summary>
+		/// キーと値を書き込みます。
+		/// </summary>
+		/// <param name="name">
+		/// キー
+		/// </param>
+		/// <param name="value">
+		/// 値
+		/// </param>
+		template <class Type>
+		void write(StringView name, const Type& value)
+		{
+			key(name);
+
+			write(value);
+		}
+
+		/// <summary>
+		/// 開いているファイルのパスを返します。
+		/// </summary>
+		/// <remarks>
+		/// IWriter に書き出している場合と、クローズしている場合は空の文字列です。
+		/// </remarks>
+		FilePath path() const
+		{
+			return m_writer.path();
+		}
+	};
+}
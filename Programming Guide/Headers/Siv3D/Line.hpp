@@ -130,6 +130,12 @@ namespace s3d
 		return os << CharType('(') << line.p[0] << CharType(',') << line.p[1] << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const LineInt& line)
+	{
+		FormatTuple(formatData, line.p[0], line.p[1]);
+	}
+
 	template <class CharType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, LineInt& line)
 	{
@@ -137,6 +143,20 @@ namespace s3d
 		return is >> unused >> line.p[0] >> unused >> line.p[1] >> unused;
 	}
 
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, LineInt& line)
+	{
+		LineInt result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.p[0], result.p[1]);
+
+		if (r)
+		{
+			line = result;
+		}
+
+		return r;
+	}
+
 	/// <summary>
 	/// 線分
 	/// </summary>
@@ -252,12 +272,32 @@ namespace s3d
 		return os << CharType('(') << line.p[0] << CharType(',') << line.p[1] << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const Line& line)
+	{
+		FormatTuple(formatData, line.p[0], line.p[1]);
+	}
+
 	template <class CharType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, Line& line)
 	{
 		CharType unused;
 		return is >> unused >> line.p[0] >> unused >> line.p[1] >> unused;
 	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Line& line)
+	{
+		Line result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.p[0], result.p[1]);
+
+		if (r)
+		{
+			line = result;
+		}
+
+		return r;
+	}
 }
 
 # include "Line.inl"
@@ -36,7 +36,7 @@ namespace s3d
 
 		explicit LineString(const String& pts)
 		{
-			std::wistringstream(pts.str()) >> *this;
+			FromChars(pts, *this);
 		}
 
 		explicit LineString(const Array<Point>& pts)
@@ -314,4 +314,30 @@ namespace s3d
 
 		return is;
 	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, LineString& lineStr)
+	{
+		detail::TextScanner scanner(first, last);
+
+		Array<Vec2> pts;
+		wchar unused = L'\0';
+
+		scanner >> unused;
+
+		while (scanner && unused != L')')
+		{
+			Vec2 v;
+
+			scanner >> v >> unused;
+
+			pts.push_back(v);
+		}
+
+		if (scanner)
+		{
+			lineStr = LineString(std::move(pts));
+		}
+
+		return scanner.result();
+	}
 }
@@ -0,0 +1,681 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include <cstring>
+# include <intrin.h>
+# include <emmintrin.h>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "String.hpp"
+# include "StringView.hpp"
+# include "Optional.hpp"
+# include "Parse.hpp"
+# include "DateTime.hpp"
+# include "FileSystem.hpp"
+# include "ThreadPool.hpp"
+# include "Unicode.hpp"
+# include "MemoryMappedFile.hpp"
+# include "PropertyMacro.hpp"
+
+namespace s3d
+{
+	namespace detail
+	{
+		inline uint32 LowestSetBit(uint32 mask)
+		{
+			unsigned long index;
+
+			_BitScanForward(&index, mask);
+
+			return index;
+		}
+
+		/// <summary>
+		/// ファイルの一部分を走査して見つけた改行の位置
+		/// </summary>
+		/// <remarks>
+		/// 区間の先頭が引用符の外か内かは、前の区間をすべて走査するまで分からないため、
+		/// 区間内の引用符の数の偶奇ごとに改行を記録しておき、後から正しい方を選びます。
+		/// </remarks>
+		struct CSVChunkScan
+		{
+			Array<size_t> newlines[2];
+
+			bool oddQuotes = false;
+		};
+
+		inline void ScanCSVChunk(const uint8* data, size_t first, size_t last, CSVChunkScan& scan)
+		{
+			const __m128i quote = _mm_set1_epi8('"');
+
+			const __m128i lf = _mm_set1_epi8('\n');
+
+			uint32 parity = 0;
+
+			size_t i = first;
+
+			for (; i + 16 <= last; i += 16)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+				const uint32 q = _mm_movemask_epi8(_mm_cmpeq_epi8(v, quote));
+
+				uint32 n = _mm_movemask_epi8(_mm_cmpeq_epi8(v, lf));
+
+				if (!q)
+				{
+					for (; n; n &= n - 1)
+					{
+						scan.newlines[parity].push_back(i + LowestSetBit(n));
+					}
+
+					continue;
+				}
+
+				for (uint32 m = q | n; m; m &= m - 1)
+				{
+					const uint32 bit = LowestSetBit(m);
+
+					if (q & (1u << bit))
+					{
+						parity ^= 1;
+					}
+					else
+					{
+						scan.newlines[parity].push_back(i + bit);
+					}
+				}
+			}
+
+			for (; i < last; ++i)
+			{
+				if (data[i] == '"')
+				{
+					parity ^= 1;
+				}
+				else if (data[i] == '\n')
+				{
+					scan.newlines[parity].push_back(i);
+				}
+			}
+
+			scan.oddQuotes = (parity != 0);
+		}
+
+		/// <summary>
+		/// マップした CSV ファイルと、その行とフィールドの位置
+		/// </summary>
+		struct CSVIndex
+		{
+			MemoryMappedFile file;
+
+			Optional<DateTime> writeTime;
+
+			uint8 separator = ',';
+
+			// 行 r のフィールドは fieldStarts[rowOffsets[r]] から fieldStarts[rowOffsets[r + 1] - 1] まで。
+			// 各行の最後の要素は番兵で、最後のフィールドの終端 + 1 を指す
+			Array<size_t> rowOffsets;
+
+			Array<size_t> fieldStarts;
+
+			// 行 [first, last) のフィールドの開始位置を starts に、各行のフィールド数 + 1 を counts に追加する
+			void scanFields(const Array<size_t>& rowStarts, size_t first, size_t last, Array<size_t>& starts, Array<size_t>& counts) const
+			{
+				const uint8* const data = file.data();
+
+				for (size_t row = first; row < last; ++row)
+				{
+					const size_t begin = rowStarts[row];
+
+					size_t end = rowStarts[row + 1] - 1;
+
+					if (end > begin && data[end - 1] == '\r')
+					{
+						--end;
+					}
+
+					const size_t before = starts.size();
+
+					size_t pos = begin;
+
+					for (;;)
+					{
+						starts.push_back(pos);
+
+						size_t p = pos;
+
+						if (p < end && data[p] == '"')
+						{
+							for (++p; p < end; ++p)
+							{
+								if (data[p] == '"')
+								{
+									if (p + 1 < end && data[p + 1] == '"')
+									{
+										++p;
+									}
+									else
+									{
+										++p;
+										break;
+									}
+								}
+							}
+						}
+
+						const void* sep = (p < end) ? std::memchr(data + p, separator, end - p) : nullptr;
+
+						if (!sep)
+						{
+							break;
+						}
+
+						pos = static_cast<const uint8*>(sep) - data + 1;
+					}
+
+					starts.push_back(end + 1);
+
+					counts.push_back(starts.size() - before);
+				}
+			}
+
+			void build()
+			{
+				const uint8* const data = file.data();
+
+				const size_t size = file.size();
+
+				const size_t start = (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) ? 3 : 0;
+
+				const auto pool = Threading::GetPool();
+
+				const size_t maxTasks = (pool->numThreads() + 1) * 4;
+
+				// 改行の位置を区間ごとに並列に探す
+				const size_t numChunks = std::max<size_t>(1, std::min<size_t>((size - start) >> 20, maxTasks));
+
+				const size_t chunkSize = (size - start + numChunks - 1) / numChunks;
+
+				Array<CSVChunkScan> scans(numChunks);
+
+				pool->parallelFor(0, numChunks, [&](size_t i)
+				{
+					const size_t first = start + chunkSize * i;
+
+					ScanCSVChunk(data, first, std::min(first + chunkSize, size), scans[i]);
+				});
+
+				Array<size_t> rowStarts;
+
+				rowStarts.push_back(start);
+
+				size_t parity = 0;
+
+				for (auto& scan : scans)
+				{
+					for (const size_t pos : scan.newlines[parity])
+					{
+						rowStarts.push_back(pos + 1);
+					}
+
+					parity ^= scan.oddQuotes;
+
+					Array<size_t>().swap(scan.newlines[0]);
+
+					Array<size_t>().swap(scan.newlines[1]);
+				}
+
+				// 最後の要素は番兵で、ファイルの末尾に改行があるものとした位置の次を指す
+				if (rowStarts.back() < size)
+				{
+					rowStarts.push_back(size + 1);
+				}
+
+				// 各行のフィールドの位置を並列に求めてから連結する
+				const size_t numRows = rowStarts.size() - 1;
+
+				const size_t numRowChunks = std::max<size_t>(1, std::min<size_t>(numRows / 4096, maxTasks));
+
+				const size_t rowsPerChunk = (numRows + numRowChunks - 1) / std::max<size_t>(numRowChunks, 1);
+
+				Array<Array<size_t>> starts(numRowChunks), counts(numRowChunks);
+
+				pool->parallelFor(0, numRowChunks, [&](size_t i)
+				{
+					const size_t first = std::min(rowsPerChunk * i, numRows);
+
+					scanFields(rowStarts, first, std::min(first + rowsPerChunk, numRows), starts[i], counts[i]);
+				});
+
+				Array<size_t>().swap(rowStarts);
+
+				Array<size_t> bases(numRowChunks + 1);
+
+				rowOffsets.reserve(numRows + 1);
+
+				rowOffsets.push_back(0);
+
+				for (size_t i = 0; i < numRowChunks; ++i)
+				{
+					bases[i + 1] = bases[i] + starts[i].size();
+
+					for (const size_t count : counts[i])
+					{
+						rowOffsets.push_back(rowOffsets.back() + count);
+					}
+
+					Array<size_t>().swap(counts[i]);
+				}
+
+				fieldStarts.resize(bases.back());
+
+				pool->parallelFor(0, numRowChunks, [&](size_t i)
+				{
+					std::copy(starts[i].begin(), starts[i].end(), fieldStarts.begin() + bases[i]);
+
+					Array<size_t>().swap(starts[i]);
+				});
+			}
+		};
+	}
+
+	/// <summary>
+	/// メモリにマップして読み込む CSV ファイル
+	/// </summary>
+	/// <remarks>
+	/// ファイルを UTF-8 (BOM は省略可) としてメモリにマップし、行とフィールドの位置だけを記録します。
+	/// 行の区切りは、引用符の内外を判別しながら複数のスレッドで並列に探します。
+	/// フィールドの値はアクセスされたときに変換され、String としては保持しません。
+	/// CSVReader と同じ関数で値を取得できるほか、getColumn() で列全体を並列に変換できます。
+	/// コピーは読み込んだ内容を共有します。
+	/// </remarks>
+	class MappedCSVReader
+	{
+	private:
+
+		std::shared_ptr<const detail::CSVIndex> m_index;
+
+		// フィールドの内容を UTF-16 に変換して function に渡す
+		template <class Fty>
+		bool visitField(size_t row, size_t column, Fty function) const
+		{
+			if (!m_index || row + 1 >= m_index->rowOffsets.size())
+			{
+				return false;
+			}
+
+			const size_t offset = m_index->rowOffsets[row] + column;
+
+			if (offset + 1 >= m_index->rowOffsets[row + 1])
+			{
+				return false;
+			}
+
+			const char* first = reinterpret_cast<const char*>(m_index->file.data()) + m_index->fieldStarts[offset];
+
+			const char* last = reinterpret_cast<const char*>(m_index->file.data()) + m_index->fieldStarts[offset + 1] - 1;
+
+			const bool quoted = (first != last && *first == '"');
+
+			if (quoted)
+			{
+				++first;
+
+				const char* closing = last;
+
+				while (closing != first && closing[-1] != '"')
+				{
+					--closing;
+				}
+
+				if (closing != first)
+				{
+					last = closing - 1;
+				}
+			}
+
+			constexpr size_t StackLength = 128;
+
+			wchar stack[StackLength];
+
+			String heap;
+
+			const size_t length = last - first;
+
+			wchar* buffer = stack;
+
+			if (length > StackLength)
+			{
+				heap.resize(length);
+
+				buffer = &heap[0];
+			}
+
+			size_t n = Unicode::UTF8ToUTF16(first, length, buffer);
+
+			if (quoted)
+			{
+				// "" を " に戻す
+				size_t to = 0;
+
+				for (size_t from = 0; from < n; ++from)
+				{
+					buffer[to++] = buffer[from];
+
+					if (buffer[from] == L'"' && from + 1 < n && buffer[from + 1] == L'"')
+					{
+						++from;
+					}
+				}
+
+				n = to;
+			}
+
+			function(StringView(buffer, n));
+
+			return true;
+		}
+
+		template <class Type>
+		static bool Convert(StringView str, Type& to)
+		{
+			if (auto value = ParseOpt<Type>(str))
+			{
+				to = std::move(value.value());
+
+				return true;
+			}
+
+			return false;
+		}
+
+		static bool Convert(StringView str, String& to)
+		{
+			to.assign(str.begin(), str.end());
+
+			return true;
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		MappedCSVReader() = default;
+
+		/// <summary>
+		/// CSV ファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <param name="separator">
+		/// 区切り文字
+		/// </param>
+		explicit MappedCSVReader(const FilePath& path, char separator = ',')
+		{
+			open(path, separator);
+		}
+
+		/// <summary>
+		/// CSV ファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <param name="separator">
+		/// 区切り文字
+		/// </param>
+		/// <returns>
+		/// ファイルのオープンに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const FilePath& path, char separator = ',')
+		{
+			close();
+
+			auto index = std::make_shared<detail::CSVIndex>();
+
+			if (!index->file.open(path))
+			{
+				return false;
+			}
+
+			index->writeTime = FileSystem::WriteTime(path);
+
+			index->separator = static_cast<uint8>(separator);
+
+			index->build();
+
+			m_index = std::move(index);
+
+			return true;
+		}
+
+		/// <summary>
+		/// CSV ファイルを閉じます。
+		/// </summary>
+		void close()
+		{
+			m_index.reset();
+		}
+
+		/// <summary>
+		/// CSV ファイルが開いているかを返します。
+		/// </summary>
+		/// <returns>
+		/// ファイルが開いている場合 true, それ以外の場合は false
+		/// </returns>
+		bool isOpened() const
+		{
+			return static_cast<bool>(m_index);
+		}
+
+		/// <summary>
+		/// 開いてから CSV ファイルが更新されたかを返します。
+		/// </summary>
+		/// <remarks>
+		/// マップ中のファイルへの書き込みと、別のファイルで置き換える保存を検出できます。
+		/// マップ中のファイルを短くする書き込みは OS によって拒否されます。
+		/// </remarks>
+		/// <returns>
+		/// 更新された場合 true, それ以外の場合は false
+		/// </returns>
+		bool hasChanged() const
+		{
+			return m_index && FileSystem::WriteTime(m_index->file.path()) != m_index->writeTime;
+		}
+
+		/// <summary>
+		/// CSV ファイルを開き直します。
+		/// </summary>
+		/// <returns>
+		/// ファイルのオープンに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool reload()
+		{
+			if (!m_index)
+			{
+				return false;
+			}
+
+			const FilePath path = m_index->file.path();
+
+			return open(path, static_cast<char>(m_index->separator));
+		}
+
+		explicit operator bool() const
+		{
+			return isOpened();
+		}
+
+		/// <summary>
+		/// 指定した行の列数を返します。
+		/// </summary>
+		/// <param name="row">
+		/// 行
+		/// </param>
+		/// <returns>
+		/// 列数。行が存在しない場合は 0
+		/// </returns>
+		size_t columns(size_t row) const
+		{
+			if (!m_index || row + 1 >= m_index->rowOffsets.size())
+			{
+				return 0;
+			}
+
+			return m_index->rowOffsets[row + 1] - m_index->rowOffsets[row] - 1;
+		}
+
+		/// <summary>
+		/// 指定した行と列の値を取得します。
+		/// </summary>
+		/// <param name="row">
+		/// 行
+		/// </param>
+		/// <param name="column">
+		/// 列
+		/// </param>
+		/// <returns>
+		/// 値。存在しないか変換できない場合は Type()
+		/// </returns>
+		template <class Type>
+		Type get(size_t row, size_t column) const
+		{
+			if (const auto opt = getOpt<Type>(row, column))
+			{
+				return opt.value();
+			}
+
+			return Type();
+		}
+
+		/// <summary>
+		/// 指定した行と列の値を取得します。
+		/// </summary>
+		/// <param name="row">
+		/// 行
+		/// </param>
+		/// <param name="column">
+		/// 列
+		/// </param>
+		/// <param name="defaultValue">
+		/// 存在しないか変換できない場合の値
+		/// </param>
+		/// <returns>
+		/// 値
+		/// </returns>
+		template <class Type>
+		Type getOr(size_t row, size_t column, Type&& defaultValue) const
+		{
+			return getOpt<Type>(row, column).value_or(std::move(defaultValue));
+		}
+
+		/// <summary>
+		/// 指定した行と列の値を取得します。
+		/// </summary>
+		/// <param name="row">
+		/// 行
+		/// </param>
+		/// <param name="column">
+		/// 列
+		/// </param>
+		/// <returns>
+		/// 値の Optional. 存在しないか変換できない場合は none
+		/// </returns>
+		template <class Type>
+		Optional<Type> getOpt(size_t row, size_t column) const
+		{
+			Optional<Type> result;
+
+			visitField(row, column, [&result](StringView str)
+			{
+				Type value;
+
+				if (Convert(str, value))
+				{
+					result = std::move(value);
+				}
+			});
+
+			return result;
+		}
+
+		/// <summary>
+		/// 指定した列の値を全ての行について並列に変換します。
+		/// </summary>
+		/// <param name="column">
+		/// 列
+		/// </param>
+		/// <param name="defaultValue">
+		/// 存在しないか変換できない場合の値
+		/// </param>
+		/// <returns>
+		/// 行数と同じ長さの配列
+		/// </returns>
+		template <class Type>
+		Array<Type> getColumn(size_t column, const Type& defaultValue = Type()) const
+		{
+			const size_t numRows = rows;
+
+			Array<Type> result(numRows, defaultValue);
+
+			const size_t rowsPerTask = 16384;
+
+			Threading::GetPool()->parallelFor(0, (numRows + rowsPerTask - 1) / rowsPerTask, [&](size_t task)
+			{
+				const size_t last = std::min(numRows, (task + 1) * rowsPerTask);
+
+				for (size_t row = task * rowsPerTask; row < last; ++row)
+				{
+					visitField(row, column, [&](StringView str)
+					{
+						Convert(str, result[row]);
+					});
+				}
+			});
+
+			return result;
+		}
+
+		/// <summary>
+		/// 行が 1 つもないかを返します。
+		/// </summary>
+		/// <returns>
+		/// 行が 1 つもない場合 true, それ以外の場合は false
+		/// </returns>
+		bool isEmpty() const
+		{
+			return rows == 0;
+		}
+
+		/// <summary>
+		/// 行数
+		/// </summary>
+		Property_Get(size_t, rows) const
+		{
+			return m_index ? m_index->rowOffsets.size() - 1 : 0;
+		}
+
+		/// <summary>
+		/// 開いている CSV ファイルのパスを返します。
+		/// </summary>
+		/// <returns>
+		/// ファイルパス
+		/// </returns>
+		FilePath path() const
+		{
+			return m_index ? m_index->file.path() : FilePath();
+		}
+	};
+}
@@ -0,0 +1,432 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include <cstring>
+# include <type_traits>
+# include "Fwd.hpp"
+# include "IReader.hpp"
+# include "String.hpp"
+# include "ArrayView.hpp"
+# include "MemoryMappedFile.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// メモリにマップした読み込み用ファイル
+	/// </summary>
+	/// <remarks>
+	/// BinaryReader と異なり、ファイルをメモリにマップして読み込みます。
+	/// ファイルの内容はアクセスされたページから OS が読み込むため、大きなファイルでもファイル全体を読み込むためのメモリを確保しません。
+	/// data() と readSubset() はマップされたメモリを直接指し、コピーしません。
+	/// コピーした MappedFileReader はマッピングを共有し、読み込み位置はそれぞれが持ちます。
+	/// マッピングは、それを共有する最後の MappedFileReader が閉じられるまで有効です。
+	/// </remarks>
+	class MappedFileReader : public IReader
+	{
+	private:
+
+		std::shared_ptr<const MemoryMappedFile> m_file;
+
+		int64 m_size = 0;
+
+		int64 m_pos = 0;
+
+		int64 clampSize(int64 pos, int64 size) const
+		{
+			if (pos < 0 || pos > m_size || size < 0)
+			{
+				return 0;
+			}
+
+			return (size > m_size - pos) ? (m_size - pos) : size;
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		MappedFileReader() = default;
+
+		/// <summary>
+		/// 読み込み用のファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		explicit MappedFileReader(const FilePath& path)
+		{
+			open(path);
+		}
+
+		/// <summary>
+		/// 読み込み用のファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <returns>
+		/// ファイルのオープンに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const FilePath& path)
+		{
+			close();
+
+			auto file = std::make_shared<MemoryMappedFile>(path);
+
+			if (!file->isOpened())
+			{
+				return false;
+			}
+
+			m_size = static_cast<int64>(file->size());
+
+			m_file = std::move(file);
+
+			return true;
+		}
+
+		/// <summary>
+		/// ファイルを閉じます。
+		/// </summary>
+		/// <remarks>
+		/// 他の MappedFileReader がマッピングを共有している場合、マッピングはそれらが閉じられるまで残ります。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void close()
+		{
+			m_file.reset();
+
+			m_size = m_pos = 0;
+		}
+
+		/// <summary>
+		/// ファイルがオープンされているかを返します。
+		/// </summary>
+		/// <returns>
+		/// ファイルがオープンされている場合 true, それ以外の場合は false
+		/// </returns>
+		bool isOpened() const override
+		{
+			return static_cast<bool>(m_file);
+		}
+
+		/// <summary>
+		/// ファイルがオープンされているかを返します。
+		/// </summary>
+		/// <returns>
+		/// ファイルがオープンされている場合 true, それ以外の場合は false
+		/// </returns>
+		explicit operator bool() const { return isOpened(); }
+
+		/// <summary>
+		/// ファイルのサイズを返します。
+		/// </summary>
+		/// <returns>
+		/// ファイルのサイズ（バイト）
+		/// </returns>
+		int64 size() const override
+		{
+			return m_size;
+		}
+
+		/// <summary>
+		/// 現在の読み込み位置を返します。
+		/// </summary>
+		/// <returns>
+		/// 現在の読み込み位置（バイト）
+		/// </returns>
+		int64 getPos() const override
+		{
+			return m_pos;
+		}
+
+		/// <summary>
+		/// 読み込み位置を変更します。
+		/// </summary>
+		/// <param name="pos">
+		/// 新しい読み込み位置（バイト）
+		/// </param>
+		/// <returns>
+		/// 読み込み位置の変更に成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool setPos(int64 pos) override
+		{
+			if (pos < 0 || pos > m_size)
+			{
+				return false;
+			}
+
+			m_pos = pos;
+
+			return true;
+		}
+
+		/// <summary>
+		/// ファイルを読み飛ばし、読み込み位置を変更します。
+		/// </summary>
+		/// <param name="offset">
+		/// 読み飛ばすサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 新しい読み込み位置
+		/// </returns>
+		int64 skip(int64 offset) override
+		{
+			m_pos += (offset < -m_pos) ? -m_pos : (offset > m_size - m_pos) ? (m_size - m_pos) : offset;
+
+			return m_pos;
+		}
+
+		/// <summary>
+		/// マップされたファイルの先頭のポインタを返します。
+		/// </summary>
+		/// <remarks>
+		/// 現在の読み込み位置に関係なく、ファイルの先頭のポインタを返します。
+		/// 空のファイルや、オープンしていない場合は nullptr です。
+		/// </remarks>
+		/// <returns>
+		/// ファイルの先頭のポインタ
+		/// </returns>
+		const uint8* data() const
+		{
+			return m_file ? m_file->data() : nullptr;
+		}
+
+		/// <summary>
+		/// ファイルからデータを読み込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 読み込み先
+		/// </param>
+		/// <param name="size">
+		/// 読み込むサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 実際に読み込んだサイズ（バイト）
+		/// </returns>
+		int64 read(_Out_writes_bytes_all_(size) void* buffer, int64 size) override
+		{
+			const int64 readSize = lookahead(buffer, m_pos, size);
+
+			m_pos += readSize;
+
+			return readSize;
+		}
+
+		/// <summary>
+		/// ファイルからデータを読み込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 読み込み先
+		/// </param>
+		/// <param name="pos">
+		/// 先頭から数えた読み込み開始位置（バイト）
+		/// </param>
+		/// <param name="size">
+		/// 読み込むサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 実際に読み込んだサイズ（バイト）
+		/// </returns>
+		int64 read(_Out_writes_bytes_all_(size) void* buffer, int64 pos, int64 size) override
+		{
+			if (!setPos(pos))
+			{
+				return 0;
+			}
+
+			return read(buffer, size);
+		}
+
+		/// <summary>
+		/// ファイルからデータを読み込みます。
+		/// </summary>
+		/// <param name="to">
+		/// 読み込み先
+		/// </param>
+		/// <returns>
+		/// 読み込みに成功したら true, それ以外の場合は false
+		/// </returns>
+		template <class Type>
+		_Check_return_ bool read(Type& to)
+		{
+			static_assert(std::is_trivially_copyable<Type>::value, "MappedFileReader::read(): Type must be trivially copyable");
+
+			if (static_cast<int64>(sizeof(Type)) > m_size - m_pos)
+			{
+				return false;
+			}
+
+			std::memcpy(std::addressof(to), m_file->data() + m_pos, sizeof(Type));
+
+			m_pos += sizeof(Type);
+
+			return true;
+		}
+
+		/// <summary>
+		/// 読み込み位置を変更しないデータ読み込みをサポートしているかを返します。
+		/// </summary>
+		/// <returns>
+		/// つねに true
+		/// </returns>
+		bool supportsLookahead() const override { return true; }
+
+		/// <summary>
+		/// 読み込み位置を変更しないでデータを読み込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 読み込み先
+		/// </param>
+		/// <param name="size">
+		/// 読み込むサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 実際に読み込んだサイズ（バイト）
+		/// </returns>
+		int64 lookahead(_Out_writes_bytes_all_(size) void* buffer, int64 size) const override
+		{
+			return lookahead(buffer, m_pos, size);
+		}
+
+		/// <summary>
+		/// 読み込み位置を変更しないでデータを読み込みます。
+		/// </summary>
+		/// <param name="buffer">
+		/// 読み込み先
+		/// </param>
+		/// <param name="pos">
+		/// 先頭から数えた読み込み開始位置（バイト）
+		/// </param>
+		/// <param name="size">
+		/// 読み込むサイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// 実際に読み込んだサイズ（バイト）
+		/// </returns>
+		int64 lookahead(_Out_writes_bytes_all_(size) void* buffer, int64 pos, int64 size) const override
+		{
+			const int64 readSize = clampSize(pos, size);
+
+			if (readSize)
+			{
+				std::memcpy(buffer, m_file->data() + pos, static_cast<size_t>(readSize));
+			}
+
+			return readSize;
+		}
+
+		/// <summary>
+		/// 読み込み位置を変更しないでデータを読み込みます。
+		/// </summary>
+		/// <param name="to">
+		/// 読み込み先
+		/// </param>
+		/// <returns>
+		/// 読み込みに成功したら true, それ以外の場合は false
+		/// </returns>
+		template <class Type>
+		_Check_return_ bool lookahead(Type& to) const
+		{
+			static_assert(std::is_trivially_copyable<Type>::value, "MappedFileReader::lookahead(): Type must be trivially copyable");
+
+			return IReader::lookahead(to);
+		}
+
+		/// <summary>
+		/// 読み込み位置を変更しないで、指定した範囲のデータへの参照を返します。
+		/// </summary>
+		/// <param name="pos">
+		/// 先頭から数えた開始位置（バイト）
+		/// </param>
+		/// <param name="size">
+		/// サイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// マップされたメモリへの参照。範囲がファイルの終端を越える場合は終端までの参照
+		/// </returns>
+		ArrayView<uint8> lookaheadSubset(int64 pos, int64 size) const
+		{
+			const int64 viewSize = clampSize(pos, size);
+
+			return viewSize ? ArrayView<uint8>(m_file->data() + pos, static_cast<size_t>(viewSize)) : ArrayView<uint8>();
+		}
+
+		/// <summary>
+		/// 現在の読み込み位置以降のすべてのデータへの参照を返し、読み込み位置を終端に移動します。
+		/// </summary>
+		/// <returns>
+		/// マップされたメモリへの参照
+		/// </returns>
+		_Check_return_
+		ArrayView<uint8> readWhole()
+		{
+			return readSubset(m_size - m_pos);
+		}
+
+		/// <summary>
+		/// 現在の読み込み位置から指定したサイズのデータへの参照を返し、読み込み位置を進めます。
+		/// </summary>
+		/// <param name="size">
+		/// サイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// マップされたメモリへの参照
+		/// </returns>
+		_Check_return_
+		ArrayView<uint8> readSubset(int64 size)
+		{
+			const ArrayView<uint8> view = lookaheadSubset(m_pos, size);
+
+			m_pos += view.size();
+
+			return view;
+		}
+
+		/// <summary>
+		/// 読み込み範囲を指定してデータへの参照を返し、読み込み位置をその範囲の終端に移動します。
+		/// </summary>
+		/// <param name="pos">
+		/// 先頭から数えた開始位置（バイト）
+		/// </param>
+		/// <param name="size">
+		/// サイズ（バイト）
+		/// </param>
+		/// <returns>
+		/// マップされたメモリへの参照
+		/// </returns>
+		_Check_return_
+		ArrayView<uint8> readSubset(int64 pos, int64 size)
+		{
+			if (!setPos(pos))
+			{
+				return ArrayView<uint8>();
+			}
+
+			return readSubset(size);
+		}
+
+		/// <summary>
+		/// オープンしているファイルのパスを返します。
+		/// </summary>
+		/// <remarks>
+		/// クローズしている場合は空の文字列です。
+		/// </remarks>
+		FilePath path() const
+		{
+			return m_file ? m_file->path() : FilePath();
+		}
+	};
+}
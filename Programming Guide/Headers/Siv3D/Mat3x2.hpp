@@ -205,6 +205,12 @@ namespace s3d
 			<< Float2(mat._31, mat._32) << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const Mat3x2& mat)
+	{
+		FormatTuple(formatData, Float2(mat._11, mat._12), Float2(mat._21, mat._22), Float2(mat._31, mat._32));
+	}
+
 	template <class CharType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, Mat3x2& mat)
 	{
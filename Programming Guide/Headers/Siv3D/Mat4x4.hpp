@@ -173,6 +173,12 @@ namespace s3d
 			<< mat.r[3] << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const Mat4x4& mat)
+	{
+		FormatTuple(formatData, mat.r[0], mat.r[1], mat.r[2], mat.r[3]);
+	}
+
 	template <class CharType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, Mat4x4& mat)
 	{
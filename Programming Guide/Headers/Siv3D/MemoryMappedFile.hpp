@@ -0,0 +1,293 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cstdint>
+# include <utility>
+# include "Fwd.hpp"
+# include "String.hpp"
+
+// <Windows.h> は GDI の Rectangle, Ellipse, Polygon や MessageBox マクロを公開してしまうので、
+// 必要な kernel32 の関数だけを <Windows.h> と同じ型で宣言する
+struct _SECURITY_ATTRIBUTES;
+
+extern "C"
+{
+	__declspec(dllimport) void* __stdcall CreateFileW(const wchar_t* lpFileName, unsigned long dwDesiredAccess, unsigned long dwShareMode,
+		_SECURITY_ATTRIBUTES* lpSecurityAttributes, unsigned long dwCreationDisposition, unsigned long dwFlagsAndAttributes, void* hTemplateFile);
+
+	__declspec(dllimport) unsigned long __stdcall GetFileSize(void* hFile, unsigned long* lpFileSizeHigh);
+
+	__declspec(dllimport) void* __stdcall CreateFileMappingW(void* hFile, _SECURITY_ATTRIBUTES* lpFileMappingAttributes, unsigned long flProtect,
+		unsigned long dwMaximumSizeHigh, unsigned long dwMaximumSizeLow, const wchar_t* lpName);
+
+# ifdef _WIN64
+	__declspec(dllimport) void* __stdcall MapViewOfFile(void* hFileMappingObject, unsigned long dwDesiredAccess,
+		unsigned long dwFileOffsetHigh, unsigned long dwFileOffsetLow, unsigned __int64 dwNumberOfBytesToMap);
+# else
+	__declspec(dllimport) void* __stdcall MapViewOfFile(void* hFileMappingObject, unsigned long dwDesiredAccess,
+		unsigned long dwFileOffsetHigh, unsigned long dwFileOffsetLow, unsigned long dwNumberOfBytesToMap);
+# endif
+
+	__declspec(dllimport) int __stdcall UnmapViewOfFile(const void* lpBaseAddress);
+
+	__declspec(dllimport) int __stdcall CloseHandle(void* hObject);
+
+	__declspec(dllimport) unsigned long __stdcall GetLastError();
+
+	__declspec(dllimport) void __stdcall SetLastError(unsigned long dwErrCode);
+}
+
+namespace s3d
+{
+	namespace detail
+	{
+		namespace Win32
+		{
+			constexpr unsigned long GenericRead = 0x80000000UL;
+
+			constexpr unsigned long FileShareRead = 0x00000001UL;
+
+			constexpr unsigned long FileShareWrite = 0x00000002UL;
+
+			constexpr unsigned long FileShareDelete = 0x00000004UL;
+
+			constexpr unsigned long OpenExisting = 3;
+
+			constexpr unsigned long FileAttributeNormal = 0x00000080UL;
+
+			constexpr unsigned long PageReadOnly = 0x02;
+
+			constexpr unsigned long FileMapRead = 0x0004;
+
+			constexpr unsigned long InvalidFileSize = 0xFFFFFFFFUL;
+
+			inline void* InvalidHandle()
+			{
+				return reinterpret_cast<void*>(static_cast<std::intptr_t>(-1));
+			}
+		}
+	}
+
+	/// <summary>
+	/// 読み込み専用でメモリにマップしたファイル
+	/// </summary>
+	/// <remarks>
+	/// ファイルの内容はアクセスされたページから OS が読み込むため、ファイル全体を読み込むためのメモリを確保しません。
+	/// マップ中も他のプロセスによる読み込み・書き込み・削除（上書き保存のための置き換え）を許可します。
+	/// ファイルが書き換えられるとマップした内容も変わりうるので、変更を検出した場合は開き直してください。
+	/// </remarks>
+	class MemoryMappedFile
+	{
+	private:
+
+		void* m_file = detail::Win32::InvalidHandle();
+
+		void* m_mapping = nullptr;
+
+		const uint8* m_data = nullptr;
+
+		size_t m_size = 0;
+
+		FilePath m_path;
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		MemoryMappedFile() = default;
+
+		/// <summary>
+		/// ファイルをマップします。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		explicit MemoryMappedFile(const FilePath& path)
+		{
+			open(path);
+		}
+
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+
+		MemoryMappedFile& operator =(const MemoryMappedFile&) = delete;
+
+		MemoryMappedFile(MemoryMappedFile&& other) noexcept
+		{
+			swap(other);
+		}
+
+		MemoryMappedFile& operator =(MemoryMappedFile&& other) noexcept
+		{
+			MemoryMappedFile(std::move(other)).swap(*this);
+
+			return *this;
+		}
+
+		/// <summary>
+		/// デストラクタ
+		/// </summary>
+		~MemoryMappedFile()
+		{
+			close();
+		}
+
+		/// <summary>
+		/// ファイルをマップします。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <remarks>
+		/// 大きさが 0 のファイルは、data() が nullptr の状態で開かれます。
+		/// </remarks>
+		/// <returns>
+		/// ファイルのマップに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const FilePath& path)
+		{
+			close();
+
+			using namespace detail::Win32;
+
+			m_file = ::CreateFileW(path.c_str(), GenericRead, FileShareRead | FileShareWrite | FileShareDelete, nullptr, OpenExisting, FileAttributeNormal, nullptr);
+
+			if (m_file == InvalidHandle())
+			{
+				return false;
+			}
+
+			unsigned long sizeHigh = 0;
+
+			::SetLastError(0);
+
+			const unsigned long sizeLow = ::GetFileSize(m_file, &sizeHigh);
+
+			const uint64 size = (static_cast<uint64>(sizeHigh) << 32) | sizeLow;
+
+			if ((sizeLow == InvalidFileSize && ::GetLastError() != 0) || size > static_cast<uint64>(SIZE_MAX))
+			{
+				close();
+
+				return false;
+			}
+
+			m_path = path;
+
+			if (size == 0)
+			{
+				return true;
+			}
+
+			m_mapping = ::CreateFileMappingW(m_file, nullptr, PageReadOnly, 0, 0, nullptr);
+
+			if (!m_mapping)
+			{
+				close();
+
+				return false;
+			}
+
+			m_data = static_cast<const uint8*>(::MapViewOfFile(m_mapping, FileMapRead, 0, 0, 0));
+
+			if (!m_data)
+			{
+				close();
+
+				return false;
+			}
+
+			m_size = static_cast<size_t>(size);
+
+			return true;
+		}
+
+		/// <summary>
+		/// ファイルのマップを解除して閉じます。
+		/// </summary>
+		void close()
+		{
+			if (m_data)
+			{
+				::UnmapViewOfFile(m_data);
+
+				m_data = nullptr;
+			}
+
+			if (m_mapping)
+			{
+				::CloseHandle(m_mapping);
+
+				m_mapping = nullptr;
+			}
+
+			if (m_file != detail::Win32::InvalidHandle())
+			{
+				::CloseHandle(m_file);
+
+				m_file = detail::Win32::InvalidHandle();
+			}
+
+			m_size = 0;
+
+			m_path.clear();
+		}
+
+		/// <summary>
+		/// ファイルが開かれているかを返します。
+		/// </summary>
+		/// <returns>
+		/// ファイルが開かれている場合 true, それ以外の場合は false
+		/// </returns>
+		bool isOpened() const
+		{
+			return m_file != detail::Win32::InvalidHandle();
+		}
+
+		explicit operator bool() const
+		{
+			return isOpened();
+		}
+
+		/// <summary>
+		/// ファイルの内容の先頭を返します。
+		/// </summary>
+		const uint8* data() const
+		{
+			return m_data;
+		}
+
+		/// <summary>
+		/// ファイルの大きさ（バイト）を返します。
+		/// </summary>
+		size_t size() const
+		{
+			return m_size;
+		}
+
+		/// <summary>
+		/// 開いているファイルのパスを返します。
+		/// </summary>
+		const FilePath& path() const
+		{
+			return m_path;
+		}
+
+		void swap(MemoryMappedFile& other) noexcept
+		{
+			std::swap(m_file, other.m_file);
+			std::swap(m_mapping, other.m_mapping);
+			std::swap(m_data, other.m_data);
+			std::swap(m_size, other.m_size);
+			m_path.swap(other.m_path);
+		}
+	};
+}
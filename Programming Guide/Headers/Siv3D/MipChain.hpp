@@ -0,0 +1,383 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cmath>
+# include <cstring>
+# include <emmintrin.h>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "Image.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// すべてのミップマップレベルを 1 つの連続したメモリに格納した画像
+	/// </summary>
+	/// <remarks>
+	/// レベル 0 が元の画像で、各レベルの行は隙間なく並びます（行のデータサイズは 幅 * sizeof(Color)）。
+	/// テクスチャのサブリソースの初期データとしてそのまま渡せます。
+	/// </remarks>
+	struct MipChain
+	{
+		/// <summary>
+		/// すべてのレベルのピクセル
+		/// </summary>
+		Array<Color> pixels;
+
+		/// <summary>
+		/// 各レベルの幅と高さ（ピクセル）
+		/// </summary>
+		Array<Size> sizes;
+
+		/// <summary>
+		/// 各レベルの先頭の pixels でのインデックス
+		/// </summary>
+		Array<size_t> offsets;
+
+		/// <summary>
+		/// レベルの数を返します。
+		/// </summary>
+		size_t levels() const
+		{
+			return sizes.size();
+		}
+
+		/// <summary>
+		/// 指定したレベルの先頭のポインタを返します。
+		/// </summary>
+		const Color* level(size_t index) const
+		{
+			return pixels.data() + offsets[index];
+		}
+
+		/// <summary>
+		/// 指定したレベルの先頭のポインタを返します。
+		/// </summary>
+		Color* level(size_t index)
+		{
+			return pixels.data() + offsets[index];
+		}
+
+		/// <summary>
+		/// 指定したレベルの行のデータサイズを返します。
+		/// </summary>
+		uint32 stride(size_t index) const
+		{
+			return sizes[index].x * sizeof(Color);
+		}
+
+		/// <summary>
+		/// 指定したレベルをコピーした Image を返します。
+		/// </summary>
+		Image toImage(size_t index) const
+		{
+			Image image(sizes[index]);
+
+			if (!image.isEmpty)
+			{
+				std::memcpy(image.data(), level(index), image.memorySize());
+			}
+
+			return image;
+		}
+
+		/// <summary>
+		/// すべてのレベルをコピーした Image の配列を返します。
+		/// </summary>
+		/// <remarks>
+		/// Texture(const Array<Image>&, TextureDesc) に渡せます。
+		/// </remarks>
+		Array<Image> toImages() const
+		{
+			Array<Image> images;
+
+			for (size_t i = 0; i < levels(); ++i)
+			{
+				images.push_back(toImage(i));
+			}
+
+			return images;
+		}
+	};
+
+	namespace Imaging
+	{
+		namespace detail
+		{
+			inline const float* SRGBToLinearTable()
+			{
+				static const auto table = []()
+				{
+					Array<float> t(256);
+
+					for (size_t i = 0; i < 256; ++i)
+					{
+						const double c = i / 255.0;
+
+						t[i] = static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+					}
+
+					return t;
+				}();
+
+				return table.data();
+			}
+
+			// 線形値を 16 ビットで量子化して引く。黒付近の急な勾配でも 1 階調未満の誤差に収まる
+			inline const uint8* LinearToSRGBTable()
+			{
+				static const auto table = []()
+				{
+					Array<uint8> t(65536);
+
+					for (size_t i = 0; i < t.size(); ++i)
+					{
+						const double c = i / 65535.0;
+
+						const double s = c <= 0.0031308 ? c * 12.92 : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055;
+
+						t[i] = static_cast<uint8>(Clamp(s * 255.0 + 0.5, 0.0, 255.0));
+					}
+
+					return t;
+				}();
+
+				return table.data();
+			}
+
+			// 1 レベル分の状態。下のレベルの行がそろうたびに 1 行を縮小する
+			struct MipLevelBuilder
+			{
+				Size size;
+
+				Color* output = nullptr;
+
+				int32 rowsReceived = 0;
+
+				int32 firstPending = 0;
+
+				// 未消費の行 (1 ピクセル = RGBA の float 4 個)
+				Array<Array<float>> pending;
+			};
+
+			class MipChainBuilder
+			{
+			private:
+
+				Array<MipLevelBuilder> m_levels;
+
+				const float* m_toLinear;
+
+				const uint8* m_toSRGB;
+
+				bool m_sRGB;
+
+				Array<float> m_rowSum;
+
+				uint32 toChannel(float linear) const
+				{
+					if (m_sRGB)
+					{
+						return m_toSRGB[static_cast<int32>(Clamp(linear, 0.0f, 1.0f) * 65535.0f + 0.5f)];
+					}
+
+					return static_cast<uint32>(Clamp(linear * 255.0f + 0.5f, 0.0f, 255.0f));
+				}
+
+				void writeRow(MipLevelBuilder& level, int32 y, const float* row)
+				{
+					Color* out = level.output + static_cast<size_t>(y) * level.size.x;
+
+					for (int32 x = 0; x < level.size.x; ++x, row += 4)
+					{
+						out[x] = Color(toChannel(row[0]), toChannel(row[1]), toChannel(row[2]),
+							static_cast<uint32>(Clamp(row[3] * 255.0f + 0.5f, 0.0f, 255.0f)));
+					}
+				}
+
+				// 下のレベルの行 [begin, end) と列を 2:1 で縮小した 1 行を作る（奇数の端は 3 つを平均）
+				void reduce(const MipLevelBuilder& src, int32 begin, int32 end, int32 dstWidth, Array<float>& dst)
+				{
+					const int32 srcWidth = src.size.x;
+
+					m_rowSum.assign(static_cast<size_t>(srcWidth) * 4, 0.0f);
+
+					for (int32 y = begin; y < end; ++y)
+					{
+						const float* row = src.pending[y - src.firstPending].data();
+
+						for (size_t i = 0; i < m_rowSum.size(); i += 4)
+						{
+							_mm_storeu_ps(&m_rowSum[i], _mm_add_ps(_mm_loadu_ps(&m_rowSum[i]), _mm_loadu_ps(row + i)));
+						}
+					}
+
+					dst.resize(static_cast<size_t>(dstWidth) * 4);
+
+					for (int32 x = 0; x < dstWidth; ++x)
+					{
+						const int32 x0 = 2 * x;
+
+						const int32 x1 = (x == dstWidth - 1) ? srcWidth : std::min(x0 + 2, srcWidth);
+
+						__m128 sum = _mm_setzero_ps();
+
+						for (int32 sx = x0; sx < x1; ++sx)
+						{
+							sum = _mm_add_ps(sum, _mm_loadu_ps(&m_rowSum[sx * 4]));
+						}
+
+						const float scale = 1.0f / ((x1 - x0) * (end - begin));
+
+						_mm_storeu_ps(&dst[x * 4], _mm_mul_ps(sum, _mm_set1_ps(scale)));
+					}
+				}
+
+			public:
+
+				MipChainBuilder(MipChain& chain, bool sRGB)
+					: m_toLinear(SRGBToLinearTable())
+					, m_toSRGB(LinearToSRGBTable())
+					, m_sRGB(sRGB)
+				{
+					for (size_t i = 0; i < chain.levels(); ++i)
+					{
+						MipLevelBuilder level;
+
+						level.size = chain.sizes[i];
+
+						level.output = chain.level(i);
+
+						m_levels.push_back(std::move(level));
+					}
+				}
+
+				void pushSourceRow(const Color* row)
+				{
+					MipLevelBuilder& base = m_levels[0];
+
+					Array<float> linear(static_cast<size_t>(base.size.x) * 4);
+
+					for (int32 x = 0; x < base.size.x; ++x)
+					{
+						const Color c = row[x];
+
+						linear[x * 4 + 0] = m_sRGB ? m_toLinear[c.r] : c.r / 255.0f;
+						linear[x * 4 + 1] = m_sRGB ? m_toLinear[c.g] : c.g / 255.0f;
+						linear[x * 4 + 2] = m_sRGB ? m_toLinear[c.b] : c.b / 255.0f;
+						linear[x * 4 + 3] = c.a / 255.0f;
+					}
+
+					pushRow(0, std::move(linear));
+				}
+
+				void pushRow(size_t index, Array<float>&& row)
+				{
+					if (index + 1 >= m_levels.size())
+					{
+						return;
+					}
+
+					MipLevelBuilder& src = m_levels[index];
+
+					MipLevelBuilder& dst = m_levels[index + 1];
+
+					src.pending.push_back(std::move(row));
+
+					++src.rowsReceived;
+
+					const int32 y = dst.rowsReceived;
+
+					const int32 begin = 2 * y;
+
+					const int32 end = (y == dst.size.y - 1) ? src.size.y : begin + 2;
+
+					if (src.rowsReceived < end)
+					{
+						return;
+					}
+
+					Array<float> reduced;
+
+					reduce(src, begin, end, dst.size.x, reduced);
+
+					writeRow(dst, y, reduced.data());
+
+					src.pending.clear();
+
+					src.firstPending = src.rowsReceived;
+
+					pushRow(index + 1, std::move(reduced));
+				}
+			};
+		}
+
+		/// <summary>
+		/// 1x1 までのすべてのミップマップを生成します。
+		/// </summary>
+		/// <param name="src">
+		/// 元の画像
+		/// </param>
+		/// <param name="sRGB">
+		/// RGB 成分を sRGB として扱い、線形空間で平均する場合 true
+		/// </param>
+		/// <remarks>
+		/// 元の画像を 1 回だけ上から順に読み、2 行そろうたびに次のレベルの 1 行を作ります。
+		/// 中間のレベルは 8 ビットに丸めずに線形の浮動小数点のまま次のレベルの入力になり、処理中の行はキャッシュに収まります。
+		/// 幅や高さが奇数のときは、端の 3 ピクセルを平均します。
+		/// </remarks>
+		/// <returns>
+		/// ミップマップ
+		/// </returns>
+		inline MipChain GenerateMipChain(const Image& src, bool sRGB = true)
+		{
+			MipChain chain;
+
+			if (src.isEmpty)
+			{
+				return chain;
+			}
+
+			Size size = src.size;
+
+			size_t total = 0;
+
+			for (;;)
+			{
+				chain.sizes.push_back(size);
+
+				chain.offsets.push_back(total);
+
+				total += static_cast<size_t>(size.x) * size.y;
+
+				if (size.x == 1 && size.y == 1)
+				{
+					break;
+				}
+
+				size = Size(std::max(size.x / 2, 1), std::max(size.y / 2, 1));
+			}
+
+			chain.pixels.resize(total);
+
+			std::memcpy(chain.level(0), src.data(), src.memorySize());
+
+			detail::MipChainBuilder builder(chain, sRGB);
+
+			for (int32 y = 0; y < src.height; ++y)
+			{
+				builder.pushSourceRow(src[y]);
+			}
+
+			return chain;
+		}
+	}
+}
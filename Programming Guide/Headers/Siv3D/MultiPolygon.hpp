@@ -37,7 +37,7 @@ namespace s3d
 
 		explicit MultiPolygon(const String& pts)
 		{
-			std::wistringstream(pts.str()) >> *this;
+			FromChars(pts, *this);
 		}
 
 		explicit MultiPolygon(const Array<Polygon>& polygons);
@@ -248,6 +248,32 @@ namespace s3d
 		return is;
 	}
 
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, MultiPolygon& multiPolygon)
+	{
+		detail::TextScanner scanner(first, last);
+
+		Array<Polygon> polygons;
+		wchar unused = L'\0';
+
+		scanner >> unused;
+
+		while (scanner && unused != L')')
+		{
+			Polygon polygon;
+
+			scanner >> polygon >> unused;
+
+			polygons.push_back(std::move(polygon));
+		}
+
+		if (scanner)
+		{
+			multiPolygon = MultiPolygon(std::move(polygons));
+		}
+
+		return scanner.result();
+	}
+
 	namespace Geometry2D
 	{
 		/// <summary>
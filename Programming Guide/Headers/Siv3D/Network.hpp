@@ -46,7 +46,7 @@ namespace s3d
 
 		explicit IPv4(const String& ipv4)
 		{
-			std::wistringstream(ipv4.str()) >> *this;
+			FromChars(ipv4, *this);
 		}
 
 		static IPv4 localhost()
@@ -88,6 +88,26 @@ namespace s3d
 		return is;
 	}
 
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, IPv4& ipv4)
+	{
+		detail::TextScanner scanner(first, last);
+
+		uint8 b[4];
+		wchar unused;
+
+		scanner >> b[0] >> unused
+			>> b[1] >> unused
+			>> b[2] >> unused
+			>> b[3];
+
+		if (scanner)
+		{
+			ipv4 = IPv4(b[0], b[1], b[2], b[3]);
+		}
+
+		return scanner.result();
+	}
+
 	namespace Network
 	{
 		Optional<IPv4> GetPrivateIPv4();
@@ -14,6 +14,7 @@
 # include "String.hpp"
 # include "StaticAssertMacro.hpp"
 # include "FormatInt.hpp"
+# include "FromChars.hpp"
 # include "Optional.hpp"
 
 namespace s3d
@@ -430,586 +431,80 @@ namespace s3d
 	//
 	////////////////////////////////////////////////////////////////
 
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <class Type>
-	Type FromString(const String& str, int32 radix = 0);
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline int8 FromString<int8>(const String& str, int32 radix)
-	{
-		const int32 result = ::wcstol(str.c_str(), nullptr, radix);
-		return (result < INT8_MIN || INT8_MAX < result) ? 0 : static_cast<int8>(result);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline uint8 FromString<uint8>(const String& str, int32 radix)
-	{
-		const uint32 result = ::wcstoul(str.c_str(), nullptr, radix);
-		return (UINT8_MAX < result) ? 0 : static_cast<uint8>(result);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline int16 FromString<int16>(const String& str, int32 radix)
-	{
-		const int32 result = ::wcstol(str.data(), nullptr, radix);
-		return (result < INT16_MIN || INT16_MAX < result) ? 0 : static_cast<int16>(result);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline uint16 FromString<uint16>(const String& str, int32 radix)
-	{
-		const uint32 result = ::wcstoul(str.data(), nullptr, radix);
-		return (UINT16_MAX < result) ? 0 : static_cast<uint16>(result);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline int32 FromString<int32>(const String& str, int32 radix)
-	{
-		return ::wcstol(str.data(), nullptr, radix);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline uint32 FromString<uint32>(const String& str, int32 radix)
-	{
-		return ::wcstoul(str.data(), nullptr, radix);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline long FromString<long>(const String& str, int32 radix)
-	{
-		return ::wcstol(str.data(), nullptr, radix);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline unsigned long FromString<unsigned long>(const String& str, int32 radix)
-	{
-		return ::wcstoul(str.data(), nullptr, radix);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline int64 FromString<int64>(const String& str, int32 radix)
-	{
-		return ::_wcstoi64(str.data(), nullptr, radix);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline uint64 FromString<uint64>(const String& str, int32 radix)
-	{
-		return ::_wcstoui64(str.data(), nullptr, radix);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"123.45")
-	/// </param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline float FromString<float>(const String& str, int32)
-	{
-		return static_cast<float>(::_wtof(str.data()));
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"123.45")
-	/// </param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline double FromString<double>(const String& str, int32)
-	{
-		return ::_wtof(str.data());
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"123.45")
-	/// </param>
-	/// <returns>
-	/// 文字列から変換された数値
-	/// </returns>
-	template <>
-	inline long double FromString<long double>(const String& str, int32)
-	{
-		return ::_wtof(str.data());
-	}
-
-	////////////////////////////////////////////////////////////////
-	//
-	//		FromStringOpt
-	//
-	////////////////////////////////////////////////////////////////
-
-	template<class Type>
-	Optional<Type> FromStringOpt(const String& str, int32 radix = 0);
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"123", L"0x7F")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
-	/// </returns>
-	template <>
-	inline Optional<int8> FromStringOpt<int8>(const String& str, int32 radix)
+	namespace detail
 	{
-		wchar* p;
-		const int32 result = ::wcstol(str.data(), &p, radix);
-
-		if (str.data() == p || result < INT8_MIN || INT8_MAX < result)
+		template <class Type>
+		inline FromCharsResult FromString(StringView str, Type& value, int32 radix, std::false_type)
 		{
-			return none;
-		}
-
-		return static_cast<int8>(result);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"123", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
-	/// </returns>
-	template <>
-	inline Optional<uint8> FromStringOpt<uint8>(const String& str, int32 radix)
-	{
-		wchar* p;
-		const uint32 result = ::wcstol(str.data(), &p, radix);
+			const wchar* const last = str.data() + str.length();
 
-		if (str.data() == p || UINT8_MAX < result)
-		{
-			return none;
+			return FromChars(SkipSpaces(str.data(), last), last, value, radix);
 		}
 
-		return static_cast<uint8>(result);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
-	/// </returns>
-	template <>
-	inline Optional<int16> FromStringOpt<int16>(const String& str, int32 radix)
-	{
-		wchar* p;
-		const int32 result = ::wcstol(str.data(), &p, radix);
-
-		if (str.data() == p || result < INT16_MIN || INT16_MAX < result)
-		{
-			return none;
-		}
-
-		return static_cast<int16>(result);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
-	/// </returns>
-	template <>
-	inline Optional<uint16> FromStringOpt<uint16>(const String& str, int32 radix)
-	{
-		wchar* p;
-		const uint32 result = ::wcstol(str.data(), &p, radix);
-
-		if (str.data() == p || UINT16_MAX < result)
-		{
-			return none;
-		}
-
-		return static_cast<uint16>(result);
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
-	/// </returns>
-	template <>
-	inline Optional<int32> FromStringOpt<int32>(const String& str, int32 radix)
-	{
-		wchar* p;
-		const int32 result = ::wcstol(str.data(), &p, radix);
-
-		if (str.data() == p)
-		{
-			return none;
-		}
-
-		return result;
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
-	/// </returns>
-	template <>
-	inline Optional<uint32> FromStringOpt<uint32>(const String& str, int32 radix)
-	{
-		wchar* p;
-		const uint32 result = ::wcstoul(str.data(), &p, radix);
-
-		if (str.data() == p)
+		template <class Type>
+		inline FromCharsResult FromString(StringView str, Type& value, int32, std::true_type)
 		{
-			return none;
-		}
+			const wchar* const last = str.data() + str.length();
 
-		return result;
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
-	/// </returns>
-	template <>
-	inline Optional<long> FromStringOpt<long>(const String& str, int32 radix)
-	{
-		wchar* p;
-		const long result = ::wcstol(str.data(), &p, radix);
-
-		if (str.data() == p)
-		{
-			return none;
+			return FromChars(SkipSpaces(str.data(), last), last, value);
 		}
-
-		return result;
 	}
 
 	/// <summary>
 	/// 文字列から数値に変換します。
 	/// </summary>
 	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
+	///	変換される文字列（例: L"12345", L"0xFF", L"1.5e3"）
 	/// </param>
 	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
+	///	整数の場合に使用する基数、0 の場合は自動
 	///	</param>
+	/// <remarks>
+	/// 先頭の空白を読み飛ばし、数値として読み取れる部分までを変換します。ロケールには依存しません。
+	/// </remarks>
 	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
+	/// 文字列から変換された数値、失敗した場合や範囲外の場合は 0
 	/// </returns>
-	template <>
-	inline Optional<unsigned long> FromStringOpt<unsigned long>(const String& str, int32 radix)
+	template <class Type>
+	inline Type FromString(StringView str, int32 radix = 0)
 	{
-		wchar* p;
-		const unsigned long result = ::wcstoul(str.data(), &p, radix);
+		static_assert(std::is_arithmetic<Type>::value, "FromString() requires an arithmetic type");
 
-		if (str.data() == p)
-		{
-			return none;
-		}
+		Type value = 0;
 
-		return result;
-	}
+		detail::FromString(str, value, radix, std::is_floating_point<Type>());
 
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
-	/// </param>
-	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
-	///	</param>
-	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
-	/// </returns>
-	template <>
-	inline Optional<int64> FromStringOpt<int64>(const String& str, int32 radix)
-	{
-		wchar* p;
-		const int64 result = ::_wcstoi64(str.data(), &p, radix);
-
-		if (str.data() == p)
-		{
-			return none;
-		}
-
-		return result;
+		return value;
 	}
 
 	/// <summary>
 	/// 文字列から数値に変換します。
 	/// </summary>
 	/// <param name="str">
-	///	変換される文字列（例: L"12345", L"0xFF")
+	///	変換される文字列（例: L"12345", L"0xFF", L"1.5e3"）
 	/// </param>
 	/// <param name="radix">
-	///	使用する基数、0 の場合は自動
+	///	整数の場合に使用する基数、0 の場合は自動
 	///	</param>
+	/// <remarks>
+	/// 先頭の空白を読み飛ばし、数値として読み取れる部分までを変換します。ロケールには依存しません。
+	/// </remarks>
 	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
-	/// </returns>
-	template <>
-	inline Optional<uint64> FromStringOpt<uint64>(const String& str, int32 radix)
-	{
-		wchar* p;
-		const uint64 result = ::_wcstoui64(str.data(), &p, radix);
-
-		if (str.data() == p)
-		{
-			return none;
-		}
-
-		return result;
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"123.45")
-	/// </param>
-	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
-	/// </returns>
-	template <>
-	inline Optional<float> FromStringOpt<float>(const String& str, int32)
-	{
-		wchar* p;
-		const float result = static_cast<float>(::wcstod(str.data(), &p));
-
-		if (str.data() == p)
-		{
-			return none;
-		}
-
-		return result;
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"123.45")
-	/// </param>
-	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
+	/// 文字列から変換された数値の Optional, 失敗した場合や範囲外の場合は none
 	/// </returns>
-	template <>
-	inline Optional<double> FromStringOpt<double>(const String& str, int32)
+	template <class Type>
+	inline Optional<Type> FromStringOpt(StringView str, int32 radix = 0)
 	{
-		wchar* p;
-		const double result = ::wcstod(str.data(), &p);
-
-		if (str.data() == p)
-		{
-			return none;
-		}
+		static_assert(std::is_arithmetic<Type>::value, "FromStringOpt() requires an arithmetic type");
 
-		return result;
-	}
-
-	/// <summary>
-	/// 文字列から数値に変換します。
-	/// </summary>
-	/// <param name="str">
-	///	変換される文字列（例: L"123.45")
-	/// </param>
-	/// <returns>
-	/// 文字列から変換された数値の Optional, 失敗した場合は none
-	/// </returns>
-	template <>
-	inline Optional<long double> FromStringOpt<long double>(const String& str, int32)
-	{
-		wchar* p;
-		const long double result = ::wcstod(str.data(), &p);
+		Type value;
 
-		if (str.data() == p)
+		if (detail::FromString(str, value, radix, std::is_floating_point<Type>()))
 		{
-			return none;
+			return value;
 		}
 
-		return result;
+		return none;
 	}
 
 	////////////////////////////////////////////////////////////////
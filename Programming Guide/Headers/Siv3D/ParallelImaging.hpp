@@ -0,0 +1,236 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cstring>
+# include "Fwd.hpp"
+# include "Image.hpp"
+# include "ThreadPool.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// 画像を行の帯（タイル）に分割して、フィルタをスレッドプールで並列に適用するスケジューラ
+	/// </summary>
+	/// <remarks>
+	/// 各タイルにはフィルタのカーネル半径分の上下の余白（ハロー）を付けて処理し、余白を除いた行だけを出力にコピーします。
+	/// 画像の上下端ではハローが画像の端で打ち切られるため、単一スレッドで画像全体に適用した結果とビット単位で一致します。
+	/// </remarks>
+	class ImageTileScheduler
+	{
+	private:
+
+		std::shared_ptr<ThreadPool> m_pool;
+
+		size_t m_bandBytes;
+
+	public:
+
+		/// <summary>
+		/// 1 つのタイルの既定のデータサイズ（バイト）
+		/// </summary>
+		static constexpr size_t DefaultBandBytes = 256 * 1024;
+
+		/// <summary>
+		/// スケジューラを作成します。
+		/// </summary>
+		/// <param name="pool">
+		/// 使用するスレッドプール
+		/// </param>
+		/// <param name="bandBytes">
+		/// 1 つのタイルのおおよそのデータサイズ（バイト）
+		/// </param>
+		explicit ImageTileScheduler(std::shared_ptr<ThreadPool> pool = Threading::GetPool(), size_t bandBytes = DefaultBandBytes)
+			: m_pool(std::move(pool))
+			, m_bandBytes(bandBytes) {}
+
+		/// <summary>
+		/// タイルの高さ（ピクセル）を返します。
+		/// </summary>
+		/// <param name="image">
+		/// 分割する画像
+		/// </param>
+		/// <param name="halo">
+		/// フィルタが必要とする上下の余白（ピクセル）
+		/// </param>
+		/// <returns>
+		/// タイルの高さ（ピクセル）
+		/// </returns>
+		int32 bandHeight(const Image& image, int32 halo) const
+		{
+			if (image.isEmpty)
+			{
+				return 0;
+			}
+
+			const int32 rows = static_cast<int32>(m_bandBytes / image.stride);
+
+			// ハローの再計算量をタイルの半分以下に抑える
+			const int32 minRows = std::max(halo * 4, 8);
+
+			return std::min(std::max(rows, minRows), image.height);
+		}
+
+		/// <summary>
+		/// 画像をタイルに分割してフィルタを適用します。
+		/// </summary>
+		/// <param name="src">
+		/// 入力画像
+		/// </param>
+		/// <param name="dst">
+		/// 出力画像
+		/// </param>
+		/// <param name="halo">
+		/// フィルタのカーネル半径（ピクセル）以上の値
+		/// </param>
+		/// <param name="filter">
+		/// 画像の大きさを変えない単一スレッドのフィルタ
+		/// </param>
+		/// <remarks>
+		/// src と dst は同じ画像でもかまいません。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		void apply(const Image& src, Image& dst, int32 halo, const std::function<void(const Image&, Image&)>& filter) const
+		{
+			const int32 bandRows = bandHeight(src, halo);
+
+			if (bandRows == 0 || bandRows >= src.height || m_pool->numThreads() == 0)
+			{
+				filter(src, dst);
+
+				return;
+			}
+
+			if (&src == &dst)
+			{
+				const Image copy = src;
+
+				apply(copy, dst, halo, filter);
+
+				return;
+			}
+
+			const int32 width = src.width;
+
+			const int32 height = src.height;
+
+			const size_t numBands = (height + bandRows - 1) / bandRows;
+
+			dst.resize(width, height);
+
+			m_pool->parallelFor(0, numBands, [&](size_t band)
+			{
+				const int32 y0 = static_cast<int32>(band) * bandRows;
+				const int32 y1 = std::min(y0 + bandRows, height);
+				const int32 top = std::max(y0 - halo, 0);
+				const int32 bottom = std::min(y1 + halo, height);
+
+				const Image in = src.clip(0, top, width, bottom - top);
+
+				Image out;
+
+				filter(in, out);
+
+				for (int32 y = y0; y < y1; ++y)
+				{
+					std::memcpy(dst[y], out[y - top], src.stride);
+				}
+			});
+		}
+	};
+
+	namespace Imaging
+	{
+		/// <summary>
+		/// Imaging のフィルタを ImageTileScheduler で並列に実行する関数群
+		/// </summary>
+		/// <remarks>
+		/// 結果は同名の Imaging の関数とビット単位で一致します。
+		/// 使用するスレッド数は Threading::SetPoolSize() で変更できます。
+		/// </remarks>
+		namespace Parallel
+		{
+			inline void Blur(const Image& src, Image& dst, int32 horizontal, int32 vertical)
+			{
+				ImageTileScheduler().apply(src, dst, vertical, [=](const Image& s, Image& d)
+				{
+					Imaging::Blur(s, d, horizontal, vertical);
+				});
+			}
+
+			inline void GaussianBlur(const Image& src, Image& dst, int32 horizontal, int32 vertical)
+			{
+				ImageTileScheduler().apply(src, dst, vertical, [=](const Image& s, Image& d)
+				{
+					Imaging::GaussianBlur(s, d, horizontal, vertical);
+				});
+			}
+
+			inline void MedianBlur(const Image& src, Image& dst, int32 apertureSize)
+			{
+				ImageTileScheduler().apply(src, dst, apertureSize, [=](const Image& s, Image& d)
+				{
+					Imaging::MedianBlur(s, d, apertureSize);
+				});
+			}
+
+			inline void Dilate(const Image& src, Image& dst, int32 iterations = 1)
+			{
+				ImageTileScheduler().apply(src, dst, iterations, [=](const Image& s, Image& d)
+				{
+					Imaging::Dilate(s, d, iterations);
+				});
+			}
+
+			inline void Erode(const Image& src, Image& dst, int32 iterations = 1)
+			{
+				ImageTileScheduler().apply(src, dst, iterations, [=](const Image& s, Image& d)
+				{
+					Imaging::Erode(s, d, iterations);
+				});
+			}
+
+			inline void Sobel(const Image& src, Image& dst, int32 dx = 1, int32 dy = 1, int32 apertureSize = 3)
+			{
+				ImageTileScheduler().apply(src, dst, apertureSize, [=](const Image& s, Image& d)
+				{
+					Imaging::Sobel(s, d, dx, dy, apertureSize);
+				});
+			}
+
+			inline void Laplacian(const Image& src, Image& dst, int32 apertureSize = 3)
+			{
+				ImageTileScheduler().apply(src, dst, apertureSize, [=](const Image& s, Image& d)
+				{
+					Imaging::Laplacian(s, d, apertureSize);
+				});
+			}
+
+			inline void AdaptiveThreshold(const Image& src, Image& dst, AdaptiveMethod method, int32 blockSize, int32 c, bool inverse = false)
+			{
+				ImageTileScheduler().apply(src, dst, blockSize, [=](const Image& s, Image& d)
+				{
+					Imaging::AdaptiveThreshold(s, d, method, blockSize, c, inverse);
+				});
+			}
+
+			/// <remarks>
+			/// Canny のヒステリシス処理はエッジを画像全体にわたって追跡するため、タイルに分割すると結果が一致しません。
+			/// そのため、この関数は Imaging::Canny() をそのまま呼び出します。
+			/// </remarks>
+			inline void Canny(const Image& src, Image& dst, uint8 lowThreshold, uint8 highThreshold, int32 apertureSize = 3, bool useL2Gradient = false)
+			{
+				Imaging::Canny(src, dst, lowThreshold, highThreshold, apertureSize, useL2Gradient);
+			}
+		}
+	}
+}
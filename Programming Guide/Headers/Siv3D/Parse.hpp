@@ -9,6 +9,7 @@
 //-----------------------------------------------
 
 # pragma once
+# include <cstring>
 # include <sstream>
 # include "String.hpp"
 # include "Optional.hpp"
@@ -16,6 +17,58 @@
 
 namespace s3d
 {
+	namespace detail
+	{
+		inline StringView TrimSpaces(StringView str)
+		{
+			const wchar* first = str.data();
+
+			const wchar* last = first + str.length();
+
+			first = SkipSpaces(first, last);
+
+			while (first != last && IsSpace(last[-1]))
+			{
+				--last;
+			}
+
+			return StringView(first, last - first);
+		}
+
+		inline bool EqualsNoCase(StringView str, const char* word)
+		{
+			return str.length() == std::strlen(word) && MatchNoCase(str.data(), str.data() + str.length(), word);
+		}
+
+		template <class Type>
+		struct HasFromChars
+		{
+		private:
+
+			template <class U>
+			static auto test(int) -> decltype(FromChars(std::declval<const wchar*>(), std::declval<const wchar*>(), std::declval<U&>()), std::true_type());
+
+			template <class U>
+			static std::false_type test(...);
+
+		public:
+
+			static constexpr bool value = decltype(test<Type>(0))::value;
+		};
+
+		template <class Type>
+		inline bool ParseText(StringView str, Type& to, std::true_type)
+		{
+			return FromChars(str.data(), str.data() + str.length(), to).ok;
+		}
+
+		template <class Type>
+		inline bool ParseText(StringView str, Type& to, std::false_type)
+		{
+			return !!(std::wistringstream{ std::wstring(str.data(), str.length()) } >> to);
+		}
+	}
+
 	////////////////////////////////////////////////////////////////
 	//
 	//		Parse
@@ -32,14 +85,11 @@ namespace s3d
 	/// 文字列から変換されたデータ
 	/// </returns>
 	template <class Type>
-	typename std::enable_if<!std::is_arithmetic<Type>::value, Type>::type Parse(const String& str)
+	typename std::enable_if<!std::is_arithmetic<Type>::value, Type>::type Parse(StringView str)
 	{
 		Type to;
 
-		if (std::wistringstream{ str.str() } >> to)
-		{
-			return to;
-		}
+		detail::ParseText(str, to, std::integral_constant<bool, detail::HasFromChars<Type>::value>());
 
 		return to;
 	}
@@ -54,7 +104,7 @@ namespace s3d
 	/// 文字列から変換されたデータ
 	/// </returns>
 	template <class Type>
-	typename std::enable_if<std::is_arithmetic<Type>::value, Type>::type Parse(const String& str)
+	typename std::enable_if<std::is_arithmetic<Type>::value, Type>::type Parse(StringView str)
 	{
 		return FromString<Type>(str);
 	}
@@ -69,9 +119,9 @@ namespace s3d
 	/// 文字列から変換されたデータ
 	/// </returns>
 	template <>
-	inline bool Parse<bool>(const String& str)
+	inline bool Parse<bool>(StringView str)
 	{
-		return str.trim().lower() == L"true";
+		return detail::EqualsNoCase(detail::TrimSpaces(str), "true");
 	}
 
 	/// <summary>
@@ -84,9 +134,11 @@ namespace s3d
 	/// 文字列から変換されたデータ
 	/// </returns>
 	template <>
-	inline char Parse<char>(const String& str)
+	inline char Parse<char>(StringView str)
 	{
-		return static_cast<char>(str.trim()[0]);
+		const StringView t = detail::TrimSpaces(str);
+
+		return t.length() ? static_cast<char>(t[0]) : '\0';
 	}
 
 	/// <summary>
@@ -99,9 +151,11 @@ namespace s3d
 	/// 文字列から変換されたデータ
 	/// </returns>
 	template <>
-	inline wchar Parse<wchar>(const String& str)
+	inline wchar Parse<wchar>(StringView str)
 	{
-		return str.trim()[0];
+		const StringView t = detail::TrimSpaces(str);
+
+		return t.length() ? t[0] : L'\0';
 	}
 
 	/// <summary>
@@ -114,9 +168,9 @@ namespace s3d
 	/// 文字列から変換されたデータ
 	/// </returns>
 	template <>
-	inline String Parse<String>(const String& str)
+	inline String Parse<String>(StringView str)
 	{
-		return str;
+		return String(str.data(), str.length());
 	}
 
 	////////////////////////////////////////////////////////////////
@@ -135,11 +189,11 @@ namespace s3d
 	/// 文字列から変換されたデータの Optional, 失敗した場合は none
 	/// </returns>
 	template <class Type>
-	typename std::enable_if<!std::is_arithmetic<Type>::value, Optional<Type>>::type ParseOpt(const String& str)
+	typename std::enable_if<!std::is_arithmetic<Type>::value, Optional<Type>>::type ParseOpt(StringView str)
 	{
 		Type to;
 
-		if (std::wistringstream{ str.str() } >> to)
+		if (detail::ParseText(str, to, std::integral_constant<bool, detail::HasFromChars<Type>::value>()))
 		{
 			return Optional<Type>(to);
 		}
@@ -157,7 +211,7 @@ namespace s3d
 	/// 文字列から変換されたデータの Optional, 失敗した場合は none
 	/// </returns>
 	template <class Type>
-	typename std::enable_if<std::is_arithmetic<Type>::value, Optional<Type>>::type ParseOpt(const String& str)
+	typename std::enable_if<std::is_arithmetic<Type>::value, Optional<Type>>::type ParseOpt(StringView str)
 	{
 		return FromStringOpt<Type>(str);
 	}
@@ -172,15 +226,15 @@ namespace s3d
 	/// 文字列から変換されたデータの Optional, 失敗した場合は none
 	/// </returns>
 	template <>
-	inline Optional<bool> ParseOpt<bool>(const String& str)
+	inline Optional<bool> ParseOpt<bool>(StringView str)
 	{
-		const String lower = str.trim().lower();
+		const StringView t = detail::TrimSpaces(str);
 
-		if (lower == L"true")
+		if (detail::EqualsNoCase(t, "true"))
 		{
 			return Optional<bool>(true);
 		}
-		else if (lower == L"false")
+		else if (detail::EqualsNoCase(t, "false"))
 		{
 			return Optional<bool>(false);
 		}
@@ -198,11 +252,11 @@ namespace s3d
 	/// 文字列から変換されたデータの Optional, 失敗した場合は none
 	/// </returns>
 	template <>
-	inline Optional<char> ParseOpt<char>(const String& str)
+	inline Optional<char> ParseOpt<char>(StringView str)
 	{
-		const String t = str.trim();
+		const StringView t = detail::TrimSpaces(str);
 
-		if (t.isEmpty)
+		if (t.length() == 0)
 		{
 			return none;
 		}
@@ -220,11 +274,11 @@ namespace s3d
 	/// 文字列から変換されたデータの Optional, 失敗した場合は none
 	/// </returns>
 	template <>
-	inline Optional<wchar> ParseOpt<wchar>(const String& str)
+	inline Optional<wchar> ParseOpt<wchar>(StringView str)
 	{
-		const String t = str.trim();
+		const StringView t = detail::TrimSpaces(str);
 
-		if (t.isEmpty)
+		if (t.length() == 0)
 		{
 			return none;
 		}
@@ -242,9 +296,9 @@ namespace s3d
 	/// 文字列から変換されたデータの Optional, 失敗した場合は none
 	/// </returns>
 	template <>
-	inline Optional<String> ParseOpt<String>(const String& str)
+	inline Optional<String> ParseOpt<String>(StringView str)
 	{
-		return Optional<String>(str);
+		return Optional<String>(String(str.data(), str.length()));
 	}
 
 	////////////////////////////////////////////////////////////////
@@ -266,7 +320,7 @@ namespace s3d
 	/// 文字列から変換されたデータの, 失敗した場合は defaultValue
 	/// </returns>
 	template <class Type, class U>
-	Type ParseOr(const String& str, U&& defaultValue)
+	Type ParseOr(StringView str, U&& defaultValue)
 	{
 		return ParseOpt<Type>(str).value_or(std::forward<U>(defaultValue));
 	}
@@ -233,6 +233,12 @@ namespace s3d
 		return os << CharType('(') << v.x << CharType(',') << v.y << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const Point& v)
+	{
+		FormatTuple(formatData, v.x, v.y);
+	}
+
 	/// <summary>
 	/// 入力ストリームに点を渡します。
 	/// </summary>
@@ -252,6 +258,20 @@ namespace s3d
 		return is >> unused >> v.x >> unused >> v.y >> unused;
 	}
 
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Point& v)
+	{
+		Point result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.x, result.y);
+
+		if (r)
+		{
+			v = result;
+		}
+
+		return r;
+	}
+
 	inline constexpr Point operator * (int32 s, const Point& p);
 
 	inline constexpr Float2 operator * (float s, const Point& p);
@@ -78,7 +78,7 @@ namespace s3d
 
 		explicit Polygon(const String& pts)
 		{
-			std::wistringstream(pts.str()) >> *this;
+			FromChars(pts, *this);
 		}
 
 		explicit Polygon(const Array<Vec2>& outer, const Array<Array<Vec2>>& holes = {});
@@ -489,6 +489,58 @@ namespace s3d
 		return is;
 	}
 
+	namespace detail
+	{
+		inline void ScanPoints(TextScanner& scanner, Array<Vec2>& pts)
+		{
+			wchar unused = L'\0';
+
+			while (scanner && unused != L')')
+			{
+				Vec2 v;
+
+				scanner >> v >> unused;
+
+				pts.push_back(v);
+			}
+		}
+	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Polygon& polygon)
+	{
+		detail::TextScanner scanner(first, last);
+
+		Array<Vec2> pts;
+		Array<Array<Vec2>> holes;
+		wchar unused;
+
+		scanner >> unused >> unused;
+
+		detail::ScanPoints(scanner, pts);
+
+		scanner >> unused;
+
+		while (scanner && unused == L',')
+		{
+			Array<Vec2> hole;
+
+			scanner >> unused;
+
+			detail::ScanPoints(scanner, hole);
+
+			holes.push_back(std::move(hole));
+
+			scanner >> unused;
+		}
+
+		if (scanner)
+		{
+			polygon = Polygon(pts, holes);
+		}
+
+		return scanner.result();
+	}
+
 	namespace Geometry2D
 	{
 		/// <summary>
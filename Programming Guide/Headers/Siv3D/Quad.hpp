@@ -32,7 +32,7 @@ namespace s3d
 
 		explicit Quad(const String& pts)
 		{
-			std::wistringstream(pts.str()) >> *this;
+			FromChars(pts, *this);
 		}
 
 		Quad(double x0, double y0, double x1, double y1, double x2, double y2, double x3, double y3)
@@ -174,6 +174,12 @@ namespace s3d
 			<< quad.p[3] << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const Quad& quad)
+	{
+		FormatTuple(formatData, quad.p[0], quad.p[1], quad.p[2], quad.p[3]);
+	}
+
 	template <class CharType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, Quad& quad)
 	{
@@ -184,4 +190,18 @@ namespace s3d
 			>> quad.p[2] >> unused
 			>> quad.p[3] >> unused;
 	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Quad& quad)
+	{
+		Quad result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.p[0], result.p[1], result.p[2], result.p[3]);
+
+		if (r)
+		{
+			quad = result;
+		}
+
+		return r;
+	}
 }
@@ -115,6 +115,12 @@ namespace s3d
 		return os << q.component;
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const Quaternion& q)
+	{
+		Formatter(formatData, q.component);
+	}
+
 	template <class CharType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, Quaternion& q)
 	{
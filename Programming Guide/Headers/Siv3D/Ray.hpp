@@ -65,10 +65,30 @@ namespace s3d
 		return	os << CharType('(') << ray.origin << CharType(',') << ray.direction << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const Ray& ray)
+	{
+		FormatTuple(formatData, ray.origin, ray.direction);
+	}
+
 	template <class CharType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, Ray& ray)
 	{
 		CharType unused;
 		return	is >> unused >> ray.origin >> unused >> ray.direction >> unused;
 	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Ray& ray)
+	{
+		Ray result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.origin, result.direction);
+
+		if (r)
+		{
+			ray = result;
+		}
+
+		return r;
+	}
 }
@@ -870,6 +870,12 @@ namespace s3d
 			<< r.h << CharType(')');
 	}
 
+	template <class SizeType, class ElementType>
+	inline void Formatter(FormatData& formatData, const Rectangle<SizeType, ElementType>& r)
+	{
+		FormatTuple(formatData, r.x, r.y, r.w, r.h);
+	}
+
 	template <class CharType, class SizeType, class ElementType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, Rectangle<SizeType, ElementType>& r)
 	{
@@ -881,6 +887,21 @@ namespace s3d
 			>> r.h >> unused;
 	}
 
+	template <class SizeType, class ElementType>
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Rectangle<SizeType, ElementType>& rect)
+	{
+		Rectangle<SizeType, ElementType> result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.x, result.y, result.w, result.h);
+
+		if (r)
+		{
+			rect = result;
+		}
+
+		return r;
+	}
+
 	/// <summary>
 	/// 長方形（要素が int 型）
 	/// </summary>
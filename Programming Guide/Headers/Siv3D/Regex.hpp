@@ -10,8 +10,14 @@
 
 # pragma once
 # include <regex>
+# include <list>
+# include <mutex>
+# include <memory>
+# include <unordered_map>
+# include "Fwd.hpp"
 # include "Array.hpp"
 # include "String.hpp"
+# include "RegexEngine.hpp"
 
 namespace s3d
 {
@@ -20,14 +26,470 @@ namespace s3d
 	/// </summary>
 	using Match = std::wsmatch;
 
+	/// <summary>
+	/// コンパイル済みの正規表現
+	/// </summary>
+	/// <remarks>
+	/// パターンは構築時に一度だけコンパイルされます。コピーはコンパイル結果を共有し、複数のスレッドから同時に使えます。
+	/// 後方参照や先読みを含まないパターンは DFA で照合し、それ以外は std::wregex で照合します。どちらでも結果は同じです。
+	/// </remarks>
+	class RegexObject
+	{
+	private:
+
+		struct Data
+		{
+			String pattern;
+
+			std::wregex regex;
+
+			detail::RegexDFA dfa;
+
+			bool hasDFA = false;
+		};
+
+		std::shared_ptr<const Data> m_data;
+
+		static bool HasGroupReference(const String& replacement)
+		{
+			for (size_t i = 0; i + 1 < replacement.length; ++i)
+			{
+				if (replacement[i] == L'$' && L'0' <= replacement[i + 1] && replacement[i + 1] <= L'9')
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		// ECMAScript の置換書式 ($$, $&, $`, $', $n, $nn) を展開する
+		static void AppendFormat(String& out, const String& replacement, const String& input,
+			size_t prefixBegin, size_t begin, size_t end, const Match* match)
+		{
+			const size_t length = replacement.length;
+
+			for (size_t i = 0; i < length; ++i)
+			{
+				const wchar ch = replacement[i];
+
+				if (ch != L'$' || i + 1 == length)
+				{
+					out.push_back(ch);
+					continue;
+				}
+
+				const wchar next = replacement[i + 1];
+
+				if (next == L'$')
+				{
+					out.push_back(L'$');
+				}
+				else if (next == L'&')
+				{
+					out.append(input.data() + begin, end - begin);
+				}
+				else if (next == L'`')
+				{
+					out.append(input.data() + prefixBegin, begin - prefixBegin);
+				}
+				else if (next == L'\'')
+				{
+					out.append(input.data() + end, input.length - end);
+				}
+				else if (L'0' <= next && next <= L'9')
+				{
+					size_t index = next - L'0';
+
+					if (i + 2 < length && L'0' <= replacement[i + 2] && replacement[i + 2] <= L'9')
+					{
+						index = index * 10 + (replacement[i + 2] - L'0');
+						++i;
+					}
+
+					if (index == 0)
+					{
+						out.append(input.data() + begin, end - begin);
+					}
+					else if (match && index < match->size())
+					{
+						const auto& sub = (*match)[index];
+						out.append(sub.first, sub.second);
+					}
+				}
+				else
+				{
+					out.push_back(L'$');
+					continue;
+				}
+
+				++i;
+			}
+		}
+
+		String replace(const String& input, const String& replacement, bool firstOnly) const
+		{
+			if (!m_data)
+			{
+				return input;
+			}
+
+			if (!m_data->hasDFA)
+			{
+				return std::regex_replace(input.str(), m_data->regex, replacement.str(),
+					firstOnly ? std::regex_constants::format_first_only : std::regex_constants::format_default);
+			}
+
+			const wchar* const text = input.data();
+
+			const size_t length = input.length;
+
+			std::vector<uint8> starts;
+
+			if (!m_data->dfa.findStarts(text, length, starts))
+			{
+				return input;
+			}
+
+			const bool needsGroups = (m_data->regex.mark_count() > 0) && HasGroupReference(replacement);
+
+			String result;
+
+			result.reserve(length);
+
+			size_t copied = 0, pos = 0;
+
+			bool previousEmpty = false;
+
+			for (;;)
+			{
+				// std::regex_iterator と同じく、空のマッチの直後は同じ位置で空でないマッチを先に試す
+				ptrdiff_t begin = -1, end = -1;
+
+				if (previousEmpty)
+				{
+					if (pos == length)
+					{
+						break;
+					}
+
+					if (starts[pos] && (end = m_data->dfa.matchAt(text, length, pos, false)) >= 0)
+					{
+						begin = pos;
+					}
+					else
+					{
+						++pos;
+					}
+				}
+
+				if (begin < 0)
+				{
+					while (pos <= length && !starts[pos])
+					{
+						++pos;
+					}
+
+					if (pos > length)
+					{
+						break;
+					}
+
+					begin = pos;
+
+					end = m_data->dfa.matchAt(text, length, pos, true);
+				}
+
+				result.append(text + copied, begin - copied);
+
+				if (needsGroups)
+				{
+					using namespace std::regex_constants;
+
+					Match match;
+
+					const auto flags = (begin > 0 ? match_prev_avail : match_default) | match_continuous
+						| (begin == end ? match_default : match_not_null);
+
+					std::regex_search(input.str().begin() + begin, input.str().end(), match, m_data->regex, flags);
+
+					AppendFormat(result, replacement, input, copied, begin, end, &match);
+				}
+				else
+				{
+					AppendFormat(result, replacement, input, copied, begin, end, nullptr);
+				}
+
+				copied = pos = end;
+
+				previousEmpty = (begin == end);
+
+				if (firstOnly)
+				{
+					break;
+				}
+			}
+
+			result.append(text + copied, length - copied);
+
+			return result;
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		RegexObject() = default;
+
+		/// <summary>
+		/// 正規表現をコンパイルします。
+		/// </summary>
+		/// <param name="pattern">
+		/// ECMAScript 形式の正規表現
+		/// </param>
+		/// <exception cref="std::regex_error">
+		/// パターンが不正な場合
+		/// </exception>
+		explicit RegexObject(const String& pattern)
+		{
+			auto data = std::make_shared<Data>();
+
+			data->pattern = pattern;
+
+			data->regex.assign(pattern.str());
+
+			data->hasDFA = data->dfa.compile(pattern, data->regex);
+
+			m_data = std::move(data);
+		}
+
+		/// <summary>
+		/// 正規表現が空であるかを返します。
+		/// </summary>
+		bool isEmpty() const
+		{
+			return !m_data;
+		}
+
+		explicit operator bool() const
+		{
+			return !isEmpty();
+		}
+
+		/// <summary>
+		/// コンパイル元のパターンを返します。
+		/// </summary>
+		const String& pattern() const
+		{
+			static const String empty;
+
+			return m_data ? m_data->pattern : empty;
+		}
+
+		/// <summary>
+		/// DFA で照合できるパターンであるかを返します。
+		/// </summary>
+		bool hasDFA() const
+		{
+			return m_data && m_data->hasDFA;
+		}
+
+		/// <summary>
+		/// 正規表現にマッチする部分があるかを返します。
+		/// </summary>
+		/// <param name="input">
+		/// 対象の文字列
+		/// </param>
+		/// <returns>
+		/// マッチする部分がある場合 true, それ以外の場合は false
+		/// </returns>
+		bool contains(const String& input) const
+		{
+			if (!m_data)
+			{
+				return false;
+			}
+
+			if (!m_data->hasDFA)
+			{
+				return std::regex_search(input.str(), m_data->regex);
+			}
+
+			std::vector<uint8> starts;
+
+			return m_data->dfa.findStarts(input.data(), input.length, starts);
+		}
+
+		/// <summary>
+		/// 正規表現に一致した最初の文字列を置換します。
+		/// </summary>
+		/// <param name="input">
+		/// 対象の文字列
+		/// </param>
+		/// <param name="replacement">
+		/// 置換後の正規表現
+		/// </param>
+		/// <returns>
+		/// 置換した文字列
+		/// </returns>
+		String replaceFirst(const String& input, const String& replacement) const
+		{
+			return replace(input, replacement, true);
+		}
+
+		/// <summary>
+		/// 正規表現に一致した文字列を全て置換します。
+		/// </summary>
+		/// <param name="input">
+		/// 対象の文字列
+		/// </param>
+		/// <param name="replacement">
+		/// 置換後の正規表現
+		/// </param>
+		/// <returns>
+		/// 置換した文字列
+		/// </returns>
+		String replaceAll(const String& input, const String& replacement) const
+		{
+			return replace(input, replacement, false);
+		}
+
+		/// <summary>
+		/// 正規表現に一致する全てのマッチを返します。
+		/// </summary>
+		/// <param name="input">
+		/// 対象の文字列。戻り値のマッチはこの文字列を参照します。
+		/// </param>
+		/// <returns>
+		/// マッチの一覧
+		/// </returns>
+		Array<Match> search(const String& input) const
+		{
+			if (!contains(input))
+			{
+				return{};
+			}
+
+			return Array<Match>(std::wsregex_iterator(input.str().begin(), input.str().end(), m_data->regex), std::wsregex_iterator());
+		}
+	};
+
+	namespace detail
+	{
+		/// <summary>
+		/// パターン文字列から RegexObject を引く LRU キャッシュ
+		/// </summary>
+		class RegexCache
+		{
+		private:
+
+			using Entry = std::pair<std::wstring, RegexObject>;
+
+			std::mutex m_mutex;
+
+			std::list<Entry> m_entries;
+
+			std::unordered_map<std::wstring, std::list<Entry>::iterator> m_index;
+
+			size_t m_capacity = 64;
+
+			void trim()
+			{
+				while (m_entries.size() > m_capacity)
+				{
+					m_index.erase(m_entries.back().first);
+
+					m_entries.pop_back();
+				}
+			}
+
+		public:
+
+			RegexObject get(const String& pattern)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+
+					const auto it = m_index.find(pattern.str());
+
+					if (it != m_index.end())
+					{
+						m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+						return it->second->second;
+					}
+				}
+
+				// コンパイル中は他のスレッドを待たせない
+				RegexObject regex(pattern);
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				if (m_index.find(pattern.str()) == m_index.end())
+				{
+					m_entries.emplace_front(pattern.str(), regex);
+
+					m_index.emplace(pattern.str(), m_entries.begin());
+
+					trim();
+				}
+
+				return regex;
+			}
+
+			void setCapacity(size_t capacity)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				m_capacity = capacity;
+
+				trim();
+			}
+		};
+
+		inline RegexCache& GetRegexCache()
+		{
+			static RegexCache cache;
+
+			return cache;
+		}
+	}
+
 	/// <summary>
 	/// 正規表現
 	/// </summary>
 	/// <remarks>
 	/// 正規表現の機能を提供します。
+	/// パターンを String で渡す関数は、最近使った 64 個のパターンのコンパイル結果をキャッシュして再利用します。
 	/// </remarks>
 	namespace Regex
 	{
+		/// <summary>
+		/// 正規表現をコンパイルします。同じパターンのコンパイル結果がキャッシュにあればそれを返します。
+		/// </summary>
+		/// <param name="regex">
+		/// 正規表現
+		/// </param>
+		/// <returns>
+		/// コンパイル済みの正規表現
+		/// </returns>
+		inline RegexObject Compile(const String& regex)
+		{
+			return detail::GetRegexCache().get(regex);
+		}
+
+		/// <summary>
+		/// Compile() がキャッシュするパターンの最大数を設定します。
+		/// </summary>
+		/// <param name="capacity">
+		/// キャッシュするパターンの最大数。0 の場合はキャッシュしません。
+		/// </param>
+		inline void SetCacheCapacity(size_t capacity)
+		{
+			detail::GetRegexCache().setCapacity(capacity);
+		}
+
 		/// <summary>
 		/// 正規表現に一致した最初の文字列を置換します。
 		/// </summary>
@@ -43,7 +505,15 @@ namespace s3d
 		/// <returns>
 		/// 置換した文字列
 		/// </returns>
-		inline String ReplaceFirst(const String& input, const String& regex, const String& replacement);
+		inline String ReplaceFirst(const String& input, const RegexObject& regex, const String& replacement)
+		{
+			return regex.replaceFirst(input, replacement);
+		}
+
+		inline String ReplaceFirst(const String& input, const String& regex, const String& replacement)
+		{
+			return Compile(regex).replaceFirst(input, replacement);
+		}
 
 		/// <summary>
 		/// 正規表現に一致した文字列を全て置換します。
@@ -60,7 +530,15 @@ namespace s3d
 		/// <returns>
 		/// 置換した文字列
 		/// </returns>
-		inline String ReplaceAll(const String& input, const String& regex, const String& replacement);
+		inline String ReplaceAll(const String& input, const RegexObject& regex, const String& replacement)
+		{
+			return regex.replaceAll(input, replacement);
+		}
+
+		inline String ReplaceAll(const String& input, const String& regex, const String& replacement)
+		{
+			return Compile(regex).replaceAll(input, replacement);
+		}
 
 		/// <summary>
 		/// 正規表現に一致する全てのマッチを返します。
@@ -74,8 +552,36 @@ namespace s3d
 		/// <returns>
 		/// マッチの一覧
 		/// </returns>
-		inline Array<Match> Search(const String& input, const String& regex);
+		inline Array<Match> Search(const String& input, const RegexObject& regex)
+		{
+			return regex.search(input);
+		}
+
+		inline Array<Match> Search(const String& input, const String& regex)
+		{
+			return Compile(regex).search(input);
+		}
+
+		/// <summary>
+		/// 正規表現にマッチする部分があるかを返します。
+		/// </summary>
+		/// <param name="input">
+		/// 対象の文字列
+		/// </param>
+		/// <param name="regex">
+		/// 検索する正規表現
+		/// </param>
+		/// <returns>
+		/// マッチする部分がある場合 true, それ以外の場合は false
+		/// </returns>
+		inline bool Contains(const String& input, const RegexObject& regex)
+		{
+			return regex.contains(input);
+		}
+
+		inline bool Contains(const String& input, const String& regex)
+		{
+			return Compile(regex).contains(input);
+		}
 	}
 }
-
-# include "Regex.inl"
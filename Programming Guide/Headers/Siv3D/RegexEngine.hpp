@@ -0,0 +1,1104 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <regex>
+# include <map>
+# include <vector>
+# include <algorithm>
+# include "Fwd.hpp"
+# include "String.hpp"
+
+namespace s3d
+{
+	namespace detail
+	{
+		/// <summary>
+		/// バックトラックを必要としない正規表現を DFA で照合するエンジン
+		/// </summary>
+		/// <remarks>
+		/// std::wregex (ECMAScript) と同じマッチを返します。
+		/// 逆向きの DFA で「マッチが始まりうる位置」を 1 回の走査ですべて求め、
+		/// 各開始位置からは優先順位付きの DFA（RE2 と同じ leftmost-first 方式）でマッチの終端を求めます。
+		/// 後方参照、先読み、\b、POSIX 文字クラスを含むパターンや、状態数が上限を超えるパターンは compile() が false を返すので、
+		/// 呼び出し側は std::wregex を使ってください。
+		/// 構築後は変更されないため、複数のスレッドから同時に使えます。
+		/// </remarks>
+		class RegexDFA
+		{
+		private:
+
+			enum class Op : uint8 { Class, Split, Jump, Match, AssertBegin, AssertEnd };
+
+			struct Instruction
+			{
+				Op op;
+
+				int32 x;
+
+				int32 y;
+			};
+
+			enum { TraitsWord = 1, TraitsSpace = 2, TraitsDigit = 4 };
+
+			struct CharSet
+			{
+				std::vector<std::pair<uint32, uint32>> ranges;
+
+				uint8 traits = 0;
+
+				uint8 negatedTraits = 0;
+
+				bool negated = false;
+			};
+
+			struct Node
+			{
+				enum Kind : uint8 { Set, Concat, Alternate, Repeat, Begin, End } kind;
+
+				int32 set = -1;
+
+				std::vector<int32> children;
+
+				int32 min = 0;
+
+				int32 max = 0;
+
+				bool greedy = true;
+			};
+
+			struct Unsupported {};
+
+			struct Automaton
+			{
+				std::vector<int32> next;
+
+				std::vector<uint8> flags;
+
+				int32 start[4] = {};
+			};
+
+			enum { StateMatch = 1, StateAcceptsAtEnd = 2, StateAcceptsEmptyText = 4 };
+
+			enum { MaxInstructions = 4000, MaxStates = 2000 };
+
+			std::vector<CharSet> m_sets;
+
+			std::vector<Node> m_nodes;
+
+			std::vector<uint32> m_boundaries;
+
+			std::vector<int32> m_segmentClasses;
+
+			int32 m_asciiClasses[128] = {};
+
+			int32 m_numClasses = 0;
+
+			bool m_usesTraits = false;
+
+			std::regex_traits<wchar> m_traits;
+
+			std::regex_traits<wchar>::char_class_type m_classWord{}, m_classSpace{}, m_classDigit{};
+
+			Automaton m_forward;
+
+			Automaton m_reverse;
+
+			////////////////////////////////////////////////////////////////
+			//
+			//		Parser
+			//
+
+			class Parser
+			{
+			private:
+
+				RegexDFA& m_dfa;
+
+				const wchar* m_ptr;
+
+				const wchar* m_end;
+
+				int32 addNode(Node&& node)
+				{
+					m_dfa.m_nodes.push_back(std::move(node));
+
+					return static_cast<int32>(m_dfa.m_nodes.size() - 1);
+				}
+
+				int32 addSetNode(CharSet&& set)
+				{
+					m_dfa.m_sets.push_back(std::move(set));
+
+					Node node;
+					node.kind = Node::Set;
+					node.set = static_cast<int32>(m_dfa.m_sets.size() - 1);
+
+					return addNode(std::move(node));
+				}
+
+				bool peek(wchar ch) const
+				{
+					return m_ptr != m_end && *m_ptr == ch;
+				}
+
+				wchar next()
+				{
+					if (m_ptr == m_end)
+					{
+						throw Unsupported();
+					}
+
+					return *m_ptr++;
+				}
+
+				static int32 HexValue(wchar ch)
+				{
+					if (L'0' <= ch && ch <= L'9') return ch - L'0';
+					if (L'a' <= ch && ch <= L'f') return ch - L'a' + 10;
+					if (L'A' <= ch && ch <= L'F') return ch - L'A' + 10;
+					throw Unsupported();
+				}
+
+				static bool IsAlnum(wchar ch)
+				{
+					return (L'0' <= ch && ch <= L'9') || (L'a' <= ch && ch <= L'z') || (L'A' <= ch && ch <= L'Z');
+				}
+
+				// \d \w \s などの文字クラスなら set に追加して true を返す
+				static bool ClassEscape(wchar ch, CharSet& set)
+				{
+					switch (ch)
+					{
+					case L'w': set.traits |= TraitsWord; return true;
+					case L's': set.traits |= TraitsSpace; return true;
+					case L'd': set.traits |= TraitsDigit; return true;
+					case L'W': set.negatedTraits |= TraitsWord; return true;
+					case L'S': set.negatedTraits |= TraitsSpace; return true;
+					case L'D': set.negatedTraits |= TraitsDigit; return true;
+					default: return false;
+					}
+				}
+
+				// 1 文字を表すエスケープ（\ の後ろ）
+				uint32 charEscape(bool inClass)
+				{
+					const wchar ch = next();
+
+					switch (ch)
+					{
+					case L't': return L'\t';
+					case L'n': return L'\n';
+					case L'v': return L'\v';
+					case L'f': return L'\f';
+					case L'r': return L'\r';
+					case L'b':
+						if (inClass) return L'\b';
+						throw Unsupported();
+					case L'0':
+						if (m_ptr != m_end && L'0' <= *m_ptr && *m_ptr <= L'9') throw Unsupported();
+						return 0;
+					case L'c':
+						{
+							const wchar letter = next();
+							if (!((L'a' <= letter && letter <= L'z') || (L'A' <= letter && letter <= L'Z'))) throw Unsupported();
+							return letter % 32;
+						}
+					case L'x':
+						{
+							const int32 hi = HexValue(next());
+							return hi * 16 + HexValue(next());
+						}
+					case L'u':
+						{
+							uint32 value = 0;
+							for (int32 i = 0; i < 4; ++i) value = value * 16 + HexValue(next());
+							return value;
+						}
+					default:
+						if (IsAlnum(ch))
+						{
+							// 後方参照や未知のエスケープ
+							throw Unsupported();
+						}
+						return ch;
+					}
+				}
+
+				int32 parseClass()
+				{
+					CharSet set;
+
+					if (peek(L'^'))
+					{
+						set.negated = true;
+						++m_ptr;
+					}
+
+					if (peek(L']'))
+					{
+						throw Unsupported();
+					}
+
+					while (!peek(L']'))
+					{
+						if (peek(L'[') && m_end - m_ptr >= 2 && (m_ptr[1] == L':' || m_ptr[1] == L'.' || m_ptr[1] == L'='))
+						{
+							throw Unsupported();
+						}
+
+						uint32 lo = next();
+
+						if (lo == L'\\')
+						{
+							if (m_ptr != m_end && ClassEscape(*m_ptr, set))
+							{
+								++m_ptr;
+								continue;
+							}
+
+							lo = charEscape(true);
+						}
+
+						uint32 hi = lo;
+
+						if (peek(L'-') && m_end - m_ptr >= 2 && m_ptr[1] != L']')
+						{
+							++m_ptr;
+
+							hi = next();
+
+							if (hi == L'\\')
+							{
+								if (m_ptr != m_end && ClassEscape(*m_ptr, set))
+								{
+									throw Unsupported();
+								}
+
+								hi = charEscape(true);
+							}
+
+							if (hi < lo)
+							{
+								throw Unsupported();
+							}
+						}
+
+						set.ranges.emplace_back(lo, hi);
+					}
+
+					++m_ptr;
+
+					return addSetNode(std::move(set));
+				}
+
+				int32 parseAtom()
+				{
+					const wchar ch = next();
+
+					switch (ch)
+					{
+					case L'(':
+						{
+							if (peek(L'?'))
+							{
+								if (m_end - m_ptr < 2 || m_ptr[1] != L':')
+								{
+									throw Unsupported();
+								}
+
+								m_ptr += 2;
+							}
+
+							const int32 node = parseAlternation();
+
+							if (next() != L')')
+							{
+								throw Unsupported();
+							}
+
+							return node;
+						}
+					case L'^':
+					case L'$':
+						{
+							Node node;
+							node.kind = (ch == L'^') ? Node::Begin : Node::End;
+							return addNode(std::move(node));
+						}
+					case L'.':
+						{
+							CharSet set;
+							set.negated = true;
+							for (uint32 excluded : DotExcluded()) set.ranges.emplace_back(excluded, excluded);
+							return addSetNode(std::move(set));
+						}
+					case L'[':
+						return parseClass();
+					case L'\\':
+						{
+							CharSet set;
+
+							if (m_ptr != m_end && ClassEscape(*m_ptr, set))
+							{
+								++m_ptr;
+							}
+							else
+							{
+								const uint32 c = charEscape(false);
+								set.ranges.emplace_back(c, c);
+							}
+
+							return addSetNode(std::move(set));
+						}
+					case L'*':
+					case L'+':
+					case L'?':
+					case L'{':
+					case L')':
+					case L'|':
+						throw Unsupported();
+					default:
+						{
+							CharSet set;
+							set.ranges.emplace_back(ch, ch);
+							return addSetNode(std::move(set));
+						}
+					}
+				}
+
+				int32 parseNumber()
+				{
+					if (m_ptr == m_end || *m_ptr < L'0' || L'9' < *m_ptr)
+					{
+						throw Unsupported();
+					}
+
+					int32 value = 0;
+
+					while (m_ptr != m_end && L'0' <= *m_ptr && *m_ptr <= L'9')
+					{
+						value = value * 10 + (*m_ptr++ - L'0');
+
+						if (value > MaxInstructions)
+						{
+							throw Unsupported();
+						}
+					}
+
+					return value;
+				}
+
+				bool isNullable(const int32 index) const
+				{
+					const Node& node = m_dfa.m_nodes[index];
+
+					switch (node.kind)
+					{
+					case Node::Set:
+						return false;
+					case Node::Concat:
+						return std::all_of(node.children.begin(), node.children.end(), [this](int32 child) { return isNullable(child); });
+					case Node::Alternate:
+						return std::any_of(node.children.begin(), node.children.end(), [this](int32 child) { return isNullable(child); });
+					case Node::Repeat:
+						return node.min == 0 || isNullable(node.children.front());
+					default:
+						return true;
+					}
+				}
+
+				int32 parseRepeat()
+				{
+					const int32 atom = parseAtom();
+
+					if (m_ptr == m_end)
+					{
+						return atom;
+					}
+
+					int32 min, max;
+
+					switch (*m_ptr)
+					{
+					case L'*': min = 0; max = -1; ++m_ptr; break;
+					case L'+': min = 1; max = -1; ++m_ptr; break;
+					case L'?': min = 0; max = 1; ++m_ptr; break;
+					case L'{':
+						++m_ptr;
+						min = max = parseNumber();
+						if (peek(L','))
+						{
+							++m_ptr;
+							max = peek(L'}') ? -1 : parseNumber();
+						}
+						if (next() != L'}' || (max != -1 && max < min)) throw Unsupported();
+						break;
+					default:
+						return atom;
+					}
+
+					const Node::Kind kind = m_dfa.m_nodes[atom].kind;
+
+					if (kind == Node::Begin || kind == Node::End)
+					{
+						throw Unsupported();
+					}
+
+					// 空にマッチしうる部分式の繰り返しは ECMAScript 固有の打ち切り規則に従うので扱わない
+					if (max != 1 && isNullable(atom))
+					{
+						throw Unsupported();
+					}
+
+					Node node;
+					node.kind = Node::Repeat;
+					node.children.push_back(atom);
+					node.min = min;
+					node.max = max;
+
+					if (peek(L'?'))
+					{
+						node.greedy = false;
+						++m_ptr;
+					}
+
+					if (m_ptr != m_end && (*m_ptr == L'*' || *m_ptr == L'+' || *m_ptr == L'?' || *m_ptr == L'{'))
+					{
+						throw Unsupported();
+					}
+
+					return addNode(std::move(node));
+				}
+
+				int32 parseConcat()
+				{
+					Node node;
+					node.kind = Node::Concat;
+
+					while (m_ptr != m_end && *m_ptr != L'|' && *m_ptr != L')')
+					{
+						node.children.push_back(parseRepeat());
+					}
+
+					return addNode(std::move(node));
+				}
+
+			public:
+
+				Parser(RegexDFA& dfa, const wchar* first, const wchar* last)
+					: m_dfa(dfa)
+					, m_ptr(first)
+					, m_end(last) {}
+
+				int32 parseAlternation()
+				{
+					Node node;
+					node.kind = Node::Alternate;
+					node.children.push_back(parseConcat());
+
+					while (peek(L'|'))
+					{
+						++m_ptr;
+						node.children.push_back(parseConcat());
+					}
+
+					if (node.children.size() == 1)
+					{
+						return node.children.front();
+					}
+
+					return addNode(std::move(node));
+				}
+
+				bool atEnd() const
+				{
+					return m_ptr == m_end;
+				}
+			};
+
+			// ECMAScript の . がマッチしない改行文字は実装によって異なるので、std::wregex に問い合わせる
+			static const std::vector<uint32>& DotExcluded()
+			{
+				static const std::vector<uint32> excluded = []()
+				{
+					std::vector<uint32> result;
+
+					const std::wregex dot(L".");
+
+					for (const wchar ch : { wchar(L'\n'), wchar(L'\r'), wchar(0x2028), wchar(0x2029) })
+					{
+						if (!std::regex_match(std::wstring(1, ch), dot))
+						{
+							result.push_back(ch);
+						}
+					}
+
+					return result;
+				}();
+
+				return excluded;
+			}
+
+			////////////////////////////////////////////////////////////////
+			//
+			//		Alphabet
+			//
+
+			uint8 traitsBits(uint32 ch) const
+			{
+				const wchar c = static_cast<wchar>(ch);
+
+				return static_cast<uint8>((m_traits.isctype(c, m_classWord) ? TraitsWord : 0)
+					| (m_traits.isctype(c, m_classSpace) ? TraitsSpace : 0)
+					| (m_traits.isctype(c, m_classDigit) ? TraitsDigit : 0));
+			}
+
+			static bool Contains(const CharSet& set, uint32 ch, uint8 bits)
+			{
+				bool in = ((set.traits & bits) != 0) || ((set.negatedTraits & ~bits & 7) != 0);
+
+				for (const auto& range : set.ranges)
+				{
+					in |= (range.first <= ch && ch <= range.second);
+				}
+
+				return in != set.negated;
+			}
+
+			void buildAlphabet(std::vector<std::vector<uint8>>& classInSet)
+			{
+				m_boundaries = { 0, 128 };
+
+				for (const auto& set : m_sets)
+				{
+					m_usesTraits |= (set.traits | set.negatedTraits) != 0;
+
+					for (const auto& range : set.ranges)
+					{
+						m_boundaries.push_back(range.first);
+
+						if (range.second != 0xFFFFFFFFu)
+						{
+							m_boundaries.push_back(range.second + 1);
+						}
+					}
+				}
+
+				std::sort(m_boundaries.begin(), m_boundaries.end());
+
+				m_boundaries.erase(std::unique(m_boundaries.begin(), m_boundaries.end()), m_boundaries.end());
+
+				std::map<std::vector<uint8>, int32> signatures;
+
+				m_segmentClasses.assign(m_boundaries.size() * 8, 0);
+
+				for (size_t segment = 0; segment < m_boundaries.size(); ++segment)
+				{
+					for (uint8 bits = 0; bits < (m_usesTraits ? 8 : 1); ++bits)
+					{
+						std::vector<uint8> signature(m_sets.size());
+
+						for (size_t i = 0; i < m_sets.size(); ++i)
+						{
+							signature[i] = Contains(m_sets[i], m_boundaries[segment], bits);
+						}
+
+						const auto it = signatures.emplace(std::move(signature), static_cast<int32>(signatures.size())).first;
+
+						m_segmentClasses[segment * 8 + bits] = it->second;
+					}
+				}
+
+				m_numClasses = static_cast<int32>(signatures.size());
+
+				classInSet.assign(m_sets.size(), std::vector<uint8>(m_numClasses));
+
+				for (const auto& signature : signatures)
+				{
+					for (size_t i = 0; i < m_sets.size(); ++i)
+					{
+						classInSet[i][signature.second] = signature.first[i];
+					}
+				}
+
+				for (uint32 ch = 0; ch < 128; ++ch)
+				{
+					m_asciiClasses[ch] = classOfSlow(ch);
+				}
+			}
+
+			int32 classOfSlow(uint32 ch) const
+			{
+				const size_t segment = std::upper_bound(m_boundaries.begin(), m_boundaries.end(), ch) - m_boundaries.begin() - 1;
+
+				return m_segmentClasses[segment * 8 + (m_usesTraits ? traitsBits(ch) : 0)];
+			}
+
+			int32 classOf(wchar ch) const
+			{
+				const uint32 c = static_cast<uint32>(ch);
+
+				return c < 128 ? m_asciiClasses[c] : classOfSlow(c);
+			}
+
+			////////////////////////////////////////////////////////////////
+			//
+			//		NFA
+			//
+
+			static int32 Emit(std::vector<Instruction>& program, Op op, int32 x = 0, int32 y = 0)
+			{
+				if (program.size() >= MaxInstructions)
+				{
+					throw Unsupported();
+				}
+
+				program.push_back({ op, x, y });
+
+				return static_cast<int32>(program.size() - 1);
+			}
+
+			void emit(int32 index, bool reverse, std::vector<Instruction>& program) const
+			{
+				const Node& node = m_nodes[index];
+
+				switch (node.kind)
+				{
+				case Node::Set:
+					Emit(program, Op::Class, node.set);
+					break;
+				case Node::Begin:
+					Emit(program, reverse ? Op::AssertEnd : Op::AssertBegin);
+					break;
+				case Node::End:
+					Emit(program, reverse ? Op::AssertBegin : Op::AssertEnd);
+					break;
+				case Node::Concat:
+					if (reverse)
+					{
+						for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) emit(*it, reverse, program);
+					}
+					else
+					{
+						for (const int32 child : node.children) emit(child, reverse, program);
+					}
+					break;
+				case Node::Alternate:
+					{
+						std::vector<int32> jumps;
+
+						for (size_t i = 0; i + 1 < node.children.size(); ++i)
+						{
+							const int32 split = Emit(program, Op::Split);
+							program[split].x = split + 1;
+							emit(node.children[i], reverse, program);
+							jumps.push_back(Emit(program, Op::Jump));
+							program[split].y = static_cast<int32>(program.size());
+						}
+
+						emit(node.children.back(), reverse, program);
+
+						for (const int32 jump : jumps) program[jump].x = static_cast<int32>(program.size());
+					}
+					break;
+				case Node::Repeat:
+					{
+						for (int32 i = 0; i < node.min; ++i)
+						{
+							emit(node.children[0], reverse, program);
+						}
+
+						if (node.max == -1)
+						{
+							const int32 split = Emit(program, Op::Split);
+							emit(node.children[0], reverse, program);
+							Emit(program, Op::Jump, split);
+							const int32 out = static_cast<int32>(program.size());
+							program[split].x = node.greedy ? split + 1 : out;
+							program[split].y = node.greedy ? out : split + 1;
+						}
+						else
+						{
+							std::vector<int32> splits;
+
+							for (int32 i = node.min; i < node.max; ++i)
+							{
+								splits.push_back(Emit(program, Op::Split));
+								emit(node.children[0], reverse, program);
+							}
+
+							const int32 out = static_cast<int32>(program.size());
+
+							for (const int32 split : splits)
+							{
+								program[split].x = node.greedy ? split + 1 : out;
+								program[split].y = node.greedy ? out : split + 1;
+							}
+						}
+					}
+					break;
+				}
+			}
+
+			// pc から ε 遷移でたどれる命令を優先順に list に追加する
+			static void AddThread(const std::vector<Instruction>& program, int32 pc, bool atBegin, bool atEnd,
+				std::vector<int32>& list, std::vector<uint8>& visited, std::vector<int32>& stack)
+			{
+				stack.push_back(pc);
+
+				while (!stack.empty())
+				{
+					pc = stack.back();
+					stack.pop_back();
+
+					if (visited[pc])
+					{
+						continue;
+					}
+
+					visited[pc] = true;
+
+					const Instruction& inst = program[pc];
+
+					switch (inst.op)
+					{
+					case Op::Jump:
+						stack.push_back(inst.x);
+						break;
+					case Op::Split:
+						stack.push_back(inst.y);
+						stack.push_back(inst.x);
+						break;
+					case Op::AssertBegin:
+						if (atBegin) stack.push_back(pc + 1);
+						break;
+					case Op::AssertEnd:
+						if (atEnd) stack.push_back(pc + 1);
+						else list.push_back(pc);
+						break;
+					default:
+						list.push_back(pc);
+						break;
+					}
+				}
+			}
+
+			////////////////////////////////////////////////////////////////
+			//
+			//		DFA
+			//
+
+			// ordered が true なら優先順位付き（最初の Match より後ろのスレッドは捨てる）、false なら集合として状態を作る
+			static Automaton BuildAutomaton(const std::vector<Instruction>& program, const std::vector<std::vector<uint8>>& classInSet,
+				int32 numClasses, bool ordered)
+			{
+				Automaton automaton;
+
+				std::map<std::vector<int32>, int32> ids;
+
+				std::vector<std::vector<int32>> lists;
+
+				std::vector<uint8> visited(program.size());
+
+				std::vector<int32> stack;
+
+				const auto closure = [&](int32 pc, bool atBegin, bool atEnd, std::vector<int32>& list)
+				{
+					std::fill(visited.begin(), visited.end(), 0);
+
+					AddThread(program, pc, atBegin, atEnd, list, visited, stack);
+				};
+
+				const auto intern = [&](std::vector<int32> list)
+				{
+					if (ordered)
+					{
+						for (size_t i = 0; i < list.size(); ++i)
+						{
+							if (program[list[i]].op == Op::Match)
+							{
+								list.resize(i + 1);
+								break;
+							}
+						}
+					}
+					else
+					{
+						std::sort(list.begin(), list.end());
+						list.erase(std::unique(list.begin(), list.end()), list.end());
+					}
+
+					const auto it = ids.find(list);
+
+					if (it != ids.end())
+					{
+						return it->second;
+					}
+
+					if (lists.size() >= MaxStates)
+					{
+						throw Unsupported();
+					}
+
+					const int32 id = static_cast<int32>(lists.size());
+
+					ids.emplace(list, id);
+
+					lists.push_back(std::move(list));
+
+					return id;
+				};
+
+				intern({});
+
+				std::vector<int32> anywhere;
+
+				if (!ordered)
+				{
+					closure(0, false, false, anywhere);
+				}
+
+				for (int32 i = 0; i < 4; ++i)
+				{
+					const bool atBegin = (i & 2) != 0, allowEmpty = (i & 1) != 0;
+
+					std::vector<int32> list;
+
+					closure(0, atBegin, false, list);
+
+					if (!allowEmpty)
+					{
+						list.erase(std::remove_if(list.begin(), list.end(), [&](int32 pc) { return program[pc].op == Op::Match; }), list.end());
+					}
+
+					automaton.start[i] = intern(std::move(list));
+				}
+
+				for (size_t state = 0; state < lists.size(); ++state)
+				{
+					for (int32 c = 0; c < numClasses; ++c)
+					{
+						std::vector<int32> list;
+
+						std::fill(visited.begin(), visited.end(), 0);
+
+						for (const int32 pc : lists[state])
+						{
+							if (program[pc].op == Op::Class && classInSet[program[pc].x][c])
+							{
+								AddThread(program, pc + 1, false, false, list, visited, stack);
+							}
+						}
+
+						if (!ordered)
+						{
+							list.insert(list.end(), anywhere.begin(), anywhere.end());
+						}
+
+						automaton.next.push_back(intern(std::move(list)));
+					}
+				}
+
+				for (const auto& list : lists)
+				{
+					uint8 flags = 0;
+
+					for (const int32 pc : list)
+					{
+						if (program[pc].op == Op::Match)
+						{
+							flags |= StateMatch | StateAcceptsAtEnd | StateAcceptsEmptyText;
+						}
+						else if (program[pc].op == Op::AssertEnd)
+						{
+							// 空の文字列では終端が先頭でもあるので、$ の後ろの ^ も成立する
+							for (const bool atBegin : { false, true })
+							{
+								std::vector<int32> end;
+
+								closure(pc + 1, atBegin, true, end);
+
+								for (const int32 e : end)
+								{
+									if (program[e].op == Op::Match)
+									{
+										flags |= (atBegin ? StateAcceptsEmptyText : StateAcceptsAtEnd);
+									}
+								}
+							}
+						}
+					}
+
+					automaton.flags.push_back(flags);
+				}
+
+				return automaton;
+			}
+
+		public:
+
+			/// <summary>
+			/// パターンを DFA にコンパイルします。
+			/// </summary>
+			/// <param name="pattern">
+			/// ECMAScript 形式の正規表現
+			/// </param>
+			/// <param name="regex">
+			/// 同じパターンからコンパイル済みの std::wregex（文字クラスの判定に使うロケールを共有します）
+			/// </param>
+			/// <returns>
+			/// DFA で扱えるパターンであれば true, それ以外の場合は false
+			/// </returns>
+			bool compile(const String& pattern, const std::wregex& regex)
+			{
+				try
+				{
+					m_traits.imbue(regex.getloc());
+					m_classWord = m_traits.lookup_classname(L"w", L"w" + 1);
+					m_classSpace = m_traits.lookup_classname(L"s", L"s" + 1);
+					m_classDigit = m_traits.lookup_classname(L"d", L"d" + 1);
+
+					Parser parser(*this, pattern.data(), pattern.data() + pattern.length);
+
+					const int32 root = parser.parseAlternation();
+
+					if (!parser.atEnd())
+					{
+						return false;
+					}
+
+					std::vector<std::vector<uint8>> classInSet;
+
+					buildAlphabet(classInSet);
+
+					std::vector<Instruction> forward, reverse;
+
+					emit(root, false, forward);
+					Emit(forward, Op::Match);
+
+					emit(root, true, reverse);
+					Emit(reverse, Op::Match);
+
+					m_forward = BuildAutomaton(forward, classInSet, m_numClasses, true);
+
+					m_reverse = BuildAutomaton(reverse, classInSet, m_numClasses, false);
+				}
+				catch (const Unsupported&)
+				{
+					return false;
+				}
+
+				m_nodes.clear();
+				m_nodes.shrink_to_fit();
+
+				return true;
+			}
+
+			/// <summary>
+			/// マッチが始まりうる位置をすべて求めます。
+			/// </summary>
+			/// <param name="text">
+			/// 対象の文字列
+			/// </param>
+			/// <param name="length">
+			/// 対象の文字列の長さ
+			/// </param>
+			/// <param name="starts">
+			/// 位置 i からマッチが始まる場合に starts[i] が 1 になる配列（長さ length + 1）
+			/// </param>
+			/// <returns>
+			/// マッチが 1 つでも存在する場合 true, それ以外の場合は false
+			/// </returns>
+			bool findStarts(const wchar* text, size_t length, std::vector<uint8>& starts) const
+			{
+				starts.assign(length + 1, 0);
+
+				int32 state = m_reverse.start[3];
+
+				bool found = (m_reverse.flags[state] & StateMatch) != 0;
+
+				starts[length] = found;
+
+				for (size_t i = length; i-- > 0;)
+				{
+					state = m_reverse.next[state * m_numClasses + classOf(text[i])];
+
+					const bool match = (m_reverse.flags[state] & StateMatch) != 0;
+
+					starts[i] = match;
+
+					found |= match;
+				}
+
+				if (m_reverse.flags[state] & (length == 0 ? StateAcceptsEmptyText : StateAcceptsAtEnd))
+				{
+					starts[0] = found = true;
+				}
+
+				return found;
+			}
+
+			/// <summary>
+			/// 位置 start から始まる最優先のマッチの終端を返します。
+			/// </summary>
+			/// <param name="text">
+			/// 対象の文字列
+			/// </param>
+			/// <param name="length">
+			/// 対象の文字列の長さ
+			/// </param>
+			/// <param name="start">
+			/// マッチの開始位置
+			/// </param>
+			/// <param name="allowEmpty">
+			/// 空のマッチを許すか
+			/// </param>
+			/// <returns>
+			/// マッチの終端、マッチしない場合は -1
+			/// </returns>
+			ptrdiff_t matchAt(const wchar* text, size_t length, size_t start, bool allowEmpty) const
+			{
+				int32 state = m_forward.start[(start == 0 ? 2 : 0) + (allowEmpty ? 1 : 0)];
+
+				ptrdiff_t last = (m_forward.flags[state] & StateMatch) ? static_cast<ptrdiff_t>(start) : -1;
+
+				size_t pos = start;
+
+				for (; pos < length; ++pos)
+				{
+					state = m_forward.next[state * m_numClasses + classOf(text[pos])];
+
+					if (state == 0)
+					{
+						break;
+					}
+
+					if (m_forward.flags[state] & StateMatch)
+					{
+						last = static_cast<ptrdiff_t>(pos + 1);
+					}
+				}
+
+				if (pos == length && (m_forward.flags[state] & (length == 0 ? StateAcceptsEmptyText : StateAcceptsAtEnd)))
+				{
+					last = static_cast<ptrdiff_t>(length);
+				}
+
+				if (!allowEmpty && last == static_cast<ptrdiff_t>(start))
+				{
+					return -1;
+				}
+
+				return last;
+			}
+		};
+	}
+}
@@ -31,7 +31,7 @@ namespace s3d
 
 		explicit RoundRect(const String& str)
 		{
-			std::wistringstream(str.str()) >> *this;
+			FromChars(str, *this);
 		}
 
 		RoundRect(double _x, double _y, double _w, double _h, double _r)
@@ -224,6 +224,12 @@ namespace s3d
 			<< roundRect.r << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const RoundRect& roundRect)
+	{
+		FormatTuple(formatData, roundRect.x, roundRect.y, roundRect.w, roundRect.h, roundRect.r);
+	}
+
 	template <class CharType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, RoundRect& roundRect)
 	{
@@ -235,4 +241,18 @@ namespace s3d
 			>> roundRect.h >> unused
 			>> roundRect.r >> unused;
 	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, RoundRect& roundRect)
+	{
+		RoundRect result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.x, result.y, result.w, result.h, result.r);
+
+		if (r)
+		{
+			roundRect = result;
+		}
+
+		return r;
+	}
 }
@@ -9,6 +9,8 @@
 //-----------------------------------------------
 
 # pragma once
+# include <atomic>
+# include <intrin.h>
 
 namespace s3d
 {
@@ -38,6 +40,30 @@ namespace s3d
 		SSE4_2 = 42
 	};
 
+	/// <summary>
+	/// ヘッダ内の SIMD カーネルが使う命令セット
+	/// </summary>
+	/// <remarks>
+	/// ImageKernels, ImageCompositor, StringSearch の名前空間直下の関数が、どの実装を使うかを表します。
+	/// </remarks>
+	enum class SIMDKernel
+	{
+		/// <summary>
+		/// SIMD 命令を使わない実装
+		/// </summary>
+		Scalar,
+
+		/// <summary>
+		/// SSE2
+		/// </summary>
+		SSE2,
+
+		/// <summary>
+		/// AVX2
+		/// </summary>
+		AVX2
+	};
+
 	/// <summary>
 	/// SIMD
 	/// </summary>
@@ -59,10 +85,116 @@ namespace s3d
 		/// </param>
 		/// <remarks>
 		/// デフォルトでは SupportedSSE() が設定されています。
+		/// ライブラリ内の処理にのみ影響します。ヘッダ内の SIMD カーネルは SetKernel() で選択します。
 		/// </remarks>
 		/// <returns>
 		/// 変更に成功した場合 true, それ以外の場合は false
 		/// </returns>
 		bool SetSSE(SSE sse);
+
+		/// <summary>
+		/// CPU と OS が AVX2 をサポートしているかを返します。
+		/// </summary>
+		/// <remarks>
+		/// 最初の呼び出しで cpuid と xgetbv から判定し、結果を保持します。
+		/// SetKernel() の設定には影響されません。
+		/// </remarks>
+		/// <returns>
+		/// AVX2 が使える場合 true, それ以外の場合は false
+		/// </returns>
+		inline bool SupportsAVX2()
+		{
+			static const bool supported = []()
+			{
+				int info[4];
+
+				__cpuid(info, 0);
+
+				if (info[0] < 7)
+				{
+					return false;
+				}
+
+				// OSXSAVE と AVX
+				constexpr int osxsaveAVX = (1 << 27) | (1 << 28);
+
+				__cpuid(info, 1);
+
+				if ((info[2] & osxsaveAVX) != osxsaveAVX)
+				{
+					return false;
+				}
+
+				// OS がコンテキストスイッチで XMM と YMM レジスタを保存するか
+				if ((_xgetbv(0) & 0x6) != 0x6)
+				{
+					return false;
+				}
+
+				__cpuidex(info, 7, 0);
+
+				return (info[1] & (1 << 5)) != 0;
+			}();
+
+			return supported;
+		}
+
+		/// <summary>
+		/// ヘッダ内の SIMD カーネルで使える最も新しい命令セットを返します。
+		/// </summary>
+		/// <returns>
+		/// AVX2 が使える場合は SIMDKernel::AVX2, それ以外の場合は SIMDKernel::SSE2
+		/// </returns>
+		inline SIMDKernel SupportedKernel()
+		{
+			return SupportsAVX2() ? SIMDKernel::AVX2 : SIMDKernel::SSE2;
+		}
+
+		namespace detail
+		{
+			inline std::atomic<SIMDKernel>& SelectedKernel()
+			{
+				static std::atomic<SIMDKernel> kernel{ SupportedKernel() };
+
+				return kernel;
+			}
+		}
+
+		/// <summary>
+		/// ヘッダ内の SIMD カーネルが使う命令セットを返します。
+		/// </summary>
+		/// <returns>
+		/// 使用する命令セット
+		/// </returns>
+		inline SIMDKernel GetKernel()
+		{
+			return detail::SelectedKernel().load(std::memory_order_relaxed);
+		}
+
+		/// <summary>
+		/// ヘッダ内の SIMD カーネルが使う命令セットを変更します。
+		/// </summary>
+		/// <param name="kernel">
+		/// 使用する命令セット
+		/// </param>
+		/// <remarks>
+		/// デフォルトでは SupportedKernel() が設定されています。
+		/// SIMDKernel::SSE2 を設定すると、CPU が AVX2 に対応していても AVX2 の実装を使いません。
+		/// 結果の比較や、AVX2 命令によるクロックの低下を避けたい場合に使います。
+		/// </remarks>
+		/// <returns>
+		/// 変更に成功した場合 true, CPU が対応していない命令セットの場合は false
+		/// </returns>
+		inline bool SetKernel(SIMDKernel kernel)
+		{
+			if (kernel > SupportedKernel())
+			{
+				return false;
+			}
+
+			detail::SelectedKernel().store(kernel, std::memory_order_relaxed);
+
+			return true;
+		}
 	}
 }
@@ -9,6 +9,10 @@
 //-----------------------------------------------
 
 # pragma once
+# include <array>
+# include <cstring>
+# include <cstdint>
+# include <utility>
 # include "../ThirdParty/cereal/cereal.hpp"
 # include "../ThirdParty/cereal/archives/binary.hpp"
 # include "../ThirdParty/cereal/types/array.hpp"
@@ -55,16 +59,42 @@
 # include "../ThirdParty/cereal/types/valarray.hpp"
 # endif
 # include "../ThirdParty/cereal/types/vector.hpp"
+# include "ArrayView.hpp"
 
 namespace s3d
 {
+	/// <summary>
+	/// 要素のメモリ上の表現がそのままシリアライズ結果になる型かを表します。
+	/// </summary>
+	/// <remarks>
+	/// true の型の配列は、要素ごとではなく 1 回の saveBinary / loadBinary でまとめて読み書きされます。
+	/// パディングがなく、メンバをメモリ上の順にシリアライズする型にのみ特殊化してください。
+	/// </remarks>
+	template <class Type>
+	struct IsBulkSerializable : std::is_arithmetic<Type> {};
+
 	template <class Writer>
 	class Serializer : public cereal::OutputArchive<Serializer<Writer>, cereal::AllowEmptyClassElision>
 	{
 	private:
 
+		// 小さな書き込みをまとめるバッファの大きさ（バイト）
+		static constexpr size_t BufferSize = 4096;
+
 		std::shared_ptr<IWriter> m_writer;
 
+		std::array<uint8, BufferSize> m_buffer;
+
+		size_t m_bufferSize = 0;
+
+		void writeDirect(const void* data, size_t size)
+		{
+			auto const writtenSize = static_cast<std::size_t>(m_writer->write(data, size));
+
+			if (writtenSize != size)
+				throw cereal::Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+		}
+
 	public:
 
 		template <class ...Args>
@@ -75,16 +105,59 @@ namespace s3d
 
 		}
 
+		~Serializer()
+		{
+			if (m_bufferSize)
+			{
+				m_writer->write(m_buffer.data(), m_bufferSize);
+			}
+		}
+
 		void saveBinary(const void* data, size_t size)
 		{
-			auto const writtenSize = static_cast<std::size_t>(m_writer->write(data, size));
+			if (size <= BufferSize - m_bufferSize)
+			{
+				std::memcpy(m_buffer.data() + m_bufferSize, data, size);
 
-			if (writtenSize != size)
-				throw cereal::Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+				m_bufferSize += size;
+
+				return;
+			}
+
+			flush();
+
+			if (size < BufferSize)
+			{
+				std::memcpy(m_buffer.data(), data, size);
+
+				m_bufferSize = size;
+
+				return;
+			}
+
+			writeDirect(data, size);
 		}
 
+		/// <summary>
+		/// バッファにたまっている内容を Writer に書き出します。
+		/// </summary>
+		void flush()
+		{
+			if (m_bufferSize)
+			{
+				const size_t size = std::exchange(m_bufferSize, 0);
+
+				writeDirect(m_buffer.data(), size);
+			}
+		}
+
+		/// <summary>
+		/// バッファの内容を書き出してから、Writer を返します。
+		/// </summary>
 		Writer& getWriter()
 		{
+			flush();
+
 			return *std::dynamic_pointer_cast<Writer>(m_writer);
 		}
 	};
@@ -164,6 +237,155 @@ namespace s3d
 		ar.loadBinary(bd.data, static_cast<std::size_t>(bd.size));
 	}
 
+	//////////////////////////////////////////////////////
+	//
+	//	IsBulkSerializable
+	//
+	template <> struct IsBulkSerializable<Color> : std::true_type {};
+	template <> struct IsBulkSerializable<ColorF> : std::true_type {};
+	template <> struct IsBulkSerializable<HSV> : std::true_type {};
+	template <> struct IsBulkSerializable<Point> : std::true_type {};
+	template <> struct IsBulkSerializable<Float2> : std::true_type {};
+	template <> struct IsBulkSerializable<Vec2> : std::true_type {};
+	template <> struct IsBulkSerializable<Float3> : std::true_type {};
+	template <> struct IsBulkSerializable<Vec3> : std::true_type {};
+	template <> struct IsBulkSerializable<Float4> : std::true_type {};
+	template <> struct IsBulkSerializable<Vec4> : std::true_type {};
+	template <> struct IsBulkSerializable<Mat3x2> : std::true_type {};
+	template <> struct IsBulkSerializable<LineInt> : std::true_type {};
+	template <> struct IsBulkSerializable<Line> : std::true_type {};
+	template <> struct IsBulkSerializable<Rect> : std::true_type {};
+	template <> struct IsBulkSerializable<RectF> : std::true_type {};
+	template <> struct IsBulkSerializable<Circle> : std::true_type {};
+	template <> struct IsBulkSerializable<Ellipse> : std::true_type {};
+	template <> struct IsBulkSerializable<Triangle> : std::true_type {};
+	template <> struct IsBulkSerializable<Quad> : std::true_type {};
+	template <> struct IsBulkSerializable<RoundRect> : std::true_type {};
+	template <> struct IsBulkSerializable<FloatRect> : std::true_type {};
+	template <> struct IsBulkSerializable<FloatQuad> : std::true_type {};
+	template <> struct IsBulkSerializable<HalfFloat> : std::true_type {};
+	template <> struct IsBulkSerializable<R32F> : std::true_type {};
+	template <> struct IsBulkSerializable<RGBA16F> : std::true_type {};
+	template <> struct IsBulkSerializable<RGBA32F> : std::true_type {};
+	template <> struct IsBulkSerializable<R16F> : std::true_type {};
+	template <> struct IsBulkSerializable<RG16F> : std::true_type {};
+	template <> struct IsBulkSerializable<RG32F> : std::true_type {};
+	template <> struct IsBulkSerializable<WaveSample> : std::true_type {};
+
+	static_assert(sizeof(Color) == 4 && sizeof(Point) == 8 && sizeof(Rect) == 16 && sizeof(Circle) == 24
+		&& sizeof(RoundRect) == 40 && sizeof(Mat3x2) == 24 && sizeof(FloatQuad) == 32
+		&& sizeof(R32F) == 4 && sizeof(RGBA16F) == 8 && sizeof(RGBA32F) == 16 && sizeof(WaveSample) == 4,
+		"IsBulkSerializable types must not contain padding");
+
+	namespace detail
+	{
+		template <class Type, class Archive>
+		using IsBulkSavable = std::integral_constant<bool, IsBulkSerializable<Type>::value
+			&& cereal::traits::is_output_serializable<cereal::BinaryData<Type>, Archive>::value>;
+
+		template <class Type, class Archive>
+		using IsBulkLoadable = std::integral_constant<bool, IsBulkSerializable<Type>::value
+			&& cereal::traits::is_input_serializable<cereal::BinaryData<Type>, Archive>::value>;
+
+		template <class Archive, class Type, std::enable_if_t<IsBulkSavable<Type, Archive>::value>* = nullptr>
+		inline void SaveElements(Archive& archive, const Type* data, size_t size)
+		{
+			archive(cereal::binary_data(data, size * sizeof(Type)));
+		}
+
+		template <class Archive, class Type, std::enable_if_t<!IsBulkSavable<Type, Archive>::value>* = nullptr>
+		inline void SaveElements(Archive& archive, const Type* data, size_t size)
+		{
+			for (size_t i = 0; i < size; ++i)
+			{
+				archive(data[i]);
+			}
+		}
+
+		template <class Archive, class Type, std::enable_if_t<IsBulkLoadable<Type, Archive>::value>* = nullptr>
+		inline void LoadElements(Archive& archive, Type* data, size_t size)
+		{
+			archive(cereal::binary_data(data, size * sizeof(Type)));
+		}
+
+		template <class Archive, class Type, std::enable_if_t<!IsBulkLoadable<Type, Archive>::value>* = nullptr>
+		inline void LoadElements(Archive& archive, Type* data, size_t size)
+		{
+			for (size_t i = 0; i < size; ++i)
+			{
+				archive(data[i]);
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////
+	//
+	//	Array
+	//
+
+	//
+	// 算術型の Array は cereal が 1 ブロックで読み書きする
+	// IsBulkSerializable な型も同じ形式で 1 ブロックにまとめる
+	//
+	template <class Writer, class Type, class Allocator>
+	inline std::enable_if_t<IsBulkSerializable<Type>::value && !std::is_arithmetic<Type>::value>
+	CEREAL_SAVE_FUNCTION_NAME(Serializer<Writer>& archive, const std::vector<Type, Allocator>& array)
+	{
+		archive(cereal::make_size_tag(static_cast<cereal::size_type>(array.size())));
+		archive(cereal::binary_data(array.data(), array.size() * sizeof(Type)));
+	}
+
+	template <class Reader, class Type, class Allocator>
+	inline std::enable_if_t<IsBulkSerializable<Type>::value && !std::is_arithmetic<Type>::value>
+	CEREAL_LOAD_FUNCTION_NAME(Deserializer<Reader>& archive, std::vector<Type, Allocator>& array)
+	{
+		cereal::size_type size;
+		archive(cereal::make_size_tag(size));
+		array.resize(static_cast<size_t>(size));
+		archive(cereal::binary_data(array.data(), static_cast<size_t>(size) * sizeof(Type)));
+	}
+
+	//////////////////////////////////////////////////////
+	//
+	//	ArrayView
+	//
+
+	//
+	// Array と同じ形式で書き出す
+	//
+	template <class Archive, class Type>
+	inline void save(Archive& archive, const ArrayView<Type>& view)
+	{
+		archive(cereal::make_size_tag(static_cast<cereal::size_type>(view.size())));
+		detail::SaveElements(archive, view.data(), view.size());
+	}
+
+	//
+	// ByteArray からは、コピーせずにバッファの中を指す ArrayView を読み込む
+	// ArrayView は ByteArray のバッファが解放されるまで有効
+	//
+	template <class Type>
+	inline void load(Deserializer<ByteArray>& archive, ArrayView<Type>& view)
+	{
+		static_assert(IsBulkSerializable<Type>::value, "ArrayView<Type> can be deserialized only if IsBulkSerializable<Type> is true");
+
+		cereal::size_type size;
+		archive(cereal::make_size_tag(size));
+
+		ByteArray& reader = archive.getReader();
+		const uint8* const data = reader.data() + reader.getPos();
+		const int64 remaining = reader.size() - reader.getPos();
+
+		if (size > static_cast<cereal::size_type>(remaining) / sizeof(Type))
+			throw cereal::Exception("Failed to read " + std::to_string(size * sizeof(Type)) + " bytes from input stream! Read " + std::to_string(remaining));
+
+		if (reinterpret_cast<std::uintptr_t>(data) % alignof(Type) != 0)
+			throw cereal::Exception("Failed to create an ArrayView: data is not aligned to " + std::to_string(alignof(Type)) + " bytes");
+
+		reader.skip(static_cast<int64>(size * sizeof(Type)));
+		view = ArrayView<Type>(static_cast<const Type*>(static_cast<const void*>(data)), static_cast<size_t>(size));
+	}
+
 	//////////////////////////////////////////////////////
 	//
 	//	Optional
@@ -228,18 +450,28 @@ namespace s3d
 	{
 		archive(cereal::make_size_tag(static_cast<cereal::size_type>(grid.width)));
 		archive(cereal::make_size_tag(static_cast<cereal::size_type>(grid.height)));
-		archive(grid.getArray());
+		archive(cereal::make_size_tag(static_cast<cereal::size_type>(grid.num_elements())));
+		detail::SaveElements(archive, grid.data(), grid.num_elements());
 	}
 
 	template <class Archive, class Type>
 	inline void load(Archive& archive, Grid<Type>& grid)
 	{
-		cereal::size_type width, height;
+		cereal::size_type width, height, size;
 		archive(cereal::make_size_tag(width));
 		archive(cereal::make_size_tag(height));
-		Array<Type> data(static_cast<size_t>(width * height));
-		archive(data);
-		grid = Grid<Type>(static_cast<size_t>(width), static_cast<size_t>(height), std::move(data));
+		archive(cereal::make_size_tag(size));
+
+		if (size != width * height)
+			throw cereal::Exception("Grid size mismatch: " + std::to_string(width) + " x " + std::to_string(height) + " != " + std::to_string(size));
+
+		grid.clear();
+
+		if (size)
+		{
+			grid.resize(static_cast<size_t>(width), static_cast<size_t>(height));
+			detail::LoadElements(archive, grid.data(), static_cast<size_t>(size));
+		}
 	}
 
 	//////////////////////////////////////////////////////
@@ -1131,12 +1363,27 @@ namespace s3d
 	//
 	//	Image
 	//
+
+	//
+	// PNG にエンコードせず、ピクセルをそのまま 1 ブロックで書き出す
+	// 先頭のサイズタグが RawImageTag の場合は生のピクセル、それ以外は以前の形式の PNG
+	//
+	namespace detail
+	{
+		constexpr cereal::size_type RawImageTag = ~cereal::size_type(0);
+	}
+
 	template <class Archive>
 	inline void save(Archive & ar, const Image& image)
 	{
-		const auto encoded = image.encodePNG();
-		ar(cereal::make_size_tag(static_cast<cereal::size_type>(encoded.size())));
-		ar(cereal::binary_data(encoded.data(), encoded.size()));
+		const uint32 width = image.width, height = image.height;
+		ar(cereal::make_size_tag(detail::RawImageTag));
+		ar(width, height);
+
+		if (!image.isEmpty)
+		{
+			ar(cereal::binary_data(image.data(), image.memorySize()));
+		}
 	}
 
 	template <class Archive>
@@ -1144,9 +1391,36 @@ namespace s3d
 	{
 		cereal::size_type binarySize;
 		ar(cereal::make_size_tag(binarySize));
-		Array<uint8> binary(static_cast<size_t>(binarySize));
-		ar(cereal::binary_data(binary.data(), binary.size()));
-		image = Image(ByteArray(std::move(binary)));
+
+		if (binarySize != detail::RawImageTag)
+		{
+			Array<uint8> binary(static_cast<size_t>(binarySize));
+			ar(cereal::binary_data(binary.data(), binary.size()));
+			image = Image(ByteArray(std::move(binary)));
+			return;
+		}
+
+		uint32 width, height;
+		ar(width, height);
+
+		// 壊れたアーカイブの大きさで確保しないよう、Image を作る前に検査する
+		const uint64 numPixels = static_cast<uint64>(width) * height;
+
+		if (width > static_cast<uint32>(Image::MaxSize) || height > static_cast<uint32>(Image::MaxSize))
+			throw cereal::Exception("Invalid image size: " + std::to_string(width) + " x " + std::to_string(height));
+
+		if (image.width != static_cast<int32>(width) || image.height != static_cast<int32>(height))
+		{
+			image = Image(width, height);
+
+			if (static_cast<uint64>(image.num_pixels) != numPixels)
+				throw cereal::Exception("Invalid image size: " + std::to_string(width) + " x " + std::to_string(height));
+		}
+
+		if (!image.isEmpty)
+		{
+			ar(cereal::binary_data(image.data(), image.memorySize()));
+		}
 	}
 
 	//////////////////////////////////////////////////////
@@ -1285,10 +1559,11 @@ namespace s3d
 	//
 	//	WaveSample
 	//
-
-	//
-	// unimplemented
-	//
+	template <class Archive>
+	void serialize(Archive& archive, WaveSample& waveSample)
+	{
+		archive(waveSample._left_right);
+	}
 
 	//////////////////////////////////////////////////////
 	//
@@ -1303,10 +1578,33 @@ namespace s3d
 	//
 	//	Wave
 	//
+	template <class Archive>
+	inline void save(Archive& archive, const Wave& wave)
+	{
+		const uint32 samplingRate = wave.samplingRate;
+		archive(samplingRate);
+		archive(cereal::make_size_tag(static_cast<cereal::size_type>(wave.lengthSample)));
 
-	//
-	// unimplemented
-	//
+		if (!wave.isEmpty)
+		{
+			detail::SaveElements(archive, static_cast<const WaveSample*>(wave.data()), wave.lengthSample);
+		}
+	}
+
+	template <class Archive>
+	inline void load(Archive& archive, Wave& wave)
+	{
+		uint32 samplingRate;
+		cereal::size_type size;
+		archive(samplingRate);
+		archive(cereal::make_size_tag(size));
+		wave = Wave(static_cast<size_t>(size), samplingRate);
+
+		if (!wave.isEmpty)
+		{
+			detail::LoadElements(archive, static_cast<WaveSample*>(wave.data()), static_cast<size_t>(size));
+		}
+	}
 
 	//////////////////////////////////////////////////////
 	//
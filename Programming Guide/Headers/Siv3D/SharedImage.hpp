@@ -0,0 +1,173 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include "Fwd.hpp"
+# include "Image.hpp"
+# include "ImageView.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// ピクセルを共有する画像
+	/// </summary>
+	/// <remarks>
+	/// コピーはピクセルを複製せず、参照カウントで同じ Image を共有します。
+	/// edit() で書き込み用の Image を取得したとき、ほかと共有している場合に限り複製します（コピーオンライト）。
+	/// 同じ SharedImage オブジェクトを複数のスレッドから同時に edit() してはいけません。
+	/// </remarks>
+	class SharedImage
+	{
+	private:
+
+		std::shared_ptr<Image> m_image;
+
+		static const Image& EmptyImage()
+		{
+			static const Image empty;
+
+			return empty;
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		SharedImage() = default;
+
+		/// <summary>
+		/// 画像をムーブして作成します。
+		/// </summary>
+		/// <param name="image">
+		/// ムーブする画像
+		/// </param>
+		SharedImage(Image&& image)
+			: m_image(std::make_shared<Image>(std::move(image))) {}
+
+		/// <summary>
+		/// 画像をコピーして作成します。
+		/// </summary>
+		/// <param name="image">
+		/// コピーする画像
+		/// </param>
+		explicit SharedImage(const Image& image)
+			: m_image(std::make_shared<Image>(image)) {}
+
+		/// <summary>
+		/// 読み込み用の画像を返します。
+		/// </summary>
+		/// <returns>
+		/// 画像
+		/// </returns>
+		const Image& get() const
+		{
+			return m_image ? *m_image : EmptyImage();
+		}
+
+		operator const Image&() const
+		{
+			return get();
+		}
+
+		const Image* operator ->() const
+		{
+			return &get();
+		}
+
+		/// <summary>
+		/// 書き込み用の画像を返します。
+		/// </summary>
+		/// <remarks>
+		/// ほかの SharedImage や ImageView とピクセルを共有している場合は、先に複製します。
+		/// 返された参照は、この SharedImage をコピーするまで有効です。
+		/// </remarks>
+		/// <returns>
+		/// 画像
+		/// </returns>
+		Image& edit()
+		{
+			if (!m_image)
+			{
+				m_image = std::make_shared<Image>();
+			}
+			else if (m_image.use_count() > 1)
+			{
+				m_image = std::make_shared<Image>(*m_image);
+			}
+
+			return *m_image;
+		}
+
+		/// <summary>
+		/// 画像の所有権を手放し、画像をムーブして返します。
+		/// </summary>
+		/// <remarks>
+		/// ほかと共有している場合はコピーを返します。
+		/// </remarks>
+		/// <returns>
+		/// 画像
+		/// </returns>
+		Image release()
+		{
+			Image image = std::move(edit());
+
+			m_image.reset();
+
+			return image;
+		}
+
+		/// <summary>
+		/// ピクセルを共有しているかを返します。
+		/// </summary>
+		bool isShared() const
+		{
+			return m_image.use_count() > 1;
+		}
+
+		/// <summary>
+		/// ピクセルを共有しているオブジェクトの数を返します。
+		/// </summary>
+		long useCount() const
+		{
+			return m_image.use_count();
+		}
+
+		/// <summary>
+		/// 画像全体を参照するビューを返します。
+		/// </summary>
+		/// <remarks>
+		/// ビューはピクセルの所有権を共有するため、この SharedImage が edit() されたり破棄されたりしても参照先は変わりません。
+		/// </remarks>
+		ImageView view() const
+		{
+			return ImageView(m_image);
+		}
+
+		ImageView operator ()(int32 x, int32 y, int32 w, int32 h) const
+		{
+			return view().sub({ x, y, w, h });
+		}
+
+		ImageView operator ()(const Rect& rect) const
+		{
+			return view().sub(rect);
+		}
+
+		Property_Get(int32, width) const { return get().width; }
+
+		Property_Get(int32, height) const { return get().height; }
+
+		Property_Get(Size, size) const { return get().size; }
+
+		Property_Get(bool, isEmpty) const { return get().isEmpty; }
+	};
+}
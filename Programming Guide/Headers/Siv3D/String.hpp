@@ -15,9 +15,29 @@
 # include "Fwd.hpp"
 # include "PropertyMacro.hpp"
 # include "Array.hpp"
+# include "Char.hpp"
+# include "StringSearch.hpp"
 
 namespace s3d
 {
+	namespace detail
+	{
+		inline constexpr bool IsTrimmed(wchar ch)
+		{
+			return IsSpace(ch) || IsControl(ch);
+		}
+
+		inline constexpr bool IsAsciiLower(wchar ch)
+		{
+			return (L'a' <= ch) && (ch <= L'z');
+		}
+
+		inline constexpr bool IsAsciiUpper(wchar ch)
+		{
+			return (L'A' <= ch) && (ch <= L'Z');
+		}
+	}
+
 	/// <summary>
 	/// 文字列
 	/// </summary>
@@ -1106,7 +1126,7 @@ namespace s3d
 		/// </returns>
 		size_t indexOf(const String& str, size_t offset = 0) const
 		{
-			return m_string.find(str.data(), offset, str.length);
+			return StringSearch::IndexOf(m_string.data(), m_string.length(), str.data(), str.length, offset);
 		}
 
 		/// <summary>
@@ -1126,7 +1146,7 @@ namespace s3d
 		/// </returns>
 		size_t indexOf(const wchar* str, size_t offset = 0) const
 		{
-			return m_string.find(str, offset, traits_type::length(str));
+			return StringSearch::IndexOf(m_string.data(), m_string.length(), str, traits_type::length(str), offset);
 		}
 
 		/// <summary>
@@ -1143,7 +1163,7 @@ namespace s3d
 		/// </returns>
 		size_t indexOf(wchar ch, size_t offset = 0) const
 		{
-			return m_string.find(ch, offset);
+			return StringSearch::IndexOf(m_string.data(), m_string.length(), ch, offset);
 		}
 
 		/// <summary>
@@ -1248,7 +1268,7 @@ namespace s3d
 		/// </returns>
 		size_t indexOfAny(const String& anyof, size_t offset = 0) const
 		{
-			return m_string.find_first_of(anyof.data(), offset, anyof.length);
+			return StringSearch::IndexOfAny(m_string.data(), m_string.length(), anyof.data(), anyof.length, offset);
 		}
 
 		/// <summary>
@@ -1268,7 +1288,7 @@ namespace s3d
 		/// </returns>
 		size_t indexOfAny(const wchar* anyof, size_t offset = 0) const
 		{
-			return m_string.find_first_of(anyof, offset, traits_type::length(anyof));
+			return StringSearch::IndexOfAny(m_string.data(), m_string.length(), anyof, traits_type::length(anyof), offset);
 		}
 
 		/// <summary>
@@ -1550,6 +1570,22 @@ namespace s3d
 		/// </returns>
 		String trimLeft() const;
 
+		/// <summary>
+		/// 先頭にある空白と制御文字を除去します。
+		/// </summary>
+		/// <remarks>
+		/// trimLeft() と異なり、新しい文字列を作りません。
+		/// </remarks>
+		/// <returns>
+		/// *this
+		/// </returns>
+		String& trimLeftInPlace()
+		{
+			m_string.erase(m_string.begin(), std::find_if_not(m_string.begin(), m_string.end(), detail::IsTrimmed));
+
+			return *this;
+		}
+
 		/// <summary>
 		/// 末尾にある空白と制御文字を除去した文字列を返します。
 		/// </summary>
@@ -1561,6 +1597,22 @@ namespace s3d
 		/// </returns>
 		String trimRight() const;
 
+		/// <summary>
+		/// 末尾にある空白と制御文字を除去します。
+		/// </summary>
+		/// <remarks>
+		/// trimRight() と異なり、新しい文字列を作りません。
+		/// </remarks>
+		/// <returns>
+		/// *this
+		/// </returns>
+		String& trimRightInPlace()
+		{
+			m_string.erase(std::find_if_not(m_string.rbegin(), m_string.rend(), detail::IsTrimmed).base(), m_string.end());
+
+			return *this;
+		}
+
 		/// <summary>
 		/// 先頭と末尾にある空白と制御文字を除去した文字列を返します。
 		/// </summary>
@@ -1572,6 +1624,20 @@ namespace s3d
 		/// </returns>
 		String trim() const;
 
+		/// <summary>
+		/// 先頭と末尾にある空白と制御文字を除去します。
+		/// </summary>
+		/// <remarks>
+		/// trim() と異なり、新しい文字列を作りません。
+		/// </remarks>
+		/// <returns>
+		/// *this
+		/// </returns>
+		String& trimInPlace()
+		{
+			return trimRightInPlace().trimLeftInPlace();
+		}
+
 		/// <summary>
 		/// 反転した文字列を返します。
 		/// </summary>
@@ -1591,6 +1657,30 @@ namespace s3d
 		/// </returns>
 		String capitalize() const;
 
+		/// <summary>
+		/// 最初に登場する英字を大文字にします。
+		/// </summary>
+		/// <returns>
+		/// *this
+		/// </returns>
+		String& capitalizeInPlace()
+		{
+			for (auto& ch : m_string)
+			{
+				if (detail::IsAsciiLower(ch))
+				{
+					ch -= 32;
+					break;
+				}
+				else if (detail::IsAsciiUpper(ch))
+				{
+					break;
+				}
+			}
+
+			return *this;
+		}
+
 		/// <summary>
 		/// 英字をすべて大文字にした文字列を返します。
 		/// </summary>
@@ -1599,6 +1689,25 @@ namespace s3d
 		/// </returns>
 		String upper() const;
 
+		/// <summary>
+		/// 英字をすべて大文字にします。
+		/// </summary>
+		/// <returns>
+		/// *this
+		/// </returns>
+		String& upperInPlace()
+		{
+			for (auto& ch : m_string)
+			{
+				if (detail::IsAsciiLower(ch))
+				{
+					ch -= 32;
+				}
+			}
+
+			return *this;
+		}
+
 		/// <summary>
 		/// 英字をすべて小文字にした文字列を返します。
 		/// </summary>
@@ -1607,6 +1716,25 @@ namespace s3d
 		/// </returns>
 		String lower() const;
 
+		/// <summary>
+		/// 英字をすべて小文字にします。
+		/// </summary>
+		/// <returns>
+		/// *this
+		/// </returns>
+		String& lowerInPlace()
+		{
+			for (auto& ch : m_string)
+			{
+				if (detail::IsAsciiUpper(ch))
+				{
+					ch += 32;
+				}
+			}
+
+			return *this;
+		}
+
 		/// <summary>
 		/// 英字の大文字と小文字を入れ替えた文字列を返します。
 		/// </summary>
@@ -1615,6 +1743,29 @@ namespace s3d
 		/// </returns>
 		String swapCase() const;
 
+		/// <summary>
+		/// 英字の大文字と小文字を入れ替えます。
+		/// </summary>
+		/// <returns>
+		/// *this
+		/// </returns>
+		String& swapCaseInPlace()
+		{
+			for (auto& ch : m_string)
+			{
+				if (detail::IsAsciiLower(ch))
+				{
+					ch -= 32;
+				}
+				else if (detail::IsAsciiUpper(ch))
+				{
+					ch += 32;
+				}
+			}
+
+			return *this;
+		}
+
 		/// <summary>
 		/// XML エスケープした文字列を返します。
 		/// </summary>
@@ -1659,7 +1810,7 @@ namespace s3d
 		/// </returns>
 		size_t count(wchar ch) const
 		{
-			return std::count(begin(), end(), ch);
+			return StringSearch::Count(m_string.data(), m_string.data() + m_string.length(), ch);
 		}
 
 		/// <summary>
@@ -1813,6 +1964,25 @@ namespace s3d
 		/// </returns>
 		String replace(wchar oldChar, wchar newChar) const;
 
+		/// <summary>
+		/// 指定した文字を置換します。
+		/// </summary>
+		/// <param name="oldChar">
+		/// 置換対象の文字
+		/// </param>
+		/// <param name="newChar">
+		/// 置換後の文字
+		/// </param>
+		/// <returns>
+		/// *this
+		/// </returns>
+		String& replaceInPlace(wchar oldChar, wchar newChar)
+		{
+			std::replace(m_string.begin(), m_string.end(), oldChar, newChar);
+
+			return *this;
+		}
+
 		/// <summary>
 		/// 指定した文字列を置換した文字列を返します。
 		/// </summary>
@@ -1827,6 +1997,24 @@ namespace s3d
 		/// </returns>
 		String replace(const String& oldStr, const String& newStr) const;
 
+		/// <summary>
+		/// 指定した文字列を置換します。
+		/// </summary>
+		/// <param name="oldStr">
+		/// 置換対象の文字列
+		/// </param>
+		/// <param name="newStr">
+		/// 置換後の文字列
+		/// </param>
+		/// <remarks>
+		/// 置換後の文字列の方が短い場合は新しいメモリを確保しません。
+		/// oldStr や newStr がこの文字列の一部を参照している場合は、先にコピーしてから置換します。
+		/// </remarks>
+		/// <returns>
+		/// *this
+		/// </returns>
+		String& replaceInPlace(const StringView& oldStr, const StringView& newStr);
+
 		/// <summary>
 		/// 指定した文字を除去した文字列を返します。
 		/// </summary>
@@ -1838,6 +2026,22 @@ namespace s3d
 		/// </returns>
 		String remove(wchar ch) const;
 
+		/// <summary>
+		/// 指定した文字を除去します。
+		/// </summary>
+		/// <param name="ch">
+		/// 除去対象の文字
+		/// </param>
+		/// <returns>
+		/// *this
+		/// </returns>
+		String& removeInPlace(wchar ch)
+		{
+			m_string.erase(std::remove(m_string.begin(), m_string.end(), ch), m_string.end());
+
+			return *this;
+		}
+
 		/// <summary>
 		/// 指定した文字列を除去した文字列を返します。
 		/// </summary>
@@ -1849,6 +2053,17 @@ namespace s3d
 		/// </returns>
 		String remove(const StringView& str) const;
 
+		/// <summary>
+		/// 指定した文字列を除去します。
+		/// </summary>
+		/// <param name="str">
+		/// 除去対象の文字列
+		/// </param>
+		/// <returns>
+		/// *this
+		/// </returns>
+		String& removeInPlace(const StringView& str);
+
 		/// <summary>
 		/// 条件に合う文字を除去した文字列を返します。
 		/// </summary>
@@ -1860,6 +2075,23 @@ namespace s3d
 		/// </returns>
 		String remove_if(std::function<bool(wchar)> function) const;
 
+		/// <summary>
+		/// 条件に合う文字を除去します。
+		/// </summary>
+		/// <param name="function">
+		/// 条件を記述した関数
+		/// </param>
+		/// <returns>
+		/// *this
+		/// </returns>
+		template <class Fty>
+		String& remove_ifInPlace(Fty function)
+		{
+			m_string.erase(std::remove_if(m_string.begin(), m_string.end(), function), m_string.end());
+
+			return *this;
+		}
+
 		/// <summary>
 		/// 指定した区切り文字で文字列を分割します。
 		/// </summary>
@@ -1870,6 +2102,48 @@ namespace s3d
 		/// 分割された文字列
 		/// </returns>
 		std::vector<String> split(wchar ch) const;
+
+		/// <summary>
+		/// 指定した区切り文字で文字列を分割した範囲を返します。
+		/// </summary>
+		/// <param name="ch">
+		/// 区切り文字
+		/// </param>
+		/// <remarks>
+		/// split() と同じ位置で分割しますが、各要素はこの文字列を参照する StringView で、メモリを確保しません。
+		/// 範囲を使い終わるまでこの文字列を変更しないでください。
+		/// </remarks>
+		/// <returns>
+		/// 分割された文字列を順に返す範囲
+		/// </returns>
+		StringSplitRange splitView(wchar ch) const;
+
+		/// <summary>
+		/// 空白類文字で区切られたトークンの範囲を返します。
+		/// </summary>
+		/// <remarks>
+		/// 連続する区切りは 1 つとみなし、空のトークンは返しません。
+		/// 各要素はこの文字列を参照する StringView で、メモリを確保しません。
+		/// </remarks>
+		/// <returns>
+		/// トークンを順に返す範囲
+		/// </returns>
+		StringTokenRange tokenize() const;
+
+		/// <summary>
+		/// 指定したいずれかの文字で区切られたトークンの範囲を返します。
+		/// </summary>
+		/// <param name="delimiters">
+		/// 区切り文字の一覧
+		/// </param>
+		/// <remarks>
+		/// 連続する区切りは 1 つとみなし、空のトークンは返しません。
+		/// 各要素はこの文字列を参照する StringView で、メモリを確保しません。
+		/// </remarks>
+		/// <returns>
+		/// トークンを順に返す範囲
+		/// </returns>
+		StringTokenRange tokenize(const StringView& delimiters) const;
 	};
 
 	/// <summary>
@@ -0,0 +1,569 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <algorithm>
+# include <string>
+# include <intrin.h>
+# include <immintrin.h>
+# include "Fwd.hpp"
+# include "SIMD.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// 文字列の検索
+	/// </summary>
+	/// <remarks>
+	/// String と StringView の検索関数が使う、SIMD 命令による実装です。
+	/// SIMD::GetKernel() が AVX2 の場合は 16 文字ずつ、SSE2 の場合は 8 文字ずつ比較します。
+	/// 実装は SIMD::SetKernel() で選択でき、どの実装も Scalar 版と同じ結果を返します。
+	/// 戻り値はすべて見つかった位置のポインタで、見つからなかった場合は last を返します。
+	/// </remarks>
+	namespace StringSearch
+	{
+		static_assert(sizeof(wchar) == 2, "StringSearch assumes 16-bit wchar");
+
+		namespace detail
+		{
+			inline uint32 CountTrailingZeros(uint32 mask)
+			{
+				unsigned long index;
+
+				_BitScanForward(&index, mask);
+
+				return index;
+			}
+
+			// 集合の文字数がこれ以下なら SIMD で比較する
+			constexpr size_t MaxVectorSetSize = 8;
+
+			// これより短い文字列は分岐の少ない 1 文字ずつの比較の方が速い
+			constexpr size_t MinVectorLength = 32;
+
+			inline bool UseAVX2()
+			{
+				return SIMD::GetKernel() == SIMDKernel::AVX2;
+			}
+
+			inline bool UseSSE2()
+			{
+				return SIMD::GetKernel() != SIMDKernel::Scalar;
+			}
+		}
+
+		/// <summary>
+		/// 1 文字ずつ比較する実装
+		/// </summary>
+		namespace Scalar
+		{
+			inline const wchar* Find(const wchar* first, const wchar* last, wchar ch)
+			{
+				for (; first != last; ++first)
+				{
+					if (*first == ch)
+					{
+						return first;
+					}
+				}
+
+				return last;
+			}
+
+			inline size_t Count(const wchar* first, const wchar* last, wchar ch)
+			{
+				size_t count = 0;
+
+				for (; first != last; ++first)
+				{
+					count += (*first == ch);
+				}
+
+				return count;
+			}
+
+			inline const wchar* FindAny(const wchar* first, const wchar* last, const wchar* set, size_t setLength)
+			{
+				// 下位 8 ビットのビットマップで候補を絞ってから集合を調べる
+				uint32 bitmap[8] = {};
+
+				for (size_t i = 0; i < setLength; ++i)
+				{
+					bitmap[(set[i] & 0xFF) >> 5] |= (1u << (set[i] & 31));
+				}
+
+				for (; first != last; ++first)
+				{
+					const wchar ch = *first;
+
+					if ((bitmap[(ch & 0xFF) >> 5] & (1u << (ch & 31)))
+						&& std::char_traits<wchar>::find(set, setLength, ch))
+					{
+						return first;
+					}
+				}
+
+				return last;
+			}
+
+			inline const wchar* Search(const wchar* first, const wchar* last, const wchar* str, size_t length)
+			{
+				if (length == 0)
+				{
+					return first;
+				}
+
+				if (static_cast<size_t>(last - first) < length)
+				{
+					return last;
+				}
+
+				const wchar* const end = last - length + 1;
+
+				for (; (first = Find(first, end, str[0])) != end; ++first)
+				{
+					if (std::char_traits<wchar>::compare(first + 1, str + 1, length - 1) == 0)
+					{
+						return first;
+					}
+				}
+
+				return last;
+			}
+		}
+
+		/// <summary>
+		/// SSE2 による実装（1 命令で 8 文字）
+		/// </summary>
+		namespace SSE2
+		{
+			inline const wchar* Find(const wchar* first, const wchar* last, wchar ch)
+			{
+				const __m128i c = _mm_set1_epi16(static_cast<int16>(ch));
+
+				for (; last - first >= 8; first += 8)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+
+					const uint32 mask = _mm_movemask_epi8(_mm_cmpeq_epi16(v, c));
+
+					if (mask)
+					{
+						return first + (detail::CountTrailingZeros(mask) >> 1);
+					}
+				}
+
+				return Scalar::Find(first, last, ch);
+			}
+
+			inline size_t Count(const wchar* first, const wchar* last, wchar ch)
+			{
+				const __m128i c = _mm_set1_epi16(static_cast<int16>(ch));
+
+				const __m128i one = _mm_set1_epi16(1);
+
+				__m128i total = _mm_setzero_si128();
+
+				while (last - first >= 8)
+				{
+					// 16 ビットの各レーンが溢れる前に 32 ビットに足し込む
+					const size_t blocks = std::min<size_t>((last - first) / 8, 0x7FFF);
+
+					__m128i sum = _mm_setzero_si128();
+
+					for (size_t i = 0; i < blocks; ++i, first += 8)
+					{
+						const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+
+						sum = _mm_sub_epi16(sum, _mm_cmpeq_epi16(v, c));
+					}
+
+					total = _mm_add_epi32(total, _mm_madd_epi16(sum, one));
+				}
+
+				total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(1, 0, 3, 2)));
+
+				total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(2, 3, 0, 1)));
+
+				return static_cast<uint32>(_mm_cvtsi128_si32(total)) + Scalar::Count(first, last, ch);
+			}
+
+			inline const wchar* FindAny(const wchar* first, const wchar* last, const wchar* set, size_t setLength)
+			{
+				if (setLength > detail::MaxVectorSetSize)
+				{
+					return Scalar::FindAny(first, last, set, setLength);
+				}
+
+				__m128i chars[detail::MaxVectorSetSize];
+
+				for (size_t i = 0; i < setLength; ++i)
+				{
+					chars[i] = _mm_set1_epi16(static_cast<int16>(set[i]));
+				}
+
+				for (; last - first >= 8; first += 8)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+
+					__m128i eq = _mm_setzero_si128();
+
+					for (size_t i = 0; i < setLength; ++i)
+					{
+						eq = _mm_or_si128(eq, _mm_cmpeq_epi16(v, chars[i]));
+					}
+
+					const uint32 mask = _mm_movemask_epi8(eq);
+
+					if (mask)
+					{
+						return first + (detail::CountTrailingZeros(mask) >> 1);
+					}
+				}
+
+				return Scalar::FindAny(first, last, set, setLength);
+			}
+
+			inline const wchar* Search(const wchar* first, const wchar* last, const wchar* str, size_t length)
+			{
+				if (length < 2)
+				{
+					return length ? Find(first, last, str[0]) : first;
+				}
+
+				// 先頭と末尾の文字が一致する位置だけを候補として比較する
+				const __m128i head = _mm_set1_epi16(static_cast<int16>(str[0]));
+
+				const __m128i tail = _mm_set1_epi16(static_cast<int16>(str[length - 1]));
+
+				const wchar* p = first;
+
+				for (; last - p >= static_cast<ptrdiff_t>(length + 7); p += 8)
+				{
+					const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+					const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + length - 1));
+
+					uint32 mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(a, head), _mm_cmpeq_epi16(b, tail))) & 0x5555;
+
+					while (mask)
+					{
+						const wchar* const candidate = p + (detail::CountTrailingZeros(mask) >> 1);
+
+						if (std::char_traits<wchar>::compare(candidate + 1, str + 1, length - 2) == 0)
+						{
+							return candidate;
+						}
+
+						mask &= mask - 1;
+					}
+				}
+
+				return Scalar::Search(p, last, str, length);
+			}
+		}
+
+		/// <summary>
+		/// AVX2 による実装（1 命令で 16 文字）
+		/// </summary>
+		namespace AVX2
+		{
+			inline const wchar* Find(const wchar* first, const wchar* last, wchar ch)
+			{
+				const __m256i c = _mm256_set1_epi16(static_cast<int16>(ch));
+
+				for (; last - first >= 16; first += 16)
+				{
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+
+					const uint32 mask = _mm256_movemask_epi8(_mm256_cmpeq_epi16(v, c));
+
+					if (mask)
+					{
+						return first + (detail::CountTrailingZeros(mask) >> 1);
+					}
+				}
+
+				return SSE2::Find(first, last, ch);
+			}
+
+			inline size_t Count(const wchar* first, const wchar* last, wchar ch)
+			{
+				const __m256i c = _mm256_set1_epi16(static_cast<int16>(ch));
+
+				const __m256i one = _mm256_set1_epi16(1);
+
+				__m256i total = _mm256_setzero_si256();
+
+				while (last - first >= 16)
+				{
+					const size_t blocks = std::min<size_t>((last - first) / 16, 0x7FFF);
+
+					__m256i sum = _mm256_setzero_si256();
+
+					for (size_t i = 0; i < blocks; ++i, first += 16)
+					{
+						const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+
+						sum = _mm256_sub_epi16(sum, _mm256_cmpeq_epi16(v, c));
+					}
+
+					total = _mm256_add_epi32(total, _mm256_madd_epi16(sum, one));
+				}
+
+				__m128i t = _mm_add_epi32(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+
+				t = _mm_add_epi32(t, _mm_shuffle_epi32(t, _MM_SHUFFLE(1, 0, 3, 2)));
+
+				t = _mm_add_epi32(t, _mm_shuffle_epi32(t, _MM_SHUFFLE(2, 3, 0, 1)));
+
+				return static_cast<uint32>(_mm_cvtsi128_si32(t)) + SSE2::Count(first, last, ch);
+			}
+
+			inline const wchar* FindAny(const wchar* first, const wchar* last, const wchar* set, size_t setLength)
+			{
+				if (setLength > detail::MaxVectorSetSize)
+				{
+					return Scalar::FindAny(first, last, set, setLength);
+				}
+
+				__m256i chars[detail::MaxVectorSetSize];
+
+				for (size_t i = 0; i < setLength; ++i)
+				{
+					chars[i] = _mm256_set1_epi16(static_cast<int16>(set[i]));
+				}
+
+				for (; last - first >= 16; first += 16)
+				{
+					const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+
+					__m256i eq = _mm256_setzero_si256();
+
+					for (size_t i = 0; i < setLength; ++i)
+					{
+						eq = _mm256_or_si256(eq, _mm256_cmpeq_epi16(v, chars[i]));
+					}
+
+					const uint32 mask = _mm256_movemask_epi8(eq);
+
+					if (mask)
+					{
+						return first + (detail::CountTrailingZeros(mask) >> 1);
+					}
+				}
+
+				return SSE2::FindAny(first, last, set, setLength);
+			}
+
+			inline const wchar* Search(const wchar* first, const wchar* last, const wchar* str, size_t length)
+			{
+				if (length < 2)
+				{
+					return length ? Find(first, last, str[0]) : first;
+				}
+
+				const __m256i head = _mm256_set1_epi16(static_cast<int16>(str[0]));
+
+				const __m256i tail = _mm256_set1_epi16(static_cast<int16>(str[length - 1]));
+
+				const wchar* p = first;
+
+				for (; last - p >= static_cast<ptrdiff_t>(length + 15); p += 16)
+				{
+					const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+
+					const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + length - 1));
+
+					uint32 mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi16(a, head), _mm256_cmpeq_epi16(b, tail))) & 0x55555555;
+
+					while (mask)
+					{
+						const wchar* const candidate = p + (detail::CountTrailingZeros(mask) >> 1);
+
+						if (std::char_traits<wchar>::compare(candidate + 1, str + 1, length - 2) == 0)
+						{
+							return candidate;
+						}
+
+						mask &= mask - 1;
+					}
+				}
+
+				return SSE2::Search(p, last, str, length);
+			}
+		}
+
+		/// <summary>
+		/// 文字を検索します。
+		/// </summary>
+		/// <param name="first">
+		/// 検索範囲の先頭
+		/// </param>
+		/// <param name="last">
+		/// 検索範囲の終端
+		/// </param>
+		/// <param name="ch">
+		/// 検索する文字
+		/// </param>
+		/// <returns>
+		/// 最初に見つかった位置、見つからなかった場合は last
+		/// </returns>
+		inline const wchar* Find(const wchar* first, const wchar* last, wchar ch)
+		{
+			if (static_cast<size_t>(last - first) < detail::MinVectorLength)
+			{
+				return Scalar::Find(first, last, ch);
+			}
+
+			return detail::UseAVX2() ? AVX2::Find(first, last, ch) : detail::UseSSE2() ? SSE2::Find(first, last, ch) : Scalar::Find(first, last, ch);
+		}
+
+		/// <summary>
+		/// 文字の個数を数えます。
+		/// </summary>
+		/// <param name="first">
+		/// 検索範囲の先頭
+		/// </param>
+		/// <param name="last">
+		/// 検索範囲の終端
+		/// </param>
+		/// <param name="ch">
+		/// 検索する文字
+		/// </param>
+		/// <returns>
+		/// 見つかった文字の個数
+		/// </returns>
+		inline size_t Count(const wchar* first, const wchar* last, wchar ch)
+		{
+			if (static_cast<size_t>(last - first) < detail::MinVectorLength)
+			{
+				return Scalar::Count(first, last, ch);
+			}
+
+			return detail::UseAVX2() ? AVX2::Count(first, last, ch) : detail::UseSSE2() ? SSE2::Count(first, last, ch) : Scalar::Count(first, last, ch);
+		}
+
+		/// <summary>
+		/// 集合に含まれるいずれかの文字を検索します。
+		/// </summary>
+		/// <param name="first">
+		/// 検索範囲の先頭
+		/// </param>
+		/// <param name="last">
+		/// 検索範囲の終端
+		/// </param>
+		/// <param name="set">
+		/// 文字の集合
+		/// </param>
+		/// <param name="setLength">
+		/// 集合の文字数
+		/// </param>
+		/// <returns>
+		/// 最初に見つかった位置、見つからなかった場合は last
+		/// </returns>
+		inline const wchar* FindAny(const wchar* first, const wchar* last, const wchar* set, size_t setLength)
+		{
+			if (setLength == 1)
+			{
+				return Find(first, last, set[0]);
+			}
+
+			if (static_cast<size_t>(last - first) < detail::MinVectorLength || setLength > detail::MaxVectorSetSize)
+			{
+				return Scalar::FindAny(first, last, set, setLength);
+			}
+
+			return detail::UseAVX2() ? AVX2::FindAny(first, last, set, setLength) : detail::UseSSE2() ? SSE2::FindAny(first, last, set, setLength) : Scalar::FindAny(first, last, set, setLength);
+		}
+
+		/// <summary>
+		/// 文字列を検索します。
+		/// </summary>
+		/// <param name="first">
+		/// 検索範囲の先頭
+		/// </param>
+		/// <param name="last">
+		/// 検索範囲の終端
+		/// </param>
+		/// <param name="str">
+		/// 検索する文字列
+		/// </param>
+		/// <param name="length">
+		/// 検索する文字列の長さ
+		/// </param>
+		/// <returns>
+		/// 最初に見つかった位置、見つからなかった場合は last。length が 0 の場合は first
+		/// </returns>
+		inline const wchar* Search(const wchar* first, const wchar* last, const wchar* str, size_t length)
+		{
+			if (static_cast<size_t>(last - first) < detail::MinVectorLength + length)
+			{
+				return Scalar::Search(first, last, str, length);
+			}
+
+			return detail::UseAVX2() ? AVX2::Search(first, last, str, length) : detail::UseSSE2() ? SSE2::Search(first, last, str, length) : Scalar::Search(first, last, str, length);
+		}
+
+		/// <summary>
+		/// 文字を指定した位置から検索し、最初に現れた位置を返します。
+		/// </summary>
+		/// <returns>
+		/// 見つかった位置、見つからなかった場合は size_t(-1)
+		/// </returns>
+		inline size_t IndexOf(const wchar* data, size_t size, wchar ch, size_t offset)
+		{
+			if (offset >= size)
+			{
+				return size_t(-1);
+			}
+
+			const wchar* const it = Find(data + offset, data + size, ch);
+
+			return it == data + size ? size_t(-1) : static_cast<size_t>(it - data);
+		}
+
+		/// <summary>
+		/// 文字列を指定した位置から検索し、最初に現れた位置を返します。
+		/// </summary>
+		/// <returns>
+		/// 見つかった位置、見つからなかった場合は size_t(-1)
+		/// </returns>
+		inline size_t IndexOf(const wchar* data, size_t size, const wchar* str, size_t length, size_t offset)
+		{
+			if (offset > size || size - offset < length)
+			{
+				return size_t(-1);
+			}
+
+			const wchar* const it = Search(data + offset, data + size, str, length);
+
+			return (it == data + size && length != 0) ? size_t(-1) : static_cast<size_t>(it - data);
+		}
+
+		/// <summary>
+		/// 集合に含まれるいずれかの文字を指定した位置から検索し、最初に現れた位置を返します。
+		/// </summary>
+		/// <returns>
+		/// 見つかった位置、見つからなかった場合は size_t(-1)
+		/// </returns>
+		inline size_t IndexOfAny(const wchar* data, size_t size, const wchar* set, size_t setLength, size_t offset)
+		{
+			if (offset >= size || setLength == 0)
+			{
+				return size_t(-1);
+			}
+
+			const wchar* const it = FindAny(data + offset, data + size, set, setLength);
+
+			return it == data + size ? size_t(-1) : static_cast<size_t>(it - data);
+		}
+	}
+}
@@ -10,6 +10,7 @@
 
 # pragma once
 # include <algorithm>
+# include <iterator>
 # include <utility>
 # include "String.hpp"
 
@@ -484,9 +485,7 @@ namespace s3d
 		/// </returns>
 		size_type indexOf(StringView str) const
 		{
-			const_iterator iter = std::search(cbegin(), cend(), str.cbegin(), str.cend());
-
-			return (iter == cend()) ? npos : std::distance(cbegin(), iter);
+			return StringSearch::IndexOf(m_ptr, m_length, str.m_ptr, str.m_length, 0);
 		}
 
 		/// <summary>
@@ -503,9 +502,7 @@ namespace s3d
 		/// </returns>
 		size_type indexOf(wchar ch) const noexcept
 		{
-			const_iterator iter = std::find(cbegin(), cend(), ch);
-
-			return (iter == cend()) ? npos : std::distance(cbegin(), iter);
+			return StringSearch::IndexOf(m_ptr, m_length, ch, 0);
 		}
 
 		/// <summary>
@@ -585,9 +582,7 @@ namespace s3d
 		/// </returns>
 		size_type indexOfAny(StringView anyof) const
 		{
-			const_iterator iter = std::find_first_of(cbegin(), cend(), anyof.cbegin(), anyof.cend());
-
-			return (iter == cend()) ? npos : std::distance(cbegin(), iter);
+			return StringSearch::IndexOfAny(m_ptr, m_length, anyof.m_ptr, anyof.m_length, 0);
 		}
 
 		/// <summary>
@@ -693,6 +688,45 @@ namespace s3d
 			return String(m_ptr, m_length);
 		}
 
+		/// <summary>
+		/// 指定した区切り文字で文字列を分割した範囲を返します。
+		/// </summary>
+		/// <param name="ch">
+		/// 区切り文字
+		/// </param>
+		/// <remarks>
+		/// 各要素は同じ文字列を参照する StringView で、メモリを確保しません。
+		/// </remarks>
+		/// <returns>
+		/// 分割された文字列を順に返す範囲
+		/// </returns>
+		StringSplitRange splitView(wchar ch) const;
+
+		/// <summary>
+		/// 空白類文字で区切られたトークンの範囲を返します。
+		/// </summary>
+		/// <remarks>
+		/// 連続する区切りは 1 つとみなし、空のトークンは返しません。
+		/// </remarks>
+		/// <returns>
+		/// トークンを順に返す範囲
+		/// </returns>
+		StringTokenRange tokenize() const;
+
+		/// <summary>
+		/// 指定したいずれかの文字で区切られたトークンの範囲を返します。
+		/// </summary>
+		/// <param name="delimiters">
+		/// 区切り文字の一覧
+		/// </param>
+		/// <remarks>
+		/// 連続する区切りは 1 つとみなし、空のトークンは返しません。
+		/// </remarks>
+		/// <returns>
+		/// トークンを順に返す範囲
+		/// </returns>
+		StringTokenRange tokenize(StringView delimiters) const;
+
 	private:
 
 		size_type reverse_distance(const_reverse_iterator first, const_reverse_iterator last) const
@@ -715,6 +749,409 @@ namespace s3d
 		}
 	};
 
+	/// <summary>
+	/// 区切り文字で分割した文字列を StringView として順に返す範囲
+	/// </summary>
+	/// <remarks>
+	/// 区切り文字が n 個あれば n + 1 個の要素（空の文字列を含む）を返します。空の文字列からは要素を返しません。
+	/// </remarks>
+	class StringSplitRange
+	{
+	private:
+
+		const wchar* m_first = nullptr;
+
+		const wchar* m_last = nullptr;
+
+		wchar m_separator = L'\0';
+
+	public:
+
+		class iterator
+		{
+		private:
+
+			const wchar* m_begin = nullptr;
+
+			const wchar* m_end = nullptr;
+
+			const wchar* m_last = nullptr;
+
+			wchar m_separator = L'\0';
+
+			void findEnd()
+			{
+				m_end = std::char_traits<wchar>::find(m_begin, m_last - m_begin, m_separator);
+
+				if (!m_end)
+				{
+					m_end = m_last;
+				}
+			}
+
+		public:
+
+			using iterator_category	= std::forward_iterator_tag;
+			using value_type		= StringView;
+			using difference_type	= ptrdiff_t;
+			using pointer			= const StringView*;
+			using reference			= StringView;
+
+			iterator() = default;
+
+			iterator(const wchar* first, const wchar* last, wchar separator)
+				: m_begin(first)
+				, m_last(last)
+				, m_separator(separator)
+			{
+				findEnd();
+			}
+
+			StringView operator *() const
+			{
+				return StringView(m_begin, m_end - m_begin);
+			}
+
+			iterator& operator ++()
+			{
+				if (m_end == m_last)
+				{
+					*this = iterator();
+				}
+				else
+				{
+					m_begin = m_end + 1;
+
+					findEnd();
+				}
+
+				return *this;
+			}
+
+			iterator operator ++(int)
+			{
+				const iterator tmp = *this;
+
+				++*this;
+
+				return tmp;
+			}
+
+			bool operator ==(const iterator& other) const
+			{
+				return m_begin == other.m_begin && m_end == other.m_end;
+			}
+
+			bool operator !=(const iterator& other) const
+			{
+				return !(*this == other);
+			}
+		};
+
+		using const_iterator = iterator;
+
+		StringSplitRange() = default;
+
+		StringSplitRange(StringView str, wchar separator)
+			: m_first(str.data())
+			, m_last(str.data() + str.length())
+			, m_separator(separator) {}
+
+		iterator begin() const
+		{
+			return m_first == m_last ? iterator() : iterator(m_first, m_last, m_separator);
+		}
+
+		iterator end() const
+		{
+			return iterator();
+		}
+
+		/// <summary>
+		/// 要素を配列にして返します。
+		/// </summary>
+		/// <returns>
+		/// 分割された文字列の配列
+		/// </returns>
+		Array<StringView> asArray() const
+		{
+			return Array<StringView>(begin(), end());
+		}
+	};
+
+	/// <summary>
+	/// 区切り文字で区切られた空でないトークンを StringView として順に返す範囲
+	/// </summary>
+	class StringTokenRange
+	{
+	private:
+
+		const wchar* m_first = nullptr;
+
+		const wchar* m_last = nullptr;
+
+		StringView m_delimiters;
+
+		bool m_whitespace = true;
+
+	public:
+
+		class iterator
+		{
+		private:
+
+			const wchar* m_begin = nullptr;
+
+			const wchar* m_end = nullptr;
+
+			const wchar* m_last = nullptr;
+
+			StringView m_delimiters;
+
+			bool m_whitespace = true;
+
+			bool isDelimiter(wchar ch) const
+			{
+				if (m_whitespace)
+				{
+					return IsSpace(ch);
+				}
+
+				return std::char_traits<wchar>::find(m_delimiters.data(), m_delimiters.length(), ch) != nullptr;
+			}
+
+			void find(const wchar* pos)
+			{
+				while (pos != m_last && isDelimiter(*pos))
+				{
+					++pos;
+				}
+
+				if (pos == m_last)
+				{
+					*this = iterator();
+
+					return;
+				}
+
+				m_begin = m_end = pos;
+
+				while (m_end != m_last && !isDelimiter(*m_end))
+				{
+					++m_end;
+				}
+			}
+
+		public:
+
+			using iterator_category	= std::forward_iterator_tag;
+			using value_type		= StringView;
+			using difference_type	= ptrdiff_t;
+			using pointer			= const StringView*;
+			using reference			= StringView;
+
+			iterator() = default;
+
+			iterator(const wchar* first, const wchar* last, StringView delimiters, bool whitespace)
+				: m_last(last)
+				, m_delimiters(delimiters)
+				, m_whitespace(whitespace)
+			{
+				find(first);
+			}
+
+			StringView operator *() const
+			{
+				return StringView(m_begin, m_end - m_begin);
+			}
+
+			iterator& operator ++()
+			{
+				find(m_end);
+
+				return *this;
+			}
+
+			iterator operator ++(int)
+			{
+				const iterator tmp = *this;
+
+				++*this;
+
+				return tmp;
+			}
+
+			bool operator ==(const iterator& other) const
+			{
+				return m_begin == other.m_begin;
+			}
+
+			bool operator !=(const iterator& other) const
+			{
+				return !(*this == other);
+			}
+		};
+
+		using const_iterator = iterator;
+
+		StringTokenRange() = default;
+
+		explicit StringTokenRange(StringView str)
+			: m_first(str.data())
+			, m_last(str.data() + str.length()) {}
+
+		StringTokenRange(StringView str, StringView delimiters)
+			: m_first(str.data())
+			, m_last(str.data() + str.length())
+			, m_delimiters(delimiters)
+			, m_whitespace(false) {}
+
+		iterator begin() const
+		{
+			return iterator(m_first, m_last, m_delimiters, m_whitespace);
+		}
+
+		iterator end() const
+		{
+			return iterator();
+		}
+
+		/// <summary>
+		/// 要素を配列にして返します。
+		/// </summary>
+		/// <returns>
+		/// トークンの配列
+		/// </returns>
+		Array<StringView> asArray() const
+		{
+			return Array<StringView>(begin(), end());
+		}
+	};
+
+	inline StringSplitRange StringView::splitView(const wchar ch) const
+	{
+		return StringSplitRange(*this, ch);
+	}
+
+	inline StringTokenRange StringView::tokenize() const
+	{
+		return StringTokenRange(*this);
+	}
+
+	inline StringTokenRange StringView::tokenize(const StringView delimiters) const
+	{
+		return StringTokenRange(*this, delimiters);
+	}
+
+	inline StringSplitRange String::splitView(const wchar ch) const
+	{
+		return StringSplitRange(*this, ch);
+	}
+
+	inline StringTokenRange String::tokenize() const
+	{
+		return StringTokenRange(*this);
+	}
+
+	inline StringTokenRange String::tokenize(const StringView& delimiters) const
+	{
+		return StringTokenRange(*this, delimiters);
+	}
+
+	inline String& String::replaceInPlace(const StringView& oldStr, const StringView& newStr)
+	{
+		// 自身を参照するビューは書き換えや再確保で無効になるので、先にコピーする
+		const auto aliases = [this](const StringView& view)
+		{
+			const std::less<const wchar*> less;
+
+			return !view.empty() && !less(view.data(), m_string.data()) && less(view.data(), m_string.data() + m_string.length());
+		};
+
+		if (aliases(oldStr) || aliases(newStr))
+		{
+			const String oldCopy = oldStr.to_string(), newCopy = newStr.to_string();
+
+			return replaceInPlace(oldCopy, newCopy);
+		}
+
+		const size_t oldLength = oldStr.length(), newLength = newStr.length();
+
+		size_t pos = oldLength ? StringSearch::IndexOf(m_string.data(), m_string.length(), oldStr.data(), oldLength, 0) : npos;
+
+		if (pos == npos)
+		{
+			return *this;
+		}
+
+		if (newLength <= oldLength)
+		{
+			// 前から詰めながら書き換える
+			wchar* const p = &m_string[0];
+
+			size_t write = pos;
+
+			for (;;)
+			{
+				std::char_traits<wchar>::copy(p + write, newStr.data(), newLength);
+
+				write += newLength;
+
+				size_t read = pos + oldLength;
+
+				pos = StringSearch::IndexOf(m_string.data(), m_string.length(), oldStr.data(), oldLength, read);
+
+				const size_t next = (pos == npos) ? m_string.length() : pos;
+
+				std::char_traits<wchar>::move(p + write, p + read, next - read);
+
+				write += next - read;
+
+				if (pos == npos)
+				{
+					break;
+				}
+			}
+
+			m_string.resize(write);
+
+			return *this;
+		}
+
+		size_t count = 0;
+
+		for (size_t i = pos; i != npos; i = StringSearch::IndexOf(m_string.data(), m_string.length(), oldStr.data(), oldLength, i + oldLength))
+		{
+			++count;
+		}
+
+		string_type result;
+
+		result.reserve(m_string.length() + (newLength - oldLength) * count);
+
+		size_t read = 0;
+
+		while (pos != npos)
+		{
+			result.append(m_string, read, pos - read).append(newStr.data(), newLength);
+
+			read = pos + oldLength;
+
+			pos = StringSearch::IndexOf(m_string.data(), m_string.length(), oldStr.data(), oldLength, read);
+		}
+
+		result.append(m_string, read, npos);
+
+		m_string.swap(result);
+
+		return *this;
+	}
+
+	inline String& String::removeInPlace(const StringView& str)
+	{
+		return replaceInPlace(str, StringView());
+	}
+
 	//  Comparison operators
 	//  Equality
 	inline bool operator == (StringView x, StringView y)
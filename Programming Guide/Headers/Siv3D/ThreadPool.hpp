@@ -0,0 +1,507 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include <vector>
+# include <deque>
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+# include <atomic>
+# include <future>
+# include <functional>
+# include <algorithm>
+# include "Fwd.hpp"
+# include "Uncopyable.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// ワークスティーリング方式のスレッドプール
+	/// </summary>
+	/// <remarks>
+	/// ワーカースレッドごとにタスクキューを持ち、自分のキューが空になると他のワーカーのキューからタスクを盗みます。
+	/// ワーカー数が 0 の場合、すべてのタスクは呼び出し側のスレッドで実行されます。
+	/// </remarks>
+	class ThreadPool : private Uncopyable
+	{
+	private:
+
+		using Task = std::function<void()>;
+
+		struct Queue
+		{
+			std::mutex mutex;
+
+			std::deque<Task> tasks;
+		};
+
+		std::vector<std::unique_ptr<Queue>> m_queues;
+
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_sleepMutex;
+
+		std::condition_variable m_condition;
+
+		std::atomic<size_t> m_queued{ 0 };
+
+		std::atomic<size_t> m_next{ 0 };
+
+		bool m_stop = false;
+
+		struct WorkerInfo
+		{
+			const ThreadPool* pool = nullptr;
+
+			size_t index = 0;
+		};
+
+		static WorkerInfo& CurrentWorker()
+		{
+			static thread_local WorkerInfo info;
+
+			return info;
+		}
+
+		size_t queueIndexForPush()
+		{
+			const WorkerInfo& info = CurrentWorker();
+
+			if (info.pool == this)
+			{
+				return info.index;
+			}
+
+			return m_next++ % m_queues.size();
+		}
+
+		bool tryPop(size_t index, Task& task)
+		{
+			Queue& queue = *m_queues[index];
+
+			std::lock_guard<std::mutex> lock(queue.mutex);
+
+			if (queue.tasks.empty())
+			{
+				return false;
+			}
+
+			task = std::move(queue.tasks.back());
+
+			queue.tasks.pop_back();
+
+			--m_queued;
+
+			return true;
+		}
+
+		bool trySteal(size_t index, Task& task)
+		{
+			Queue& queue = *m_queues[index];
+
+			std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+
+			if (!lock || queue.tasks.empty())
+			{
+				return false;
+			}
+
+			task = std::move(queue.tasks.front());
+
+			queue.tasks.pop_front();
+
+			--m_queued;
+
+			return true;
+		}
+
+		bool tryAcquire(size_t self, Task& task)
+		{
+			const size_t num = m_queues.size();
+
+			if (self < num && tryPop(self, task))
+			{
+				return true;
+			}
+
+			for (size_t i = 1; i <= num; ++i)
+			{
+				if (trySteal((self + i) % num, task))
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		void workerLoop(size_t index)
+		{
+			CurrentWorker() = { this, index };
+
+			for (;;)
+			{
+				Task task;
+
+				if (tryAcquire(index, task))
+				{
+					task();
+
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(m_sleepMutex);
+
+				m_condition.wait(lock, [this] { return m_stop || m_queued > 0; });
+
+				if (m_stop && m_queued == 0)
+				{
+					return;
+				}
+			}
+		}
+
+		void push(Task task)
+		{
+			if (m_threads.empty())
+			{
+				task();
+
+				return;
+			}
+
+			{
+				Queue& queue = *m_queues[queueIndexForPush()];
+
+				std::lock_guard<std::mutex> lock(queue.mutex);
+
+				queue.tasks.push_back(std::move(task));
+
+				++m_queued;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_sleepMutex);
+			}
+
+			m_condition.notify_one();
+		}
+
+	public:
+
+		/// <summary>
+		/// スレッドプールを作成します。
+		/// </summary>
+		/// <param name="numThreads">
+		/// ワーカースレッドの数
+		/// </param>
+		explicit ThreadPool(size_t numThreads)
+		{
+			for (size_t i = 0; i < std::max<size_t>(numThreads, 1); ++i)
+			{
+				m_queues.push_back(std::make_unique<Queue>());
+			}
+
+			for (size_t i = 0; i < numThreads; ++i)
+			{
+				m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+			}
+		}
+
+		/// <summary>
+		/// デストラクタ
+		/// </summary>
+		/// <remarks>
+		/// キューに残っているタスクをすべて実行してからスレッドを終了します。
+		/// </remarks>
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_sleepMutex);
+
+				m_stop = true;
+			}
+
+			m_condition.notify_all();
+
+			for (auto& thread : m_threads)
+			{
+				thread.join();
+			}
+		}
+
+		/// <summary>
+		/// ワーカースレッドの数を返します。
+		/// </summary>
+		/// <returns>
+		/// ワーカースレッドの数
+		/// </returns>
+		size_t numThreads() const
+		{
+			return m_threads.size();
+		}
+
+		/// <summary>
+		/// 呼び出し側のスレッドが、このプールのワーカースレッドであるかを返します。
+		/// </summary>
+		/// <returns>
+		/// このプールのワーカースレッドの場合 true, それ以外の場合は false
+		/// </returns>
+		bool isWorkerThread() const
+		{
+			return CurrentWorker().pool == this;
+		}
+
+		/// <summary>
+		/// タスクを追加します。
+		/// </summary>
+		/// <param name="function">
+		/// 実行する関数
+		/// </param>
+		/// <returns>
+		/// 関数の戻り値を受け取る future
+		/// </returns>
+		template <class Fty>
+		auto submit(Fty&& function) -> std::future<decltype(function())>
+		{
+			using Result = decltype(function());
+
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fty>(function));
+
+			std::future<Result> result = task->get_future();
+
+			push([task]() { (*task)(); });
+
+			return result;
+		}
+
+		/// <summary>
+		/// キューに残っているタスクを 1 つ、呼び出し側のスレッドで実行します。
+		/// </summary>
+		/// <returns>
+		/// タスクを実行した場合 true, キューが空だった場合は false
+		/// </returns>
+		bool runPendingTask()
+		{
+			const WorkerInfo& info = CurrentWorker();
+
+			const size_t self = (info.pool == this) ? info.index : m_queues.size();
+
+			Task task;
+
+			if (!tryAcquire(self, task))
+			{
+				return false;
+			}
+
+			task();
+
+			return true;
+		}
+
+		/// <summary>
+		/// [first, last) の各インデックスについて関数を並列に実行し、すべての完了を待ちます。
+		/// </summary>
+		/// <param name="first">
+		/// 最初のインデックス
+		/// </param>
+		/// <param name="last">
+		/// 最後のインデックスの次
+		/// </param>
+		/// <param name="function">
+		/// 各インデックスについて実行する関数
+		/// </param>
+		/// <remarks>
+		/// 待機中は呼び出し側のスレッドもタスクを実行するため、ワーカースレッドの中から呼び出すこともできます。
+		/// </remarks>
+		void parallelFor(size_t first, size_t last, const std::function<void(size_t)>& function)
+		{
+			if (first >= last)
+			{
+				return;
+			}
+
+			if (m_threads.empty() || (last - first) == 1)
+			{
+				for (size_t i = first; i < last; ++i)
+				{
+					function(i);
+				}
+
+				return;
+			}
+
+			std::atomic<size_t> remaining{ last - first };
+
+			std::exception_ptr exception;
+
+			std::mutex exceptionMutex;
+
+			for (size_t i = first + 1; i < last; ++i)
+			{
+				push([&, i]()
+				{
+					try
+					{
+						function(i);
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> lock(exceptionMutex);
+
+						exception = std::current_exception();
+					}
+
+					--remaining;
+				});
+			}
+
+			try
+			{
+				function(first);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(exceptionMutex);
+
+				exception = std::current_exception();
+			}
+
+			--remaining;
+
+			while (remaining > 0)
+			{
+				if (!runPendingTask())
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			if (exception)
+			{
+				std::rethrow_exception(exception);
+			}
+		}
+	};
+
+	namespace Threading
+	{
+		namespace detail
+		{
+			struct DefaultPoolHolder
+			{
+				std::mutex mutex;
+
+				std::shared_ptr<ThreadPool> pool;
+			};
+
+			inline DefaultPoolHolder& GetDefaultPoolHolder()
+			{
+				static DefaultPoolHolder holder;
+
+				return holder;
+			}
+
+			// 最後の参照が自分のワーカースレッド上で解放されたプールは、別のスレッドで破棄する
+			struct PoolDeleter
+			{
+				void operator()(ThreadPool* pool) const
+				{
+					if (pool->isWorkerThread())
+					{
+						std::thread([pool]() { delete pool; }).detach();
+					}
+					else
+					{
+						delete pool;
+					}
+				}
+			};
+
+			inline std::shared_ptr<ThreadPool> MakePool(size_t numThreads)
+			{
+				return std::shared_ptr<ThreadPool>(new ThreadPool(numThreads), PoolDeleter());
+			}
+		}
+
+		/// <summary>
+		/// 論理コア数から決まる、既定のワーカースレッド数を返します。
+		/// </summary>
+		/// <returns>
+		/// 既定のワーカースレッド数
+		/// </returns>
+		inline size_t DefaultPoolSize()
+		{
+			const size_t concurrency = std::thread::hardware_concurrency();
+
+			return concurrency > 1 ? (concurrency - 1) : 0;
+		}
+
+		/// <summary>
+		/// エンジン共有のスレッドプールを返します。
+		/// </summary>
+		/// <returns>
+		/// 共有のスレッドプール
+		/// </returns>
+		/// <remarks>
+		/// 初回の呼び出し時に DefaultPoolSize() 個のワーカースレッドで作成されます。
+		/// </remarks>
+		inline std::shared_ptr<ThreadPool> GetPool()
+		{
+			auto& holder = detail::GetDefaultPoolHolder();
+
+			std::lock_guard<std::mutex> lock(holder.mutex);
+
+			if (!holder.pool)
+			{
+				holder.pool = detail::MakePool(DefaultPoolSize());
+			}
+
+			return holder.pool;
+		}
+
+		/// <summary>
+		/// 共有のスレッドプールのワーカースレッド数を変更します。
+		/// </summary>
+		/// <param name="numThreads">
+		/// ワーカースレッドの数。0 の場合はすべての処理を呼び出し側のスレッドで実行します。
+		/// </param>
+		/// <remarks>
+		/// 実行中のタスクは古いプールで最後まで実行されます。
+		/// プールのタスクの中から呼び出すこともでき、その場合の古いプールは別のスレッドで破棄されます。
+		/// </remarks>
+		/// <returns>
+		/// なし
+		/// </returns>
+		inline void SetPoolSize(size_t numThreads)
+		{
+			auto& holder = detail::GetDefaultPoolHolder();
+
+			auto pool = detail::MakePool(numThreads);
+
+			std::lock_guard<std::mutex> lock(holder.mutex);
+
+			holder.pool.swap(pool);
+		}
+
+		/// <summary>
+		/// 共有のスレッドプールのワーカースレッド数を返します。
+		/// </summary>
+		/// <returns>
+		/// ワーカースレッドの数
+		/// </returns>
+		inline size_t GetPoolSize()
+		{
+			return GetPool()->numThreads();
+		}
+	}
+}
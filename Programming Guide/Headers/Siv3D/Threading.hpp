@@ -14,6 +14,7 @@
 # include "String.hpp"
 # include "Image.hpp"
 # include "Wave.hpp"
+# include "ImageBatch.hpp"
 
 namespace s3d
 {
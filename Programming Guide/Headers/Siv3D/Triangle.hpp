@@ -191,6 +191,12 @@ namespace s3d
 			<< triangle.p2 << CharType(')');
 	}
 
+	template <>
+	inline void Formatter(FormatData& formatData, const Triangle& triangle)
+	{
+		FormatTuple(formatData, triangle.p0, triangle.p1, triangle.p2);
+	}
+
 	template <class CharType>
 	inline std::basic_istream<CharType>& operator >> (std::basic_istream<CharType>& is, Triangle& triangle)
 	{
@@ -200,4 +206,18 @@ namespace s3d
 			>> triangle.p1 >> unused
 			>> triangle.p2 >> unused;
 	}
+
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Triangle& triangle)
+	{
+		Triangle result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.p0, result.p1, result.p2);
+
+		if (r)
+		{
+			triangle = result;
+		}
+
+		return r;
+	}
 }
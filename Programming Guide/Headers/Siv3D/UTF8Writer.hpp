@@ -0,0 +1,393 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include <cstring>
+# include <algorithm>
+# include <utility>
+# include "Fwd.hpp"
+# include "Array.hpp"
+# include "String.hpp"
+# include "StringView.hpp"
+# include "IWriter.hpp"
+# include "BinaryWriter.hpp"
+# include "Unicode.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// IWriter へ UTF-8 のテキストを書き出すバッファ
+	/// </summary>
+	/// <remarks>
+	/// 書き込んだ文字列は固定長のバッファで UTF-8 に変換され、バッファが一杯になるたびに IWriter に書き出されます。
+	/// 書き出す量によらず、使うメモリはバッファの大きさだけです。
+	/// flush() または close() を呼ぶか、デストラクタが呼ばれるまで、最後の部分は書き出されません。
+	/// </remarks>
+	class UTF8Writer
+	{
+	private:
+
+		std::shared_ptr<IWriter> m_writer;
+
+		Array<char> m_buffer;
+
+		size_t m_size = 0;
+
+		FilePath m_path;
+
+		bool openWriter(const std::shared_ptr<IWriter>& writer, bool writeBOM)
+		{
+			close();
+
+			if (!writer || !writer->isOpened())
+			{
+				return false;
+			}
+
+			m_writer = writer;
+
+			m_size = 0;
+
+			if (m_buffer.size() < MinBufferSize)
+			{
+				m_buffer.resize(DefaultBufferSize);
+			}
+
+			if (writeBOM && m_writer->size() == 0)
+			{
+				writeUTF8("\xEF\xBB\xBF", 3);
+			}
+
+			return true;
+		}
+
+	public:
+
+		/// <summary>
+		/// デフォルトのバッファの大きさ（バイト）
+		/// </summary>
+		static constexpr size_t DefaultBufferSize = 64 * 1024;
+
+		/// <summary>
+		/// バッファの大きさの最小値（バイト）
+		/// </summary>
+		static constexpr size_t MinBufferSize = 16;
+
+		/// <summary>
+		/// デフォルトコンストラクタ
+		/// </summary>
+		UTF8Writer() = default;
+
+		/// <summary>
+		/// 書き出し用のファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <param name="openMode">
+		/// ファイルのオープンモード
+		/// </param>
+		/// <param name="writeBOM">
+		/// ファイルが空のとき、先頭に BOM を書き込むか
+		/// </param>
+		explicit UTF8Writer(const FilePath& path, OpenMode openMode = OpenMode::Trunc, bool writeBOM = true)
+		{
+			open(path, openMode, writeBOM);
+		}
+
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <param name="writeBOM">
+		/// IWriter が空のとき、先頭に BOM を書き込むか
+		/// </param>
+		template <class Writer, class = std::enable_if_t<std::is_base_of<IWriter, std::decay_t<Writer>>::value>>
+		explicit UTF8Writer(Writer&& writer, bool writeBOM = false)
+		{
+			open(std::forward<Writer>(writer), writeBOM);
+		}
+
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <param name="writeBOM">
+		/// IWriter が空のとき、先頭に BOM を書き込むか
+		/// </param>
+		explicit UTF8Writer(const std::shared_ptr<IWriter>& writer, bool writeBOM = false)
+		{
+			open(writer, writeBOM);
+		}
+
+		UTF8Writer(const UTF8Writer&) = delete;
+
+		UTF8Writer& operator =(const UTF8Writer&) = delete;
+
+		UTF8Writer(UTF8Writer&&) = default;
+
+		UTF8Writer& operator =(UTF8Writer&& other)
+		{
+			close();
+
+			m_writer = std::move(other.m_writer);
+			m_buffer = std::move(other.m_buffer);
+			m_size = std::exchange(other.m_size, 0);
+			m_path = std::move(other.m_path);
+
+			return *this;
+		}
+
+		/// <summary>
+		/// デストラクタ
+		/// </summary>
+		~UTF8Writer()
+		{
+			close();
+		}
+
+		/// <summary>
+		/// 書き出し用のファイルを開きます。
+		/// </summary>
+		/// <param name="path">
+		/// ファイルパス
+		/// </param>
+		/// <param name="openMode">
+		/// ファイルのオープンモード
+		/// </param>
+		/// <param name="writeBOM">
+		/// ファイルが空のとき、先頭に BOM を書き込むか
+		/// </param>
+		/// <returns>
+		/// ファイルのオープンに成功した場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const FilePath& path, OpenMode openMode = OpenMode::Trunc, bool writeBOM = true)
+		{
+			if (!openWriter(std::make_shared<BinaryWriter>(path, openMode), writeBOM))
+			{
+				return false;
+			}
+
+			m_path = path;
+
+			return true;
+		}
+
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <param name="writeBOM">
+		/// IWriter が空のとき、先頭に BOM を書き込むか
+		/// </param>
+		/// <returns>
+		/// IWriter が開いている場合 true, それ以外の場合は false
+		/// </returns>
+		template <class Writer, class = std::enable_if_t<std::is_base_of<IWriter, std::decay_t<Writer>>::value>>
+		bool open(Writer&& writer, bool writeBOM = false)
+		{
+			return openWriter(std::make_shared<std::decay_t<Writer>>(std::forward<Writer>(writer)), writeBOM);
+		}
+
+		/// <summary>
+		/// IWriter に書き出します。
+		/// </summary>
+		/// <param name="writer">
+		/// IWriter
+		/// </param>
+		/// <param name="writeBOM">
+		/// IWriter が空のとき、先頭に BOM を書き込むか
+		/// </param>
+		/// <returns>
+		/// IWriter が開いている場合 true, それ以外の場合は false
+		/// </returns>
+		bool open(const std::shared_ptr<IWriter>& writer, bool writeBOM = false)
+		{
+			return openWriter(writer, writeBOM);
+		}
+
+		/// <summary>
+		/// バッファの内容を書き出し、IWriter を手放します。
+		/// </summary>
+		/// <remarks>
+		/// 閉じた後の書き込みは、再び開くまで無視されます。
+		/// </remarks>
+		void close()
+		{
+			if (!m_writer)
+			{
+				return;
+			}
+
+			flush();
+
+			m_writer.reset();
+
+			m_path.clear();
+		}
+
+		/// <summary>
+		/// バッファの内容を IWriter に書き出します。
+		/// </summary>
+		void flush()
+		{
+			if (m_writer && m_size)
+			{
+				m_writer->write(m_buffer.data(), m_size);
+			}
+
+			m_size = 0;
+		}
+
+		bool isOpened() const
+		{
+			return static_cast<bool>(m_writer);
+		}
+
+		explicit operator bool() const
+		{
+			return isOpened();
+		}
+
+		/// <summary>
+		/// バッファの大きさを変更します。
+		/// </summary>
+		/// <param name="size">
+		/// バッファの大きさ（バイト）
+		/// </param>
+		void setBufferSize(size_t size)
+		{
+			flush();
+
+			m_buffer.resize(size < MinBufferSize ? MinBufferSize : size);
+
+			m_buffer.shrink_to_fit();
+		}
+
+		/// <summary>
+		/// 文字列を UTF-8 に変換して書き込みます。
+		/// </summary>
+		/// <param name="str">
+		/// 文字列
+		/// </param>
+		void write(StringView str)
+		{
+			if (!m_writer)
+			{
+				return;
+			}
+
+			const wchar* p = str.data();
+
+			size_t length = str.length();
+
+			while (length)
+			{
+				// UTF-16 の 1 文字は UTF-8 で最大 3 バイト
+				size_t count = std::min(length, (m_buffer.size() - m_size) / 3);
+
+				// サロゲートペアを分けない
+				if (count && count < length && Unicode::detail::IsHighSurrogate(p[count - 1]))
+				{
+					--count;
+				}
+
+				if (count == 0)
+				{
+					flush();
+
+					continue;
+				}
+
+				m_size += Unicode::UTF16ToUTF8(StringView(p, count), m_buffer.data() + m_size);
+
+				p += count;
+
+				length -= count;
+			}
+		}
+
+		/// <summary>
+		/// 文字を UTF-8 に変換して書き込みます。
+		/// </summary>
+		/// <param name="ch">
+		/// 文字
+		/// </param>
+		void write(wchar ch)
+		{
+			if (!m_writer)
+			{
+				return;
+			}
+
+			if (ch < 0x80 && m_size < m_buffer.size())
+			{
+				m_buffer[m_size++] = static_cast<char>(ch);
+
+				return;
+			}
+
+			write(StringView(&ch, 1));
+		}
+
+		/// <summary>
+		/// UTF-8 のバイト列をそのまま書き込みます。
+		/// </summary>
+		/// <param name="data">
+		/// UTF-8 のバイト列
+		/// </param>
+		/// <param name="size">
+		/// バイト数
+		/// </param>
+		void writeUTF8(const char* data, size_t size)
+		{
+			if (!m_writer)
+			{
+				return;
+			}
+
+			while (size)
+			{
+				if (m_size == m_buffer.size())
+				{
+					flush();
+				}
+
+				const size_t count = std::min(size, m_buffer.size() - m_size);
+
+				std::memcpy(m_buffer.data() + m_size, data, count);
+
+				m_size += count;
+
+				data += count;
+
+				size -= count;
+			}
+		}
+
+		/// <summary>
+		/// 開いているファイルのパスを返します。
+		/// </summary>
+		/// <remarks>
+		/// IWriter に書き出している場合と、クローズしている場合は空の文字列です。
+		/// </remarks>
+		const FilePath& path() const
+		{
+			return m_path;
+		}
+	};
+}
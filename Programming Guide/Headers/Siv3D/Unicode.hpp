@@ -0,0 +1,686 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (C) 2008-2016 Ryo Suzuki
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <string>
+# include <emmintrin.h>
+# include "Fwd.hpp"
+# include "String.hpp"
+# include "StringView.hpp"
+
+namespace s3d
+{
+	/// <summary>
+	/// UTF-8, UTF-16, UTF-32 の相互変換
+	/// </summary>
+	/// <remarks>
+	/// 変換関数は呼び出し側が用意したバッファに書き込み、書き込んだ要素数を返します。
+	/// ASCII が続く区間は SSE2 で 16 文字ずつ変換します。
+	/// 不正なバイト列や対になっていないサロゲートは U+FFFD に置き換えます（不正な部分列 1 つにつき 1 文字）。
+	/// </remarks>
+	namespace Unicode
+	{
+		static_assert(sizeof(wchar) == 2, "Unicode assumes 16-bit wchar");
+
+		/// <summary>
+		/// 不正な入力の代わりに出力される文字
+		/// </summary>
+		constexpr char32_t ReplacementCharacter = 0xFFFD;
+
+		namespace detail
+		{
+			constexpr char32_t InvalidCodePoint = 0xFFFFFFFF;
+
+			inline bool IsHighSurrogate(char32_t ch)
+			{
+				return (ch & 0xFC00) == 0xD800;
+			}
+
+			inline bool IsLowSurrogate(char32_t ch)
+			{
+				return (ch & 0xFC00) == 0xDC00;
+			}
+
+			inline bool IsAscii16(const char* src)
+			{
+				return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src))) == 0;
+			}
+
+			inline bool IsAscii16(const wchar* src)
+			{
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+
+				const __m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<int16>(0xFF80)));
+
+				return _mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) == 0xFFFF;
+			}
+
+			inline void WidenAscii16(const char* src, wchar* dst)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi8(v, _mm_setzero_si128()));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_unpackhi_epi8(v, _mm_setzero_si128()));
+			}
+
+			inline void NarrowAscii16(const wchar* src, char* dst)
+			{
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(a, b));
+			}
+
+			inline char32_t DecodeUTF8Slow(const uint8*& p, const uint8* end)
+			{
+				const uint32 c = *p++;
+
+				size_t count;
+
+				uint32 lower = 0x80, upper = 0xBF;
+
+				char32_t cp;
+
+				if (0xC2 <= c && c <= 0xDF)
+				{
+					count = 1;
+					cp = c & 0x1F;
+				}
+				else if (0xE0 <= c && c <= 0xEF)
+				{
+					count = 2;
+					cp = c & 0x0F;
+					lower = (c == 0xE0) ? 0xA0 : 0x80;
+					upper = (c == 0xED) ? 0x9F : 0xBF;
+				}
+				else if (0xF0 <= c && c <= 0xF4)
+				{
+					count = 3;
+					cp = c & 0x07;
+					lower = (c == 0xF0) ? 0x90 : 0x80;
+					upper = (c == 0xF4) ? 0x8F : 0xBF;
+				}
+				else
+				{
+					return InvalidCodePoint;
+				}
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					if (p == end || *p < lower || upper < *p)
+					{
+						return InvalidCodePoint;
+					}
+
+					cp = (cp << 6) | (*p++ & 0x3F);
+
+					lower = 0x80;
+					upper = 0xBF;
+				}
+
+				return cp;
+			}
+
+			// p から 1 文字を読み、不正な場合は不正な部分列の分だけ進めて InvalidCodePoint を返す
+			inline char32_t DecodeUTF8(const uint8*& p, const uint8* end)
+			{
+				const uint32 c = p[0];
+
+				if (c < 0x80)
+				{
+					++p;
+					return c;
+				}
+
+				// 2 バイトと 3 バイトの正しい文字は分岐を減らして読む
+				if (c < 0xE0)
+				{
+					if (c >= 0xC2 && end - p >= 2 && (p[1] & 0xC0) == 0x80)
+					{
+						const char32_t cp = ((c & 0x1F) << 6) | (p[1] & 0x3F);
+						p += 2;
+						return cp;
+					}
+				}
+				else if (c < 0xF0 && end - p >= 3 && (p[1] & 0xC0) == 0x80 && (p[2] & 0xC0) == 0x80)
+				{
+					const char32_t cp = ((c & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+
+					if (cp >= 0x800 && (cp < 0xD800 || 0xDFFF < cp))
+					{
+						p += 3;
+						return cp;
+					}
+				}
+
+				return DecodeUTF8Slow(p, end);
+			}
+
+			// p から 1 文字を読み、対になっていないサロゲートは InvalidCodePoint を返す
+			inline char32_t DecodeUTF16(const wchar*& p, const wchar* end)
+			{
+				const char32_t c = *p++;
+
+				if (!IsHighSurrogate(c) && !IsLowSurrogate(c))
+				{
+					return c;
+				}
+
+				if (IsHighSurrogate(c) && p != end && IsLowSurrogate(*p))
+				{
+					return 0x10000 + ((c - 0xD800) << 10) + (*p++ - 0xDC00);
+				}
+
+				return InvalidCodePoint;
+			}
+
+			inline char* EncodeUTF8(char32_t cp, char* dst)
+			{
+				if (cp < 0x80)
+				{
+					*dst++ = static_cast<char>(cp);
+				}
+				else if (cp < 0x800)
+				{
+					*dst++ = static_cast<char>(0xC0 | (cp >> 6));
+					*dst++ = static_cast<char>(0x80 | (cp & 0x3F));
+				}
+				else if (cp < 0x10000)
+				{
+					*dst++ = static_cast<char>(0xE0 | (cp >> 12));
+					*dst++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+					*dst++ = static_cast<char>(0x80 | (cp & 0x3F));
+				}
+				else
+				{
+					*dst++ = static_cast<char>(0xF0 | (cp >> 18));
+					*dst++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+					*dst++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+					*dst++ = static_cast<char>(0x80 | (cp & 0x3F));
+				}
+
+				return dst;
+			}
+
+			inline wchar* EncodeUTF16(char32_t cp, wchar* dst)
+			{
+				if (cp < 0x10000)
+				{
+					*dst++ = static_cast<wchar>(cp);
+				}
+				else
+				{
+					*dst++ = static_cast<wchar>(0xD800 + ((cp - 0x10000) >> 10));
+					*dst++ = static_cast<wchar>(0xDC00 + ((cp - 0x10000) & 0x3FF));
+				}
+
+				return dst;
+			}
+
+			inline char32_t Sanitize(char32_t cp)
+			{
+				return (cp > 0x10FFFF || (0xD800 <= cp && cp <= 0xDFFF)) ? ReplacementCharacter : cp;
+			}
+		}
+
+		/// <summary>
+		/// UTF-8 のバイト列が正しいかを返します。
+		/// </summary>
+		/// <param name="src">
+		/// UTF-8 のバイト列
+		/// </param>
+		/// <param name="length">
+		/// バイト数
+		/// </param>
+		/// <returns>
+		/// 正しい UTF-8 である場合 true, それ以外の場合は false
+		/// </returns>
+		inline bool IsValidUTF8(const char* src, size_t length)
+		{
+			const char* const end = src + length;
+
+			while (src != end)
+			{
+				if (static_cast<uint16>(*src) < 0x80 && end - src >= 16 && detail::IsAscii16(src))
+				{
+					src += 16;
+					continue;
+				}
+
+				const uint8* p = reinterpret_cast<const uint8*>(src);
+
+				if (detail::DecodeUTF8(p, reinterpret_cast<const uint8*>(end)) == detail::InvalidCodePoint)
+				{
+					return false;
+				}
+
+				src = reinterpret_cast<const char*>(p);
+			}
+
+			return true;
+		}
+
+		/// <summary>
+		/// UTF-16 の文字列に対になっていないサロゲートが含まれていないかを返します。
+		/// </summary>
+		/// <param name="str">
+		/// 文字列
+		/// </param>
+		/// <returns>
+		/// 正しい UTF-16 である場合 true, それ以外の場合は false
+		/// </returns>
+		inline bool IsValidUTF16(StringView str)
+		{
+			const wchar* src = str.data();
+
+			const wchar* const end = src + str.length();
+
+			while (src != end)
+			{
+				if (detail::DecodeUTF16(src, end) == detail::InvalidCodePoint)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		/// <summary>
+		/// UTF-8 のバイト列を UTF-16 に変換したときの長さを返します。
+		/// </summary>
+		/// <param name="src">
+		/// UTF-8 のバイト列
+		/// </param>
+		/// <param name="length">
+		/// バイト数
+		/// </param>
+		/// <returns>
+		/// 変換後の文字数
+		/// </returns>
+		inline size_t UTF16Length(const char* src, size_t length)
+		{
+			const char* const end = src + length;
+
+			size_t count = 0;
+
+			while (src != end)
+			{
+				if (static_cast<uint16>(*src) < 0x80 && end - src >= 16 && detail::IsAscii16(src))
+				{
+					src += 16;
+					count += 16;
+					continue;
+				}
+
+				const uint8* p = reinterpret_cast<const uint8*>(src);
+
+				const char32_t cp = detail::DecodeUTF8(p, reinterpret_cast<const uint8*>(end));
+
+				count += (cp != detail::InvalidCodePoint && cp >= 0x10000) ? 2 : 1;
+
+				src = reinterpret_cast<const char*>(p);
+			}
+
+			return count;
+		}
+
+		/// <summary>
+		/// UTF-8 のバイト列を UTF-16 に変換します。
+		/// </summary>
+		/// <param name="src">
+		/// UTF-8 のバイト列
+		/// </param>
+		/// <param name="length">
+		/// バイト数
+		/// </param>
+		/// <param name="dst">
+		/// 出力先。UTF16Length(src, length) 文字（最大で length 文字）の領域が必要です。
+		/// </param>
+		/// <returns>
+		/// 書き込んだ文字数
+		/// </returns>
+		inline size_t UTF8ToUTF16(const char* src, size_t length, wchar* dst)
+		{
+			const char* const end = src + length;
+
+			wchar* const first = dst;
+
+			while (src != end)
+			{
+				if (static_cast<uint16>(*src) < 0x80 && end - src >= 16 && detail::IsAscii16(src))
+				{
+					do
+					{
+						detail::WidenAscii16(src, dst);
+						src += 16;
+						dst += 16;
+					} while (end - src >= 16 && detail::IsAscii16(src));
+
+					continue;
+				}
+
+				const uint8* p = reinterpret_cast<const uint8*>(src);
+
+				const char32_t cp = detail::DecodeUTF8(p, reinterpret_cast<const uint8*>(end));
+
+				dst = detail::EncodeUTF16(cp == detail::InvalidCodePoint ? ReplacementCharacter : cp, dst);
+
+				src = reinterpret_cast<const char*>(p);
+			}
+
+			return dst - first;
+		}
+
+		/// <summary>
+		/// UTF-16 の文字列を UTF-8 に変換したときのバイト数を返します。
+		/// </summary>
+		/// <param name="str">
+		/// 文字列
+		/// </param>
+		/// <returns>
+		/// 変換後のバイト数
+		/// </returns>
+		inline size_t UTF8Length(StringView str)
+		{
+			const wchar* src = str.data();
+
+			const wchar* const end = src + str.length();
+
+			size_t count = 0;
+
+			while (src != end)
+			{
+				if (static_cast<uint16>(*src) < 0x80 && end - src >= 16 && detail::IsAscii16(src))
+				{
+					src += 16;
+					count += 16;
+					continue;
+				}
+
+				const char32_t cp = detail::DecodeUTF16(src, end);
+
+				count += (cp < 0x80) ? 1 : (cp < 0x800) ? 2 : (cp < 0x10000 || cp == detail::InvalidCodePoint) ? 3 : 4;
+			}
+
+			return count;
+		}
+
+		/// <summary>
+		/// UTF-16 の文字列を UTF-8 に変換します。
+		/// </summary>
+		/// <param name="str">
+		/// 文字列
+		/// </param>
+		/// <param name="dst">
+		/// 出力先。UTF8Length(str) バイト（最大で str.length() * 3 バイト）の領域が必要です。
+		/// </param>
+		/// <returns>
+		/// 書き込んだバイト数
+		/// </returns>
+		inline size_t UTF16ToUTF8(StringView str, char* dst)
+		{
+			const wchar* src = str.data();
+
+			const wchar* const end = src + str.length();
+
+			char* const first = dst;
+
+			while (src != end)
+			{
+				if (static_cast<uint16>(*src) < 0x80 && end - src >= 16 && detail::IsAscii16(src))
+				{
+					do
+					{
+						detail::NarrowAscii16(src, dst);
+						src += 16;
+						dst += 16;
+					} while (end - src >= 16 && detail::IsAscii16(src));
+
+					continue;
+				}
+
+				const char32_t cp = detail::DecodeUTF16(src, end);
+
+				dst = detail::EncodeUTF8(cp == detail::InvalidCodePoint ? ReplacementCharacter : cp, dst);
+			}
+
+			return dst - first;
+		}
+
+		/// <summary>
+		/// UTF-16 の文字列を UTF-32 に変換したときの長さを返します。
+		/// </summary>
+		/// <param name="str">
+		/// 文字列
+		/// </param>
+		/// <returns>
+		/// 変換後の文字数
+		/// </returns>
+		inline size_t UTF32Length(StringView str)
+		{
+			const wchar* src = str.data();
+
+			const wchar* const end = src + str.length();
+
+			size_t count = 0;
+
+			for (; src != end; ++count)
+			{
+				detail::DecodeUTF16(src, end);
+			}
+
+			return count;
+		}
+
+		/// <summary>
+		/// UTF-16 の文字列を UTF-32 に変換します。
+		/// </summary>
+		/// <param name="str">
+		/// 文字列
+		/// </param>
+		/// <param name="dst">
+		/// 出力先。UTF32Length(str) 文字（最大で str.length() 文字）の領域が必要です。
+		/// </param>
+		/// <returns>
+		/// 書き込んだ文字数
+		/// </returns>
+		inline size_t UTF16ToUTF32(StringView str, char32_t* dst)
+		{
+			const wchar* src = str.data();
+
+			const wchar* const end = src + str.length();
+
+			char32_t* const first = dst;
+
+			while (src != end)
+			{
+				const char32_t cp = detail::DecodeUTF16(src, end);
+
+				*dst++ = (cp == detail::InvalidCodePoint) ? ReplacementCharacter : cp;
+			}
+
+			return dst - first;
+		}
+
+		/// <summary>
+		/// UTF-32 の文字列を UTF-16 に変換したときの長さを返します。
+		/// </summary>
+		/// <param name="src">
+		/// UTF-32 の文字列
+		/// </param>
+		/// <param name="length">
+		/// 文字数
+		/// </param>
+		/// <returns>
+		/// 変換後の文字数
+		/// </returns>
+		inline size_t UTF16Length(const char32_t* src, size_t length)
+		{
+			size_t count = 0;
+
+			for (size_t i = 0; i < length; ++i)
+			{
+				count += (detail::Sanitize(src[i]) >= 0x10000) ? 2 : 1;
+			}
+
+			return count;
+		}
+
+		/// <summary>
+		/// UTF-32 の文字列を UTF-16 に変換します。
+		/// </summary>
+		/// <param name="src">
+		/// UTF-32 の文字列
+		/// </param>
+		/// <param name="length">
+		/// 文字数
+		/// </param>
+		/// <param name="dst">
+		/// 出力先。UTF16Length(src, length) 文字（最大で length * 2 文字）の領域が必要です。
+		/// </param>
+		/// <returns>
+		/// 書き込んだ文字数
+		/// </returns>
+		inline size_t UTF32ToUTF16(const char32_t* src, size_t length, wchar* dst)
+		{
+			wchar* const first = dst;
+
+			for (size_t i = 0; i < length; ++i)
+			{
+				dst = detail::EncodeUTF16(detail::Sanitize(src[i]), dst);
+			}
+
+			return dst - first;
+		}
+
+		/// <summary>
+		/// UTF-8 のバイト列を String に変換します。
+		/// </summary>
+		/// <param name="src">
+		/// UTF-8 のバイト列
+		/// </param>
+		/// <param name="length">
+		/// バイト数
+		/// </param>
+		/// <returns>
+		/// 変換した文字列
+		/// </returns>
+		inline String FromUTF8(const char* src, size_t length)
+		{
+			String result;
+
+			result.resize(length);
+
+			result.resize(UTF8ToUTF16(src, length, &result[0]));
+
+			return result;
+		}
+
+		/// <summary>
+		/// UTF-8 の文字列を String に変換します。
+		/// </summary>
+		/// <param name="str">
+		/// UTF-8 の文字列
+		/// </param>
+		/// <returns>
+		/// 変換した文字列
+		/// </returns>
+		inline String FromUTF8(const std::string& str)
+		{
+			return FromUTF8(str.data(), str.size());
+		}
+
+		/// <summary>
+		/// 文字列を UTF-8 に変換します。
+		/// </summary>
+		/// <param name="str">
+		/// 文字列
+		/// </param>
+		/// <returns>
+		/// UTF-8 の文字列
+		/// </returns>
+		inline std::string ToUTF8(StringView str)
+		{
+			std::string result(UTF8Length(str), '\0');
+
+			UTF16ToUTF8(str, &result[0]);
+
+			return result;
+		}
+
+		/// <summary>
+		/// 文字列を UTF-8 に変換して dst の末尾に追加します。
+		/// </summary>
+		/// <param name="str">
+		/// 文字列
+		/// </param>
+		/// <param name="dst">
+		/// 追加先の文字列
+		/// </param>
+		/// <returns>
+		/// 追加したバイト数
+		/// </returns>
+		inline size_t AppendUTF8(StringView str, std::string& dst)
+		{
+			const size_t offset = dst.size();
+
+			dst.resize(offset + str.length() * 3);
+
+			const size_t written = UTF16ToUTF8(str, &dst[0] + offset);
+
+			dst.resize(offset + written);
+
+			return written;
+		}
+
+		/// <summary>
+		/// UTF-32 の文字列を String に変換します。
+		/// </summary>
+		/// <param name="str">
+		/// UTF-32 の文字列
+		/// </param>
+		/// <returns>
+		/// 変換した文字列
+		/// </returns>
+		inline String FromUTF32(const std::u32string& str)
+		{
+			String result;
+
+			result.resize(str.size() * 2);
+
+			result.resize(UTF32ToUTF16(str.data(), str.size(), &result[0]));
+
+			return result;
+		}
+
+		/// <summary>
+		/// 文字列を UTF-32 に変換します。
+		/// </summary>
+		/// <param name="str">
+		/// 文字列
+		/// </param>
+		/// <returns>
+		/// UTF-32 の文字列
+		/// </returns>
+		inline std::u32string ToUTF32(StringView str)
+		{
+			std::u32string result(str.length(), U'\0');
+
+			result.resize(UTF16ToUTF32(str, &result[0]));
+
+			return result;
+		}
+	}
+}
@@ -275,6 +275,12 @@ namespace s3d
 		return os << CharType('(') << v.x << CharType(',') << v.y << CharType(')');
 	}
 
+	template <class Type>
+	inline void Formatter(FormatData& formatData, const Vector2D<Type>& v)
+	{
+		FormatTuple(formatData, v.x, v.y);
+	}
+
 	/// <summary>
 	/// 入力ストリームに 2 次元ベクトルを渡します。
 	/// </summary>
@@ -294,6 +300,21 @@ namespace s3d
 		return is >> unused >> v.x >> unused >> v.y >> unused;
 	}
 
+	template <class Type>
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Vector2D<Type>& v)
+	{
+		Vector2D<Type> result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.x, result.y);
+
+		if (r)
+		{
+			v = result;
+		}
+
+		return r;
+	}
+
 	using Float2	= Vector2D<float>;
 	using Vec2		= Vector2D<double>;
 
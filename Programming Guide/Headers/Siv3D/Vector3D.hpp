@@ -261,6 +261,12 @@ namespace s3d
 		return os << CharType('(') << v.x << CharType(',') << v.y << CharType(',') << v.z << CharType(')');
 	}
 
+	template <class Type>
+	inline void Formatter(FormatData& formatData, const Vector3D<Type>& v)
+	{
+		FormatTuple(formatData, v.x, v.y, v.z);
+	}
+
 	/// <summary>
 	/// 入力ストリームに 3 次元ベクトルを渡します。
 	/// </summary>
@@ -280,6 +286,21 @@ namespace s3d
 		return is >> unused >> v.x >> unused >> v.y >> unused >> v.z >> unused;
 	}
 
+	template <class Type>
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Vector3D<Type>& v)
+	{
+		Vector3D<Type> result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.x, result.y, result.z);
+
+		if (r)
+		{
+			v = result;
+		}
+
+		return r;
+	}
+
 	using Float3	= Vector3D<float>;
 	using Vec3		= Vector3D<double>;
 
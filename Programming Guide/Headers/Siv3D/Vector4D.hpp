@@ -273,6 +273,12 @@ namespace s3d
 		return os << CharType('(') << v.x << CharType(',') << v.y << CharType(',') << v.z << CharType(',') << v.w << CharType(')');
 	}
 
+	template <class Type>
+	inline void Formatter(FormatData& formatData, const Vector4D<Type>& v)
+	{
+		FormatTuple(formatData, v.x, v.y, v.z, v.w);
+	}
+
 	/// <summary>
 	/// 入力ストリームに 4 次元ベクトルを渡します。
 	/// </summary>
@@ -292,6 +298,21 @@ namespace s3d
 		return is >> unused >> v.x >> unused >> v.y >> unused >> v.z >> unused >> v.w >> unused;
 	}
 
+	template <class Type>
+	inline FromCharsResult FromChars(const wchar* first, const wchar* last, Vector4D<Type>& v)
+	{
+		Vector4D<Type> result;
+
+		const FromCharsResult r = detail::ScanTuple(first, last, result.x, result.y, result.z, result.w);
+
+		if (r)
+		{
+			v = result;
+		}
+
+		return r;
+	}
+
 	using Float4	= Vector4D<float>;
 	using Vec4		= Vector4D<double>;
 